@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -5,16 +10,17 @@
 #include <GLFW/glfw3.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <imgui/imgui.h>
-#include <imgui/imgui_impl_glfw.h>
 #include <imgui/imgui_impl_opengl3.h>
 #include <core/clock.hpp>
 #include <core/controls.hpp>
+#include <core/fixed_timestep.hpp>
 #include <core/mouse.hpp>
 #include <orc/cube.hpp>
 #include <orc/cubemap.hpp>
 #include <orc/light.hpp>
 #include <orc/model.hpp>
 #include <orc/object.hpp>
+#include <orc/render_thread.hpp>
 #include <orc/scene.hpp>
 #include <orc/skybox.hpp>
 
@@ -34,14 +40,21 @@ void initializeGLFW()
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 }
 
+// The debug UI is drawn by whichever thread renders, which isn't always the
+// main thread, so it doesn't use ImGui's GLFW backend: most GLFW functions
+// may only be called from the main thread. The UI is display only, and the
+// window is fullscreen, so it only needs to be told the window's size.
 void initializeDebugUi(GLFWwindow *window)
 {
+    int width, height;
+    glfwGetWindowSize(window, &width, &height);
+
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGui::StyleColorsDark();
     ImGui::GetIO().IniFilename = "var/imgui.ini";
     ImGui::GetIO().LogFilename = "var/log/imgui.log";
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui::GetIO().DisplaySize = ImVec2((float)width, (float)height);
     ImGui_ImplOpenGL3_Init("#version 330");
 }
 
@@ -64,27 +77,124 @@ GLFWwindow *openWindowedFullscreenWindow(const char *title)
     return glfwCreateWindow(mode->width, mode->height, title, monitor, NULL);
 }
 
-void buildDebugUi(const orc::Scene &scene)
+// Draws the debug UI over a frame. The frame's stats come from its snapshot,
+// since the scene may already be a frame ahead of it. targetDistance is
+// whatever the main thread last picked, or infinity if nothing.
+void drawDebugUi(const orc::RenderSnapshot &snapshot, float targetDistance)
 {
-    glm::vec3 cameraPos = scene.GetCamera().GetPosition();
+    static double lastFrameTime = glfwGetTime();
+    double t = glfwGetTime();
+    ImGui::GetIO().DeltaTime = std::max((float)(t - lastFrameTime), 1e-6f);
+    lastFrameTime = t;
 
+    ImGui_ImplOpenGL3_NewFrame();
+    ImGui::NewFrame();
     ImGui::Begin("Debug Window");
 
+    const glm::vec3 &cameraPos = snapshot.CameraPosition;
+    const orc::SceneStats &stats = snapshot.Stats;
     ImGui::Text("Camera Position: (%.1f, %.1f, %.1f)", cameraPos.x, cameraPos.y, cameraPos.z);
     ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
+    ImGui::Text("Updated Nodes: %zu", stats.UpdatedNodes);
+    ImGui::Text("Visible Meshes: %zu", stats.VisibleMeshes);
+    ImGui::Text("Culled Meshes: %zu", stats.CulledMeshes);
+    ImGui::Text("Lights: %zu", stats.Lights);
+    ImGui::Text("Clustered Lights: %zu", stats.ClusteredLights);
+    ImGui::Text("Skipped Meshes: %zu", stats.SkippedMeshes);
+    ImGui::Text("Occluded Meshes: %zu (%zu occluders)", stats.OccludedMeshes, stats.Occluders);
+    ImGui::Text("Triangles: %zu / %zu", stats.SubmittedTriangles, stats.FullDetailTriangles);
+    ImGui::Text("Draw Calls: %zu", stats.DrawCalls);
+    ImGui::Text("Batched Meshes: %zu (%zu merged)", stats.BatchedMeshes, stats.MergedMeshes);
+    if (std::isfinite(targetDistance)) ImGui::Text("Target Distance: %.1f", targetDistance);
+    else ImGui::Text("Target Distance: none");
 
     ImGui::End();
+    ImGui::Render();
+    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
 
 void cleanupDebugUi()
 {
     ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
 }
 
-int main()
+// Renders the same flythrough of the scene twice: once updating and drawing
+// each frame on the main thread, and once drawing on a render thread while
+// the main thread updates the next frame. Prints the throughput and latency
+// of both, where latency is the time from starting to update a frame until
+// the GPU has finished drawing it.
+void runBenchmark(GLFWwindow *window, orc::Scene &scene, int numFrames)
 {
+    // Frames aren't held back by the display, and each one is waited for so
+    // that latency covers the GPU's work too
+    glfwSwapInterval(0);
+    std::vector<double> frameStarts(numFrames), frameEnds(numFrames);
+    auto step = [&scene, numFrames]() {
+        scene.GetCamera().Rotate(glm::radians(360.0f / numFrames), 0, 0);
+        scene.Update();
+    };
+    auto renderFrame = [window, &scene](const orc::RenderSnapshot &snapshot) {
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        scene.Render(snapshot);
+        glfwSwapBuffers(window);
+        glFinish();
+    };
+    auto report = [&frameStarts, &frameEnds, numFrames](const char *mode) {
+        double latency = 0.0;
+        for (int i = 0; i < numFrames; i++) latency += frameEnds[i] - frameStarts[i];
+        double seconds = frameEnds[numFrames - 1] - frameStarts[0];
+        printf(
+            "%-14s %8.1f frames/s %8.2f ms/frame %8.2f ms latency\n",
+            mode,
+            numFrames / seconds,
+            1000.0 * seconds / numFrames,
+            1000.0 * latency / numFrames
+        );
+    };
+
+    orc::RenderSnapshot snapshot;
+    for (int i = 0; i < numFrames; i++)
+    {
+        frameStarts[i] = glfwGetTime();
+        step();
+        scene.Extract(snapshot);
+        renderFrame(snapshot);
+        frameEnds[i] = glfwGetTime();
+    }
+    snapshot.Clear();
+    report("Single thread");
+
+    // Frames are drawn in the order that they're submitted
+    glfwMakeContextCurrent(nullptr);
+    {
+        int numRendered = 0;
+        orc::RenderThread renderThread(
+            scene,
+            [window] { glfwMakeContextCurrent(window); },
+            [&renderFrame, &frameEnds, &numRendered](const orc::RenderSnapshot &snapshot) {
+                renderFrame(snapshot);
+                frameEnds[numRendered++] = glfwGetTime();
+            },
+            [] { glfwMakeContextCurrent(nullptr); }
+        );
+        for (int i = 0; i < numFrames; i++)
+        {
+            frameStarts[i] = glfwGetTime();
+            step();
+            renderThread.Submit();
+        }
+    }
+    glfwMakeContextCurrent(window);
+    report("Render thread");
+}
+
+int main(int argc, char *argv[])
+{
+    // With --benchmark, renders a fixed flythrough instead of taking input
+    bool isBenchmark = argc > 1 && std::string(argv[1]) == "--benchmark";
+
     srand(time(nullptr)); // Initialize RNG
     initializeGLFW();
 
@@ -128,69 +238,131 @@ int main()
     scene.GetCamera().Translate(13, 1.5, 0);
     scene.GetCamera().Rotate(glm::radians(90.0f), 0, 0);
 
-    // This model is not checked into source control for practical reasons
-    std::shared_ptr<orc::Object> object = orc::LoadModel("data/models/sponza_scene/scene.gltf");
-    object->Scale(1.5, 1.5, 1.5);
-    scene.GetRoot().AttachChild(object);
+    // Importing the models takes seconds, so they're imported once and saved
+    // to a snapshot, which later launches load instead. Delete the snapshot
+    // after changing the models.
+    const std::string snapshotPath = "data/models/demo.snapshot";
+    if (std::filesystem::exists(snapshotPath))
+    {
+        scene.Load(snapshotPath);
+    }
+    else
+    {
+        // This model is not checked into source control for practical reasons
+        std::shared_ptr<orc::Object> object = orc::LoadModel("data/models/sponza_scene/scene.gltf", scene.GetNodePool());
+        object->Scale(1.5, 1.5, 1.5);
+        scene.GetRoot().AttachChild(object);
+
+        std::shared_ptr<orc::Object> object2 = orc::LoadModel("data/models/legion_commander/scene.gltf", scene.GetNodePool(), true);
+        object2->Scale(0.01, 0.01, 0.01);
+        object2->Translate(0, 0.05, 0);
+        object2->Rotate(glm::radians(90.0f), 0, 0);
+        scene.GetRoot().AttachChild(object2);
+
+        scene.Save(snapshotPath);
+    }
+
+    // The models never move, so each is merged into a few large meshes
+    std::vector<std::shared_ptr<orc::Node>> models = scene.GetRoot().GetChildren();
+    for (const std::shared_ptr<orc::Node> &model : models)
+    {
+        if (model.get() != &scene.GetCamera()) scene.BatchStatic(*model);
+    }
 
-    std::shared_ptr<orc::Object> object2 = orc::LoadModel("data/models/legion_commander/scene.gltf");
-    object2->Scale(0.01, 0.01, 0.01);
-    object2->Translate(0, 0.05, 0);
-    object2->Rotate(glm::radians(90.0f), 0, 0);
-    scene.GetRoot().AttachChild(object2);
+    // Small colored lights along the floor of the atrium. Each only reaches
+    // a few units, so only nearby fragments pay for it.
+    for (int i = 0; i < 256; i++)
+    {
+        std::shared_ptr<orc::OmniLight> light = orc::OmniLight::Create(scene.GetNodePool());
+        light->SetColor(rand() / (float)RAND_MAX, rand() / (float)RAND_MAX, rand() / (float)RAND_MAX);
+        light->SetRange(3.0f);
+        light->Translate(rand() / (float)RAND_MAX * 36 - 18, 0.5, rand() / (float)RAND_MAX * 14 - 7);
+        light->Scale(0.05, 0.05, 0.05);
+        scene.GetRoot().AttachChild(light);
+    }
+
+    std::shared_ptr<orc::SpotLight> flash = orc::SpotLight::Create(scene.GetNodePool());
+    flash->SetRange(40.0f);
 
-    std::shared_ptr<orc::SpotLight> flash = orc::SpotLight::Create();
+    if (isBenchmark)
+    {
+        runBenchmark(window, scene, 1000);
+        cleanupDebugUi();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 0;
+    }
 
     Clock clock;
+    FixedTimestep timestep;
     KeyboardMouseControls ctrl(*window, 0.2f);
     bool isFlashlightOn = false;
+    std::atomic<float> targetDistance(INFINITY);
 
-    while(!glfwWindowShouldClose(window))
+    // The render thread draws each frame while this thread updates the scene
+    // for the next one, and takes over the context until it stops
+    glfwMakeContextCurrent(nullptr);
     {
-        // Notify ImGui of each frame
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
-
-        clock.tick();
-        ctrl.newFrame(clock.getElapsedSeconds());
-
-        // TODO: Build orientation-specific translation into Node API (e.g. TranslateFront())
-        glm::vec3 cameraTranslation = 6.0f * (
-            scene.GetCamera().GetFront() * (float)ctrl.getValue(Controls::Signal::moveY) +
-            scene.GetCamera().GetRight() * (float)ctrl.getValue(Controls::Signal::moveX)
+        orc::RenderThread renderThread(
+            scene,
+            [window] { glfwMakeContextCurrent(window); },
+            [window, &scene, &targetDistance](const orc::RenderSnapshot &snapshot) {
+                // Fill background color first
+                glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+                scene.Render(snapshot);
+                drawDebugUi(snapshot, targetDistance);
+                glfwSwapBuffers(window);
+            },
+            [] { glfwMakeContextCurrent(nullptr); }
         );
-        glm::vec3 cameraRotation(
-            -glm::radians(ctrl.getValue(Controls::Signal::aimX)),
-            glm::radians(ctrl.getValue(Controls::Signal::aimY)),
-            0
-        );
-        scene.GetCamera().Translate(cameraTranslation.x, cameraTranslation.y, cameraTranslation.z);
-        scene.GetCamera().Rotate(cameraRotation.x, cameraRotation.y, cameraRotation.z);
 
-        if (ctrl.isLeading(Controls::Signal::exit)) glfwSetWindowShouldClose(window, true);
-        if (ctrl.isLeading(Controls::Signal::action2))
+        while(!glfwWindowShouldClose(window))
         {
-            isFlashlightOn = !isFlashlightOn;
-            if (isFlashlightOn) scene.GetCamera().AttachChild(flash);
-            else flash->Detach();
+            // The simulation runs at a fixed rate, however fast frames are
+            // drawn, and frames are drawn partway between its last two steps
+            clock.tick();
+            int steps = timestep.advance(clock.getElapsedSeconds());
+            for (int i = 0; i < steps; i++)
+            {
+                scene.BeginStep();
+                ctrl.newFrame(timestep.getStepSeconds());
+
+                // TODO: Build orientation-specific translation into Node API (e.g. TranslateFront())
+                glm::vec3 cameraTranslation = 6.0f * (
+                    scene.GetCamera().GetFront() * (float)ctrl.getValue(Controls::Signal::moveY) +
+                    scene.GetCamera().GetRight() * (float)ctrl.getValue(Controls::Signal::moveX)
+                );
+                glm::vec3 cameraRotation(
+                    -glm::radians(ctrl.getValue(Controls::Signal::aimX)),
+                    glm::radians(ctrl.getValue(Controls::Signal::aimY)),
+                    0
+                );
+                scene.GetCamera().Translate(cameraTranslation.x, cameraTranslation.y, cameraTranslation.z);
+                scene.GetCamera().Rotate(cameraRotation.x, cameraRotation.y, cameraRotation.z);
+
+                if (ctrl.isLeading(Controls::Signal::exit)) glfwSetWindowShouldClose(window, true);
+                if (ctrl.isLeading(Controls::Signal::action2))
+                {
+                    isFlashlightOn = !isFlashlightOn;
+                    if (isFlashlightOn) scene.GetCamera().AttachChild(flash);
+                    else flash->Detach();
+                }
+
+                scene.Update();
+            }
+            scene.SetInterpolation(timestep.getAlpha());
+
+            // Pick whatever is at the center of the screen
+            orc::RaycastHit hit = scene.Raycast(scene.GetCamera().GetPosition(), scene.GetCamera().GetFront());
+            targetDistance = hit.HitObject ? hit.Distance : INFINITY;
+
+            renderThread.Submit();
+            glfwPollEvents();
         }
-
-        // Fill background color first
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        scene.Update();
-        scene.Draw();
-
-        // Render the debug UI
-        buildDebugUi(scene);
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-
-        glfwSwapBuffers(window);
-        glfwPollEvents();
     }
+    glfwMakeContextCurrent(window);
 
     cleanupDebugUi();
     glfwDestroyWindow(window);
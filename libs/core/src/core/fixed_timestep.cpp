@@ -0,0 +1,42 @@
+#include "fixed_timestep.hpp"
+
+FixedTimestep::FixedTimestep(double stepSeconds, int maxSteps)
+    : stepSeconds(stepSeconds)
+    , maxSteps(maxSteps)
+    , accumulated(0.0)
+    , dropped(0.0)
+{}
+
+int FixedTimestep::advance(double elapsed)
+{
+    accumulated += elapsed;
+
+    double maxAccumulated = stepSeconds * maxSteps;
+    if (accumulated >= maxAccumulated + stepSeconds)
+    {
+        // Keep whatever part of a step had accumulated, so that alpha doesn't
+        // jump when falling behind
+        double excess = (int)((accumulated - maxAccumulated) / stepSeconds) * stepSeconds;
+        dropped += excess;
+        accumulated -= excess;
+    }
+
+    int steps = (int)(accumulated / stepSeconds);
+    accumulated -= steps * stepSeconds;
+    return steps;
+}
+
+double FixedTimestep::getStepSeconds()
+{
+    return stepSeconds;
+}
+
+double FixedTimestep::getAlpha()
+{
+    return accumulated / stepSeconds;
+}
+
+double FixedTimestep::getDroppedSeconds()
+{
+    return dropped;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+// Drives a simulation in steps of a fixed length, regardless of how long
+// frames take. Time elapsed between frames accumulates, and each frame runs
+// as many whole steps as have accumulated. The remainder carries over to the
+// next frame, and is exposed as an interpolation factor so that rendering
+// can blend between the last two steps.
+class FixedTimestep
+{
+    public:
+    // If a frame falls so far behind that it would need more than maxSteps
+    // steps to catch up, the excess time is dropped. Otherwise a slow frame
+    // would have to simulate more steps, making the next frame slower still.
+    FixedTimestep(double stepSeconds = 1.0 / 60.0, int maxSteps = 5);
+
+    // Should be called once on every frame with the number of seconds that
+    // have elapsed since the previous frame. Returns the number of steps to
+    // run before drawing the frame.
+    int advance(double elapsed);
+
+    double getStepSeconds();
+
+    // Gets the fraction of a step, in [0, 1), by which real time is ahead of
+    // the last step that was run
+    double getAlpha();
+
+    // Gets the total number of seconds that have been dropped to keep up
+    double getDroppedSeconds();
+
+    private:
+    double stepSeconds;
+    int maxSteps;
+    double accumulated;
+    double dropped;
+};
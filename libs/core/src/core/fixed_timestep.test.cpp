@@ -0,0 +1,53 @@
+#include <catch2/catch_test_macros.hpp>
+#include "fixed_timestep.hpp"
+
+// Steps are a quarter of a second long, so that every sum below is exact
+
+TEST_CASE("Whole steps are run as soon as they've elapsed", "[core]") {
+    FixedTimestep timestep(0.25, 5);
+    REQUIRE(timestep.getStepSeconds() == 0.25);
+
+    REQUIRE(timestep.advance(0.5) == 2);
+    REQUIRE(timestep.getAlpha() == 0.0);
+    REQUIRE(timestep.advance(0.25) == 1);
+    REQUIRE(timestep.getAlpha() == 0.0);
+    REQUIRE(timestep.advance(0.0) == 0);
+    REQUIRE(timestep.getDroppedSeconds() == 0.0);
+}
+
+TEST_CASE("Time left over from a step carries into the next frame", "[core]") {
+    FixedTimestep timestep(0.25, 5);
+
+    // Less than a step runs nothing, but moves alpha along
+    REQUIRE(timestep.advance(0.125) == 0);
+    REQUIRE(timestep.getAlpha() == 0.5);
+
+    REQUIRE(timestep.advance(0.3125) == 1);
+    REQUIRE(timestep.getAlpha() == 0.75);
+    REQUIRE(timestep.advance(0.0625) == 1);
+    REQUIRE(timestep.getAlpha() == 0.0);
+    REQUIRE(timestep.getDroppedSeconds() == 0.0);
+}
+
+TEST_CASE("Frames that fall too far behind drop whole steps", "[core]") {
+    FixedTimestep timestep(0.25, 5);
+
+    // Just short of one step more than the maximum is caught up on
+    REQUIRE(timestep.advance(1.375) == 5);
+    REQUIRE(timestep.getAlpha() == 0.5);
+    REQUIRE(timestep.getDroppedSeconds() == 0.0);
+
+    // With one step more, that step is dropped
+    REQUIRE(timestep.advance(1.375) == 5);
+    REQUIRE(timestep.getAlpha() == 0.0);
+    REQUIRE(timestep.getDroppedSeconds() == 0.25);
+
+    // Part of a step that had accumulated is kept, so alpha doesn't jump
+    REQUIRE(timestep.advance(10.125) == 5);
+    REQUIRE(timestep.getAlpha() == 0.5);
+    REQUIRE(timestep.getDroppedSeconds() == 9.0);
+
+    // Dropping doesn't affect the frames that follow
+    REQUIRE(timestep.advance(0.125) == 1);
+    REQUIRE(timestep.getAlpha() == 0.0);
+}
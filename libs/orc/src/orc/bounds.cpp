@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+
+static const glm::vec3 &pointAt(const glm::vec3 *points, size_t i, size_t stride)
+{
+    return *reinterpret_cast<const glm::vec3 *>(reinterpret_cast<const char *>(points) + i * stride);
+}
+
+namespace orc
+{
+    AABB EmptyAABB()
+    {
+        return AABB{
+            .Min = glm::vec3(std::numeric_limits<float>::infinity()),
+            .Max = glm::vec3(-std::numeric_limits<float>::infinity()),
+        };
+    }
+
+    bool IsEmpty(const AABB &box)
+    {
+        return box.Min.x > box.Max.x || box.Min.y > box.Max.y || box.Min.z > box.Max.z;
+    }
+
+    AABB Merge(const AABB &a, const AABB &b)
+    {
+        return AABB{.Min = glm::min(a.Min, b.Min), .Max = glm::max(a.Max, b.Max)};
+    }
+
+    AABB Merge(const AABB &box, glm::vec3 point)
+    {
+        return AABB{.Min = glm::min(box.Min, point), .Max = glm::max(box.Max, point)};
+    }
+
+    AABB TransformAABB(const AABB &box, const glm::mat4 &mx)
+    {
+        if (IsEmpty(box)) return box;
+
+        // Transform the center, then project the rotated and scaled extents
+        // onto each world axis (Arvo's method). This avoids transforming all
+        // eight corners.
+        glm::vec3 center = (box.Min + box.Max) * 0.5f;
+        glm::vec3 extent = (box.Max - box.Min) * 0.5f;
+        glm::vec3 worldCenter = glm::vec3(mx * glm::vec4(center, 1.0f));
+        glm::vec3 worldExtent =
+            glm::abs(glm::vec3(mx[0])) * extent.x +
+            glm::abs(glm::vec3(mx[1])) * extent.y +
+            glm::abs(glm::vec3(mx[2])) * extent.z;
+
+        return AABB{.Min = worldCenter - worldExtent, .Max = worldCenter + worldExtent};
+    }
+
+    BoundingSphere TransformSphere(const BoundingSphere &sphere, const glm::mat4 &mx)
+    {
+        float maxScale = std::max({
+            glm::length(glm::vec3(mx[0])),
+            glm::length(glm::vec3(mx[1])),
+            glm::length(glm::vec3(mx[2])),
+        });
+
+        return BoundingSphere{
+            .Center = glm::vec3(mx * glm::vec4(sphere.Center, 1.0f)),
+            .Radius = sphere.Radius * maxScale,
+        };
+    }
+
+    AABB ComputeAABB(const glm::vec3 *points, size_t count, size_t stride)
+    {
+        AABB box = EmptyAABB();
+        for (size_t i = 0; i < count; i++)
+        {
+            box = Merge(box, pointAt(points, i, stride));
+        }
+
+        return box;
+    }
+
+    BoundingSphere ComputeBoundingSphere(const glm::vec3 *points, size_t count, size_t stride)
+    {
+        if (count == 0)
+        {
+            return BoundingSphere{.Center = glm::vec3(0.0f), .Radius = 0.0f};
+        }
+
+        AABB box = ComputeAABB(points, count, stride);
+        glm::vec3 center = (box.Min + box.Max) * 0.5f;
+
+        float maxDist2 = 0.0f;
+        for (size_t i = 0; i < count; i++)
+        {
+            glm::vec3 d = pointAt(points, i, stride) - center;
+            maxDist2 = std::max(maxDist2, glm::dot(d, d));
+        }
+
+        return BoundingSphere{.Center = center, .Radius = std::sqrt(maxDist2)};
+    }
+
+    bool Intersects(const AABB &a, const AABB &b)
+    {
+        return
+            a.Min.x <= b.Max.x && a.Max.x >= b.Min.x &&
+            a.Min.y <= b.Max.y && a.Max.y >= b.Min.y &&
+            a.Min.z <= b.Max.z && a.Max.z >= b.Min.z;
+    }
+
+    bool Intersects(const AABB &box, const BoundingSphere &sphere)
+    {
+        if (IsEmpty(box)) return false;
+
+        // Compare against the point in the box closest to the sphere's center
+        glm::vec3 d = glm::clamp(sphere.Center, box.Min, box.Max) - sphere.Center;
+        return glm::dot(d, d) <= sphere.Radius * sphere.Radius;
+    }
+
+    bool Intersects(const Ray &ray, const AABB &box, float maxDistance, float &distance)
+    {
+        if (IsEmpty(box)) return false;
+
+        // Clip the ray against the slab between each pair of planes (Kay and
+        // Kajiya). Dividing by a zero component yields infinities that
+        // correctly leave the ray unclipped, unless it starts on a plane.
+        glm::vec3 invDir = 1.0f / ray.Direction;
+        glm::vec3 t0 = (box.Min - ray.Origin) * invDir;
+        glm::vec3 t1 = (box.Max - ray.Origin) * invDir;
+        glm::vec3 tMin = glm::min(t0, t1);
+        glm::vec3 tMax = glm::max(t0, t1);
+
+        float enter = std::max({tMin.x, tMin.y, tMin.z, 0.0f});
+        float exit = std::min({tMax.x, tMax.y, tMax.z, maxDistance});
+        if (enter > exit) return false;
+
+        distance = enter;
+        return true;
+    }
+
+    bool Contains(const AABB &box, glm::vec3 point)
+    {
+        return
+            point.x >= box.Min.x && point.x <= box.Max.x &&
+            point.y >= box.Min.y && point.y <= box.Max.y &&
+            point.z >= box.Min.z && point.z <= box.Max.z;
+    }
+}
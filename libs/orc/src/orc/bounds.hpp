@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+
+namespace orc
+{
+    // An axis-aligned bounding box. A box whose minimum exceeds its maximum
+    // is empty, and contains nothing, not even a point.
+    struct AABB
+    {
+        glm::vec3 Min;
+        glm::vec3 Max;
+    };
+
+    struct BoundingSphere
+    {
+        glm::vec3 Center;
+        float Radius;
+    };
+
+    // A half-line starting at Origin. Direction does not need to be
+    // normalized, but distances along the ray are measured in multiples of
+    // its length.
+    struct Ray
+    {
+        glm::vec3 Origin;
+        glm::vec3 Direction;
+    };
+
+    // Returns a box that contains nothing. Merging anything into it yields
+    // the other box unchanged.
+    AABB EmptyAABB();
+
+    bool IsEmpty(const AABB &box);
+
+    // Returns the smallest box containing both boxes
+    AABB Merge(const AABB &a, const AABB &b);
+
+    // Returns the smallest box containing both the box and the point
+    AABB Merge(const AABB &box, glm::vec3 point);
+
+    // Returns the smallest axis-aligned box that contains the box after it
+    // has been transformed by mx
+    AABB TransformAABB(const AABB &box, const glm::mat4 &mx);
+
+    // Returns a sphere that contains the sphere after it has been transformed
+    // by mx. Non-uniform scaling stretches the sphere, so the radius is
+    // scaled by the largest scaling factor.
+    BoundingSphere TransformSphere(const BoundingSphere &sphere, const glm::mat4 &mx);
+
+    // Computes the bounds of count points that are spaced stride bytes apart,
+    // which allows points to be read directly out of an array of vertices
+    AABB ComputeAABB(const glm::vec3 *points, size_t count, size_t stride = sizeof(glm::vec3));
+
+    // The sphere is centered on the points' bounding box, which is not
+    // necessarily minimal, but is cheap and tight enough for culling
+    BoundingSphere ComputeBoundingSphere(const glm::vec3 *points, size_t count, size_t stride = sizeof(glm::vec3));
+
+    bool Intersects(const AABB &a, const AABB &b);
+
+    bool Intersects(const AABB &box, const BoundingSphere &sphere);
+
+    // Returns true if the ray enters the box within maxDistance, and sets
+    // distance to where it enters. Rays that start inside the box enter it at
+    // a distance of 0.
+    bool Intersects(const Ray &ray, const AABB &box, float maxDistance, float &distance);
+
+    bool Contains(const AABB &box, glm::vec3 point);
+}
@@ -0,0 +1,87 @@
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <testutils/glm.hpp>
+#include "bounds.hpp"
+
+TEST_CASE("Compute bounds of strided points", "[orc]") {
+    struct Vertex
+    {
+        glm::vec3 Coordinates;
+        float Padding;
+    };
+    std::vector<Vertex> vertices = {
+        {glm::vec3(1.0f, 2.0f, 3.0f), 100.0f},
+        {glm::vec3(-1.0f, 0.0f, 5.0f), 100.0f},
+        {glm::vec3(0.0f, -2.0f, 4.0f), 100.0f},
+    };
+
+    orc::AABB box = orc::ComputeAABB(&vertices[0].Coordinates, vertices.size(), sizeof(Vertex));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(-1.0f, -2.0f, 3.0f), box.Min));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(1.0f, 2.0f, 5.0f), box.Max));
+
+    orc::BoundingSphere sphere = orc::ComputeBoundingSphere(&vertices[0].Coordinates, vertices.size(), sizeof(Vertex));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(0.0f, 0.0f, 4.0f), sphere.Center));
+    REQUIRE(sphere.Radius == glm::length(glm::vec3(1.0f, 2.0f, 1.0f)));
+}
+
+TEST_CASE("Merge empty bounds", "[orc]") {
+    orc::AABB empty = orc::EmptyAABB();
+    orc::AABB box{.Min = glm::vec3(-1.0f), .Max = glm::vec3(1.0f)};
+
+    REQUIRE(orc::IsEmpty(empty));
+    REQUIRE(orc::IsEmpty(orc::TransformAABB(empty, glm::translate(glm::mat4(1.0f), glm::vec3(1.0f)))));
+    REQUIRE(!orc::Intersects(empty, box));
+    REQUIRE(!orc::Intersects(empty, orc::BoundingSphere{.Center = glm::vec3(0.0f), .Radius = 1.0f}));
+
+    orc::AABB merged = orc::Merge(empty, box);
+    REQUIRE(testutils::Vec3Equals(box.Min, merged.Min));
+    REQUIRE(testutils::Vec3Equals(box.Max, merged.Max));
+}
+
+TEST_CASE("Transform bounds", "[orc]") {
+    orc::AABB box{.Min = glm::vec3(0.0f), .Max = glm::vec3(2.0f, 1.0f, 1.0f)};
+    glm::mat4 mx =
+        glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, 0.0f, 0.0f)) *
+        glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f)) *
+        glm::scale(glm::mat4(1.0f), glm::vec3(2.0f));
+
+    // Rotating 90 degrees around Z maps +X to +Y and +Y to -X
+    orc::AABB world = orc::TransformAABB(box, mx);
+    REQUIRE(testutils::Vec3Equals(glm::vec3(8.0f, 0.0f, 0.0f), world.Min));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(10.0f, 4.0f, 2.0f), world.Max));
+
+    orc::BoundingSphere sphere = orc::TransformSphere(orc::BoundingSphere{.Center = glm::vec3(1.0f, 0.0f, 0.0f), .Radius = 1.0f}, mx);
+    REQUIRE(testutils::Vec3Equals(glm::vec3(10.0f, 2.0f, 0.0f), sphere.Center));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(2.0f), glm::vec3(sphere.Radius)));
+}
+
+TEST_CASE("Intersect bounds", "[orc]") {
+    orc::AABB box{.Min = glm::vec3(0.0f), .Max = glm::vec3(1.0f)};
+
+    REQUIRE(orc::Intersects(box, orc::AABB{.Min = glm::vec3(1.0f), .Max = glm::vec3(2.0f)}));
+    REQUIRE(!orc::Intersects(box, orc::AABB{.Min = glm::vec3(1.1f), .Max = glm::vec3(2.0f)}));
+    REQUIRE(orc::Intersects(box, orc::BoundingSphere{.Center = glm::vec3(2.0f, 0.5f, 0.5f), .Radius = 1.0f}));
+    REQUIRE(!orc::Intersects(box, orc::BoundingSphere{.Center = glm::vec3(2.0f, 2.0f, 0.5f), .Radius = 1.0f}));
+    REQUIRE(orc::Contains(box, glm::vec3(0.5f)));
+    REQUIRE(!orc::Contains(box, glm::vec3(1.5f)));
+}
+
+TEST_CASE("Intersect rays with bounds", "[orc]") {
+    orc::AABB box{.Min = glm::vec3(0.0f), .Max = glm::vec3(1.0f)};
+    float distance = -1.0f;
+
+    REQUIRE(orc::Intersects(orc::Ray{.Origin = glm::vec3(-2.0f, 0.5f, 0.5f), .Direction = glm::vec3(1.0f, 0.0f, 0.0f)}, box, 10.0f, distance));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(2.0f), glm::vec3(distance)));
+
+    // Misses, points away, or doesn't reach far enough
+    REQUIRE(!orc::Intersects(orc::Ray{.Origin = glm::vec3(-2.0f, 1.5f, 0.5f), .Direction = glm::vec3(1.0f, 0.0f, 0.0f)}, box, 10.0f, distance));
+    REQUIRE(!orc::Intersects(orc::Ray{.Origin = glm::vec3(-2.0f, 0.5f, 0.5f), .Direction = glm::vec3(-1.0f, 0.0f, 0.0f)}, box, 10.0f, distance));
+    REQUIRE(!orc::Intersects(orc::Ray{.Origin = glm::vec3(-2.0f, 0.5f, 0.5f), .Direction = glm::vec3(1.0f, 0.0f, 0.0f)}, box, 1.5f, distance));
+    REQUIRE(!orc::Intersects(orc::Ray{.Origin = glm::vec3(-2.0f, 0.5f, 0.5f), .Direction = glm::vec3(1.0f, 0.0f, 0.0f)}, orc::EmptyAABB(), 10.0f, distance));
+
+    // Starting inside the box
+    REQUIRE(orc::Intersects(orc::Ray{.Origin = glm::vec3(0.5f), .Direction = glm::vec3(0.0f, -1.0f, 0.0f)}, box, 10.0f, distance));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(0.0f), glm::vec3(distance)));
+}
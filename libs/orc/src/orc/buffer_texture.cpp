@@ -0,0 +1,45 @@
+#include <algorithm>
+#include <cstddef>
+#include <glad/glad.h>
+#include "buffer_texture.hpp"
+
+// Buffers are never left empty, since a buffer texture without any storage
+// isn't complete, even if shaders never read from it
+const size_t minBufferSize = 16;
+
+namespace orc
+{
+    BufferTexture::BufferTexture(GLenum format)
+    {
+        glGenBuffers(1, &bufferId);
+        glBindBuffer(GL_TEXTURE_BUFFER, bufferId);
+        glBufferData(GL_TEXTURE_BUFFER, minBufferSize, nullptr, GL_STREAM_DRAW);
+
+        glGenTextures(1, &textureId);
+        glBindTexture(GL_TEXTURE_BUFFER, textureId);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, bufferId);
+    }
+
+    BufferTexture::~BufferTexture()
+    {
+        glDeleteTextures(1, &textureId);
+        glDeleteBuffers(1, &bufferId);
+    }
+
+    void BufferTexture::Upload(const void *data, size_t size)
+    {
+        glBindBuffer(GL_TEXTURE_BUFFER, bufferId);
+        glBufferData(GL_TEXTURE_BUFFER, std::max(size, minBufferSize), nullptr, GL_STREAM_DRAW);
+        if (size > 0)
+        {
+            glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+        }
+    }
+
+    void BufferTexture::Use(GLenum unit)
+    {
+        glActiveTexture(unit);
+        glBindTexture(GL_TEXTURE_BUFFER, textureId);
+        glActiveTexture(GL_TEXTURE0);
+    }
+}
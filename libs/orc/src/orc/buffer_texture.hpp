@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <glad/glad.h>
+
+namespace orc
+{
+    // A buffer that shaders read like a one dimensional texture, using
+    // texelFetch on a samplerBuffer. Suited to per-frame data that is too
+    // large for uniforms, e.g. lists of lights.
+    class BufferTexture
+    {
+        public:
+        // Each texel has the given sized internal format, e.g. GL_RGBA32F
+        BufferTexture(GLenum format);
+
+        ~BufferTexture();
+
+        // Copy constructor and copy assignment are disabled because this class
+        // manages OpenGL resources
+        BufferTexture(const BufferTexture &other) = delete;
+        void operator=(const BufferTexture &other) = delete;
+
+        // Replaces the contents of the buffer with size bytes of data. The
+        // previous storage is orphaned rather than overwritten, so draws that
+        // are still reading it don't stall the upload.
+        void Upload(const void *data, size_t size);
+
+        // Binds the texture to a texture unit, e.g. GL_TEXTURE1, then makes
+        // GL_TEXTURE0 active again, since meshes bind their textures to
+        // whichever unit is active
+        void Use(GLenum unit);
+
+        private:
+        unsigned int bufferId, textureId;
+    };
+}
@@ -0,0 +1,92 @@
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "bvh.hpp"
+#include "camera.hpp"
+#include "frustum.hpp"
+
+const size_t numObjects = 100000;
+const size_t numQueries = 1000;
+
+TEST_CASE("BVH build and query", "[orc][benchmark]") {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> pos(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.5f, 2.0f);
+    std::vector<orc::AABB> boxes;
+    for (size_t i = 0; i < numObjects; i++)
+    {
+        glm::vec3 center(pos(rng), pos(rng), pos(rng));
+        boxes.push_back(orc::AABB{.Min = center - size(rng), .Max = center + size(rng)});
+    }
+
+    std::vector<glm::vec3> points;
+    std::vector<glm::vec3> directions;
+    std::uniform_real_distribution<float> dir(-1.0f, 1.0f);
+    for (size_t i = 0; i < numQueries; i++)
+    {
+        points.push_back(glm::vec3(pos(rng), pos(rng), pos(rng)));
+        directions.push_back(glm::normalize(glm::vec3(dir(rng), dir(rng), dir(rng)) + glm::vec3(0.0f, 0.0f, 0.01f)));
+    }
+
+    std::shared_ptr<orc::Camera> camera = orc::Camera::Create();
+    camera->ComputeMxs();
+
+    orc::BVH bvh;
+    bvh.Build(boxes.data(), boxes.size());
+    std::vector<uint32_t> found;
+    std::vector<uint8_t> visible(numObjects);
+
+    BENCHMARK("Build 100k objects") {
+        bvh.Build(boxes.data(), boxes.size());
+        return bvh.GetSize();
+    };
+
+    BENCHMARK("Refit 100k objects") {
+        bvh.Refit(boxes.data());
+        return bvh.GetDegradation();
+    };
+
+    // Flat culling tests every object, which is what the hierarchy replaces
+    BENCHMARK("Frustum: flat culling") {
+        orc::CullAABBs(camera->GetFrustum(), boxes.data(), numObjects, visible.data());
+        return visible[0];
+    };
+
+    BENCHMARK("Frustum: BVH query") {
+        found.clear();
+        bvh.Query(camera->GetFrustum(), found);
+        return found.size();
+    };
+
+    BENCHMARK("1k box queries") {
+        found.clear();
+        for (const glm::vec3 &p : points)
+        {
+            bvh.Query(orc::AABB{.Min = p - glm::vec3(10.0f), .Max = p + glm::vec3(10.0f)}, found);
+        }
+        return found.size();
+    };
+
+    BENCHMARK("1k sphere queries") {
+        found.clear();
+        for (const glm::vec3 &p : points)
+        {
+            bvh.Query(orc::BoundingSphere{.Center = p, .Radius = 10.0f}, found);
+        }
+        return found.size();
+    };
+
+    BENCHMARK("1k ray queries") {
+        found.clear();
+        for (size_t i = 0; i < numQueries; i++)
+        {
+            bvh.Query(orc::Ray{.Origin = points[i], .Direction = directions[i]}, 200.0f, found);
+        }
+        return found.size();
+    };
+}
@@ -0,0 +1,362 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "bvh.hpp"
+#include "frustum.hpp"
+
+// Number of buckets that centroids are sorted into along each axis when
+// searching for the cheapest split
+const int numBins = 16;
+
+// Branches with at most this many items become leaves
+const uint32_t maxLeafSize = 4;
+
+// Relative costs of visiting a branch and testing an item, used to estimate
+// how expensive a tree is to query
+const float traversalCost = 1.0f;
+const float intersectCost = 1.0f;
+
+// Past this depth, items are split in half by count instead of by cost, which
+// bounds the depth of the tree, and therefore the size of the traversal stack,
+// no matter how items are distributed
+const uint32_t maxSahDepth = 32;
+
+namespace orc
+{
+    // Half of the surface area of a box, which is all the heuristic needs.
+    // Takes the corners rather than an AABB so that building a tree doesn't
+    // have to construct boxes in its innermost loops.
+    static inline float halfArea(glm::vec3 min, glm::vec3 max)
+    {
+        glm::vec3 d = glm::max(max - min, glm::vec3(0.0f));
+        return d.x * d.y + d.y * d.z + d.z * d.x;
+    }
+
+    static inline float halfArea(const AABB &box)
+    {
+        return halfArea(box.Min, box.Max);
+    }
+
+    static inline int binOf(float centroid, float min, float scale, int bins)
+    {
+        return std::min(bins - 1, (int)((centroid - min) * scale));
+    }
+
+    // The bounds and number of items whose centroids fall into a slice of a
+    // branch, used to estimate the cost of splitting at each slice
+    struct Bin
+    {
+        glm::vec3 Min, Max;
+        uint32_t Count;
+    };
+
+    static inline Bin mergeBins(const Bin &a, const Bin &b)
+    {
+        return Bin{.Min = glm::min(a.Min, b.Min), .Max = glm::max(a.Max, b.Max), .Count = a.Count + b.Count};
+    }
+
+    template <typename T, typename V>
+    void BVH::Traverse(T &&test, V &&visitLeaf) const
+    {
+        if (branches.empty()) return;
+
+        uint32_t stack[maxStackSize];
+        size_t stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0)
+        {
+            uint32_t idx = stack[--stackSize];
+            const Branch &branch = branches[idx];
+            if (!test(branch.Bounds)) continue;
+
+            if (branch.Right)
+            {
+                stack[stackSize++] = branch.Right;
+                stack[stackSize++] = idx + 1;
+                continue;
+            }
+
+            for (uint32_t k = branch.First; k < branch.First + branch.Count; k++)
+            {
+                visitLeaf(items[k], itemBounds[k]);
+            }
+        }
+    }
+
+    BVH::BVH()
+        : builtCost(0.0f)
+        , cost(0.0f)
+        {}
+
+    void BVH::Build(const AABB *bounds, size_t count)
+    {
+        branches.clear();
+        std::vector<BuildItem> buildItems(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            buildItems[i] = BuildItem{
+                .Bounds = bounds[i],
+                .Centroid = IsEmpty(bounds[i]) ? glm::vec3(0.0f) : (bounds[i].Min + bounds[i].Max) * 0.5f,
+                .Item = (uint32_t)i,
+            };
+        }
+
+        if (count > 0)
+        {
+            BuildBranch(buildItems, 0, (uint32_t)count, 0);
+        }
+
+        // Leaves reference items in the order they were partitioned into
+        items.resize(count);
+        itemBounds.resize(count);
+        for (size_t k = 0; k < count; k++)
+        {
+            items[k] = buildItems[k].Item;
+            itemBounds[k] = buildItems[k].Bounds;
+        }
+
+        ComputeBounds();
+        builtCost = cost;
+    }
+
+    void BVH::Refit(const AABB *bounds)
+    {
+        for (size_t k = 0; k < items.size(); k++)
+        {
+            itemBounds[k] = bounds[items[k]];
+        }
+
+        ComputeBounds();
+    }
+
+    float BVH::GetDegradation() const
+    {
+        return builtCost > 0.0f ? cost / builtCost : 1.0f;
+    }
+
+    size_t BVH::GetSize() const
+    {
+        return items.size();
+    }
+
+    void BVH::Query(const Frustum &frustum, std::vector<uint32_t> &out) const
+    {
+        if (branches.empty()) return;
+
+        uint8_t visible[maxLeafSize];
+        uint32_t stack[maxStackSize];
+        size_t stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0)
+        {
+            uint32_t idx = stack[--stackSize];
+            const Branch &branch = branches[idx];
+            Overlap overlap = Classify(frustum, branch.Bounds);
+            if (overlap == Overlap::None) continue;
+
+            // Everything beneath a branch that is entirely inside is visible,
+            // except for items without any bounds
+            if (overlap == Overlap::Full)
+            {
+                for (uint32_t k = branch.First; k < branch.First + branch.Count; k++)
+                {
+                    if (!IsEmpty(itemBounds[k])) out.push_back(items[k]);
+                }
+
+                continue;
+            }
+
+            if (branch.Right)
+            {
+                stack[stackSize++] = branch.Right;
+                stack[stackSize++] = idx + 1;
+                continue;
+            }
+
+            CullAABBs(frustum, &itemBounds[branch.First], branch.Count, visible);
+            for (uint32_t k = 0; k < branch.Count; k++)
+            {
+                if (visible[k]) out.push_back(items[branch.First + k]);
+            }
+        }
+    }
+
+    void BVH::Query(const AABB &region, std::vector<uint32_t> &out) const
+    {
+        Traverse(
+            [&region](const AABB &bounds) { return Intersects(bounds, region); },
+            [&region, &out](uint32_t item, const AABB &bounds) {
+                if (Intersects(bounds, region)) out.push_back(item);
+            }
+        );
+    }
+
+    void BVH::Query(const BoundingSphere &region, std::vector<uint32_t> &out) const
+    {
+        Traverse(
+            [&region](const AABB &bounds) { return Intersects(bounds, region); },
+            [&region, &out](uint32_t item, const AABB &bounds) {
+                if (Intersects(bounds, region)) out.push_back(item);
+            }
+        );
+    }
+
+    void BVH::Query(const Ray &ray, float maxDistance, std::vector<uint32_t> &out) const
+    {
+        float distance;
+        Traverse(
+            [&](const AABB &bounds) { return Intersects(ray, bounds, maxDistance, distance); },
+            [&](uint32_t item, const AABB &bounds) {
+                if (Intersects(ray, bounds, maxDistance, distance)) out.push_back(item);
+            }
+        );
+    }
+
+    void BVH::BuildBranch(std::vector<BuildItem> &buildItems, uint32_t first, uint32_t count, uint32_t depth)
+    {
+        uint32_t idx = (uint32_t)branches.size();
+        branches.push_back(Branch{.Bounds = EmptyAABB(), .First = first, .Count = count, .Right = 0});
+
+        // Small branches are cheap enough to test item by item, and their
+        // items are tested in a single batch
+        if (count <= maxLeafSize) return;
+
+        BuildItem *begin = buildItems.data() + first;
+        BuildItem *end = begin + count;
+        glm::vec3 centroidMin(std::numeric_limits<float>::infinity());
+        glm::vec3 centroidMax(-std::numeric_limits<float>::infinity());
+        for (const BuildItem *it = begin; it != end; it++)
+        {
+            centroidMin = glm::min(centroidMin, it->Centroid);
+            centroidMax = glm::max(centroidMax, it->Centroid);
+        }
+
+        // Find the cheapest split by sorting items into bins along all three
+        // axes in one pass, then sweeping over the bins of each axis. The
+        // cost of a split is proportional to the probability of a random ray
+        // hitting each side, i.e. its area relative to the whole, times the
+        // number of items on that side.
+        float bestCost = std::numeric_limits<float>::infinity();
+        int bestAxis = -1, bestBin = 0;
+        glm::vec3 extent = centroidMax - centroidMin;
+        glm::vec3 scale(0.0f);
+
+        // Most branches are small, and sweeping over more bins than items
+        // only costs time
+        int bins = (int)std::min<uint32_t>(numBins, count);
+        if (depth < maxSahDepth)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (extent[axis] > 0.0f) scale[axis] = bins / extent[axis];
+            }
+
+            const Bin emptyBin{
+                .Min = glm::vec3(std::numeric_limits<float>::infinity()),
+                .Max = glm::vec3(-std::numeric_limits<float>::infinity()),
+                .Count = 0,
+            };
+            Bin binned[3][numBins];
+            for (int axis = 0; axis < 3; axis++)
+            {
+                std::fill(binned[axis], binned[axis] + bins, emptyBin);
+            }
+
+            for (const BuildItem *it = begin; it != end; it++)
+            {
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    Bin &bin = binned[axis][binOf(it->Centroid[axis], centroidMin[axis], scale[axis], bins)];
+                    bin.Min = glm::min(bin.Min, it->Bounds.Min);
+                    bin.Max = glm::max(bin.Max, it->Bounds.Max);
+                    bin.Count++;
+                }
+            }
+
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (extent[axis] <= 0.0f) continue;
+
+                // Sweep from the right to accumulate the cost of everything
+                // right of each split, then from the left to add the rest
+                float rightCosts[numBins];
+                Bin accum = binned[axis][bins - 1];
+                for (int bin = bins - 1; bin > 0; bin--)
+                {
+                    if (bin < bins - 1) accum = mergeBins(accum, binned[axis][bin]);
+                    rightCosts[bin] = accum.Count ? halfArea(accum.Min, accum.Max) * accum.Count : std::numeric_limits<float>::infinity();
+                }
+
+                accum = binned[axis][0];
+                for (int bin = 1; bin < bins; bin++)
+                {
+                    if (bin > 1) accum = mergeBins(accum, binned[axis][bin - 1]);
+                    if (!accum.Count) continue;
+
+                    float splitCost = halfArea(accum.Min, accum.Max) * accum.Count + rightCosts[bin];
+                    if (splitCost < bestCost)
+                    {
+                        bestCost = splitCost;
+                        bestAxis = axis;
+                        bestBin = bin;
+                    }
+                }
+            }
+        }
+
+        BuildItem *mid;
+        if (bestAxis >= 0)
+        {
+            mid = std::partition(begin, end, [&](const BuildItem &it) {
+                return binOf(it.Centroid[bestAxis], centroidMin[bestAxis], scale[bestAxis], bins) < bestBin;
+            });
+        }
+        else
+        {
+            // All centroids coincide, or the tree is already deep, so there's
+            // nothing to gain from choosing carefully
+            int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+            mid = begin + count / 2;
+            std::nth_element(begin, mid, end, [axis](const BuildItem &a, const BuildItem &b) {
+                return a.Centroid[axis] < b.Centroid[axis];
+            });
+        }
+
+        uint32_t leftCount = (uint32_t)(mid - begin);
+        BuildBranch(buildItems, first, leftCount, depth + 1);
+        branches[idx].Right = (uint32_t)branches.size();
+        BuildBranch(buildItems, first + leftCount, count - leftCount, depth + 1);
+    }
+
+    void BVH::ComputeBounds()
+    {
+        float total = 0.0f;
+        for (size_t i = branches.size(); i-- > 0;)
+        {
+            Branch &branch = branches[i];
+            if (branch.Right)
+            {
+                branch.Bounds = Merge(branches[i + 1].Bounds, branches[branch.Right].Bounds);
+                total += halfArea(branch.Bounds) * traversalCost;
+                continue;
+            }
+
+            branch.Bounds = EmptyAABB();
+            for (uint32_t k = branch.First; k < branch.First + branch.Count; k++)
+            {
+                branch.Bounds = Merge(branch.Bounds, itemBounds[k]);
+            }
+            total += halfArea(branch.Bounds) * branch.Count * intersectCost;
+        }
+
+        float rootArea = branches.empty() ? 0.0f : halfArea(branches[0].Bounds);
+        cost = rootArea > 0.0f ? total / rootArea : 0.0f;
+    }
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "bounds.hpp"
+#include "frustum.hpp"
+
+namespace orc
+{
+    // A bounding volume hierarchy over a set of items, each identified by the
+    // index of its bounds in the array the hierarchy was built from. Queries
+    // descend only into branches that overlap the queried region and append
+    // the indices of matching items to an output vector, in no particular
+    // order. Items with empty bounds never match.
+    //
+    // Rebuilding produces the best tree, while refitting keeps the structure
+    // and only updates bounds, which is much cheaper but lets the tree's
+    // quality degrade as items move away from where they were when it was
+    // built. GetDegradation reports how far it has degraded, so callers can
+    // refit every frame and rebuild once refitting no longer pays off.
+    //
+    // Queries are const and don't touch any shared state, so they may run
+    // concurrently.
+    class BVH
+    {
+        public:
+        static constexpr uint32_t noItem = UINT32_MAX;
+
+        BVH();
+
+        // Builds the hierarchy from scratch, choosing splits that minimize
+        // the surface area heuristic
+        void Build(const AABB *bounds, size_t count);
+
+        // Updates the bounds of every branch after items have moved, without
+        // changing the structure. bounds must have as many elements as the
+        // last build.
+        void Refit(const AABB *bounds);
+
+        // Returns the estimated cost of querying the tree relative to the
+        // cost right after it was last built. Always 1 after a build, and
+        // grows as refitting stretches branches over items that have drifted
+        // apart.
+        float GetDegradation() const;
+
+        // Number of items in the hierarchy
+        size_t GetSize() const;
+
+        // Appends every item whose bounds intersect the frustum, using the
+        // same conservative test as Intersects. Branches entirely inside the
+        // frustum are accepted without testing their items against it.
+        void Query(const Frustum &frustum, std::vector<uint32_t> &out) const;
+
+        void Query(const AABB &region, std::vector<uint32_t> &out) const;
+
+        void Query(const BoundingSphere &region, std::vector<uint32_t> &out) const;
+
+        // Appends every item whose bounds the ray enters within maxDistance
+        void Query(const Ray &ray, float maxDistance, std::vector<uint32_t> &out) const;
+
+        // Finds the nearest item that the ray hits within maxDistance, where
+        // hit(item, maxDistance) tests a single item and returns the distance
+        // at which the ray hits it, or any distance of at least maxDistance
+        // if it doesn't. Branches are visited nearest first and skipped once
+        // they are further away than the nearest hit so far, so only a few
+        // items are tested. Returns the nearest item and sets maxDistance to
+        // its distance, or returns noItem if nothing was hit.
+        template <typename F>
+        uint32_t Raycast(const Ray &ray, float &maxDistance, F &&hit) const;
+
+        private:
+        // Branches are stored depth-first, so a branch's left child directly
+        // follows it and every branch precedes its descendants. The items
+        // beneath each branch also occupy a contiguous range, [First, First +
+        // Count).
+        struct Branch
+        {
+            AABB Bounds;
+            uint32_t First;
+            uint32_t Count;
+
+            // Index of the right child, or 0 for leaves, since the root can
+            // never be a right child
+            uint32_t Right;
+        };
+
+        std::vector<Branch> branches;
+
+        // Item indices and bounds, in the order the leaves reference them
+        std::vector<uint32_t> items;
+        std::vector<AABB> itemBounds;
+
+        float builtCost, cost;
+
+        // The tree is never deeper than this, so traversal can use a fixed
+        // size stack
+        static constexpr size_t maxStackSize = 64;
+
+        // Items are partitioned along with their bounds while building, so
+        // that each branch reads a contiguous range
+        struct BuildItem
+        {
+            AABB Bounds;
+            glm::vec3 Centroid;
+            uint32_t Item;
+        };
+
+        // Splits items [first, first + count) recursively, appending branches
+        void BuildBranch(std::vector<BuildItem> &buildItems, uint32_t first, uint32_t count, uint32_t depth);
+
+        // Recomputes the bounds of every branch from itemBounds, and the
+        // tree's surface area heuristic cost
+        void ComputeBounds();
+
+        // Visits every branch whose bounds are accepted by test, descending
+        // into its children if it has any. For each leaf, visitLeaf is called
+        // with the range of items beneath it.
+        template <typename T, typename V>
+        void Traverse(T &&test, V &&visitLeaf) const;
+    };
+
+    template <typename F>
+    uint32_t BVH::Raycast(const Ray &ray, float &maxDistance, F &&hit) const
+    {
+        uint32_t nearest = noItem;
+        float enter;
+        if (branches.empty() || !Intersects(ray, branches[0].Bounds, maxDistance, enter)) return nearest;
+
+        // Each entry holds a branch and the distance at which the ray enters
+        // it, which may have been overtaken by a hit since it was pushed
+        std::pair<uint32_t, float> stack[maxStackSize];
+        size_t stackSize = 0;
+        stack[stackSize++] = std::make_pair(0u, enter);
+
+        while (stackSize > 0)
+        {
+            auto [idx, distance] = stack[--stackSize];
+            if (distance > maxDistance) continue;
+
+            const Branch &branch = branches[idx];
+            if (!branch.Right)
+            {
+                for (uint32_t k = branch.First; k < branch.First + branch.Count; k++)
+                {
+                    float d = hit(items[k], maxDistance);
+                    if (d < maxDistance)
+                    {
+                        maxDistance = d;
+                        nearest = items[k];
+                    }
+                }
+
+                continue;
+            }
+
+            // Push the further child first, so the nearer one is visited
+            // first and has a chance to rule the other out
+            float leftEnter, rightEnter;
+            bool hitsLeft = Intersects(ray, branches[idx + 1].Bounds, maxDistance, leftEnter);
+            bool hitsRight = Intersects(ray, branches[branch.Right].Bounds, maxDistance, rightEnter);
+            if (hitsLeft && hitsRight && leftEnter > rightEnter)
+            {
+                stack[stackSize++] = std::make_pair(idx + 1, leftEnter);
+                stack[stackSize++] = std::make_pair(branch.Right, rightEnter);
+                continue;
+            }
+
+            if (hitsRight) stack[stackSize++] = std::make_pair(branch.Right, rightEnter);
+            if (hitsLeft) stack[stackSize++] = std::make_pair(idx + 1, leftEnter);
+        }
+
+        return nearest;
+    }
+}
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include <fixtures.hpp>
+#include "bounds.hpp"
+#include "bvh.hpp"
+#include "camera.hpp"
+#include "frustum.hpp"
+
+static std::vector<orc::AABB> randomBoxes(std::mt19937 &rng, size_t count)
+{
+    std::uniform_real_distribution<float> pos(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> size(0.1f, 3.0f);
+    std::vector<orc::AABB> boxes;
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::vec3 center(pos(rng), pos(rng), pos(rng));
+        glm::vec3 extent(size(rng), size(rng), size(rng));
+        boxes.push_back(orc::AABB{.Min = center - extent, .Max = center + extent});
+    }
+
+    return boxes;
+}
+
+static void requireAllQueriesMatch(const orc::BVH &bvh, const std::vector<orc::AABB> &boxes)
+{
+    std::shared_ptr<orc::Camera> camera = orc::Camera::Create();
+    camera->Translate(0.0f, 0.0f, 60.0f);
+    camera->ComputeMxs();
+    fixtures::RequireSameResults(bvh, boxes, fixtures::FrustumQuery{.Frustum = camera->GetFrustum()});
+
+    fixtures::RequireSameResults(bvh, boxes, fixtures::BoxQuery{.Region = orc::AABB{.Min = glm::vec3(-10.0f), .Max = glm::vec3(5.0f, 20.0f, 0.0f)}});
+    fixtures::RequireSameResults(bvh, boxes, fixtures::SphereQuery{.Region = orc::BoundingSphere{.Center = glm::vec3(20.0f, -5.0f, 3.0f), .Radius = 15.0f}});
+    fixtures::RequireSameResults(bvh, boxes, fixtures::RayQuery{
+        .Ray = orc::Ray{.Origin = glm::vec3(-60.0f, 1.0f, 2.0f), .Direction = glm::normalize(glm::vec3(1.0f, 0.1f, -0.05f))},
+        .MaxDistance = 100.0f,
+    });
+}
+
+TEST_CASE("BVH queries match brute force", "[orc]") {
+    std::mt19937 rng(7);
+    std::vector<orc::AABB> boxes = randomBoxes(rng, 2000);
+
+    // Boxes without bounds never match, and identical boxes still split
+    boxes.push_back(orc::EmptyAABB());
+    for (int i = 0; i < 20; i++)
+    {
+        boxes.push_back(orc::AABB{.Min = glm::vec3(1.0f), .Max = glm::vec3(2.0f)});
+    }
+
+    orc::BVH bvh;
+    bvh.Build(boxes.data(), boxes.size());
+    REQUIRE(bvh.GetSize() == boxes.size());
+    REQUIRE(bvh.GetDegradation() == 1.0f);
+    requireAllQueriesMatch(bvh, boxes);
+
+    // Refitting after items move keeps queries exact
+    std::uniform_real_distribution<float> offset(-5.0f, 5.0f);
+    for (orc::AABB &box : boxes)
+    {
+        glm::vec3 d(offset(rng), offset(rng), offset(rng));
+        box.Min += d;
+        box.Max += d;
+    }
+    bvh.Refit(boxes.data());
+    requireAllQueriesMatch(bvh, boxes);
+}
+
+TEST_CASE("BVH degrades as refitted items scatter", "[orc]") {
+    std::mt19937 rng(11);
+    std::vector<orc::AABB> boxes = randomBoxes(rng, 1000);
+
+    orc::BVH bvh;
+    bvh.Build(boxes.data(), boxes.size());
+
+    // Moving everything together doesn't change the tree's quality
+    for (orc::AABB &box : boxes)
+    {
+        box.Min += glm::vec3(10.0f);
+        box.Max += glm::vec3(10.0f);
+    }
+    bvh.Refit(boxes.data());
+    REQUIRE(bvh.GetDegradation() < 1.001f);
+
+    // Shuffling positions stretches every branch across the scene
+    std::vector<orc::AABB> shuffled = randomBoxes(rng, boxes.size());
+    bvh.Refit(shuffled.data());
+    REQUIRE(bvh.GetDegradation() > 2.0f);
+
+    bvh.Build(shuffled.data(), shuffled.size());
+    REQUIRE(bvh.GetDegradation() == 1.0f);
+}
+
+TEST_CASE("Query an empty BVH", "[orc]") {
+    orc::BVH bvh;
+    bvh.Build(nullptr, 0);
+
+    std::vector<uint32_t> found;
+    bvh.Query(orc::AABB{.Min = glm::vec3(-1.0f), .Max = glm::vec3(1.0f)}, found);
+    REQUIRE(found.empty());
+    REQUIRE(bvh.GetSize() == 0);
+}
+
+TEST_CASE("BVH raycast finds the nearest item", "[orc]") {
+    std::mt19937 rng(13);
+    std::vector<orc::AABB> boxes = randomBoxes(rng, 2000);
+    orc::BVH bvh;
+    bvh.Build(boxes.data(), boxes.size());
+
+    std::uniform_real_distribution<float> dir(-1.0f, 1.0f);
+    for (int r = 0; r < 100; r++)
+    {
+        orc::Ray ray{.Origin = glm::vec3(0.0f), .Direction = glm::normalize(glm::vec3(dir(rng), dir(rng), dir(rng)))};
+
+        uint32_t expected = orc::BVH::noItem;
+        float expectedDistance = 40.0f;
+        for (uint32_t i = 0; i < boxes.size(); i++)
+        {
+            float d;
+            if (orc::Intersects(ray, boxes[i], expectedDistance, d) && d < expectedDistance)
+            {
+                expected = i;
+                expectedDistance = d;
+            }
+        }
+
+        // Boxes that contain the origin are all hit at a distance of 0, so
+        // compare distances rather than items
+        float distance = 40.0f;
+        uint32_t nearest = bvh.Raycast(ray, distance, [&](uint32_t item, float maxDistance) {
+            float d;
+            return orc::Intersects(ray, boxes[item], maxDistance, d) ? d : std::numeric_limits<float>::infinity();
+        });
+        REQUIRE((nearest == orc::BVH::noItem) == (expected == orc::BVH::noItem));
+        REQUIRE(distance == expectedDistance);
+    }
+}
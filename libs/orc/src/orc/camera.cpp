@@ -1,5 +1,9 @@
+#include <memory>
+#include <new>
 #include <glm/gtc/matrix_transform.hpp>
 #include "camera.hpp"
+#include "frustum.hpp"
+#include "node_pool.hpp"
 #include "visitor.hpp"
 
 const float
@@ -23,6 +27,11 @@ namespace orc
         return std::shared_ptr<Camera>(new Camera());
     }
 
+    std::shared_ptr<Camera> Camera::Create(NodePool &pool)
+    {
+        return pool.Create<Camera>([](void *mem) { return new (mem) Camera(); });
+    }
+
     Camera::Camera()
         : fieldOfView(defaultFieldOfView)
         , aspectRatio(defaultAspectRatio)
@@ -40,11 +49,13 @@ namespace orc
     void Camera::SetFieldOfView(float fieldOfView)
     {
         this->fieldOfView = fieldOfView;
+        MarkDirty();
     }
 
     void Camera::SetAspectRatio(float aspectRatio)
     {
         this->aspectRatio = aspectRatio;
+        MarkDirty();
     }
 
     void Camera::SetClippingDistance(float near, float far)
@@ -56,14 +67,40 @@ namespace orc
 
         nearClip = near;
         farClip = far;
+        MarkDirty();
+    }
+
+    float Camera::GetFieldOfView() const
+    {
+        return fieldOfView;
     }
 
-    void Camera::ComputeMxs()
+    float Camera::GetAspectRatio() const
+    {
+        return aspectRatio;
+    }
+
+    float Camera::GetNearClippingDistance() const
+    {
+        return nearClip;
+    }
+
+    float Camera::GetFarClippingDistance() const
+    {
+        return farClip;
+    }
+
+    void Camera::ComputeDerivedMxs()
     {
-        Node::ComputeMxs();
         ComputeViewMx();
         ComputeProjectionMx();
         viewProjectionMx = projectionMx * viewMx;
+        frustum = ExtractFrustum(viewProjectionMx);
+    }
+
+    bool Camera::HasDerivedMxs() const
+    {
+        return true;
     }
 
     glm::mat4 Camera::GetViewMx() const
@@ -81,6 +118,11 @@ namespace orc
         return viewProjectionMx;
     }
 
+    const Frustum &Camera::GetFrustum() const
+    {
+        return frustum;
+    }
+
     void Camera::ComputeViewMx()
     {
         glm::vec3 pos = GetPosition();
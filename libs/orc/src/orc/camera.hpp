@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include "frustum.hpp"
 #include "node.hpp"
 #include "visitor.hpp"
 
@@ -11,6 +12,8 @@ namespace orc
         public:
         static std::shared_ptr<Camera> Create();
 
+        static std::shared_ptr<Camera> Create(NodePool &pool);
+
         void Dispatch(NodeVisitor &visitor) override;
 
         // Sets the camera's field of view angle, expressed in radians. Defaults
@@ -27,8 +30,13 @@ namespace orc
         // positive number
         void SetClippingDistance(float near, float far);
 
-        // See Node.ComputeMxs. Also computes the view-projection matrix.
-        void ComputeMxs() override;
+        float GetFieldOfView() const;
+
+        float GetAspectRatio() const;
+
+        float GetNearClippingDistance() const;
+
+        float GetFarClippingDistance() const;
 
         // Returns a matrix that performs a transformation from world space to
         // view space
@@ -42,11 +50,21 @@ namespace orc
         // perspective to all other nodes
         glm::mat4 GetViewProjectionMx() const;
 
+        // Returns the world space planes of the camera's view volume, derived
+        // from the view-projection matrix
+        const Frustum &GetFrustum() const;
+
         protected:
         Camera();
 
+        // Computes the view and projection matrices from the model matrix
+        void ComputeDerivedMxs() override;
+
+        bool HasDerivedMxs() const override;
+
         private:
         glm::mat4 viewMx, projectionMx, viewProjectionMx;
+        Frustum frustum;
         float fieldOfView, aspectRatio, nearClip, farClip;
 
         void ComputeViewMx();
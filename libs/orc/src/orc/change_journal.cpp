@@ -0,0 +1,61 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "change_journal.hpp"
+#include "node.hpp"
+
+namespace orc
+{
+    static size_t roundUpToPowerOfTwo(size_t n)
+    {
+        size_t size = 1;
+        while (size < n) size <<= 1;
+        return size;
+    }
+
+    ChangeJournal::ChangeJournal(size_t capacity)
+        : mask(0)
+        , frameBegin(0)
+        , frameEnd(0)
+        , next(0)
+        , isFrameComplete(isEnabled)
+    {
+        if (isEnabled)
+        {
+            ring.resize(roundUpToPowerOfTwo(capacity));
+            mask = ring.size() - 1;
+        }
+    }
+
+    void ChangeJournal::Record(ChangeType type, Node &node)
+    {
+        if (!isEnabled) return;
+
+        ring[next & mask] = Change{.Type = type, .Target = &node, .Handle = node.GetHandle()};
+        next++;
+    }
+
+    void ChangeJournal::EndFrame()
+    {
+        // The frame is incomplete if it wrapped around onto itself
+        isFrameComplete = isEnabled && next - frameEnd <= ring.size();
+        frameBegin = frameEnd;
+        frameEnd = next;
+    }
+
+    bool ChangeJournal::IsComplete() const
+    {
+        // Changes recorded since the frame ended may have overwritten it
+        return isFrameComplete && next - frameBegin <= ring.size();
+    }
+
+    size_t ChangeJournal::GetSize() const
+    {
+        return IsComplete() ? frameEnd - frameBegin : 0;
+    }
+
+    const Change &ChangeJournal::operator[](size_t i) const
+    {
+        return ring[(frameBegin + i) & mask];
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "node_pool.hpp"
+
+namespace orc
+{
+    class Node;
+
+    enum class ChangeType : uint8_t
+    {
+        // A node was attached to, or detached from, a node in the scene.
+        // Attaching or detaching a subtree is recorded once, for its root.
+        Attached,
+        Detached,
+
+        // A node's transformation changed. Recorded once per node per frame,
+        // no matter how many times it changes, and not for the other changes
+        // that make the scene recompute a node, e.g. attaching it.
+        Transformed,
+
+        // An object's meshes changed
+        MeshAdded,
+
+        // A light's color, range, or other parameters changed
+        LightChanged,
+    };
+
+    // A change to a node, recorded as it happens. Target may have been
+    // destroyed since, if it was detached, but the handle of a pooled node
+    // can be resolved to check.
+    struct Change
+    {
+        ChangeType Type;
+        Node *Target;
+        NodeHandle Handle;
+    };
+
+    // Records changes to the nodes of a scene in a ring buffer, grouped into
+    // frames, so that systems that keep their own state about the scene can
+    // bring it up to date incrementally instead of rescanning every node.
+    // Recording is O(1) and never allocates.
+    //
+    // If more changes are made in a frame than fit in the buffer, the frame
+    // is incomplete and consumers must fall back to rescanning. Building
+    // without ORC_CHANGE_JOURNAL compiles recording out entirely, in which
+    // case every frame is incomplete.
+    //
+    // Not thread safe: nodes must be changed by one thread at a time.
+    class ChangeJournal
+    {
+        public:
+#ifdef ORC_CHANGE_JOURNAL
+        static constexpr bool isEnabled = true;
+#else
+        static constexpr bool isEnabled = false;
+#endif
+
+        // Capacity is rounded up to a power of two
+        ChangeJournal(size_t capacity = 4096);
+
+        void Record(ChangeType type, Node &node);
+
+        // Ends the current frame. The changes recorded since the last call
+        // become the changes of the frame, and recording starts over.
+        void EndFrame();
+
+        // Returns true if every change of the last frame was kept
+        bool IsComplete() const;
+
+        // Number of changes in the last frame, or 0 if it is incomplete
+        size_t GetSize() const;
+
+        // Changes of the last frame, in the order they were recorded
+        const Change &operator[](size_t i) const;
+
+        template <typename F>
+        void ForEach(F &&f) const;
+
+        private:
+        std::vector<Change> ring;
+        uint64_t mask;
+
+        // Changes are numbered in the order they are recorded. The last frame
+        // is [frameBegin, frameEnd) and the current one is [frameEnd, next).
+        uint64_t frameBegin, frameEnd, next;
+        bool isFrameComplete;
+    };
+
+    template <typename F>
+    void ChangeJournal::ForEach(F &&f) const
+    {
+        for (size_t i = 0; i < GetSize(); i++)
+        {
+            f((*this)[i]);
+        }
+    }
+}
@@ -0,0 +1,111 @@
+#include <memory>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "change_journal.hpp"
+#include "node.hpp"
+#include "transform_store.hpp"
+
+static std::vector<orc::ChangeType> typesOf(const orc::ChangeJournal &journal)
+{
+    std::vector<orc::ChangeType> types;
+    journal.ForEach([&types](const orc::Change &change) { types.push_back(change.Type); });
+    return types;
+}
+
+TEST_CASE("Change journal keeps the changes of the last frame", "[orc]") {
+    std::shared_ptr<orc::Node> node = orc::Node::Create();
+    orc::ChangeJournal journal(5);
+
+    if (!orc::ChangeJournal::isEnabled)
+    {
+        journal.Record(orc::ChangeType::Transformed, *node);
+        journal.EndFrame();
+        REQUIRE_FALSE(journal.IsComplete());
+        REQUIRE(journal.GetSize() == 0);
+        return;
+    }
+
+    // Nothing has been recorded yet
+    REQUIRE(journal.IsComplete());
+    REQUIRE(journal.GetSize() == 0);
+
+    // Changes only show up once their frame has ended
+    journal.Record(orc::ChangeType::Attached, *node);
+    journal.Record(orc::ChangeType::Transformed, *node);
+    REQUIRE(journal.GetSize() == 0);
+    journal.EndFrame();
+    REQUIRE(journal.IsComplete());
+    REQUIRE(typesOf(journal) == std::vector<orc::ChangeType>{orc::ChangeType::Attached, orc::ChangeType::Transformed});
+    REQUIRE(journal[0].Target == node.get());
+
+    // Capacity is rounded up to 8, shared by the last frame and the current
+    // one. Recording more than fits in the current frame overwrites the
+    // last one.
+    for (int i = 0; i < 6; i++)
+    {
+        journal.Record(orc::ChangeType::LightChanged, *node);
+    }
+    REQUIRE(journal.IsComplete());
+    journal.Record(orc::ChangeType::LightChanged, *node);
+    REQUIRE_FALSE(journal.IsComplete());
+    REQUIRE(journal.GetSize() == 0);
+
+    journal.EndFrame();
+    REQUIRE(journal.IsComplete());
+    REQUIRE(journal.GetSize() == 7);
+
+    // A frame with more changes than fit at all is incomplete
+    for (int i = 0; i < 9; i++)
+    {
+        journal.Record(orc::ChangeType::Transformed, *node);
+    }
+    journal.EndFrame();
+    REQUIRE_FALSE(journal.IsComplete());
+
+    // An empty frame is complete again
+    journal.EndFrame();
+    REQUIRE(journal.IsComplete());
+    REQUIRE(journal.GetSize() == 0);
+}
+
+TEST_CASE("Nodes record their changes to the journal of their store", "[orc]") {
+    if (!orc::ChangeJournal::isEnabled) return;
+
+    std::shared_ptr<orc::Node> root = orc::Node::Create();
+    std::shared_ptr<orc::Node> a = orc::Node::Create();
+    std::shared_ptr<orc::Node> b = orc::Node::Create();
+    root->AttachChild(a);
+
+    orc::TransformStore store;
+    orc::ChangeJournal journal;
+    store.SetJournal(&journal);
+    store.Rebuild(*root);
+    store.ComputeMxs();
+
+    // Moving a node several times is recorded once per frame
+    a->Translate(1.0f, 0.0f, 0.0f);
+    a->Rotate(0.5f, 0.0f, 0.0f);
+    root->AttachChild(b);
+    journal.EndFrame();
+    REQUIRE(typesOf(journal) == std::vector<orc::ChangeType>{orc::ChangeType::Transformed, orc::ChangeType::Attached});
+    REQUIRE(journal[0].Target == a.get());
+    REQUIRE(journal[1].Target == b.get());
+
+    store.Rebuild(*root);
+    store.ComputeMxs();
+    a->Translate(1.0f, 0.0f, 0.0f);
+    b->Detach();
+    journal.EndFrame();
+
+    // Detaching a node isn't recorded as moving it
+    REQUIRE(typesOf(journal) == std::vector<orc::ChangeType>{orc::ChangeType::Transformed, orc::ChangeType::Detached});
+    REQUIRE(journal[0].Target == a.get());
+    REQUIRE(journal[1].Target == b.get());
+
+    // Nodes outside of the store don't record anything
+    store.Rebuild(*root);
+    store.ComputeMxs();
+    b->Translate(1.0f, 0.0f, 0.0f);
+    journal.EndFrame();
+    REQUIRE(journal.GetSize() == 0);
+}
@@ -1,5 +1,7 @@
+#include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <vector>
 #include <glm/glm.hpp>
 #include "cube.hpp"
 #include "mesh.hpp"
@@ -157,10 +159,20 @@ namespace orc
             std::filesystem::path("textures") /
             std::filesystem::path("crate.png");
 
-        return std::make_unique<Mesh>(
+        std::unique_ptr<Mesh> mesh = std::make_unique<Mesh>(
             vertices,
             indices,
             std::make_unique<Texture2DRef>(Texture2D::Type::BaseColor, path)
         );
+
+        // A cube is as simple as its occluder could be
+        std::vector<glm::vec3> points;
+        for (const Mesh::Vertex &vertex : vertices)
+        {
+            points.push_back(vertex.Coordinates);
+        }
+        mesh->SetOccluder(points, std::vector<uint32_t>(indices.begin(), indices.end()));
+
+        return mesh;
     }
 }
@@ -72,4 +72,14 @@ namespace orc {
 
         return *cubemap;
     }
+
+    const std::string &CubemapRef::GetKey() const
+    {
+        return paths[0];
+    }
+
+    bool CubemapRef::IsTranslucent() const
+    {
+        return false;
+    }
 }
@@ -37,6 +37,11 @@ namespace orc
 
         Texture &Load() override;
 
+        // Faces are only ever loaded together, so the first identifies them
+        const std::string &GetKey() const override;
+
+        bool IsTranslucent() const override;
+
         private:
         const std::string paths[6];
 
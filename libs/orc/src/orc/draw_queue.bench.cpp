@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "draw_queue.hpp"
+
+const size_t numDraws = 100000;
+
+TEST_CASE("Sort 100k draws", "[orc][benchmark]") {
+    // A scene's worth of draws: a few hundred textures, some of them
+    // transparent, at depths throughout the view
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> texture(1, 300);
+    std::uniform_real_distribution<float> depth(0.1f, 200.0f);
+    std::vector<uint64_t> keys;
+    for (size_t i = 0; i < numDraws; i++)
+    {
+        uint32_t t = texture(rng);
+        keys.push_back(orc::DrawQueue::MakeKey(0, t % 8 == 0, 0, t, orc::DrawQueue::QuantizeDepth(depth(rng), 200.0f)));
+    }
+
+    orc::DrawQueue queue;
+    std::vector<orc::DrawQueue::Entry> entries;
+
+    BENCHMARK("Radix sort") {
+        queue.Clear();
+        for (uint32_t i = 0; i < numDraws; i++)
+        {
+            queue.Push(keys[i], i);
+        }
+
+        queue.Sort();
+        return queue.GetEntries()[0].Item;
+    };
+
+    BENCHMARK("std::sort") {
+        entries.clear();
+        for (uint32_t i = 0; i < numDraws; i++)
+        {
+            entries.push_back(orc::DrawQueue::Entry{.Key = keys[i], .Item = i});
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const orc::DrawQueue::Entry &a, const orc::DrawQueue::Entry &b) {
+            return a.Key < b.Key;
+        });
+        return entries[0].Item;
+    };
+}
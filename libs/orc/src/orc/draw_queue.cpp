@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "draw_queue.hpp"
+
+const int radixBits = 8;
+const size_t radixSize = 1 << radixBits;
+const int numDigits = 64 / radixBits;
+
+namespace orc
+{
+    static inline uint64_t field(uint32_t value, int bits, int shift)
+    {
+        return ((uint64_t)value & ((1ull << bits) - 1)) << shift;
+    }
+
+    uint64_t DrawQueue::MakeKey(uint32_t pass, bool isTransparent, uint32_t shader, uint32_t texture, uint32_t depth)
+    {
+        int shift = 0;
+        uint64_t key = field(depth, depthBits, shift);
+        key |= field(texture, textureBits, shift += depthBits);
+        key |= field(shader, shaderBits, shift += textureBits);
+        key |= field(isTransparent, transparencyBits, shift += shaderBits);
+        key |= field(pass, passBits, shift += transparencyBits);
+        return key;
+    }
+
+    bool DrawQueue::IsTransparent(uint64_t key)
+    {
+        return (key >> (depthBits + textureBits + shaderBits)) & 1;
+    }
+
+    uint32_t DrawQueue::QuantizeDepth(float depth, float far)
+    {
+        const uint32_t numBuckets = 1u << depthBits;
+
+        // Written so that NaN clamps to 0
+        float t = depth > 0.0f ? std::min(depth / far, 1.0f) : 0.0f;
+        return std::min((uint32_t)(t * numBuckets), numBuckets - 1);
+    }
+
+    uint32_t DrawQueue::QuantizeDepthReversed(float depth, float far)
+    {
+        return ((1u << depthBits) - 1) - QuantizeDepth(depth, far);
+    }
+
+    void DrawQueue::Clear()
+    {
+        entries.clear();
+    }
+
+    void DrawQueue::Push(uint64_t key, uint32_t item)
+    {
+        entries.push_back(Entry{.Key = key, .Item = item});
+    }
+
+    void DrawQueue::Sort()
+    {
+        size_t n = entries.size();
+        if (n < 2) return;
+
+        // Count every digit of every key in a single pass
+        uint32_t counts[numDigits][radixSize] = {};
+        for (const Entry &e : entries)
+        {
+            for (int d = 0; d < numDigits; d++)
+            {
+                counts[d][(e.Key >> (d * radixBits)) & (radixSize - 1)]++;
+            }
+        }
+
+        // Least significant digit first. Each pass is stable, so the order
+        // of lower digits is kept among keys with the same higher digits.
+        scratch.resize(n);
+        bool isSortedInScratch = false;
+        for (int d = 0; d < numDigits; d++)
+        {
+            int shift = d * radixBits;
+            uint32_t *digitCounts = counts[d];
+
+            // Every key has the same digit, so the pass wouldn't move anything
+            if (digitCounts[(entries[0].Key >> shift) & (radixSize - 1)] == n) continue;
+
+            uint32_t offset = 0;
+            for (size_t b = 0; b < radixSize; b++)
+            {
+                uint32_t count = digitCounts[b];
+                digitCounts[b] = offset;
+                offset += count;
+            }
+
+            const std::vector<Entry> &src = isSortedInScratch ? scratch : entries;
+            std::vector<Entry> &dst = isSortedInScratch ? entries : scratch;
+            for (const Entry &e : src)
+            {
+                dst[digitCounts[(e.Key >> shift) & (radixSize - 1)]++] = e;
+            }
+            isSortedInScratch = !isSortedInScratch;
+        }
+
+        if (isSortedInScratch)
+        {
+            entries.swap(scratch);
+        }
+    }
+
+    size_t DrawQueue::GetSize() const
+    {
+        return entries.size();
+    }
+
+    const std::vector<DrawQueue::Entry> &DrawQueue::GetEntries() const
+    {
+        return entries;
+    }
+}
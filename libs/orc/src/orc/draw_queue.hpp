@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace orc
+{
+    // A list of draws, each identified by an item index chosen by the caller
+    // and ordered by a 64-bit key. Keys pack everything that draws are sorted
+    // by into one integer, most significant first:
+    //
+    //   pass (4 bits) | transparency (1) | shader (8) | texture (24) | depth (27)
+    //
+    // so that sorting the keys groups draws by pass, draws opaque geometry
+    // before transparent geometry, and minimizes state changes within each.
+    // Fields that don't fit are truncated, which only affects sort quality.
+    //
+    // Sorting is a radix sort, which is linear in the number of draws and
+    // skips any byte that every key shares. It is stable, so draws with equal
+    // keys are kept in the order they were pushed.
+    class DrawQueue
+    {
+        public:
+        struct Entry
+        {
+            uint64_t Key;
+            uint32_t Item;
+        };
+
+        static constexpr int passBits = 4;
+        static constexpr int transparencyBits = 1;
+        static constexpr int shaderBits = 8;
+        static constexpr int textureBits = 24;
+        static constexpr int depthBits = 27;
+
+        // Packs a sort key. Depth is a bucket, e.g. from QuantizeDepth.
+        static uint64_t MakeKey(uint32_t pass, bool isTransparent, uint32_t shader, uint32_t texture, uint32_t depth);
+
+        // Returns the transparency packed into a key by MakeKey
+        static bool IsTransparent(uint64_t key);
+
+        // Returns the depth bucket of a view space distance in front of the
+        // camera. Distances are clamped to [0, far].
+        static uint32_t QuantizeDepth(float depth, float far);
+
+        // Same as above, but farther distances get lower buckets, for draws
+        // that must be sorted back to front
+        static uint32_t QuantizeDepthReversed(float depth, float far);
+
+        void Clear();
+
+        void Push(uint64_t key, uint32_t item);
+
+        void Sort();
+
+        size_t GetSize() const;
+
+        // Entries in the order they were pushed, or in key order after Sort
+        const std::vector<Entry> &GetEntries() const;
+
+        private:
+        std::vector<Entry> entries;
+
+        // Reused between sorts
+        std::vector<Entry> scratch;
+    };
+}
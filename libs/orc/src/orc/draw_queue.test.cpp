@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "draw_queue.hpp"
+
+TEST_CASE("Draw queue sorts by key and keeps the order of equal keys", "[orc]") {
+    std::mt19937_64 rng(7);
+    orc::DrawQueue queue;
+    std::vector<orc::DrawQueue::Entry> expected;
+
+    // Few distinct values in the upper fields, like a real scene, so that
+    // some digits are shared by every key and skipped
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+        uint64_t key = orc::DrawQueue::MakeKey(rng() % 2, rng() % 2, 0, rng() % 20, rng() % 100);
+        queue.Push(key, i);
+        expected.push_back(orc::DrawQueue::Entry{.Key = key, .Item = i});
+    }
+
+    std::stable_sort(expected.begin(), expected.end(), [](const orc::DrawQueue::Entry &a, const orc::DrawQueue::Entry &b) {
+        return a.Key < b.Key;
+    });
+    queue.Sort();
+
+    REQUIRE(queue.GetSize() == expected.size());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        REQUIRE(queue.GetEntries()[i].Key == expected[i].Key);
+        REQUIRE(queue.GetEntries()[i].Item == expected[i].Item);
+    }
+
+    // Keys that differ in every byte
+    queue.Clear();
+    expected.clear();
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        uint64_t key = rng();
+        queue.Push(key, i);
+        expected.push_back(orc::DrawQueue::Entry{.Key = key, .Item = i});
+    }
+    std::sort(expected.begin(), expected.end(), [](const orc::DrawQueue::Entry &a, const orc::DrawQueue::Entry &b) {
+        return a.Key < b.Key;
+    });
+    queue.Sort();
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        REQUIRE(queue.GetEntries()[i].Item == expected[i].Item);
+    }
+
+    queue.Clear();
+    queue.Sort();
+    REQUIRE(queue.GetSize() == 0);
+}
+
+TEST_CASE("Draw queue keys order fields from most to least significant", "[orc]") {
+    using orc::DrawQueue;
+
+    // Each field outweighs every field after it
+    REQUIRE(DrawQueue::MakeKey(0, true, 255, 0xFFFFFF, 0x7FFFFFF) < DrawQueue::MakeKey(1, false, 0, 0, 0));
+    REQUIRE(DrawQueue::MakeKey(0, false, 255, 0xFFFFFF, 0x7FFFFFF) < DrawQueue::MakeKey(0, true, 0, 0, 0));
+    REQUIRE(DrawQueue::MakeKey(0, false, 0, 0xFFFFFF, 0x7FFFFFF) < DrawQueue::MakeKey(0, false, 1, 0, 0));
+    REQUIRE(DrawQueue::MakeKey(0, false, 0, 0, 0x7FFFFFF) < DrawQueue::MakeKey(0, false, 0, 1, 0));
+    REQUIRE(DrawQueue::MakeKey(0, false, 0, 0, 1) > DrawQueue::MakeKey(0, false, 0, 0, 0));
+
+    // Values too large for their field don't spill into the next one
+    REQUIRE(DrawQueue::MakeKey(0, false, 0, 1u << 24, 0) == DrawQueue::MakeKey(0, false, 0, 0, 0));
+
+    // Transparency can be read back
+    REQUIRE(DrawQueue::IsTransparent(DrawQueue::MakeKey(15, true, 0, 0, 0)));
+    REQUIRE(!DrawQueue::IsTransparent(DrawQueue::MakeKey(15, false, 255, 0xFFFFFF, 0x7FFFFFF)));
+
+    REQUIRE(DrawQueue::QuantizeDepth(-1.0f, 100.0f) == 0);
+    REQUIRE(DrawQueue::QuantizeDepth(10.0f, 100.0f) < DrawQueue::QuantizeDepth(20.0f, 100.0f));
+    REQUIRE(DrawQueue::QuantizeDepth(500.0f, 100.0f) == (1u << DrawQueue::depthBits) - 1);
+
+    REQUIRE(DrawQueue::QuantizeDepthReversed(-1.0f, 100.0f) == (1u << DrawQueue::depthBits) - 1);
+    REQUIRE(DrawQueue::QuantizeDepthReversed(10.0f, 100.0f) > DrawQueue::QuantizeDepthReversed(20.0f, 100.0f));
+    REQUIRE(DrawQueue::QuantizeDepthReversed(500.0f, 100.0f) == 0);
+}
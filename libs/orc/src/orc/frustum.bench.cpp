@@ -0,0 +1,38 @@
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "camera.hpp"
+#include "frustum.hpp"
+#include "mx_kernels.hpp"
+
+const size_t numBoxes = 100000;
+
+TEST_CASE("Frustum culling", "[orc][benchmark]") {
+    std::shared_ptr<orc::Camera> camera = orc::Camera::Create();
+    camera->ComputeMxs();
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> pos(-200.0f, 200.0f);
+    std::vector<orc::AABB> boxes;
+    for (size_t i = 0; i < numBoxes; i++)
+    {
+        glm::vec3 center(pos(rng), pos(rng), pos(rng));
+        boxes.push_back(orc::AABB{.Min = center - glm::vec3(1.0f), .Max = center + glm::vec3(1.0f)});
+    }
+    std::vector<uint8_t> visible(numBoxes);
+
+    const char *names[] = {"Scalar", "SSE", "AVX2"};
+    for (int level = 0; level <= (int)orc::GetSupportedSimdLevel(); level++)
+    {
+        BENCHMARK(std::string(names[level]) + ": cull 100k boxes") {
+            orc::CullAABBs(camera->GetFrustum(), boxes.data(), numBoxes, visible.data(), (orc::SimdLevel)level);
+            return visible[numBoxes - 1];
+        };
+    }
+}
@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "frustum.hpp"
+#include "mx_kernels.hpp"
+
+#if defined(__x86_64__)
+    #define ORC_SIMD_X86
+    #include <immintrin.h>
+#endif
+
+namespace orc
+{
+    Frustum ExtractFrustum(const glm::mat4 &viewProjectionMx)
+    {
+        // Each plane is the sum or difference of the fourth row of the matrix
+        // and one of the other rows. glm matrices are column major, so rows
+        // have to be assembled element by element.
+        glm::vec4 rows[4];
+        for (int r = 0; r < 4; r++)
+        {
+            rows[r] = glm::vec4(viewProjectionMx[0][r], viewProjectionMx[1][r], viewProjectionMx[2][r], viewProjectionMx[3][r]);
+        }
+
+        Frustum frustum{.Planes = {
+            rows[3] + rows[0],
+            rows[3] - rows[0],
+            rows[3] + rows[1],
+            rows[3] - rows[1],
+            rows[3] + rows[2],
+            rows[3] - rows[2],
+        }};
+
+        for (glm::vec4 &plane : frustum.Planes)
+        {
+            plane /= glm::length(glm::vec3(plane));
+        }
+
+        return frustum;
+    }
+
+    bool Intersects(const Frustum &frustum, const AABB &box)
+    {
+        if (IsEmpty(box)) return false;
+
+        // A box is outside of a plane if its center is further behind the
+        // plane than the box's extents reach along the plane's normal
+        glm::vec3 center = (box.Min + box.Max) * 0.5f;
+        glm::vec3 extent = (box.Max - box.Min) * 0.5f;
+        for (const glm::vec4 &plane : frustum.Planes)
+        {
+            glm::vec3 normal(plane);
+            float dist = glm::dot(normal, center) + plane.w;
+            float radius = glm::dot(glm::abs(normal), extent);
+            if (dist + radius < 0.0f) return false;
+        }
+
+        return true;
+    }
+
+    Overlap Classify(const Frustum &frustum, const AABB &box)
+    {
+        if (IsEmpty(box)) return Overlap::None;
+
+        glm::vec3 center = (box.Min + box.Max) * 0.5f;
+        glm::vec3 extent = (box.Max - box.Min) * 0.5f;
+        Overlap overlap = Overlap::Full;
+        for (const glm::vec4 &plane : frustum.Planes)
+        {
+            glm::vec3 normal(plane);
+            float dist = glm::dot(normal, center) + plane.w;
+            float radius = glm::dot(glm::abs(normal), extent);
+            if (dist + radius < 0.0f) return Overlap::None;
+            if (dist - radius < 0.0f) overlap = Overlap::Partial;
+        }
+
+        return overlap;
+    }
+
+    static void cullAABBsScalar(const Frustum &frustum, const AABB *boxes, size_t count, uint8_t *visible)
+    {
+        for (size_t k = 0; k < count; k++)
+        {
+            visible[k] = Intersects(frustum, boxes[k]);
+        }
+    }
+
+#ifdef ORC_SIMD_X86
+    // Tests four boxes at a time, with one box per lane. The arithmetic is
+    // performed in the same order as Intersects, so results match exactly.
+    static void cullAABBsSse(const Frustum &frustum, const AABB *boxes, size_t count, uint8_t *visible)
+    {
+        const __m128 half = _mm_set1_ps(0.5f), zero = _mm_setzero_ps();
+
+        for (size_t k = 0; k < count; k += 4)
+        {
+            // Pad the final batch by repeating its last box
+            size_t n = std::min(count - k, (size_t)4);
+            const AABB *b[4];
+            for (size_t l = 0; l < 4; l++)
+            {
+                b[l] = &boxes[k + std::min(l, n - 1)];
+            }
+
+            #define ORC_GATHER4(field) _mm_setr_ps(b[0]->field, b[1]->field, b[2]->field, b[3]->field)
+            __m128 minX = ORC_GATHER4(Min.x), minY = ORC_GATHER4(Min.y), minZ = ORC_GATHER4(Min.z);
+            __m128 maxX = ORC_GATHER4(Max.x), maxY = ORC_GATHER4(Max.y), maxZ = ORC_GATHER4(Max.z);
+            #undef ORC_GATHER4
+
+            __m128 outside = _mm_or_ps(
+                _mm_or_ps(_mm_cmpgt_ps(minX, maxX), _mm_cmpgt_ps(minY, maxY)),
+                _mm_cmpgt_ps(minZ, maxZ)
+            );
+
+            __m128 cx = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+            __m128 cy = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+            __m128 cz = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+            __m128 ex = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+            __m128 ey = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+            __m128 ez = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+            for (const glm::vec4 &plane : frustum.Planes)
+            {
+                __m128 dist = _mm_add_ps(
+                    _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), cx), _mm_mul_ps(_mm_set1_ps(plane.y), cy)),
+                        _mm_mul_ps(_mm_set1_ps(plane.z), cz)
+                    ),
+                    _mm_set1_ps(plane.w)
+                );
+                __m128 radius = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::fabs(plane.x)), ex), _mm_mul_ps(_mm_set1_ps(std::fabs(plane.y)), ey)),
+                    _mm_mul_ps(_mm_set1_ps(std::fabs(plane.z)), ez)
+                );
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, radius), zero));
+            }
+
+            int mask = _mm_movemask_ps(outside);
+            for (size_t l = 0; l < n; l++)
+            {
+                visible[k + l] = !((mask >> l) & 1);
+            }
+        }
+    }
+
+    // Same as above, eight boxes at a time. FMA is deliberately not used, so
+    // that rounding matches the other implementations.
+    __attribute__((target("avx2")))
+    static void cullAABBsAvx2(const Frustum &frustum, const AABB *boxes, size_t count, uint8_t *visible)
+    {
+        const __m256 half = _mm256_set1_ps(0.5f), zero = _mm256_setzero_ps();
+
+        for (size_t k = 0; k < count; k += 8)
+        {
+            size_t n = std::min(count - k, (size_t)8);
+            const AABB *b[8];
+            for (size_t l = 0; l < 8; l++)
+            {
+                b[l] = &boxes[k + std::min(l, n - 1)];
+            }
+
+            #define ORC_GATHER8(field) _mm256_setr_ps( \
+                b[0]->field, b[1]->field, b[2]->field, b[3]->field, \
+                b[4]->field, b[5]->field, b[6]->field, b[7]->field)
+            __m256 minX = ORC_GATHER8(Min.x), minY = ORC_GATHER8(Min.y), minZ = ORC_GATHER8(Min.z);
+            __m256 maxX = ORC_GATHER8(Max.x), maxY = ORC_GATHER8(Max.y), maxZ = ORC_GATHER8(Max.z);
+            #undef ORC_GATHER8
+
+            __m256 outside = _mm256_or_ps(
+                _mm256_or_ps(_mm256_cmp_ps(minX, maxX, _CMP_GT_OQ), _mm256_cmp_ps(minY, maxY, _CMP_GT_OQ)),
+                _mm256_cmp_ps(minZ, maxZ, _CMP_GT_OQ)
+            );
+
+            __m256 cx = _mm256_mul_ps(_mm256_add_ps(minX, maxX), half);
+            __m256 cy = _mm256_mul_ps(_mm256_add_ps(minY, maxY), half);
+            __m256 cz = _mm256_mul_ps(_mm256_add_ps(minZ, maxZ), half);
+            __m256 ex = _mm256_mul_ps(_mm256_sub_ps(maxX, minX), half);
+            __m256 ey = _mm256_mul_ps(_mm256_sub_ps(maxY, minY), half);
+            __m256 ez = _mm256_mul_ps(_mm256_sub_ps(maxZ, minZ), half);
+
+            for (const glm::vec4 &plane : frustum.Planes)
+            {
+                __m256 dist = _mm256_add_ps(
+                    _mm256_add_ps(
+                        _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), cx), _mm256_mul_ps(_mm256_set1_ps(plane.y), cy)),
+                        _mm256_mul_ps(_mm256_set1_ps(plane.z), cz)
+                    ),
+                    _mm256_set1_ps(plane.w)
+                );
+                __m256 radius = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(std::fabs(plane.x)), ex), _mm256_mul_ps(_mm256_set1_ps(std::fabs(plane.y)), ey)),
+                    _mm256_mul_ps(_mm256_set1_ps(std::fabs(plane.z)), ez)
+                );
+                outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(dist, radius), zero, _CMP_LT_OQ));
+            }
+
+            int mask = _mm256_movemask_ps(outside);
+            for (size_t l = 0; l < n; l++)
+            {
+                visible[k + l] = !((mask >> l) & 1);
+            }
+        }
+    }
+#endif
+
+    static void cullAABBs(const Frustum &frustum, const AABB *boxes, size_t count, uint8_t *visible, SimdLevel level)
+    {
+        switch (level)
+        {
+#ifdef ORC_SIMD_X86
+            case SimdLevel::AVX2:
+                cullAABBsAvx2(frustum, boxes, count, visible);
+                break;
+            case SimdLevel::SSE:
+                cullAABBsSse(frustum, boxes, count, visible);
+                break;
+#endif
+            default:
+                cullAABBsScalar(frustum, boxes, count, visible);
+                break;
+        }
+    }
+
+    void CullAABBs(const Frustum &frustum, const AABB *boxes, size_t count, uint8_t *visible)
+    {
+        static const SimdLevel level = GetSupportedSimdLevel();
+        cullAABBs(frustum, boxes, count, visible, level);
+    }
+
+    void CullAABBs(const Frustum &frustum, const AABB *boxes, size_t count, uint8_t *visible, SimdLevel level)
+    {
+        if (level > GetSupportedSimdLevel())
+        {
+            throw std::runtime_error("Instruction set is not supported by this CPU");
+        }
+
+        cullAABBs(frustum, boxes, count, visible, level);
+    }
+}
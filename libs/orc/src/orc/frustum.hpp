@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "mx_kernels.hpp"
+
+namespace orc
+{
+    // The volume visible to a camera, bounded by six planes. Each plane is
+    // stored as (normal, distance), with its normal facing into the frustum
+    // and normalized, so that dot(normal, p) + distance is the signed
+    // distance of point p from the plane.
+    struct Frustum
+    {
+        // Left, right, bottom, top, near, and far, in that order
+        glm::vec4 Planes[6];
+    };
+
+    // Extracts the planes of the frustum from a view-projection matrix
+    // (Gribb and Hartmann's method). Planes are in world space.
+    Frustum ExtractFrustum(const glm::mat4 &viewProjectionMx);
+
+    // Returns false if the box lies entirely outside of any plane of the
+    // frustum. Boxes that straddle the corner of a frustum may be reported as
+    // intersecting even though they are not, which is conservative.
+    bool Intersects(const Frustum &frustum, const AABB &box);
+
+    enum class Overlap
+    {
+        None,
+        Partial,
+        Full,
+    };
+
+    // Same test as Intersects, but also detects boxes that are entirely
+    // inside of every plane, so that hierarchies can accept everything
+    // beneath them without testing it
+    Overlap Classify(const Frustum &frustum, const AABB &box);
+
+    // Tests a batch of boxes against the frustum at once, writing 1 to
+    // visible[k] if boxes[k] intersects it and 0 otherwise. Empty boxes are
+    // never visible. Results are identical to calling Intersects on each box.
+    void CullAABBs(const Frustum &frustum, const AABB *boxes, size_t count, uint8_t *visible);
+
+    // Same as above, using a specific instruction set. Throws if the host
+    // CPU does not support it.
+    void CullAABBs(const Frustum &frustum, const AABB *boxes, size_t count, uint8_t *visible, SimdLevel level);
+}
@@ -0,0 +1,70 @@
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "camera.hpp"
+#include "frustum.hpp"
+#include "mx_kernels.hpp"
+
+static orc::AABB boxAt(glm::vec3 center, float halfSize)
+{
+    return orc::AABB{.Min = center - glm::vec3(halfSize), .Max = center + glm::vec3(halfSize)};
+}
+
+TEST_CASE("Cull boxes outside of the camera's view", "[orc]") {
+    // Looks down -Z with a 45 degree field of view, from 1 to 200 units away
+    std::shared_ptr<orc::Camera> camera = orc::Camera::Create();
+    camera->SetAspectRatio(1.0f);
+    camera->ComputeMxs();
+    const orc::Frustum &frustum = camera->GetFrustum();
+
+    REQUIRE(orc::Intersects(frustum, boxAt(glm::vec3(0.0f, 0.0f, -10.0f), 1.0f)));
+    REQUIRE_FALSE(orc::Intersects(frustum, boxAt(glm::vec3(0.0f, 0.0f, 10.0f), 1.0f)));
+    REQUIRE_FALSE(orc::Intersects(frustum, boxAt(glm::vec3(-20.0f, 0.0f, -10.0f), 1.0f)));
+    REQUIRE_FALSE(orc::Intersects(frustum, boxAt(glm::vec3(0.0f, 20.0f, -10.0f), 1.0f)));
+    REQUIRE_FALSE(orc::Intersects(frustum, boxAt(glm::vec3(0.0f, 0.0f, -300.0f), 1.0f)));
+    REQUIRE_FALSE(orc::Intersects(frustum, orc::EmptyAABB()));
+
+    // Boxes that straddle a plane are kept
+    REQUIRE(orc::Intersects(frustum, boxAt(glm::vec3(0.0f, 0.0f, 0.0f), 1.5f)));
+
+    // Turning the camera around brings boxes behind it into view
+    camera->Rotate(glm::radians(180.0f), 0.0f, 0.0f);
+    camera->ComputeMxs();
+    REQUIRE(orc::Intersects(camera->GetFrustum(), boxAt(glm::vec3(0.0f, 0.0f, 10.0f), 1.0f)));
+}
+
+TEST_CASE("Batched culling matches individual tests", "[orc]") {
+    std::shared_ptr<orc::Camera> camera = orc::Camera::Create();
+    camera->Rotate(0.3f, -0.2f, 0.0f);
+    camera->ComputeMxs();
+    const orc::Frustum &frustum = camera->GetFrustum();
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> pos(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> size(0.1f, 10.0f);
+
+    // An odd count exercises the padding of partial batches
+    std::vector<orc::AABB> boxes;
+    for (int i = 0; i < 1001; i++)
+    {
+        boxes.push_back(boxAt(glm::vec3(pos(rng), pos(rng), pos(rng)), size(rng)));
+    }
+    boxes[500] = orc::EmptyAABB();
+
+    std::vector<uint8_t> expected;
+    for (const orc::AABB &box : boxes)
+    {
+        expected.push_back(orc::Intersects(frustum, box));
+    }
+
+    for (int level = 0; level <= (int)orc::GetSupportedSimdLevel(); level++)
+    {
+        std::vector<uint8_t> visible(boxes.size());
+        orc::CullAABBs(frustum, boxes.data(), boxes.size(), visible.data(), (orc::SimdLevel)level);
+        REQUIRE(visible == expected);
+    }
+}
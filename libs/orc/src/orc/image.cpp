@@ -39,4 +39,12 @@ namespace orc
     {
         return channels;
     }
+
+    int Image::ReadChannels(const std::string &path)
+    {
+        int width, height, channels;
+        if (!stbi_info(path.c_str(), &width, &height, &channels)) return 0;
+
+        return channels;
+    }
 }
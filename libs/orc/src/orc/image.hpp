@@ -24,6 +24,10 @@ namespace orc
         int GetHeight() const;
         int GetChannels() const;
 
+        // Returns the number of channels of the image at a path, reading no
+        // more than its header, or 0 if it can't be read
+        static int ReadChannels(const std::string &path);
+
         private:
         int width, height, channels;
         unsigned char *data;
@@ -1,4 +1,10 @@
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include "change_journal.hpp"
 #include "light.hpp"
+#include "node_pool.hpp"
 #include "types.hpp"
 #include "visitor.hpp"
 
@@ -7,16 +13,30 @@ namespace orc
     Light::Light()
         : color(glm::vec3(1.0f))
         , phong(Phong{.Ambient = 0.05f, .Diffuse = 0.5f, .Specular = 0.8f})
+        , range(std::numeric_limits<float>::infinity())
         {}
 
     void Light::SetColor(float r, float g, float b)
     {
         color = glm::vec3(r, g, b);
+        RecordChange(ChangeType::LightChanged);
     }
 
     void Light::SetPhong(float ambient, float diffuse, float specular)
     {
         phong = Phong{.Ambient = ambient, .Diffuse = diffuse, .Specular = specular};
+        RecordChange(ChangeType::LightChanged);
+    }
+
+    void Light::SetRange(float range)
+    {
+        if (range <= 0)
+        {
+            throw std::logic_error("Light range must be greater than 0");
+        }
+
+        this->range = range;
+        RecordChange(ChangeType::LightChanged);
     }
 
     glm::vec3 Light::GetColor() const
@@ -29,11 +49,21 @@ namespace orc
         return phong;
     }
 
+    float Light::GetRange() const
+    {
+        return range;
+    }
+
     std::shared_ptr<OmniLight> OmniLight::Create()
     {
         return std::shared_ptr<OmniLight>(new OmniLight());
     }
 
+    std::shared_ptr<OmniLight> OmniLight::Create(NodePool &pool)
+    {
+        return pool.Create<OmniLight>([](void *mem) { return new (mem) OmniLight(); });
+    }
+
     OmniLight::OmniLight() : brightness(1.25f) {}
 
     void OmniLight::Dispatch(NodeVisitor &visitor)
@@ -44,6 +74,7 @@ namespace orc
     void OmniLight::SetBrightness(float brightness)
     {
         this->brightness = brightness;
+        RecordChange(ChangeType::LightChanged);
     }
 
     float OmniLight::GetBrightness() const
@@ -56,6 +87,11 @@ namespace orc
         return std::shared_ptr<SpotLight>(new SpotLight());
     }
 
+    std::shared_ptr<SpotLight> SpotLight::Create(NodePool &pool)
+    {
+        return pool.Create<SpotLight>([](void *mem) { return new (mem) SpotLight(); });
+    }
+
     SpotLight::SpotLight()
     {
         SetBlurAngles(glm::radians(15.0f), glm::radians(25.0f));
@@ -70,6 +106,7 @@ namespace orc
     {
         innerBlur = cos(inner);
         outerBlur = cos(outer);
+        RecordChange(ChangeType::LightChanged);
     }
 
     float SpotLight::GetInnerBlur() const
@@ -14,16 +14,25 @@ namespace orc
 
         void SetPhong(float ambient, float diffuse, float specular);
 
+        // Sets the distance beyond which the light has no effect. Light fades
+        // out smoothly as it approaches this distance. Lights with a finite
+        // range only cost anything where they reach, so scenes with many
+        // lights should give each one a range. Defaults to infinity.
+        void SetRange(float range);
+
         glm::vec3 GetColor() const;
 
         Phong GetPhong() const;
 
+        float GetRange() const;
+
         protected:
         Light();
 
         private:
         glm::vec3 color;
         Phong phong;
+        float range;
     };
 
     class OmniLight : public Light
@@ -31,6 +40,8 @@ namespace orc
         public:
         static std::shared_ptr<OmniLight> Create();
 
+        static std::shared_ptr<OmniLight> Create(NodePool &pool);
+
         void Dispatch(NodeVisitor &visitor) override;
 
         void SetBrightness(float brightness);
@@ -49,6 +60,8 @@ namespace orc
         public:
         static std::shared_ptr<SpotLight> Create();
 
+        static std::shared_ptr<SpotLight> Create(NodePool &pool);
+
         void Dispatch(NodeVisitor &visitor) override;
 
         void SetBlurAngles(float innerDeg, float outerDeg);
@@ -0,0 +1,42 @@
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "camera.hpp"
+#include "light_clusters.hpp"
+
+TEST_CASE("Bin lights into clusters", "[orc][benchmark]") {
+    // Lights scattered through the camera's view, each reaching a few units
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> lateral(-80.0f, 80.0f);
+    std::uniform_real_distribution<float> depth(-190.0f, -2.0f);
+    std::uniform_real_distribution<float> radius(2.0f, 8.0f);
+    std::vector<orc::BoundingSphere> lights;
+    for (int i = 0; i < 1000; i++)
+    {
+        lights.push_back(orc::BoundingSphere{.Center = glm::vec3(lateral(rng), lateral(rng) * 0.5f, depth(rng)), .Radius = radius(rng)});
+    }
+
+    std::shared_ptr<orc::Camera> camera = orc::Camera::Create();
+    camera->ComputeMxs();
+    orc::LightClusters clusters;
+
+    BENCHMARK("Bin 100 lights") {
+        clusters.Build(*camera, lights.data(), 100);
+        return clusters.GetLightIndices().size();
+    };
+
+    BENCHMARK("Bin 500 lights") {
+        clusters.Build(*camera, lights.data(), 500);
+        return clusters.GetLightIndices().size();
+    };
+
+    BENCHMARK("Bin 1000 lights") {
+        clusters.Build(*camera, lights.data(), 1000);
+        return clusters.GetLightIndices().size();
+    };
+}
@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "camera.hpp"
+#include "light_clusters.hpp"
+
+namespace orc
+{
+    // Returns the tile that a normalized device coordinate falls in along one
+    // axis, the same way shaders do
+    static inline uint32_t tileOf(float ndc, uint32_t tiles)
+    {
+        float tile = std::floor((ndc * 0.5f + 0.5f) * tiles);
+        return std::clamp(tile, 0.0f, (float)(tiles - 1));
+    }
+
+    LightClusters::LightClusters(uint32_t tilesX, uint32_t tilesY, uint32_t slices)
+        : tilesX(tilesX)
+        , tilesY(tilesY)
+        , slices(slices)
+        , depthScale(0.0f)
+        , depthBias(0.0f)
+    {
+        if (tilesX == 0 || tilesY == 0 || slices == 0)
+        {
+            throw std::logic_error("Light clusters must have at least one tile and slice");
+        }
+
+        clusters.resize(2 * GetSize(), 0);
+    }
+
+    void LightClusters::Build(const Camera &camera, const BoundingSphere *lights, size_t count)
+    {
+        float near = camera.GetNearClippingDistance();
+        float far = camera.GetFarClippingDistance();
+        depthScale = slices / std::log(far / near);
+        depthBias = -std::log(near) * depthScale;
+
+        float tanHalfFovY = std::tan(camera.GetFieldOfView() * 0.5f);
+        glm::vec2 tanHalfFov(tanHalfFovY * camera.GetAspectRatio(), tanHalfFovY);
+        glm::mat4 viewMx = camera.GetViewMx();
+
+        spans.clear();
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (std::isinf(lights[i].Radius))
+            {
+                for (uint32_t s = 0; s < slices; s++)
+                {
+                    spans.push_back(Span{.Light = i, .Slice = s, .X0 = 0, .X1 = tilesX - 1, .Y0 = 0, .Y1 = tilesY - 1});
+                }
+
+                continue;
+            }
+
+            glm::vec3 center(viewMx * glm::vec4(lights[i].Center, 1.0f));
+            AddSpans(i, center, lights[i].Radius, near, far, tanHalfFov);
+        }
+
+        // Count the lights in each cluster, lay the clusters' lists out one
+        // after another, then fill them in. Spans are in order of light, so
+        // each cluster's lights end up in order too.
+        counts.assign(GetSize(), 0);
+        for (const Span &span : spans)
+        {
+            for (uint32_t y = span.Y0; y <= span.Y1; y++)
+            {
+                uint32_t row = (span.Slice * tilesY + y) * tilesX;
+                for (uint32_t x = span.X0; x <= span.X1; x++)
+                {
+                    counts[row + x]++;
+                }
+            }
+        }
+
+        uint32_t first = 0;
+        for (size_t c = 0; c < counts.size(); c++)
+        {
+            clusters[2 * c] = first;
+            clusters[2 * c + 1] = 0;
+            first += counts[c];
+        }
+
+        lightIndices.resize(first);
+        for (const Span &span : spans)
+        {
+            for (uint32_t y = span.Y0; y <= span.Y1; y++)
+            {
+                uint32_t row = (span.Slice * tilesY + y) * tilesX;
+                for (uint32_t x = span.X0; x <= span.X1; x++)
+                {
+                    uint32_t *cluster = &clusters[2 * (row + x)];
+                    lightIndices[cluster[0] + cluster[1]++] = span.Light;
+                }
+            }
+        }
+    }
+
+    uint32_t LightClusters::GetTilesX() const
+    {
+        return tilesX;
+    }
+
+    uint32_t LightClusters::GetTilesY() const
+    {
+        return tilesY;
+    }
+
+    uint32_t LightClusters::GetSlices() const
+    {
+        return slices;
+    }
+
+    size_t LightClusters::GetSize() const
+    {
+        return (size_t)tilesX * tilesY * slices;
+    }
+
+    float LightClusters::GetDepthScale() const
+    {
+        return depthScale;
+    }
+
+    float LightClusters::GetDepthBias() const
+    {
+        return depthBias;
+    }
+
+    uint32_t LightClusters::FindCluster(glm::vec4 clipPos) const
+    {
+        // For a perspective projection, w is the distance in front of the
+        // camera
+        glm::vec2 ndc = glm::vec2(clipPos) / clipPos.w;
+        uint32_t x = tileOf(ndc.x, tilesX);
+        uint32_t y = tileOf(ndc.y, tilesY);
+        return (GetSlice(clipPos.w) * tilesY + y) * tilesX + x;
+    }
+
+    const std::vector<uint32_t> &LightClusters::GetClusters() const
+    {
+        return clusters;
+    }
+
+    const std::vector<uint32_t> &LightClusters::GetLightIndices() const
+    {
+        return lightIndices;
+    }
+
+    uint32_t LightClusters::GetSlice(float depth) const
+    {
+        float slice = std::floor(std::log(std::max(depth, 1e-6f)) * depthScale + depthBias);
+        return std::clamp(slice, 0.0f, (float)(slices - 1));
+    }
+
+    void LightClusters::AddSpans(uint32_t light, glm::vec3 center, float radius, float near, float far, glm::vec2 tanHalfFov)
+    {
+        // The camera looks down -Z in view space
+        float depth = -center.z;
+        float minDepth = std::max(depth - radius, near);
+        float maxDepth = std::min(depth + radius, far);
+        if (minDepth > maxDepth) return;
+
+        uint32_t firstSlice = GetSlice(minDepth);
+        uint32_t lastSlice = GetSlice(maxDepth);
+        for (uint32_t s = firstSlice; s <= lastSlice; s++)
+        {
+            float a = s == firstSlice ? minDepth : std::exp((s - depthBias) / depthScale);
+            float b = s == lastSlice ? maxDepth : std::exp((s + 1 - depthBias) / depthScale);
+
+            // Within the slice, the sphere is no wider than its cross section
+            // at the depth nearest to its center
+            float offset = depth < a ? a - depth : (depth > b ? depth - b : 0.0f);
+            float crossRadius = std::sqrt(std::max(radius * radius - offset * offset, 0.0f));
+
+            // Bound the box around the cross section, extruded from a to b,
+            // on screen. Dividing by depth is monotonic on either side of the
+            // view axis, so the extremes are at the box's corners.
+            glm::vec2 lo = glm::vec2(center) - crossRadius;
+            glm::vec2 hi = glm::vec2(center) + crossRadius;
+            glm::vec2 ndcMin, ndcMax;
+            for (int axis = 0; axis < 2; axis++)
+            {
+                ndcMin[axis] = (lo[axis] >= 0.0f ? lo[axis] / b : lo[axis] / a) / tanHalfFov[axis];
+                ndcMax[axis] = (hi[axis] >= 0.0f ? hi[axis] / a : hi[axis] / b) / tanHalfFov[axis];
+            }
+
+            if (ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f) continue;
+
+            spans.push_back(Span{
+                .Light = light,
+                .Slice = s,
+                .X0 = tileOf(ndcMin.x, tilesX),
+                .X1 = tileOf(ndcMax.x, tilesX),
+                .Y0 = tileOf(ndcMin.y, tilesY),
+                .Y1 = tileOf(ndcMax.y, tilesY),
+            });
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "camera.hpp"
+
+namespace orc
+{
+    // Divides a camera's view volume into a grid of clusters, which are tiles
+    // of the screen further divided into slices by depth, and finds the
+    // lights that reach into each cluster. Shaders look up the cluster that a
+    // fragment falls in and only shade the lights listed for it, so the cost
+    // of a light depends on how much of the screen it covers rather than on
+    // how many lights there are in total.
+    //
+    // Slices are spaced exponentially, so that clusters are roughly cubic
+    // near the camera as well as far away from it. Binning is conservative:
+    // a cluster may list a light that doesn't quite reach it, but never
+    // misses one that does.
+    //
+    // Runs entirely on the CPU. The results are laid out to be uploaded to
+    // buffer textures as they are.
+    class LightClusters
+    {
+        public:
+        LightClusters(uint32_t tilesX = 16, uint32_t tilesY = 9, uint32_t slices = 24);
+
+        // Bins count lights, each bounded by a world space sphere, into the
+        // clusters of the camera's current view. Lights are identified by
+        // their index in the array. Spheres with an infinite radius reach
+        // every cluster.
+        void Build(const Camera &camera, const BoundingSphere *lights, size_t count);
+
+        uint32_t GetTilesX() const;
+
+        uint32_t GetTilesY() const;
+
+        uint32_t GetSlices() const;
+
+        // Total number of clusters, tilesX * tilesY * slices
+        size_t GetSize() const;
+
+        // Slices are found by computing log(depth) * scale + bias, where depth
+        // is a view space distance in front of the camera, and rounding down
+        float GetDepthScale() const;
+
+        float GetDepthBias() const;
+
+        // Returns the index of the cluster that contains a point in clip
+        // space, exactly as shaders find it. Points outside of the view
+        // volume are clamped to the nearest cluster.
+        uint32_t FindCluster(glm::vec4 clipPos) const;
+
+        // Two values for each cluster, (first, count), where the lights that
+        // reach into the cluster are [first, first + count) of the light
+        // indices. Clusters are ordered by slice, then row, then column.
+        const std::vector<uint32_t> &GetClusters() const;
+
+        const std::vector<uint32_t> &GetLightIndices() const;
+
+        private:
+        // The clusters of one slice that a light reaches into, from tile
+        // (x0, y0) to tile (x1, y1) inclusive
+        struct Span
+        {
+            uint32_t Light;
+            uint32_t Slice;
+            uint32_t X0, X1, Y0, Y1;
+        };
+
+        uint32_t tilesX, tilesY, slices;
+        float depthScale, depthBias;
+        std::vector<uint32_t> clusters;
+        std::vector<uint32_t> lightIndices;
+
+        // Reused between builds
+        std::vector<Span> spans;
+        std::vector<uint32_t> counts;
+
+        uint32_t GetSlice(float depth) const;
+
+        // Appends the spans of one light, given its center in view space
+        void AddSpans(uint32_t light, glm::vec3 center, float radius, float near, float far, glm::vec2 tanHalfFov);
+    };
+}
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "camera.hpp"
+#include "light_clusters.hpp"
+
+static std::vector<uint32_t> lightsIn(const orc::LightClusters &clusters, uint32_t cluster)
+{
+    const uint32_t *range = &clusters.GetClusters()[2 * cluster];
+    const uint32_t *first = clusters.GetLightIndices().data() + range[0];
+    return std::vector<uint32_t>(first, first + range[1]);
+}
+
+TEST_CASE("Every point lit by a light is in a cluster that lists it", "[orc]") {
+    std::shared_ptr<orc::Camera> camera = orc::Camera::Create();
+    camera->SetAspectRatio(4.0f / 3.0f);
+    camera->SetClippingDistance(0.5f, 100.0f);
+    camera->Translate(3.0f, 2.0f, 10.0f);
+    camera->Rotate(0.4f, -0.2f, 0.0f);
+    camera->ComputeMxs();
+
+    // Lights of all sizes, including some behind the camera and some that
+    // contain it
+    std::mt19937 rng(23);
+    std::uniform_real_distribution<float> pos(-60.0f, 60.0f);
+    std::uniform_real_distribution<float> radius(0.5f, 15.0f);
+    std::vector<orc::BoundingSphere> lights;
+    for (int i = 0; i < 300; i++)
+    {
+        lights.push_back(orc::BoundingSphere{.Center = glm::vec3(pos(rng), pos(rng), pos(rng) - 40.0f), .Radius = radius(rng)});
+    }
+    lights.push_back(orc::BoundingSphere{.Center = camera->GetPosition(), .Radius = 2.0f});
+
+    orc::LightClusters clusters;
+    clusters.Build(*camera, lights.data(), lights.size());
+    REQUIRE(clusters.GetClusters().size() == 2 * clusters.GetSize());
+
+    // Sample points throughout the view volume, and find them the same way
+    // the shader would
+    glm::mat4 inverseMx = glm::inverse(camera->GetViewProjectionMx());
+    std::uniform_real_distribution<float> ndc(-1.0f, 1.0f);
+    for (int i = 0; i < 5000; i++)
+    {
+        glm::vec4 p = inverseMx * glm::vec4(ndc(rng), ndc(rng), ndc(rng), 1.0f);
+        glm::vec3 point = glm::vec3(p) / p.w;
+        std::vector<uint32_t> listed = lightsIn(clusters, clusters.FindCluster(camera->GetViewProjectionMx() * glm::vec4(point, 1.0f)));
+
+        for (uint32_t l = 0; l < lights.size(); l++)
+        {
+            if (glm::length(point - lights[l].Center) >= lights[l].Radius) continue;
+            REQUIRE(std::binary_search(listed.begin(), listed.end(), l));
+        }
+    }
+}
+
+TEST_CASE("Lights are only binned into clusters they may reach", "[orc]") {
+    std::shared_ptr<orc::Camera> camera = orc::Camera::Create();
+    camera->ComputeMxs();
+
+    std::vector<orc::BoundingSphere> lights = {
+        // Behind the camera, and beyond the far plane
+        orc::BoundingSphere{.Center = glm::vec3(0.0f, 0.0f, 10.0f), .Radius = 5.0f},
+        orc::BoundingSphere{.Center = glm::vec3(0.0f, 0.0f, -300.0f), .Radius = 50.0f},
+
+        // Small and straight ahead
+        orc::BoundingSphere{.Center = glm::vec3(0.0f, 0.0f, -50.0f), .Radius = 1.0f},
+
+        // Lights everything
+        orc::BoundingSphere{.Center = glm::vec3(0.0f), .Radius = std::numeric_limits<float>::infinity()},
+    };
+
+    orc::LightClusters clusters(16, 9, 24);
+    clusters.Build(*camera, lights.data(), lights.size());
+
+    size_t small = 0;
+    for (uint32_t c = 0; c < clusters.GetSize(); c++)
+    {
+        std::vector<uint32_t> listed = lightsIn(clusters, c);
+        REQUIRE(std::find(listed.begin(), listed.end(), 0) == listed.end());
+        REQUIRE(std::find(listed.begin(), listed.end(), 1) == listed.end());
+        REQUIRE(std::find(listed.begin(), listed.end(), 3) != listed.end());
+        if (std::find(listed.begin(), listed.end(), 2) != listed.end()) small++;
+    }
+
+    // A light that covers a few pixels in the middle of the screen reaches
+    // the central tiles of a couple of slices
+    REQUIRE(small > 0);
+    REQUIRE(small <= 8);
+    REQUIRE(clusters.GetLightIndices().size() == clusters.GetSize() + small);
+
+    // Rebuilding without any lights empties every cluster
+    clusters.Build(*camera, nullptr, 0);
+    REQUIRE(clusters.GetLightIndices().empty());
+    for (uint32_t c = 0; c < clusters.GetSize(); c++)
+    {
+        REQUIRE(clusters.GetClusters()[2 * c + 1] == 0);
+    }
+
+    REQUIRE_THROWS_AS(orc::LightClusters(0, 9, 24), std::logic_error);
+}
@@ -0,0 +1,90 @@
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "lod.hpp"
+
+// A sphere of radius 1 with rings * segments * 2 triangles, roughly
+static void buildSphere(int rings, int segments, std::vector<glm::vec3> &points, std::vector<uint32_t> &indices)
+{
+    const float pi = 3.14159265f;
+    points.push_back(glm::vec3(0.0f, 1.0f, 0.0f));
+    for (int r = 1; r < rings; r++)
+    {
+        float theta = pi * r / rings;
+        for (int s = 0; s < segments; s++)
+        {
+            float phi = 2.0f * pi * s / segments;
+            points.push_back(glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), -std::sin(theta) * std::sin(phi)));
+        }
+    }
+    points.push_back(glm::vec3(0.0f, -1.0f, 0.0f));
+
+    uint32_t bottom = points.size() - 1;
+    auto at = [segments](int r, int s) { return (uint32_t)(1 + (r - 1) * segments + s % segments); };
+    for (int s = 0; s < segments; s++)
+    {
+        indices.insert(indices.end(), {0, at(1, s), at(1, s + 1)});
+        indices.insert(indices.end(), {bottom, at(rings - 1, s + 1), at(rings - 1, s)});
+        for (int r = 1; r < rings - 1; r++)
+        {
+            indices.insert(indices.end(), {at(r, s), at(r + 1, s), at(r + 1, s + 1)});
+            indices.insert(indices.end(), {at(r, s), at(r + 1, s + 1), at(r, s + 1)});
+        }
+    }
+}
+
+TEST_CASE("Generate and select LODs", "[orc][benchmark]") {
+    std::vector<glm::vec3> points;
+    std::vector<uint32_t> indices;
+    buildSphere(64, 96, points, indices);
+
+    BENCHMARK("Generate LODs of a 12k triangle mesh") {
+        return orc::GenerateLods(points.data(), points.size(), sizeof(glm::vec3), indices.data(), indices.size()).size();
+    };
+
+    // A field of the same mesh at every distance from the camera, seen
+    // through the camera's default field of view
+    std::vector<std::vector<uint32_t>> lods = orc::GenerateLods(points.data(), points.size(), sizeof(glm::vec3), indices.data(), indices.size());
+    std::vector<size_t> lodTriangles = {indices.size() / 3};
+    for (const std::vector<uint32_t> &lod : lods)
+    {
+        lodTriangles.push_back(lod.size() / 3);
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> depth(2.0f, 1000.0f);
+    std::vector<float> depths;
+    for (int i = 0; i < 10000; i++)
+    {
+        depths.push_back(depth(rng));
+    }
+
+    orc::BoundingSphere sphere = orc::ComputeBoundingSphere(points.data(), points.size());
+    orc::LodSelector selector;
+    std::vector<uint32_t> current(depths.size(), orc::LodSelector::noLod);
+    size_t submitted = 0, fullDetail = 0;
+    for (size_t i = 0; i < depths.size(); i++)
+    {
+        float size = orc::ComputeScreenSize(sphere, glm::mat4(1.0f), depths[i], glm::radians(45.0f));
+        current[i] = selector.Select(size, current[i], lodTriangles.size());
+        fullDetail += lodTriangles[0];
+        if (current[i] != orc::LodSelector::noLod) submitted += lodTriangles[current[i]];
+    }
+    WARN("LOD levels: " << lodTriangles.size() << ", triangles submitted for 10k meshes: " << submitted << " of " << fullDetail);
+
+    BENCHMARK("Select LODs of 10k meshes") {
+        uint32_t sum = 0;
+        for (size_t i = 0; i < depths.size(); i++)
+        {
+            float size = orc::ComputeScreenSize(sphere, glm::mat4(1.0f), depths[i], glm::radians(45.0f));
+            current[i] = selector.Select(size, current[i], lodTriangles.size());
+            sum += current[i];
+        }
+        return sum;
+    };
+}
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "lod.hpp"
+#include "mesh_simplifier.hpp"
+
+// The first level may move the surface by this fraction of the mesh's
+// bounding radius, and each level after it by twice as much as the level
+// before, matching how much smaller the mesh is on screen when it's drawn
+const float lodErrorScale = 0.01f;
+
+// A level must have at most this fraction of the indices of the level before
+// to be worth keeping
+const float minLodReduction = 0.9f;
+
+// Points at sharp corners are pushed in by at most this many times the error,
+// and occluders aren't pushed in by more than this fraction of the thinnest
+// side of their bounds
+const float maxOccluderInsetScale = 4.0f;
+const float maxOccluderInsetFraction = 0.25f;
+
+namespace orc
+{
+    LodSelector::LodSelector(float fullDetailSize, float minSize, float hysteresis)
+        : fullDetailSize(fullDetailSize)
+        , minSize(minSize)
+        , hysteresis(hysteresis)
+    { }
+
+    uint32_t LodSelector::Select(float screenSize, uint32_t current, uint32_t numLevels) const
+    {
+        if (current != noLod)
+        {
+            current = std::min(current, numLevels - 1);
+        }
+
+        // Coarser levels and noLod compare greater. A mesh only moves towards
+        // the level that its size calls for as far as it would if it were a
+        // little closer to the level it's at.
+        uint32_t level = SelectWithoutHysteresis(screenSize, numLevels);
+        if (level > current)
+        {
+            return std::max(current, SelectWithoutHysteresis(screenSize * (1.0f + hysteresis), numLevels));
+        }
+        if (level < current)
+        {
+            return std::min(current, SelectWithoutHysteresis(screenSize / (1.0f + hysteresis), numLevels));
+        }
+
+        return level;
+    }
+
+    uint32_t LodSelector::SelectWithoutHysteresis(float screenSize, uint32_t numLevels) const
+    {
+        if (screenSize >= fullDetailSize) return 0;
+        if (screenSize < minSize || screenSize <= 0.0f) return noLod;
+
+        uint32_t level = 1 + (uint32_t)std::log2(fullDetailSize / screenSize);
+        return std::min(level, numLevels - 1);
+    }
+
+    float ComputeScreenSize(const BoundingSphere &sphere, const glm::mat4 &modelMx, float depth, float fieldOfView)
+    {
+        float radius = TransformSphere(sphere, modelMx).Radius;
+        if (depth <= radius) return std::numeric_limits<float>::infinity();
+
+        return radius / (depth * std::tan(0.5f * fieldOfView));
+    }
+
+    std::vector<std::vector<uint32_t>> GenerateLods(
+        const glm::vec3 *points,
+        size_t count,
+        size_t stride,
+        const uint32_t *indices,
+        size_t numIndices,
+        size_t maxLevels,
+        std::vector<float> *errors
+    )
+    {
+        std::vector<std::vector<uint32_t>> lods;
+        if (errors) errors->clear();
+        if (count == 0) return lods;
+
+        // Every level is simplified from the mesh itself, so that errors
+        // don't accumulate from one level to the next
+        float targetError = lodErrorScale * ComputeBoundingSphere(points, count, stride).Radius;
+        size_t prevIndices = numIndices;
+        for (size_t level = 1; level <= maxLevels; level++)
+        {
+            float error;
+            std::vector<uint32_t> lod = SimplifyMesh(
+                points,
+                count,
+                stride,
+                indices,
+                numIndices,
+                numIndices >> level,
+                targetError,
+                &error
+            );
+            if (lod.empty() || lod.size() > minLodReduction * prevIndices) break;
+
+            prevIndices = lod.size();
+            lods.push_back(std::move(lod));
+            if (errors) errors->push_back(error);
+            targetError *= 2.0f;
+        }
+
+        return lods;
+    }
+
+    bool BuildOccluder(
+        const glm::vec3 *points,
+        size_t stride,
+        const uint32_t *indices,
+        size_t numIndices,
+        float error,
+        std::vector<glm::vec3> &occluderPoints,
+        std::vector<uint32_t> &occluderIndices
+    )
+    {
+        occluderPoints.clear();
+        occluderIndices.clear();
+
+        // Vertices that share a position, e.g. along texture seams, become
+        // one point, so that pushing them in doesn't tear the occluder apart
+        auto isLess = [](const glm::vec3 &a, const glm::vec3 &b) {
+            return a.x != b.x ? a.x < b.x : a.y != b.y ? a.y < b.y : a.z < b.z;
+        };
+        std::map<glm::vec3, uint32_t, decltype(isLess)> pointIdxs(isLess);
+        for (size_t i = 0; i < numIndices; i++)
+        {
+            const glm::vec3 &p = *reinterpret_cast<const glm::vec3 *>(reinterpret_cast<const char *>(points) + indices[i] * stride);
+            auto inserted = pointIdxs.emplace(p, occluderPoints.size());
+            if (inserted.second) occluderPoints.push_back(p);
+            occluderIndices.push_back(inserted.first->second);
+        }
+
+        if (error <= 0.0f) return true;
+
+        AABB bounds = ComputeAABB(occluderPoints.data(), occluderPoints.size(), sizeof(glm::vec3));
+        glm::vec3 size = bounds.Max - bounds.Min;
+        if (error * maxOccluderInsetScale > maxOccluderInsetFraction * std::min(size.x, std::min(size.y, size.z)))
+        {
+            occluderPoints.clear();
+            occluderIndices.clear();
+            return false;
+        }
+
+        // Each point moves against the area weighted normal of its triangles.
+        // A triangle at an angle to that direction moves in by less than the
+        // point does, so the point moves as much further as its steepest
+        // triangle needs.
+        std::vector<glm::vec3> faceNormals(occluderIndices.size() / 3);
+        std::vector<glm::vec3> normals(occluderPoints.size(), glm::vec3(0.0f));
+        for (size_t t = 0; t < faceNormals.size(); t++)
+        {
+            const uint32_t *tri = &occluderIndices[t * 3];
+            faceNormals[t] = glm::cross(
+                occluderPoints[tri[1]] - occluderPoints[tri[0]],
+                occluderPoints[tri[2]] - occluderPoints[tri[0]]
+            );
+            for (int k = 0; k < 3; k++) normals[tri[k]] += faceNormals[t];
+        }
+
+        std::vector<float> minCosines(occluderPoints.size(), 1.0f);
+        for (glm::vec3 &n : normals)
+        {
+            if (n != glm::vec3(0.0f)) n = glm::normalize(n);
+        }
+        for (size_t t = 0; t < faceNormals.size(); t++)
+        {
+            if (faceNormals[t] == glm::vec3(0.0f)) continue;
+
+            glm::vec3 n = glm::normalize(faceNormals[t]);
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t idx = occluderIndices[t * 3 + k];
+                minCosines[idx] = std::min(minCosines[idx], glm::dot(normals[idx], n));
+            }
+        }
+
+        for (size_t i = 0; i < occluderPoints.size(); i++)
+        {
+            float cosine = std::max(minCosines[i], 1.0f / maxOccluderInsetScale);
+            occluderPoints[i] -= normals[i] * (error / cosine);
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+
+namespace orc
+{
+    // Chooses the level of detail to draw a mesh at from how large it appears
+    // on screen. Level 0 is the mesh itself, and each level after it has
+    // roughly half as many triangles as the one before.
+    class LodSelector
+    {
+        public:
+        // Returned for meshes too small to be worth drawing at all
+        static constexpr uint32_t noLod = UINT32_MAX;
+
+        // Level 0 is drawn while a mesh's screen size is at least
+        // fullDetailSize, and each level after that is drawn down to half the
+        // size of the level before. Meshes smaller than minSize aren't drawn.
+        // Once chosen, a level is kept until the mesh's size is a fraction
+        // hysteresis past the threshold, so that meshes hovering around a
+        // threshold don't flicker between levels.
+        LodSelector(float fullDetailSize = 0.25f, float minSize = 0.002f, float hysteresis = 0.1f);
+
+        // Returns the level to draw a mesh of numLevels levels at, given its
+        // screen size and the level it was drawn at last, which may be noLod.
+        // numLevels must be at least 1.
+        uint32_t Select(float screenSize, uint32_t current, uint32_t numLevels) const;
+
+        private:
+        float fullDetailSize, minSize, hysteresis;
+
+        uint32_t SelectWithoutHysteresis(float screenSize, uint32_t numLevels) const;
+    };
+
+    // Returns the screen size of a bounding sphere, transformed by modelMx,
+    // whose center is depth in front of a camera with the given vertical
+    // field of view. Screen size is the projected radius as a fraction of
+    // half the height of the screen, so a sphere that exactly fills the
+    // screen vertically has a size of 1. Spheres that the camera is inside
+    // of are infinitely large.
+    float ComputeScreenSize(const BoundingSphere &sphere, const glm::mat4 &modelMx, float depth, float fieldOfView);
+
+    // Generates up to maxLevels simplified versions of a mesh, each with
+    // about half as many triangles as the one before, using SimplifyMesh.
+    // Every level indexes the same vertices as the mesh. Stops early once a
+    // level can't be simplified much further without visibly changing its
+    // shape, so small or already simple meshes get fewer levels, or none. If
+    // errors is given, it is set to how far each level has moved the surface,
+    // as reported by SimplifyMesh.
+    std::vector<std::vector<uint32_t>> GenerateLods(
+        const glm::vec3 *points,
+        size_t count,
+        size_t stride,
+        const uint32_t *indices,
+        size_t numIndices,
+        size_t maxLevels = 3,
+        std::vector<float> *errors = nullptr
+    );
+
+    // Builds an occluder (see Mesh::Occluder) from the triangles of a level
+    // of detail whose surface has moved by up to error, keeping one point per
+    // position that they use. Simplifying moves the surface outwards as well
+    // as inwards, so each point is pushed into the mesh, far enough that each
+    // of its triangles moves in by at least error. Triangles must be wound
+    // counter-clockwise as seen from outside the mesh.
+    //
+    // Returns false, leaving the occluder empty, if the mesh is too thin to
+    // be pushed into by error without coming out the other side.
+    bool BuildOccluder(
+        const glm::vec3 *points,
+        size_t stride,
+        const uint32_t *indices,
+        size_t numIndices,
+        float error,
+        std::vector<glm::vec3> &occluderPoints,
+        std::vector<uint32_t> &occluderIndices
+    );
+}
@@ -0,0 +1,119 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "bounds.hpp"
+#include "lod.hpp"
+
+TEST_CASE("LOD levels are selected by screen size", "[orc]") {
+    orc::LodSelector selector(0.4f, 0.01f, 0.1f);
+    const uint32_t noLod = orc::LodSelector::noLod;
+
+    // Each level is drawn down to half the size of the level before, and
+    // the last level is drawn until the mesh is too small to draw
+    REQUIRE(selector.Select(1.0f, 0, 4) == 0);
+    REQUIRE(selector.Select(0.3f, 1, 4) == 1);
+    REQUIRE(selector.Select(0.15f, 2, 4) == 2);
+    REQUIRE(selector.Select(0.08f, 3, 4) == 3);
+    REQUIRE(selector.Select(0.02f, 3, 4) == 3);
+    REQUIRE(selector.Select(0.005f, noLod, 4) == noLod);
+    REQUIRE(selector.Select(0.02f, 3, 2) == 1);
+
+    // Meshes that are much closer or further away than last time skip
+    // straight to the level for their size
+    REQUIRE(selector.Select(0.08f, 0, 4) == 3);
+    REQUIRE(selector.Select(0.005f, 0, 4) == noLod);
+    REQUIRE(selector.Select(1.0f, noLod, 4) == 0);
+}
+
+TEST_CASE("LOD levels don't change around thresholds", "[orc]") {
+    orc::LodSelector selector(0.4f, 0.01f, 0.1f);
+    const uint32_t noLod = orc::LodSelector::noLod;
+
+    // Shrinking just past a threshold keeps the finer level, until the
+    // mesh is a tenth smaller than the threshold
+    REQUIRE(selector.Select(0.39f, 0, 4) == 0);
+    REQUIRE(selector.Select(0.37f, 0, 4) == 0);
+    REQUIRE(selector.Select(0.36f, 0, 4) == 1);
+
+    // The same goes for growing
+    REQUIRE(selector.Select(0.41f, 1, 4) == 1);
+    REQUIRE(selector.Select(0.43f, 1, 4) == 1);
+    REQUIRE(selector.Select(0.45f, 1, 4) == 0);
+
+    // Meshes that were skipped stay hidden until they are clearly large
+    // enough to draw, and vice versa
+    REQUIRE(selector.Select(0.0105f, noLod, 4) == noLod);
+    REQUIRE(selector.Select(0.0115f, noLod, 4) == 3);
+    REQUIRE(selector.Select(0.0095f, 3, 4) == 3);
+    REQUIRE(selector.Select(0.0085f, 3, 4) == noLod);
+}
+
+TEST_CASE("Screen size is measured from projected bounds", "[orc]") {
+    orc::BoundingSphere sphere{.Center = glm::vec3(0.0f), .Radius = 1.0f};
+    const float fov = 2.0f * std::atan(0.5f);
+
+    // At a depth of 20, half the screen is 10 units tall
+    REQUIRE(std::abs(orc::ComputeScreenSize(sphere, glm::mat4(1.0f), 20.0f, fov) - 0.1f) < 1e-5f);
+
+    // Scaling grows the sphere by its largest factor
+    glm::mat4 scaleMx = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, 3.0f, 2.0f));
+    REQUIRE(std::abs(orc::ComputeScreenSize(sphere, scaleMx, 20.0f, fov) - 0.3f) < 1e-5f);
+
+    // A camera inside of the sphere is always at full detail
+    REQUIRE(std::isinf(orc::ComputeScreenSize(sphere, glm::mat4(1.0f), 0.5f, fov)));
+}
+
+// A cube from -0.5 to 0.5 with four vertices per face, wound
+// counter-clockwise as seen from outside
+static void buildCube(std::vector<glm::vec3> &points, std::vector<uint32_t> &indices)
+{
+    const glm::vec3 x(1.0f, 0.0f, 0.0f), y(0.0f, 1.0f, 0.0f), z(0.0f, 0.0f, 1.0f);
+    const glm::vec3 faces[6][3] = {{x, y, z}, {-x, z, y}, {y, z, x}, {-y, x, z}, {z, x, y}, {-z, y, x}};
+    for (const glm::vec3 *face : faces)
+    {
+        uint32_t first = points.size();
+        glm::vec3 n = face[0] * 0.5f, u = face[1] * 0.5f, v = face[2] * 0.5f;
+        points.insert(points.end(), {n - u - v, n + u - v, n + u + v, n - u + v});
+        indices.insert(indices.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
+    }
+}
+
+TEST_CASE("Occluders are pushed into their mesh by the error of their level", "[orc]") {
+    std::vector<glm::vec3> points;
+    std::vector<uint32_t> indices;
+    buildCube(points, indices);
+
+    // Corners shared by three faces become one point each, and every face
+    // moves in by at least the error
+    std::vector<glm::vec3> occluderPoints;
+    std::vector<uint32_t> occluderIndices;
+    REQUIRE(orc::BuildOccluder(points.data(), sizeof(glm::vec3), indices.data(), indices.size(), 0.05f, occluderPoints, occluderIndices));
+    REQUIRE(occluderPoints.size() == 8);
+    REQUIRE(occluderIndices.size() == 36);
+    for (const glm::vec3 &p : occluderPoints)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            REQUIRE(std::abs(p[axis]) <= 0.45f + 1e-5f);
+            REQUIRE(std::abs(p[axis]) > 0.3f);
+        }
+    }
+
+    // Without error, the occluder is the mesh itself
+    REQUIRE(orc::BuildOccluder(points.data(), sizeof(glm::vec3), indices.data(), indices.size(), 0.0f, occluderPoints, occluderIndices));
+    for (const glm::vec3 &p : occluderPoints)
+    {
+        REQUIRE(std::abs(p.x) == 0.5f);
+    }
+
+    // A flat square can't be pushed into at all
+    std::vector<uint32_t> square(indices.begin(), indices.begin() + 6);
+    REQUIRE_FALSE(orc::BuildOccluder(points.data(), sizeof(glm::vec3), square.data(), square.size(), 0.01f, occluderPoints, occluderIndices));
+    REQUIRE(occluderPoints.empty());
+    REQUIRE(occluderIndices.empty());
+    REQUIRE(orc::BuildOccluder(points.data(), sizeof(glm::vec3), square.data(), square.size(), 0.0f, occluderPoints, occluderIndices));
+    REQUIRE(occluderPoints.size() == 4);
+}
@@ -0,0 +1,142 @@
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "bvh.hpp"
+#include "camera.hpp"
+#include "loose_octree.hpp"
+
+const size_t numMovingObjects = 50000;
+const float worldSize = 500.0f;
+
+// Objects are 2 units wide and travel up to half a unit per axis each frame
+const float maxSpeed = 0.5f;
+
+// Objects fly back and forth across the world, so after a few hundred frames
+// every object has left the neighborhood it started in
+struct MovingObjects
+{
+    std::vector<glm::vec3> Positions, Velocities;
+    std::vector<orc::AABB> Bounds;
+
+    void Step()
+    {
+        for (size_t i = 0; i < Positions.size(); i++)
+        {
+            glm::vec3 &p = Positions[i];
+            glm::vec3 &v = Velocities[i];
+            p += v;
+            if (p.x < -worldSize || p.x > worldSize) v.x = -v.x;
+            if (p.y < -worldSize || p.y > worldSize) v.y = -v.y;
+            if (p.z < -worldSize || p.z > worldSize) v.z = -v.z;
+            Bounds[i] = orc::AABB{.Min = p - glm::vec3(1.0f), .Max = p + glm::vec3(1.0f)};
+        }
+    }
+};
+
+TEST_CASE("Move 50k objects per frame", "[orc][benchmark]") {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> pos(-worldSize, worldSize);
+    std::uniform_real_distribution<float> speed(-maxSpeed, maxSpeed);
+    MovingObjects objects;
+    for (size_t i = 0; i < numMovingObjects; i++)
+    {
+        objects.Positions.push_back(glm::vec3(pos(rng), pos(rng), pos(rng)));
+        objects.Velocities.push_back(glm::vec3(speed(rng), speed(rng), speed(rng)));
+    }
+    objects.Bounds.resize(numMovingObjects);
+    objects.Step();
+
+    std::shared_ptr<orc::Camera> camera = orc::Camera::Create();
+    camera->ComputeMxs();
+    std::vector<uint32_t> found;
+
+    orc::LooseOctree octree;
+    octree.Reset(orc::AABB{.Min = glm::vec3(-worldSize), .Max = glm::vec3(worldSize)});
+    for (uint32_t i = 0; i < numMovingObjects; i++)
+    {
+        octree.Insert(i, objects.Bounds[i]);
+    }
+
+    orc::BVH refitBVH, rebuiltBVH;
+    refitBVH.Build(objects.Bounds.data(), numMovingObjects);
+
+    // Every frame includes moving the objects themselves, which is the
+    // baseline that the partitions add to
+    BENCHMARK("Frame: move only") {
+        objects.Step();
+        return objects.Bounds[0].Min.x;
+    };
+
+    BENCHMARK("Frame: octree move and frustum query") {
+        objects.Step();
+        for (uint32_t i = 0; i < numMovingObjects; i++)
+        {
+            octree.Move(i, objects.Bounds[i]);
+        }
+
+        found.clear();
+        octree.Query(camera->GetFrustum(), found);
+        return found.size();
+    };
+
+    // Refitting is cheap, but the tree was built around positions that are
+    // long gone, so queries visit most of it
+    BENCHMARK("Frame: BVH refit and frustum query") {
+        objects.Step();
+        refitBVH.Refit(objects.Bounds.data());
+
+        found.clear();
+        refitBVH.Query(camera->GetFrustum(), found);
+        return found.size();
+    };
+
+    BENCHMARK("Frame: BVH rebuild and frustum query") {
+        objects.Step();
+        rebuiltBVH.Build(objects.Bounds.data(), numMovingObjects);
+
+        found.clear();
+        rebuiltBVH.Query(camera->GetFrustum(), found);
+        return found.size();
+    };
+
+    // By now the refitted tree has been stretched by hundreds of frames of
+    // movement, while the octree is as good as the first frame
+    refitBVH.Refit(objects.Bounds.data());
+    rebuiltBVH.Build(objects.Bounds.data(), numMovingObjects);
+    for (uint32_t i = 0; i < numMovingObjects; i++)
+    {
+        octree.Move(i, objects.Bounds[i]);
+    }
+
+    BENCHMARK("Frustum: refitted BVH query") {
+        found.clear();
+        refitBVH.Query(camera->GetFrustum(), found);
+        return found.size();
+    };
+
+    BENCHMARK("Frustum: rebuilt BVH query") {
+        found.clear();
+        rebuiltBVH.Query(camera->GetFrustum(), found);
+        return found.size();
+    };
+
+    BENCHMARK("Frustum: octree query") {
+        found.clear();
+        octree.Query(camera->GetFrustum(), found);
+        return found.size();
+    };
+
+    BENCHMARK("1k octree sphere queries") {
+        found.clear();
+        for (size_t i = 0; i < 1000; i++)
+        {
+            octree.Query(orc::BoundingSphere{.Center = objects.Positions[i], .Radius = 10.0f}, found);
+        }
+        return found.size();
+    };
+}
@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "frustum.hpp"
+#include "loose_octree.hpp"
+
+// Items are kept in cells at least this many times as large as they are,
+// which leaves them room to move before they have to change cells, at the
+// cost of testing more items per cell
+const float minCellToItemRatio = 2.0f;
+
+namespace orc
+{
+    // Half of the length of the longest side of a box
+    static inline float halfExtentOf(const AABB &bounds)
+    {
+        glm::vec3 size = bounds.Max - bounds.Min;
+        return std::max(size.x, std::max(size.y, size.z)) * 0.5f;
+    }
+
+    LooseOctree::LooseOctree()
+    {
+        Reset(EmptyAABB());
+    }
+
+    void LooseOctree::Reset(const AABB &region)
+    {
+        Cell root{
+            .Center = glm::vec3(0.0f),
+            .HalfSize = 0.0f,
+            .Children = {},
+            .Parent = noCell,
+            .Depth = 0,
+            .First = noItem,
+            .Count = 0,
+        };
+
+        // An empty region leaves a root that only fits points at the origin,
+        // so every item is kept at the root
+        if (!IsEmpty(region))
+        {
+            root.Center = (region.Min + region.Max) * 0.5f;
+            root.HalfSize = halfExtentOf(region);
+        }
+
+        cells.clear();
+        cells.push_back(root);
+        freeCells.clear();
+        itemCells.clear();
+        next.clear();
+        prev.clear();
+        itemBounds.clear();
+        itemFits.clear();
+        size = 0;
+    }
+
+    void LooseOctree::Insert(uint32_t item, const AABB &bounds)
+    {
+        if (Contains(item))
+        {
+            throw std::logic_error("Item is already in the octree");
+        }
+
+        if (item >= itemCells.size())
+        {
+            itemCells.resize(item + 1, noCell);
+            next.resize(item + 1, noItem);
+            prev.resize(item + 1, noItem);
+            itemBounds.resize(item + 1, EmptyAABB());
+            itemFits.resize(item + 1);
+        }
+
+        itemBounds[item] = bounds;
+        cells[0].Count++;
+        Link(item, Fits(cells[0], bounds) ? Descend(0, bounds) : 0);
+        size++;
+    }
+
+    void LooseOctree::Move(uint32_t item, const AABB &bounds)
+    {
+        if (!Contains(item))
+        {
+            throw std::logic_error("Item is not in the octree");
+        }
+
+        itemBounds[item] = bounds;
+
+        // Items usually move a small distance relative to the size of their
+        // cell, in which case they stay where they are. Leaving them there
+        // until they outgrow the loose bounds means that items hovering
+        // around a boundary don't hop back and forth.
+        const Fit &fit = itemFits[item];
+        glm::vec3 halfExtents = (bounds.Max - bounds.Min) * 0.5f;
+        glm::vec3 reach = glm::abs((bounds.Min + bounds.Max) * 0.5f - fit.Center) + halfExtents;
+        bool isInside = reach.x <= fit.LooseHalfSize && reach.y <= fit.LooseHalfSize && reach.z <= fit.LooseHalfSize;
+        if (isInside && halfExtentOf(bounds) > fit.MinHalfExtent) return;
+
+        // Otherwise it only has to climb as far as the nearest cell that
+        // still fits it, which for small steps is usually a close relative
+        uint32_t ancestor = Leave(itemCells[item], bounds);
+        Unlink(item);
+        Link(item, Fits(cells[ancestor], bounds) ? Descend(ancestor, bounds) : ancestor);
+    }
+
+    void LooseOctree::Remove(uint32_t item)
+    {
+        if (!Contains(item))
+        {
+            throw std::logic_error("Item is not in the octree");
+        }
+
+        Leave(itemCells[item], EmptyAABB());
+        cells[0].Count--;
+        Unlink(item);
+        size--;
+    }
+
+    bool LooseOctree::Contains(uint32_t item) const
+    {
+        return item < itemCells.size() && itemCells[item] != noCell;
+    }
+
+    size_t LooseOctree::GetSize() const
+    {
+        return size;
+    }
+
+    void LooseOctree::Query(const Frustum &frustum, std::vector<uint32_t> &out) const
+    {
+        // Each entry holds a cell and whether it is known to be entirely
+        // inside the frustum
+        std::pair<uint32_t, bool> stack[maxStackSize];
+        size_t stackSize = 0;
+        stack[stackSize++] = std::make_pair(0u, false);
+
+        while (stackSize > 0)
+        {
+            auto [idx, isInside] = stack[--stackSize];
+            const Cell &cell = cells[idx];
+
+            // Only the root may hold items with empty bounds, and it is never
+            // classified, so everything inside is visible
+            if (!isInside && idx != 0)
+            {
+                Overlap overlap = Classify(frustum, GetLooseBounds(cell));
+                if (overlap == Overlap::None) continue;
+                isInside = overlap == Overlap::Full;
+            }
+
+            for (uint32_t item = cell.First; item != noItem; item = next[item])
+            {
+                if (isInside || Intersects(frustum, itemBounds[item])) out.push_back(item);
+            }
+
+            for (uint32_t child : cell.Children)
+            {
+                if (child) stack[stackSize++] = std::make_pair(child, isInside);
+            }
+        }
+    }
+
+    void LooseOctree::Query(const AABB &region, std::vector<uint32_t> &out) const
+    {
+        Traverse(
+            [&region](const AABB &bounds) { return Intersects(bounds, region); },
+            [&region, &out](uint32_t item, const AABB &bounds) {
+                if (Intersects(bounds, region)) out.push_back(item);
+            }
+        );
+    }
+
+    void LooseOctree::Query(const BoundingSphere &region, std::vector<uint32_t> &out) const
+    {
+        Traverse(
+            [&region](const AABB &bounds) { return Intersects(bounds, region); },
+            [&region, &out](uint32_t item, const AABB &bounds) {
+                if (Intersects(bounds, region)) out.push_back(item);
+            }
+        );
+    }
+
+    bool LooseOctree::Fits(const Cell &cell, const AABB &bounds) const
+    {
+        if (IsEmpty(bounds) || halfExtentOf(bounds) * minCellToItemRatio > cell.HalfSize) return false;
+
+        glm::vec3 offset = glm::abs((bounds.Min + bounds.Max) * 0.5f - cell.Center);
+        return offset.x <= cell.HalfSize && offset.y <= cell.HalfSize && offset.z <= cell.HalfSize;
+    }
+
+    uint32_t LooseOctree::Descend(uint32_t from, const AABB &bounds)
+    {
+        // Descend until the next level's cells would be too small. The
+        // center always lies in exactly one child, so the item fits it.
+        glm::vec3 center = (bounds.Min + bounds.Max) * 0.5f;
+        float minHalfSize = halfExtentOf(bounds) * minCellToItemRatio;
+        uint32_t idx = from;
+        while (cells[idx].Depth < maxDepth && minHalfSize <= cells[idx].HalfSize * 0.5f)
+        {
+            const Cell &cell = cells[idx];
+            glm::bvec3 upper = glm::greaterThanEqual(center, cell.Center);
+            int octant = (upper.x ? 1 : 0) | (upper.y ? 2 : 0) | (upper.z ? 4 : 0);
+            if (cell.Children[octant])
+            {
+                idx = cell.Children[octant];
+                cells[idx].Count++;
+                continue;
+            }
+
+            float childHalfSize = cell.HalfSize * 0.5f;
+            Cell child{
+                .Center = cell.Center + glm::vec3(
+                    upper.x ? childHalfSize : -childHalfSize,
+                    upper.y ? childHalfSize : -childHalfSize,
+                    upper.z ? childHalfSize : -childHalfSize
+                ),
+                .HalfSize = childHalfSize,
+                .Children = {},
+                .Parent = idx,
+                .Depth = cell.Depth + 1,
+                .First = noItem,
+                .Count = 1,
+            };
+
+            // Adding the child may move every cell, including the parent
+            uint32_t childIdx;
+            if (freeCells.empty())
+            {
+                childIdx = cells.size();
+                cells.push_back(child);
+            }
+            else
+            {
+                childIdx = freeCells.back();
+                freeCells.pop_back();
+                cells[childIdx] = child;
+            }
+            cells[idx].Children[octant] = childIdx;
+            idx = childIdx;
+        }
+
+        return idx;
+    }
+
+    uint32_t LooseOctree::Leave(uint32_t from, const AABB &bounds)
+    {
+        uint32_t idx = from;
+        while (idx != 0 && !Fits(cells[idx], bounds))
+        {
+            Cell &cell = cells[idx];
+            uint32_t parent = cell.Parent;
+            cell.Count--;
+
+            // A cell is released before its parent, so an empty cell never
+            // has children of its own
+            if (cell.Count == 0)
+            {
+                for (uint32_t &child : cells[parent].Children)
+                {
+                    if (child == idx) child = 0;
+                }
+                freeCells.push_back(idx);
+            }
+
+            idx = parent;
+        }
+
+        return idx;
+    }
+
+    void LooseOctree::Link(uint32_t item, uint32_t cell)
+    {
+        Cell &head = cells[cell];
+        itemCells[item] = cell;
+
+        // Items at the root may be anywhere, so they never stay put
+        itemFits[item] = cell == 0
+            ? Fit{.Center = glm::vec3(0.0f), .LooseHalfSize = -1.0f, .MinHalfExtent = 0.0f}
+            : Fit{
+                .Center = head.Center,
+                .LooseHalfSize = 2.0f * head.HalfSize,
+                .MinHalfExtent = head.Depth == maxDepth ? -1.0f : head.HalfSize * 0.5f / minCellToItemRatio,
+            };
+
+        prev[item] = noItem;
+        next[item] = head.First;
+        if (head.First != noItem) prev[head.First] = item;
+        head.First = item;
+    }
+
+    void LooseOctree::Unlink(uint32_t item)
+    {
+        uint32_t cell = itemCells[item];
+        if (prev[item] != noItem) next[prev[item]] = next[item];
+        else cells[cell].First = next[item];
+        if (next[item] != noItem) prev[next[item]] = prev[item];
+        itemCells[item] = noCell;
+    }
+
+    AABB LooseOctree::GetLooseBounds(const Cell &cell) const
+    {
+        glm::vec3 halfSize(2.0f * cell.HalfSize);
+        return AABB{.Min = cell.Center - halfSize, .Max = cell.Center + halfSize};
+    }
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "frustum.hpp"
+
+namespace orc
+{
+    // A spatial partition for items that move every frame. Space is divided
+    // into cubic cells, each split into eight children, and each item is kept
+    // in the deepest cell that is a few times larger than the item and
+    // contains its center. Cells are loose: they accept any item that fits within
+    // twice their size around their center, so an item's cell only depends
+    // on its center and size, never on which boundaries it straddles.
+    //
+    // This makes moving an item cheap. Once placed, an item stays in its cell
+    // for as long as its bounds remain within the cell's loose bounds, even
+    // after its center has crossed into a neighbor, and only its bounds are
+    // updated. Otherwise it is unlinked from one cell and linked into another
+    // in time proportional to the depth of the tree, which is bounded. Unlike
+    // a BVH, the structure never degrades, no matter how far items travel.
+    //
+    // Items are identified by small integers chosen by the caller, which
+    // index internal arrays, so they should be dense. Items outside of the
+    // region the tree was reset to, or too large for any cell, are kept at
+    // the root and tested by every query. Queries append matching items to
+    // an output vector, in no particular order. Items with empty bounds never
+    // match.
+    //
+    // Queries are const and don't touch any shared state, so they may run
+    // concurrently, but not while items are being inserted or moved.
+    class LooseOctree
+    {
+        public:
+        static constexpr uint32_t noItem = UINT32_MAX;
+
+        // Cells are never split more than this many times
+        static constexpr uint32_t maxDepth = 10;
+
+        LooseOctree();
+
+        // Removes every item and divides the smallest cube that contains
+        // region, which should be roughly where items are expected to be
+        void Reset(const AABB &region);
+
+        // Adds an item, which must not already be in the tree
+        void Insert(uint32_t item, const AABB &bounds);
+
+        // Updates the bounds of an item that is already in the tree
+        void Move(uint32_t item, const AABB &bounds);
+
+        void Remove(uint32_t item);
+
+        bool Contains(uint32_t item) const;
+
+        // Number of items in the tree
+        size_t GetSize() const;
+
+        // Appends every item whose bounds intersect the frustum, using the
+        // same conservative test as Intersects. Cells entirely inside the
+        // frustum are accepted without testing their items against it.
+        void Query(const Frustum &frustum, std::vector<uint32_t> &out) const;
+
+        void Query(const AABB &region, std::vector<uint32_t> &out) const;
+
+        void Query(const BoundingSphere &region, std::vector<uint32_t> &out) const;
+
+        // Finds the nearest item that the ray hits within maxDistance, where
+        // hit(item, maxDistance) tests a single item and returns the distance
+        // at which the ray hits it, or any distance of at least maxDistance
+        // if it doesn't. Cells that the ray doesn't enter before the nearest
+        // hit so far are skipped. Returns the nearest item and sets
+        // maxDistance to its distance, or returns noItem if nothing was hit.
+        template <typename F>
+        uint32_t Raycast(const Ray &ray, float &maxDistance, F &&hit) const;
+
+        private:
+        static constexpr uint32_t noCell = UINT32_MAX;
+
+        // Enough for a depth-first traversal that pushes every child of one
+        // cell on each level
+        static constexpr size_t maxStackSize = 8 * (maxDepth + 1);
+
+        // Cells are created when an item first needs them and released as
+        // soon as nothing is left beneath them, so that every cell in the
+        // tree has items beneath it. Released cells are reused, so items
+        // moving back and forth don't allocate.
+        struct Cell
+        {
+            glm::vec3 Center;
+
+            // Half the size of the cell before it is loosened
+            float HalfSize;
+
+            // Index of each child, or 0 if it hasn't been created yet, since
+            // the root can never be a child
+            uint32_t Children[8];
+
+            uint32_t Parent;
+            uint32_t Depth;
+
+            // Head of the list of items in this cell, linked through next and
+            // prev, and the number of items in this cell and all of its
+            // descendants
+            uint32_t First;
+            uint32_t Count;
+        };
+
+        std::vector<Cell> cells;
+        std::vector<uint32_t> freeCells;
+
+        // The region that an item may move within while staying in its
+        // current cell, copied out of the cell so that items that stay put
+        // don't have to read it
+        struct Fit
+        {
+            glm::vec3 Center;
+            float LooseHalfSize;
+
+            // An item that has shrunk to this half extent or below belongs
+            // in a deeper cell
+            float MinHalfExtent;
+        };
+
+        // Per item state, indexed by item. Items that aren't in the tree are
+        // in cell noCell.
+        std::vector<uint32_t> itemCells;
+        std::vector<uint32_t> next, prev;
+        std::vector<AABB> itemBounds;
+        std::vector<Fit> itemFits;
+
+        size_t size;
+
+        // Returns true if an item with the given bounds belongs in the cell
+        // or any of its descendants
+        bool Fits(const Cell &cell, const AABB &bounds) const;
+
+        // Finds the deepest cell at or below from that fits the bounds,
+        // creating cells as needed, and counts an item in every cell it
+        // enters below from. from must fit the bounds.
+        uint32_t Descend(uint32_t from, const AABB &bounds);
+
+        // Climbs from a cell to the nearest ancestor that fits the bounds, or
+        // the root, uncounting an item from every cell it leaves and
+        // releasing cells that are left without items beneath them. Returns
+        // the ancestor.
+        uint32_t Leave(uint32_t from, const AABB &bounds);
+
+        // Adds an item to, or removes it from, its cell's list of items,
+        // without touching counts
+        void Link(uint32_t item, uint32_t cell);
+
+        void Unlink(uint32_t item);
+
+        // Returns the bounds that items in the cell are guaranteed to lie
+        // within
+        AABB GetLooseBounds(const Cell &cell) const;
+
+        // Visits every cell whose loose bounds are accepted by test, calling
+        // visit with each item in it. The root is always visited, since it
+        // holds items that may lie anywhere.
+        template <typename T, typename V>
+        void Traverse(T &&test, V &&visit) const;
+    };
+
+    template <typename T, typename V>
+    void LooseOctree::Traverse(T &&test, V &&visit) const
+    {
+        if (cells.empty()) return;
+
+        uint32_t stack[maxStackSize];
+        size_t stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0)
+        {
+            uint32_t idx = stack[--stackSize];
+            const Cell &cell = cells[idx];
+            if (idx != 0 && !test(GetLooseBounds(cell))) continue;
+
+            for (uint32_t item = cell.First; item != noItem; item = next[item])
+            {
+                visit(item, itemBounds[item]);
+            }
+
+            for (uint32_t child : cell.Children)
+            {
+                if (child) stack[stackSize++] = child;
+            }
+        }
+    }
+
+    template <typename F>
+    uint32_t LooseOctree::Raycast(const Ray &ray, float &maxDistance, F &&hit) const
+    {
+        // Cells overlap, so they can't be visited in order along the ray, but
+        // the shrinking distance still prunes cells beyond the nearest hit
+        uint32_t nearest = noItem;
+        Traverse(
+            [&ray, &maxDistance](const AABB &bounds) {
+                float enter;
+                return Intersects(ray, bounds, maxDistance, enter);
+            },
+            [&ray, &maxDistance, &hit, &nearest](uint32_t item, const AABB &bounds) {
+                float enter;
+                if (!Intersects(ray, bounds, maxDistance, enter)) return;
+
+                float d = hit(item, maxDistance);
+                if (d < maxDistance)
+                {
+                    maxDistance = d;
+                    nearest = item;
+                }
+            }
+        );
+
+        return nearest;
+    }
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include <fixtures.hpp>
+#include "bounds.hpp"
+#include "camera.hpp"
+#include "frustum.hpp"
+#include "loose_octree.hpp"
+
+static orc::AABB randomBox(std::mt19937 &rng, float range)
+{
+    std::uniform_real_distribution<float> pos(-range, range);
+    std::uniform_real_distribution<float> size(0.1f, 3.0f);
+    glm::vec3 center(pos(rng), pos(rng), pos(rng));
+    glm::vec3 extent(size(rng), size(rng), size(rng));
+    return orc::AABB{.Min = center - extent, .Max = center + extent};
+}
+
+// Items that aren't in the tree have empty bounds
+static void requireAllQueriesMatch(const orc::LooseOctree &octree, const std::vector<orc::AABB> &boxes)
+{
+    std::shared_ptr<orc::Camera> camera = orc::Camera::Create();
+    camera->Translate(0.0f, 0.0f, 60.0f);
+    camera->ComputeMxs();
+    fixtures::RequireSameResults(octree, boxes, fixtures::FrustumQuery{.Frustum = camera->GetFrustum()});
+
+    fixtures::RequireSameResults(octree, boxes, fixtures::BoxQuery{.Region = orc::AABB{.Min = glm::vec3(-10.0f), .Max = glm::vec3(5.0f, 20.0f, 0.0f)}});
+    fixtures::RequireSameResults(octree, boxes, fixtures::SphereQuery{.Region = orc::BoundingSphere{.Center = glm::vec3(20.0f, -5.0f, 3.0f), .Radius = 15.0f}});
+
+    // A region far outside of the tree only finds items kept at the root
+    fixtures::RequireSameResults(octree, boxes, fixtures::BoxQuery{.Region = orc::AABB{.Min = glm::vec3(150.0f), .Max = glm::vec3(200.0f)}});
+}
+
+TEST_CASE("Octree queries match brute force as items move", "[orc]") {
+    std::mt19937 rng(17);
+    orc::LooseOctree octree;
+    octree.Reset(orc::AABB{.Min = glm::vec3(-50.0f), .Max = glm::vec3(50.0f)});
+
+    // Some items start outside of the tree's region, and some are larger
+    // than the whole tree
+    std::vector<orc::AABB> boxes;
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        boxes.push_back(randomBox(rng, i % 10 == 0 ? 200.0f : 50.0f));
+    }
+    boxes.push_back(orc::AABB{.Min = glm::vec3(-100.0f), .Max = glm::vec3(100.0f)});
+    boxes.push_back(orc::EmptyAABB());
+
+    for (uint32_t i = 0; i < boxes.size(); i++)
+    {
+        octree.Insert(i, boxes[i]);
+    }
+    REQUIRE(octree.GetSize() == boxes.size());
+    requireAllQueriesMatch(octree, boxes);
+
+    // Small steps mostly keep items in their cells, while teleporting moves
+    // them across the tree, and into and out of its region
+    std::uniform_real_distribution<float> step(-1.0f, 1.0f);
+    for (int frame = 0; frame < 3; frame++)
+    {
+        for (uint32_t i = 0; i < boxes.size(); i++)
+        {
+            if (i % 7 == 0)
+            {
+                boxes[i] = randomBox(rng, 150.0f);
+            }
+            else
+            {
+                glm::vec3 d(step(rng), step(rng), step(rng));
+                boxes[i].Min += d;
+                boxes[i].Max += d;
+            }
+            octree.Move(i, boxes[i]);
+        }
+
+        requireAllQueriesMatch(octree, boxes);
+    }
+
+    // Removed items no longer match, and can be inserted again
+    for (uint32_t i = 0; i < boxes.size(); i += 3)
+    {
+        octree.Remove(i);
+        boxes[i] = orc::EmptyAABB();
+    }
+    REQUIRE(!octree.Contains(0));
+    REQUIRE(octree.Contains(1));
+    requireAllQueriesMatch(octree, boxes);
+
+    boxes[0] = randomBox(rng, 50.0f);
+    octree.Insert(0, boxes[0]);
+    requireAllQueriesMatch(octree, boxes);
+}
+
+TEST_CASE("Octree rejects inserting or moving items twice", "[orc]") {
+    orc::LooseOctree octree;
+    orc::AABB box{.Min = glm::vec3(0.0f), .Max = glm::vec3(1.0f)};
+
+    REQUIRE_THROWS_AS(octree.Move(3, box), std::logic_error);
+    octree.Insert(3, box);
+    REQUIRE_THROWS_AS(octree.Insert(3, box), std::logic_error);
+
+    // Reset empties the tree
+    octree.Reset(box);
+    REQUIRE(octree.GetSize() == 0);
+    REQUIRE(!octree.Contains(3));
+    REQUIRE_THROWS_AS(octree.Remove(3), std::logic_error);
+}
+
+TEST_CASE("Octree raycast finds the nearest item", "[orc]") {
+    std::mt19937 rng(19);
+    orc::LooseOctree octree;
+    octree.Reset(orc::AABB{.Min = glm::vec3(-50.0f), .Max = glm::vec3(50.0f)});
+
+    std::vector<orc::AABB> boxes;
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        boxes.push_back(randomBox(rng, 50.0f));
+        octree.Insert(i, boxes[i]);
+    }
+
+    std::uniform_real_distribution<float> dir(-1.0f, 1.0f);
+    for (int r = 0; r < 100; r++)
+    {
+        orc::Ray ray{.Origin = glm::vec3(0.0f), .Direction = glm::normalize(glm::vec3(dir(rng), dir(rng), dir(rng)))};
+
+        float expectedDistance = 40.0f;
+        for (const orc::AABB &box : boxes)
+        {
+            float d;
+            if (orc::Intersects(ray, box, expectedDistance, d)) expectedDistance = std::min(expectedDistance, d);
+        }
+
+        float distance = 40.0f;
+        octree.Raycast(ray, distance, [&](uint32_t item, float maxDistance) {
+            float d;
+            return orc::Intersects(ray, boxes[item], maxDistance, d) ? d : std::numeric_limits<float>::infinity();
+        });
+        REQUIRE(distance == expectedDistance);
+    }
+}
@@ -0,0 +1,89 @@
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "mapped_file.hpp"
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace orc
+{
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::string &path)
+        : data(nullptr)
+        , size(0)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Failed to open file at " + path);
+        }
+
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        data = contents.data();
+        size = contents.size();
+    }
+
+    MappedFile::~MappedFile() {}
+#else
+    MappedFile::MappedFile(const std::string &path)
+        : data(nullptr)
+        , size(0)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Failed to open file at " + path);
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) < 0)
+        {
+            close(fd);
+            throw std::runtime_error("Failed to open file at " + path);
+        }
+
+        // Empty files can't be mapped, and have nothing to read anyway. The
+        // mapping outlives the file descriptor.
+        size = info.st_size;
+        if (size > 0)
+        {
+            void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED)
+            {
+                close(fd);
+                throw std::runtime_error("Failed to map file at " + path);
+            }
+
+            data = static_cast<const char *>(mapping);
+        }
+
+        close(fd);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (data)
+        {
+            munmap(const_cast<char *>(data), size);
+        }
+    }
+#endif
+
+    const char *MappedFile::GetData() const
+    {
+        return data;
+    }
+
+    size_t MappedFile::GetSize() const
+    {
+        return size;
+    }
+}
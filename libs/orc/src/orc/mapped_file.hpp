@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace orc
+{
+    // A read-only view of a whole file. Where the platform supports it, the
+    // file is mapped into memory, so that its pages are only read from disk
+    // as they're touched and are shared with the OS's file cache. Elsewhere,
+    // it's read into memory up front.
+    class MappedFile
+    {
+        public:
+        // Throws if the file can't be opened
+        MappedFile(const std::string &path);
+
+        ~MappedFile();
+
+        // Disable copy construction and assignment to avoid unmapping the
+        // file twice
+        MappedFile(const MappedFile &other) = delete;
+        void operator=(const MappedFile &other) = delete;
+
+        // The start of the file is aligned to at least a page where the file
+        // is mapped, and for any fundamental type otherwise
+        const char *GetData() const;
+
+        size_t GetSize() const;
+
+        private:
+        const char *data;
+        size_t size;
+
+        // Contents of the file, where it isn't mapped
+        std::vector<char> contents;
+    };
+}
@@ -1,15 +1,99 @@
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include <glad/glad.h>
+#include "bounds.hpp"
 #include "mesh.hpp"
 #include "texture.hpp"
+#include "triangle_mesh.hpp"
 
 namespace orc
 {
-    Mesh::Mesh(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices, std::unique_ptr<TextureRef> texture)
-        : numIndices(indices.size())
+    Mesh::Mesh(
+        const std::vector<Vertex> &vertices,
+        const std::vector<unsigned int> &indices,
+        std::unique_ptr<TextureRef> texture,
+        bool keepTriangles,
+        const std::vector<std::vector<unsigned int>> &lods
+    )
+        : lods{Lod{.First = 0, .Count = indices.size()}}
+        , numVertices(vertices.size())
+        , bounds(ComputeAABB(&vertices[0].Coordinates, vertices.size(), sizeof(Vertex)))
+        , boundingSphere(ComputeBoundingSphere(&vertices[0].Coordinates, vertices.size(), sizeof(Vertex)))
         , texture(std::move(texture))
+        , loadedTexture(nullptr)
+    {
+        if (keepTriangles)
+        {
+            triangles = std::make_unique<TriangleMesh>(
+                &vertices[0].Coordinates,
+                vertices.size(),
+                sizeof(Vertex),
+                indices.data(),
+                indices.size()
+            );
+        }
+
+        // Indices are followed by those of each level of detail
+        size_t totalIndices = indices.size();
+        for (const std::vector<unsigned int> &lod : lods)
+        {
+            this->lods.push_back(Lod{.First = totalIndices, .Count = lod.size()});
+            totalIndices += lod.size();
+        }
+
+        CreateBuffers(&vertices[0], totalIndices);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(unsigned int), &indices[0]);
+        for (size_t i = 0; i < lods.size(); i++)
+        {
+            const Lod &lod = this->lods[i + 1];
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, lod.First * sizeof(unsigned int), lod.Count * sizeof(unsigned int), lods[i].data());
+        }
+    }
+
+    Mesh::Mesh(
+        const Vertex *vertices,
+        size_t numVertices,
+        const unsigned int *indices,
+        const uint32_t *lodCounts,
+        uint32_t numLods,
+        const AABB &bounds,
+        const BoundingSphere &boundingSphere,
+        std::unique_ptr<TextureRef> texture,
+        bool keepTriangles
+    )
+        : numVertices(numVertices)
+        , bounds(bounds)
+        , boundingSphere(boundingSphere)
+        , texture(std::move(texture))
+        , loadedTexture(nullptr)
+    {
+        size_t totalIndices = 0;
+        for (uint32_t i = 0; i < numLods; i++)
+        {
+            lods.push_back(Lod{.First = totalIndices, .Count = lodCounts[i]});
+            totalIndices += lodCounts[i];
+        }
+
+        if (keepTriangles)
+        {
+            triangles = std::make_unique<TriangleMesh>(
+                &vertices[0].Coordinates,
+                numVertices,
+                sizeof(Vertex),
+                indices,
+                lods[0].Count
+            );
+        }
+
+        CreateBuffers(vertices, totalIndices);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, totalIndices * sizeof(unsigned int), indices);
+    }
+
+    void Mesh::CreateBuffers(const Vertex *vertices, size_t numIndices)
     {
         // TODO: Implement OpenGL RAII library to prevent leaks on error
         glGenVertexArrays(1, &vaoId);
@@ -19,11 +103,11 @@ namespace orc
         // Bind buffer to vertex array and load vertices
         glBindVertexArray(vaoId);
         glBindBuffer(GL_ARRAY_BUFFER, vboId);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(Vertex), vertices, GL_STATIC_DRAW);
 
-        // Do the same thing for indices
+        // Do the same thing for indices, which are filled in afterwards
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, eboId);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, numIndices * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
 
         // TODO: Configurable vertex types - not all shaders need all of these attributes
         // Set vertex attributes to be interpreted by shader:
@@ -47,18 +131,95 @@ namespace orc
 
     Texture &Mesh::GetTexture() const
     {
-        return texture->Load();
+        // Texture refs are looked up by path, which is too slow to repeat
+        // for every draw of every frame
+        if (!loadedTexture)
+        {
+            loadedTexture = &texture->Load();
+        }
+
+        return *loadedTexture;
+    }
+
+    const TextureRef &Mesh::GetTextureRef() const
+    {
+        return *texture;
+    }
+
+    const AABB &Mesh::GetBounds() const
+    {
+        return bounds;
+    }
+
+    const BoundingSphere &Mesh::GetBoundingSphere() const
+    {
+        return boundingSphere;
+    }
+
+    const TriangleMesh *Mesh::GetTriangles() const
+    {
+        return triangles.get();
+    }
+
+    uint32_t Mesh::GetNumLods() const
+    {
+        return lods.size();
+    }
+
+    size_t Mesh::GetNumIndices(uint32_t level) const
+    {
+        return lods[level].Count;
+    }
+
+    size_t Mesh::GetNumVertices() const
+    {
+        return numVertices;
+    }
+
+    void Mesh::ReadGeometry(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices) const
+    {
+        // Buffers are read through the copy target, so that the element
+        // buffer binding of whichever vertex array is bound isn't disturbed
+        vertices.resize(numVertices);
+        glBindBuffer(GL_COPY_READ_BUFFER, vboId);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, numVertices * sizeof(Vertex), vertices.data());
+
+        indices.resize(lods.back().First + lods.back().Count);
+        glBindBuffer(GL_COPY_READ_BUFFER, eboId);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, indices.size() * sizeof(unsigned int), indices.data());
+    }
+
+    void Mesh::SetOccluder(std::vector<glm::vec3> points, std::vector<uint32_t> indices)
+    {
+        occluder = std::make_unique<Occluder>(Occluder{.Points = std::move(points), .Indices = std::move(indices)});
+    }
+
+    const Mesh::Occluder *Mesh::GetOccluder() const
+    {
+        return occluder.get();
     }
 
     void Mesh::Use()
     {
         // TODO: Default texture if none provided
-        texture->Load().Use();
+        GetTexture().Use();
         glBindVertexArray(vaoId);
     }
 
     void Mesh::Draw()
     {
-        glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, 0);
+        DrawLod(0);
+    }
+
+    void Mesh::DrawLod(uint32_t level)
+    {
+        const Lod &lod = lods[level];
+        glDrawElements(GL_TRIANGLES, lod.Count, GL_UNSIGNED_INT, (void*)(lod.First * sizeof(unsigned int)));
+    }
+
+    void Mesh::DrawLodInstanced(uint32_t level, size_t count)
+    {
+        const Lod &lod = lods[level];
+        glDrawElementsInstanced(GL_TRIANGLES, lod.Count, GL_UNSIGNED_INT, (void*)(lod.First * sizeof(unsigned int)), count);
     }
 }
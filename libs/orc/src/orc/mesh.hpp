@@ -5,7 +5,9 @@
 #include <string>
 #include <vector>
 #include <glm/glm.hpp>
+#include "bounds.hpp"
 #include "texture.hpp"
+#include "triangle_mesh.hpp"
 
 namespace orc
 {
@@ -19,7 +21,35 @@ namespace orc
             glm::vec2 TextureCoords;
         };
 
-        Mesh(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices, std::unique_ptr<TextureRef> texture);
+        // If keepTriangles is set, a copy of the mesh's triangles is kept in
+        // memory for ray casting. Otherwise, rays are only tested against the
+        // mesh's bounds. Simplified levels of detail, which index the same
+        // vertices, are stored after the mesh's own indices in the same
+        // buffer, and the mesh itself becomes level 0.
+        Mesh(
+            const std::vector<Vertex> &vertices,
+            const std::vector<unsigned int> &indices,
+            std::unique_ptr<TextureRef> texture,
+            bool keepTriangles = false,
+            const std::vector<std::vector<unsigned int>> &lods = {}
+        );
+
+        // Uploads geometry that is already laid out the way the mesh keeps
+        // it, e.g. straight out of a snapshot. indices holds the mesh's own
+        // indices followed by those of each level of detail, and lodCounts
+        // the number of indices of each level, starting with the mesh
+        // itself. Bounds are passed in rather than computed.
+        Mesh(
+            const Vertex *vertices,
+            size_t numVertices,
+            const unsigned int *indices,
+            const uint32_t *lodCounts,
+            uint32_t numLods,
+            const AABB &bounds,
+            const BoundingSphere &boundingSphere,
+            std::unique_ptr<TextureRef> texture,
+            bool keepTriangles = false
+        );
 
         ~Mesh();
 
@@ -28,12 +58,61 @@ namespace orc
         Mesh(const Mesh &other) = delete;
         void operator=(const Mesh &other) = delete;
 
+        // Loads the mesh's texture the first time it's called, and returns
+        // the same texture without looking it up again after that
         Texture &GetTexture() const;
 
+        // Returns the reference that the mesh's texture is loaded from
+        const TextureRef &GetTextureRef() const;
+
+        // Returns the bounds of the mesh's vertices, in the coordinate space
+        // of the node that draws it. Computed once, at construction.
+        const AABB &GetBounds() const;
+
+        const BoundingSphere &GetBoundingSphere() const;
+
+        // Returns the triangles kept for ray casting, or nullptr if they
+        // weren't kept
+        const TriangleMesh *GetTriangles() const;
+
+        // Geometry drawn into the scene's occlusion buffer in place of the
+        // mesh. It should be a much simpler version of the mesh that doesn't
+        // reach outside of it, so that it doesn't hide what the mesh
+        // wouldn't.
+        struct Occluder
+        {
+            std::vector<glm::vec3> Points;
+            std::vector<uint32_t> Indices;
+        };
+
+        // Allows the scene to pick the mesh as an occluder
+        void SetOccluder(std::vector<glm::vec3> points, std::vector<uint32_t> indices);
+
+        // Returns nullptr if the mesh can't occlude anything
+        const Occluder *GetOccluder() const;
+
+        // Number of levels of detail, including the mesh itself
+        uint32_t GetNumLods() const;
+
+        size_t GetNumIndices(uint32_t level = 0) const;
+
+        size_t GetNumVertices() const;
+
+        // Reads the mesh's vertices, and its indices followed by those of
+        // each level of detail, back from GL
+        void ReadGeometry(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices) const;
+
         void Use();
 
         virtual void Draw();
 
+        // Draws a level of detail instead of the mesh itself
+        void DrawLod(uint32_t level);
+
+        // Draws a level of detail count times in one call. Shaders tell the
+        // copies apart by gl_InstanceID.
+        void DrawLodInstanced(uint32_t level, size_t count);
+
         private:
         // Vertex Array Object
         unsigned int vaoId;
@@ -44,10 +123,28 @@ namespace orc
         // Element Buffer Object
         unsigned int eboId;
 
-        // The number of indices passed to glDrawElements
-        int numIndices;
+        // The range of the element buffer passed to glDrawElements for each
+        // level of detail
+        struct Lod
+        {
+            size_t First;
+            size_t Count;
+        };
+        std::vector<Lod> lods;
+        size_t numVertices;
+
+        AABB bounds;
+        BoundingSphere boundingSphere;
+
+        std::unique_ptr<TriangleMesh> triangles;
+        std::unique_ptr<Occluder> occluder;
 
         // TODO: Support multiple textures (material system)
         std::unique_ptr<TextureRef> texture;
+        mutable Texture *loadedTexture;
+
+        // Creates the mesh's GL objects, uploads its vertices, and allocates
+        // room for numIndices indices, which are left for the caller to fill
+        void CreateBuffers(const Vertex *vertices, size_t numIndices);
     };
 }
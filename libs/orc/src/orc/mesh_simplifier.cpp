@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "mesh_simplifier.hpp"
+
+// Borders are held in place by planes perpendicular to the surface along each
+// border edge, weighted this much more heavily than the surface itself
+const double borderWeight = 10.0;
+
+// Collapses may not turn a triangle by more than about 75 degrees
+const float maxFlip = 0.25f;
+
+namespace orc
+{
+    // The sum of squared distances to a set of planes, as a symmetric 4x4
+    // matrix, along with the total area of the triangles the planes came from
+    struct Quadric
+    {
+        double A2, AB, AC, AD, B2, BC, BD, C2, CD, D2;
+        double Weight;
+    };
+
+    enum class VertexKind : uint8_t
+    {
+        // Surrounded by triangles, may collapse onto any neighbor
+        Manifold,
+
+        // On an open border, may only collapse along the border
+        Border,
+
+        // Never removed
+        Locked,
+    };
+
+    // A collapse of vertex U onto vertex V
+    struct Collapse
+    {
+        double Cost;
+        uint32_t U, V;
+    };
+
+    static Quadric planeQuadric(glm::vec3 normal, glm::vec3 point, double weight)
+    {
+        double a = normal.x, b = normal.y, c = normal.z;
+        double d = -(a * point.x + b * point.y + c * point.z);
+        return Quadric{
+            .A2 = a * a * weight, .AB = a * b * weight, .AC = a * c * weight, .AD = a * d * weight,
+            .B2 = b * b * weight, .BC = b * c * weight, .BD = b * d * weight,
+            .C2 = c * c * weight, .CD = c * d * weight,
+            .D2 = d * d * weight,
+            .Weight = 0.0,
+        };
+    }
+
+    static void addQuadric(Quadric &q, const Quadric &other)
+    {
+        q.A2 += other.A2; q.AB += other.AB; q.AC += other.AC; q.AD += other.AD;
+        q.B2 += other.B2; q.BC += other.BC; q.BD += other.BD;
+        q.C2 += other.C2; q.CD += other.CD;
+        q.D2 += other.D2;
+        q.Weight += other.Weight;
+    }
+
+    static double evaluateQuadric(const Quadric &q, glm::vec3 p)
+    {
+        double x = p.x, y = p.y, z = p.z;
+        double e = q.A2 * x * x + q.B2 * y * y + q.C2 * z * z
+            + 2.0 * (q.AB * x * y + q.AC * x * z + q.BC * y * z)
+            + 2.0 * (q.AD * x + q.BD * y + q.CD * z)
+            + q.D2;
+
+        // Rounding can make the error of a point on every plane negative
+        return std::max(e, 0.0);
+    }
+
+    static uint64_t edgeKey(uint32_t a, uint32_t b)
+    {
+        return ((uint64_t)a << 32) | b;
+    }
+
+    // Hashes the exact bits of a position, so that vertices are only welded
+    // if their positions are identical
+    struct PositionHash
+    {
+        size_t operator()(const glm::vec3 &p) const
+        {
+            uint32_t bits[3];
+            std::memcpy(bits, &p, sizeof(bits));
+            return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        }
+    };
+
+    std::vector<uint32_t> SimplifyMesh(
+        const glm::vec3 *points,
+        size_t count,
+        size_t stride,
+        const uint32_t *indices,
+        size_t numIndices,
+        size_t targetIndices,
+        float targetError,
+        float *error
+    )
+    {
+        std::vector<glm::vec3> positions(count);
+        const char *bytes = reinterpret_cast<const char *>(points);
+        for (size_t i = 0; i < count; i++)
+        {
+            positions[i] = *reinterpret_cast<const glm::vec3 *>(bytes + i * stride);
+        }
+
+        // Every vertex refers to the first vertex with the same position,
+        // which stands in for all of them when finding borders and measuring
+        // error. Positions used by more than one vertex are seams.
+        std::vector<uint32_t> canon(count);
+        std::unordered_map<glm::vec3, uint32_t, PositionHash> firstAt;
+        std::vector<uint8_t> isSeam(count, 0);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            canon[i] = firstAt.emplace(positions[i], i).first->second;
+        }
+
+        std::vector<uint32_t> tris;
+        std::vector<uint8_t> isUsed(count, 0);
+        for (size_t i = 0; i + 2 < numIndices; i += 3)
+        {
+            uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            if (canon[a] == canon[b] || canon[b] == canon[c] || canon[c] == canon[a]) continue;
+
+            tris.insert(tris.end(), {a, b, c});
+            isUsed[a] = isUsed[b] = isUsed[c] = 1;
+        }
+
+        std::vector<uint32_t> usedAt(count, UINT32_MAX);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (!isUsed[i]) continue;
+
+            uint32_t &first = usedAt[canon[i]];
+            if (first == UINT32_MAX) first = i;
+            else if (first != i) isSeam[canon[i]] = 1;
+        }
+
+        // Directed edges between positions, sorted so that they can be
+        // searched. Edges without a twin running the other way are borders.
+        std::vector<uint64_t> edges;
+        auto buildEdges = [&]() {
+            edges.clear();
+            for (size_t t = 0; t < tris.size(); t += 3)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    edges.push_back(edgeKey(canon[tris[t + k]], canon[tris[t + (k + 1) % 3]]));
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+            edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        };
+        auto hasEdge = [&](uint32_t ca, uint32_t cb) {
+            return std::binary_search(edges.begin(), edges.end(), edgeKey(ca, cb));
+        };
+        auto isBorderEdge = [&](uint32_t ca, uint32_t cb) {
+            return hasEdge(ca, cb) != hasEdge(cb, ca);
+        };
+
+        // Each position accumulates the planes of the triangles around it,
+        // and of the border edges that it's on
+        std::vector<Quadric> quadrics(count, Quadric{});
+        buildEdges();
+        for (size_t t = 0; t < tris.size(); t += 3)
+        {
+            glm::vec3 p[3] = {positions[tris[t]], positions[tris[t + 1]], positions[tris[t + 2]]};
+            glm::vec3 cross = glm::cross(p[1] - p[0], p[2] - p[0]);
+            float length = glm::length(cross);
+            if (length == 0.0f) continue;
+
+            glm::vec3 normal = cross / length;
+            Quadric q = planeQuadric(normal, p[0], 0.5 * length);
+            q.Weight = 0.5 * length;
+            for (int k = 0; k < 3; k++)
+            {
+                addQuadric(quadrics[canon[tris[t + k]]], q);
+
+                uint32_t ca = canon[tris[t + k]], cb = canon[tris[t + (k + 1) % 3]];
+                if (hasEdge(cb, ca)) continue;
+
+                glm::vec3 edge = p[(k + 1) % 3] - p[k];
+                glm::vec3 borderNormal = glm::cross(edge, normal);
+                if (glm::length(borderNormal) == 0.0f) continue;
+
+                Quadric border = planeQuadric(glm::normalize(borderNormal), p[k], borderWeight * glm::dot(edge, edge));
+                addQuadric(quadrics[ca], border);
+                addQuadric(quadrics[cb], border);
+            }
+        }
+
+        size_t targetTris = targetIndices / 3;
+        double maxCost = (double)targetError * targetError;
+        double maxError = 0.0;
+        std::vector<uint32_t> adjOffsets(count + 1), adj;
+        std::vector<uint32_t> numBorderEdges(count);
+        std::vector<VertexKind> kinds(count);
+        std::vector<Collapse> collapses;
+        std::vector<uint8_t> isTouched(count);
+        std::vector<uint32_t> remap(count);
+
+        // Each pass collapses as many edges as it can without any two
+        // collapses touching the same triangle, cheapest first, then rebuilds
+        // the mesh's topology for the next pass
+        while (tris.size() / 3 > targetTris)
+        {
+            size_t numTris = tris.size() / 3;
+
+            std::fill(adjOffsets.begin(), adjOffsets.end(), 0);
+            for (uint32_t v : tris) adjOffsets[v + 1]++;
+            for (size_t i = 0; i < count; i++) adjOffsets[i + 1] += adjOffsets[i];
+            adj.resize(tris.size());
+            {
+                std::vector<uint32_t> fill(adjOffsets.begin(), adjOffsets.end() - 1);
+                for (size_t i = 0; i < tris.size(); i++)
+                {
+                    adj[fill[tris[i]]++] = i / 3;
+                }
+            }
+
+            buildEdges();
+            std::fill(numBorderEdges.begin(), numBorderEdges.end(), 0);
+            for (uint64_t e : edges)
+            {
+                uint32_t ca = e >> 32, cb = (uint32_t)e;
+                if (hasEdge(cb, ca)) continue;
+
+                numBorderEdges[ca]++;
+                numBorderEdges[cb]++;
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                uint32_t c = canon[i];
+                if (isSeam[c]) kinds[i] = VertexKind::Locked;
+                else if (numBorderEdges[c] == 0) kinds[i] = VertexKind::Manifold;
+                else if (numBorderEdges[c] == 2) kinds[i] = VertexKind::Border;
+                else kinds[i] = VertexKind::Locked;
+            }
+
+            collapses.clear();
+            for (size_t t = 0; t < tris.size(); t += 3)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    // Edges between triangles are seen from both sides, but
+                    // only need to be considered once
+                    uint32_t a = tris[t + k], b = tris[t + (k + 1) % 3];
+                    if (canon[a] > canon[b] && hasEdge(canon[b], canon[a])) continue;
+
+                    for (auto [u, v] : {std::make_pair(a, b), std::make_pair(b, a)})
+                    {
+                        if (kinds[u] == VertexKind::Locked) continue;
+                        if (kinds[u] == VertexKind::Border && !isBorderEdge(canon[u], canon[v])) continue;
+
+                        Quadric q = quadrics[canon[u]];
+                        addQuadric(q, quadrics[canon[v]]);
+
+                        // Costs are normalized by area, so that they can be
+                        // compared to the target error
+                        double cost = evaluateQuadric(q, positions[v]);
+                        if (q.Weight > 0.0) cost /= q.Weight;
+                        collapses.push_back(Collapse{.Cost = cost, .U = u, .V = v});
+                    }
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) {
+                return a.Cost < b.Cost;
+            });
+
+            std::fill(isTouched.begin(), isTouched.end(), 0);
+            for (uint32_t i = 0; i < count; i++) remap[i] = i;
+
+            size_t removed = 0;
+            for (const Collapse &collapse : collapses)
+            {
+                if (numTris - removed <= targetTris) break;
+                if (collapse.Cost > maxCost) break;
+
+                uint32_t u = collapse.U, v = collapse.V;
+                if (isTouched[u] || isTouched[v]) continue;
+
+                // Moving U onto V must not turn any of the triangles that
+                // remain around U over, or close to it
+                bool isFlipped = false;
+                size_t numShared = 0;
+                for (uint32_t i = adjOffsets[u]; i < adjOffsets[u + 1] && !isFlipped; i++)
+                {
+                    const uint32_t *tri = &tris[3 * adj[i]];
+                    if (tri[0] == v || tri[1] == v || tri[2] == v)
+                    {
+                        numShared++;
+                        continue;
+                    }
+
+                    glm::vec3 p[3], q[3];
+                    for (int k = 0; k < 3; k++)
+                    {
+                        p[k] = positions[tri[k]];
+                        q[k] = tri[k] == u ? positions[v] : p[k];
+                    }
+                    glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+                    isFlipped = glm::dot(before, after) <= maxFlip * glm::length(before) * glm::length(after);
+                }
+
+                if (isFlipped) continue;
+
+                addQuadric(quadrics[canon[v]], quadrics[canon[u]]);
+                maxError = std::max(maxError, collapse.Cost);
+
+                remap[u] = v;
+                removed += numShared;
+                for (uint32_t i = adjOffsets[u]; i < adjOffsets[u + 1]; i++)
+                {
+                    const uint32_t *tri = &tris[3 * adj[i]];
+                    isTouched[tri[0]] = isTouched[tri[1]] = isTouched[tri[2]] = 1;
+                }
+            }
+
+            if (removed == 0) break;
+
+            // Drop the triangles that collapsed
+            size_t n = 0;
+            for (size_t t = 0; t < tris.size(); t += 3)
+            {
+                uint32_t a = remap[tris[t]], b = remap[tris[t + 1]], c = remap[tris[t + 2]];
+                if (canon[a] == canon[b] || canon[b] == canon[c] || canon[c] == canon[a]) continue;
+
+                tris[n++] = a;
+                tris[n++] = b;
+                tris[n++] = c;
+            }
+            tris.resize(n);
+        }
+
+        if (error)
+        {
+            *error = (float)std::sqrt(maxError);
+        }
+
+        return tris;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace orc
+{
+    // Simplifies a triangle mesh to at most targetIndices indices, or as close
+    // as it can get, by collapsing edges in order of the error they introduce
+    // according to the quadric error metric (Garland and Heckbert). Edges are
+    // collapsed onto one of their existing vertices, so the result indexes
+    // the same vertices as the input and can share its vertex buffer.
+    //
+    // Points are read the same way as TriangleMesh reads them. Vertices that
+    // share a position with another vertex, e.g. along texture seams, and
+    // corners of open borders are never removed, so that seams don't tear
+    // and borders don't shrink. Borders are otherwise simplified along their
+    // own length. Collapses that would flip a triangle over are skipped.
+    //
+    // Collapses that would move the surface further than targetError, in the
+    // units of the points, are never made, even if targetIndices hasn't been
+    // reached. If error is given, it is set to the largest distance by which
+    // the surface has moved, approximately.
+    std::vector<uint32_t> SimplifyMesh(
+        const glm::vec3 *points,
+        size_t count,
+        size_t stride,
+        const uint32_t *indices,
+        size_t numIndices,
+        size_t targetIndices,
+        float targetError,
+        float *error = nullptr
+    );
+}
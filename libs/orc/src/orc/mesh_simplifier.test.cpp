@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "mesh_simplifier.hpp"
+
+// A sphere of radius 1 at the origin, with shared vertices and triangles
+// wound counter-clockwise when seen from outside
+static void buildSphere(int rings, int segments, std::vector<glm::vec3> &points, std::vector<uint32_t> &indices)
+{
+    const float pi = 3.14159265f;
+    points.push_back(glm::vec3(0.0f, 1.0f, 0.0f));
+    for (int r = 1; r < rings; r++)
+    {
+        float theta = pi * r / rings;
+        for (int s = 0; s < segments; s++)
+        {
+            float phi = 2.0f * pi * s / segments;
+            points.push_back(glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), -std::sin(theta) * std::sin(phi)));
+        }
+    }
+    points.push_back(glm::vec3(0.0f, -1.0f, 0.0f));
+
+    uint32_t bottom = points.size() - 1;
+    auto at = [segments](int r, int s) { return (uint32_t)(1 + (r - 1) * segments + s % segments); };
+    for (int s = 0; s < segments; s++)
+    {
+        indices.insert(indices.end(), {0, at(1, s), at(1, s + 1)});
+        indices.insert(indices.end(), {bottom, at(rings - 1, s + 1), at(rings - 1, s)});
+        for (int r = 1; r < rings - 1; r++)
+        {
+            indices.insert(indices.end(), {at(r, s), at(r + 1, s), at(r + 1, s + 1)});
+            indices.insert(indices.end(), {at(r, s), at(r + 1, s + 1), at(r, s + 1)});
+        }
+    }
+}
+
+// A flat square grid of n by n quads in the XZ plane, facing +Y. If split is
+// set, the vertices of the middle column are duplicated, as they would be
+// along a texture seam.
+static void buildGrid(int n, bool split, std::vector<glm::vec3> &points, std::vector<uint32_t> &indices)
+{
+    for (int z = 0; z <= n; z++)
+    {
+        for (int x = 0; x <= n; x++)
+        {
+            points.push_back(glm::vec3((float)x, 0.0f, (float)-z));
+        }
+    }
+
+    size_t numShared = points.size();
+    for (int z = 0; z <= n && split; z++)
+    {
+        points.push_back(glm::vec3((float)(n / 2), 0.0f, (float)-z));
+    }
+
+    auto at = [&](int x, int z, bool isRightHalf) {
+        if (split && isRightHalf && x == n / 2) return (uint32_t)(numShared + z);
+        return (uint32_t)(z * (n + 1) + x);
+    };
+    for (int z = 0; z < n; z++)
+    {
+        for (int x = 0; x < n; x++)
+        {
+            bool isRightHalf = x >= n / 2;
+            indices.insert(indices.end(), {at(x, z, isRightHalf), at(x + 1, z, isRightHalf), at(x + 1, z + 1, isRightHalf)});
+            indices.insert(indices.end(), {at(x, z, isRightHalf), at(x + 1, z + 1, isRightHalf), at(x, z + 1, isRightHalf)});
+        }
+    }
+}
+
+TEST_CASE("Simplified meshes keep their shape", "[orc]") {
+    std::vector<glm::vec3> points;
+    std::vector<uint32_t> indices;
+    buildSphere(32, 48, points, indices);
+
+    float error;
+    std::vector<uint32_t> simplified = orc::SimplifyMesh(points.data(), points.size(), sizeof(glm::vec3), indices.data(), indices.size(), indices.size() / 4, 1.0f, &error);
+    REQUIRE(simplified.size() % 3 == 0);
+    REQUIRE(simplified.size() <= indices.size() / 4);
+    REQUIRE(simplified.size() >= indices.size() / 5);
+    REQUIRE(error > 0.0f);
+    REQUIRE(error < 0.05f);
+
+    // The sphere is still closed and every triangle still faces outwards
+    for (size_t i = 0; i < simplified.size(); i += 3)
+    {
+        glm::vec3 a = points[simplified[i]], b = points[simplified[i + 1]], c = points[simplified[i + 2]];
+        REQUIRE(glm::dot(glm::cross(b - a, c - a), a + b + c) > 0.0f);
+    }
+
+    // Asking for more indices than there are changes nothing
+    REQUIRE(orc::SimplifyMesh(points.data(), points.size(), sizeof(glm::vec3), indices.data(), indices.size(), indices.size(), 1.0f) == indices);
+}
+
+TEST_CASE("Simplified meshes keep their borders and seams", "[orc]") {
+    std::vector<glm::vec3> points;
+    std::vector<uint32_t> indices;
+    buildGrid(16, true, points, indices);
+
+    // A flat surface collapses without any error, down to little more than
+    // its borders and seam, while everything else would move it too far
+    float error;
+    std::vector<uint32_t> simplified = orc::SimplifyMesh(points.data(), points.size(), sizeof(glm::vec3), indices.data(), indices.size(), 0, 0.01f, &error);
+    REQUIRE(error < 1e-3f);
+    REQUIRE(simplified.size() < indices.size() / 4);
+
+    // Straight borders are simplified along their length, but the corners
+    // stay put, as does every vertex along the seam
+    std::vector<glm::vec3> corners = {
+        glm::vec3(0.0f, 0.0f, 0.0f),
+        glm::vec3(16.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 0.0f, -16.0f),
+        glm::vec3(16.0f, 0.0f, -16.0f),
+    };
+    for (int z = 0; z <= 16; z++)
+    {
+        corners.push_back(glm::vec3(8.0f, 0.0f, (float)-z));
+    }
+    for (glm::vec3 corner : corners)
+    {
+        REQUIRE(std::any_of(simplified.begin(), simplified.end(), [&](uint32_t i) { return points[i] == corner; }));
+    }
+
+    // The surface still covers the whole square
+    float area = 0.0f;
+    for (size_t i = 0; i < simplified.size(); i += 3)
+    {
+        glm::vec3 a = points[simplified[i]], b = points[simplified[i + 1]], c = points[simplified[i + 2]];
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        REQUIRE(normal.y > 0.0f);
+        area += 0.5f * normal.y;
+    }
+    REQUIRE(std::abs(area - 256.0f) < 1e-2f);
+}
@@ -1,11 +1,16 @@
+#include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <utility>
+#include <vector>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 #include <glm/glm.hpp>
+#include "lod.hpp"
 #include "mesh.hpp"
 #include "model.hpp"
+#include "node_pool.hpp"
 #include "object.hpp"
 #include "texture_2d.hpp"
 
@@ -76,6 +81,35 @@ namespace orc
         return indices;
     }
 
+    // Meshes occlude with their coarsest level of detail that can be pushed
+    // far enough into the mesh to stay inside of it. Meshes too simple to
+    // have levels of detail occlude with themselves, and meshes too thin for
+    // any of their levels don't occlude at all.
+    static void setOccluder(
+        Mesh &mesh,
+        const std::vector<Mesh::Vertex> &vertices,
+        const std::vector<unsigned int> &indices,
+        const std::vector<std::vector<unsigned int>> &lods,
+        const std::vector<float> &lodErrors
+    )
+    {
+        std::vector<glm::vec3> points;
+        std::vector<uint32_t> occluderIndices;
+        const glm::vec3 *coords = &vertices[0].Coordinates;
+        bool isBuilt = lods.empty()
+            && BuildOccluder(coords, sizeof(Mesh::Vertex), indices.data(), indices.size(), 0.0f, points, occluderIndices);
+        for (size_t level = lods.size(); level > 0 && !isBuilt; level--)
+        {
+            const std::vector<unsigned int> &lod = lods[level - 1];
+            isBuilt = BuildOccluder(coords, sizeof(Mesh::Vertex), lod.data(), lod.size(), lodErrors[level - 1], points, occluderIndices);
+        }
+
+        if (isBuilt)
+        {
+            mesh.SetOccluder(std::move(points), std::move(occluderIndices));
+        }
+    }
+
     static std::string getTexturePathFromMaterial(const aiMaterial *const material)
     {
         aiString path;
@@ -100,7 +134,23 @@ namespace orc
         return gMx;
     }
 
-    static void buildGraph(std::filesystem::path dir, const aiScene &scene, const aiNode &node, Object &parent)
+    static std::shared_ptr<Object> createObject(NodePool *pool)
+    {
+        return pool ? Object::Create(*pool) : Object::Create();
+    }
+
+    static size_t countNodes(const aiNode &node)
+    {
+        size_t count = 1;
+        for (unsigned int i = 0; i < node.mNumChildren; i ++)
+        {
+            count += countNodes(*node.mChildren[i]);
+        }
+
+        return count;
+    }
+
+    static void buildGraph(std::filesystem::path dir, const aiScene &scene, const aiNode &node, Object &parent, NodePool *pool, bool keepTriangles)
     {
         parent.SetTransformMx(assimpToGlmMx(node.mTransformation));
 
@@ -116,42 +166,91 @@ namespace orc
             {
                 aiMaterial *material = scene.mMaterials[mesh.mMaterialIndex];
                 if (material->GetTextureCount(aiTextureType_BASE_COLOR) > 0) {
-                    parent.AddMesh(std::make_shared<Mesh>(
-                        getVerticesFromMesh(mesh),
-                        getIndicesFromMesh(mesh),
+                    std::vector<Mesh::Vertex> vertices = getVerticesFromMesh(mesh);
+                    std::vector<unsigned int> indices = getIndicesFromMesh(mesh);
+
+                    // Points and lines can't be simplified or raycast, and
+                    // don't hide anything behind them
+                    bool isTriangles = mesh.mPrimitiveTypes == aiPrimitiveType_TRIANGLE;
+                    std::vector<float> lodErrors;
+                    std::vector<std::vector<unsigned int>> lods;
+                    if (isTriangles)
+                    {
+                        lods = GenerateLods(
+                            &vertices[0].Coordinates,
+                            vertices.size(),
+                            sizeof(Mesh::Vertex),
+                            indices.data(),
+                            indices.size(),
+                            3,
+                            &lodErrors
+                        );
+                    }
+                    std::shared_ptr<Mesh> loaded = std::make_shared<Mesh>(
+                        vertices,
+                        indices,
                         std::make_unique<Texture2DRef>(
                             Texture2D::Type::BaseColor,
                             dir / getTexturePathFromMaterial(material)
-                        )
-                    ));
+                        ),
+                        keepTriangles && isTriangles,
+                        lods
+                    );
+                    if (isTriangles)
+                    {
+                        setOccluder(*loaded, vertices, indices, lods, lodErrors);
+                    }
+                    parent.AddMesh(loaded);
                 }
             }
         }
 
         for (unsigned int i = 0; i < node.mNumChildren; i ++)
         {
-            std::shared_ptr<Object> child = Object::Create();
+            std::shared_ptr<Object> child = createObject(pool);
             parent.AttachChild(child); 
-            buildGraph(dir, scene, *node.mChildren[i], *child);
+            buildGraph(dir, scene, *node.mChildren[i], *child, pool, keepTriangles);
         }
     }
 
-    std::shared_ptr<Object> LoadModel(std::string path)
+    static std::shared_ptr<Object> loadModel(std::string path, NodePool *pool, bool keepTriangles)
     {
         // Import model file and perform some processing:
         // - Transform all primitives to triangles
+        // - Split meshes that mix points or lines with triangles, so that
+        //   each mesh has a single primitive type
         // - Generate surface normals if not included
         // - Flip texture coordinates vertically
+        // - Share vertices between faces, which levels of detail rely on to
+        //   find the edges they can collapse
         Assimp::Importer importer;
-        const aiScene *const scene = importer.ReadFile(path, aiProcess_Triangulate|aiProcess_GenNormals|aiProcess_FlipUVs);
+        const aiScene *const scene = importer.ReadFile(
+            path,
+            aiProcess_Triangulate|aiProcess_SortByPType|aiProcess_GenNormals|aiProcess_FlipUVs|aiProcess_JoinIdenticalVertices
+        );
 
         if (!sceneLoadedSuccessfully(scene)) {
             throw std::runtime_error("Failed to load scene at " + path);
         }
 
+        if (pool)
+        {
+            pool->Reserve<Object>(countNodes(*scene->mRootNode));
+        }
+
         std::filesystem::path fsPath = path;
-        std::shared_ptr<Object> root = Object::Create();
-        buildGraph(fsPath.parent_path(), *scene, *scene->mRootNode, *root);
+        std::shared_ptr<Object> root = createObject(pool);
+        buildGraph(fsPath.parent_path(), *scene, *scene->mRootNode, *root, pool, keepTriangles);
         return root;
     }
+
+    std::shared_ptr<Object> LoadModel(std::string path, bool keepTriangles)
+    {
+        return loadModel(path, nullptr, keepTriangles);
+    }
+
+    std::shared_ptr<Object> LoadModel(std::string path, NodePool &pool, bool keepTriangles)
+    {
+        return loadModel(path, &pool, keepTriangles);
+    }
 }
@@ -1,9 +1,21 @@
 #pragma once
 
 #include <memory>
+#include "node_pool.hpp"
 #include "object.hpp"
 
 namespace orc
 {
-    std::shared_ptr<Object> LoadModel(std::string path);
+    // Loads a model and all of its meshes. If keepTriangles is set, each mesh
+    // keeps a copy of its triangles and a BVH over them, so that rays cast
+    // into the scene hit the model's exact shape rather than its bounds.
+    // Simplified levels of detail are generated for each mesh of triangles as
+    // it's loaded, and the coarsest of them, pushed into the mesh by as much
+    // as it strays from it, becomes the mesh's occluder (see BuildOccluder).
+    // Meshes of points or lines are loaded as they are.
+    std::shared_ptr<Object> LoadModel(std::string path, bool keepTriangles = false);
+
+    // Same as above, but allocates the model's nodes from a pool. Room for
+    // every node is reserved before the hierarchy is built.
+    std::shared_ptr<Object> LoadModel(std::string path, NodePool &pool, bool keepTriangles = false);
 }
@@ -0,0 +1,88 @@
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "mx_kernels.hpp"
+#include "transform_store.hpp"
+
+const size_t numMxs = 10000;
+
+static const char *levelName(orc::SimdLevel level)
+{
+    switch (level)
+    {
+        case orc::SimdLevel::AVX2: return "AVX2";
+        case orc::SimdLevel::SSE: return "SSE";
+        default: return "Scalar";
+    }
+}
+
+TEST_CASE("Batched matrix kernels", "[orc][benchmark]") {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-3.0f, 3.0f);
+
+    std::vector<orc::Transform> transforms;
+    std::vector<int32_t> parents;
+    std::vector<uint32_t> indices;
+    for (size_t i = 0; i < numMxs; i++)
+    {
+        glm::quat orientation = glm::angleAxis(dist(rng), glm::normalize(glm::vec3(dist(rng), dist(rng), dist(rng))));
+        transforms.push_back(orc::Transform{
+            .Translation = glm::vec3(dist(rng), dist(rng), dist(rng)),
+            .Orientation = orientation,
+            .RotationMx = glm::mat3_cast(orientation),
+            .Scale = glm::vec3(1.0f),
+        });
+
+        // A shallow, wide hierarchy, typical of imported models
+        parents.push_back(i < 100 ? orc::TransformStore::noParent : i % 100);
+        indices.push_back(i);
+    }
+
+    std::vector<glm::mat4> local(numMxs), world(numMxs), mvp(numMxs);
+    glm::mat4 viewProjectionMx = orc::ComposeTransformMx(transforms[0]);
+
+    // Baselines using glm directly, as the update and draw paths used to
+    BENCHMARK("glm: compose 10k transforms") {
+        for (size_t i = 0; i < numMxs; i++) local[i] = orc::ComposeTransformMx(transforms[i]);
+        return local[numMxs - 1];
+    };
+
+    BENCHMARK("glm: multiply 10k parent * local") {
+        for (size_t i = 0; i < numMxs; i++)
+        {
+            world[i] = parents[i] == orc::TransformStore::noParent ? local[i] : world[parents[i]] * local[i];
+        }
+        return world[numMxs - 1];
+    };
+
+    BENCHMARK("glm: multiply 10k view-projection * model") {
+        for (size_t i = 0; i < numMxs; i++) mvp[i] = viewProjectionMx * world[i];
+        return mvp[numMxs - 1];
+    };
+
+    for (orc::SimdLevel level = orc::SimdLevel::Scalar; level <= orc::GetSupportedSimdLevel(); level = (orc::SimdLevel)((int)level + 1))
+    {
+        const orc::MxKernels &kernels = orc::GetMxKernels(level);
+        std::string name = levelName(level);
+
+        BENCHMARK(name + ": compose 10k transforms") {
+            kernels.ComposeTransformMxs(transforms.data(), indices.data(), numMxs, local.data());
+            return local[numMxs - 1];
+        };
+
+        BENCHMARK(name + ": multiply 10k parent * local") {
+            kernels.ComputeWorldMxs(world.data(), parents.data(), indices.data(), local.data(), numMxs);
+            return world[numMxs - 1];
+        };
+
+        BENCHMARK(name + ": multiply 10k view-projection * model") {
+            kernels.MultiplyMxs(viewProjectionMx, world.data(), numMxs, mvp.data());
+            return mvp[numMxs - 1];
+        };
+    }
+}
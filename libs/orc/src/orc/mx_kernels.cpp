@@ -0,0 +1,185 @@
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <glm/gtc/type_ptr.hpp>
+#include "mx_kernels.hpp"
+#include "transform_store.hpp"
+
+#if defined(__x86_64__)
+    #define ORC_SIMD_X86
+    #include <immintrin.h>
+#endif
+
+namespace orc
+{
+    static void composeTransformMxsScalar(const Transform *transforms, const uint32_t *indices, size_t count, glm::mat4 *out)
+    {
+        for (size_t k = 0; k < count; k++)
+        {
+            out[k] = ComposeTransformMx(transforms[indices[k]]);
+        }
+    }
+
+    static void computeWorldMxsScalar(glm::mat4 *worldMxs, const int32_t *parents, const uint32_t *indices, const glm::mat4 *localMxs, size_t count)
+    {
+        for (size_t k = 0; k < count; k++)
+        {
+            uint32_t i = indices[k];
+            int32_t p = parents[i];
+            worldMxs[i] = p == TransformStore::noParent ? localMxs[k] : worldMxs[p] * localMxs[k];
+        }
+    }
+
+    static void multiplyMxsScalar(const glm::mat4 &lhs, const glm::mat4 *rhs, size_t count, glm::mat4 *out)
+    {
+        for (size_t k = 0; k < count; k++)
+        {
+            out[k] = lhs * rhs[k];
+        }
+    }
+
+#ifdef ORC_SIMD_X86
+    // Computes out = a * b, where all matrices are column major. Safe to call
+    // when out aliases either input.
+    static inline void multiplySse(const float *a, const float *b, float *out)
+    {
+        __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+
+        for (int col = 0; col < 4; col++)
+        {
+            const float *bc = b + 4 * col;
+            __m128 r = _mm_mul_ps(a0, _mm_set1_ps(bc[0]));
+            r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(bc[1])));
+            r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+            r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(bc[3])));
+            _mm_storeu_ps(out + 4 * col, r);
+        }
+    }
+
+    static void computeWorldMxsSse(glm::mat4 *worldMxs, const int32_t *parents, const uint32_t *indices, const glm::mat4 *localMxs, size_t count)
+    {
+        for (size_t k = 0; k < count; k++)
+        {
+            uint32_t i = indices[k];
+            int32_t p = parents[i];
+            if (p == TransformStore::noParent) worldMxs[i] = localMxs[k];
+            else multiplySse(glm::value_ptr(worldMxs[p]), glm::value_ptr(localMxs[k]), glm::value_ptr(worldMxs[i]));
+        }
+    }
+
+    static void multiplyMxsSse(const glm::mat4 &lhs, const glm::mat4 *rhs, size_t count, glm::mat4 *out)
+    {
+        for (size_t k = 0; k < count; k++)
+        {
+            multiplySse(glm::value_ptr(lhs), glm::value_ptr(rhs[k]), glm::value_ptr(out[k]));
+        }
+    }
+
+    #define ORC_TARGET_AVX2 __attribute__((target("avx2,fma")))
+
+    // Computes out = a * b two result columns at a time. Each half of a
+    // 256-bit register holds one column, so every column of a is duplicated
+    // into both halves and multiplied by the matching element of two columns
+    // of b. Safe to call when out aliases either input.
+    ORC_TARGET_AVX2 static inline void multiplyAvx2(const float *a, const float *b, float *out)
+    {
+        __m256 a0 = _mm256_broadcast_ps((const __m128 *)a);
+        __m256 a1 = _mm256_broadcast_ps((const __m128 *)(a + 4));
+        __m256 a2 = _mm256_broadcast_ps((const __m128 *)(a + 8));
+        __m256 a3 = _mm256_broadcast_ps((const __m128 *)(a + 12));
+
+        for (int col = 0; col < 4; col += 2)
+        {
+            __m256 bc = _mm256_loadu_ps(b + 4 * col);
+            __m256 r = _mm256_mul_ps(a0, _mm256_shuffle_ps(bc, bc, 0x00));
+            r = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(bc, bc, 0x55), r);
+            r = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(bc, bc, 0xAA), r);
+            r = _mm256_fmadd_ps(a3, _mm256_shuffle_ps(bc, bc, 0xFF), r);
+            _mm256_storeu_ps(out + 4 * col, r);
+        }
+    }
+
+    ORC_TARGET_AVX2 static void computeWorldMxsAvx2(glm::mat4 *worldMxs, const int32_t *parents, const uint32_t *indices, const glm::mat4 *localMxs, size_t count)
+    {
+        for (size_t k = 0; k < count; k++)
+        {
+            uint32_t i = indices[k];
+            int32_t p = parents[i];
+            if (p == TransformStore::noParent) worldMxs[i] = localMxs[k];
+            else multiplyAvx2(glm::value_ptr(worldMxs[p]), glm::value_ptr(localMxs[k]), glm::value_ptr(worldMxs[i]));
+        }
+    }
+
+    ORC_TARGET_AVX2 static void multiplyMxsAvx2(const glm::mat4 &lhs, const glm::mat4 *rhs, size_t count, glm::mat4 *out)
+    {
+        for (size_t k = 0; k < count; k++)
+        {
+            multiplyAvx2(glm::value_ptr(lhs), glm::value_ptr(rhs[k]), glm::value_ptr(out[k]));
+        }
+    }
+#endif
+
+    SimdLevel GetSupportedSimdLevel()
+    {
+#ifdef ORC_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            return SimdLevel::AVX2;
+        }
+
+        // SSE2 is part of the x86-64 baseline
+        return SimdLevel::SSE;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+
+    const MxKernels &GetMxKernels(SimdLevel level)
+    {
+        static const MxKernels scalar = {
+            .ComposeTransformMxs = composeTransformMxsScalar,
+            .ComputeWorldMxs = computeWorldMxsScalar,
+            .MultiplyMxs = multiplyMxsScalar,
+        };
+
+#ifdef ORC_SIMD_X86
+        // Composing a transform only takes a few multiplications now that
+        // rotation matrices are cached, which the compiler already vectorizes
+        // as well as a hand-written kernel would
+        static const MxKernels sse = {
+            .ComposeTransformMxs = composeTransformMxsScalar,
+            .ComputeWorldMxs = computeWorldMxsSse,
+            .MultiplyMxs = multiplyMxsSse,
+        };
+        static const MxKernels avx2 = {
+            .ComposeTransformMxs = composeTransformMxsScalar,
+            .ComputeWorldMxs = computeWorldMxsAvx2,
+            .MultiplyMxs = multiplyMxsAvx2,
+        };
+#endif
+
+        if (level > GetSupportedSimdLevel())
+        {
+            throw std::runtime_error("Instruction set is not supported by this CPU");
+        }
+
+        switch (level)
+        {
+#ifdef ORC_SIMD_X86
+            case SimdLevel::AVX2:
+                return avx2;
+            case SimdLevel::SSE:
+                return sse;
+#endif
+            default:
+                return scalar;
+        }
+    }
+
+    const MxKernels &GetMxKernels()
+    {
+        static const MxKernels &kernels = GetMxKernels(GetSupportedSimdLevel());
+        return kernels;
+    }
+}
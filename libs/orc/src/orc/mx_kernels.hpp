@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "transform_store.hpp"
+
+namespace orc
+{
+    // Instruction sets that the batched matrix kernels are compiled for
+    enum class SimdLevel
+    {
+        Scalar,
+        SSE,
+        AVX2,
+    };
+
+    // Batched matrix operations. Every implementation computes each matrix
+    // independently of the others in its batch, so results don't depend on
+    // how work is split into batches.
+    struct MxKernels
+    {
+        // Composes the T*R*S matrix of transforms[indices[k]] into out[k]
+        void (*ComposeTransformMxs)(const Transform *transforms, const uint32_t *indices, size_t count, glm::mat4 *out);
+
+        // For each k in order, computes worldMxs[i] = worldMxs[parents[i]] *
+        // localMxs[k], where i = indices[k]. Nodes without a parent take
+        // their local matrix as is. Parents must either precede their
+        // children in indices or have been computed beforehand.
+        void (*ComputeWorldMxs)(glm::mat4 *worldMxs, const int32_t *parents, const uint32_t *indices, const glm::mat4 *localMxs, size_t count);
+
+        // Computes out[k] = lhs * rhs[k]
+        void (*MultiplyMxs)(const glm::mat4 &lhs, const glm::mat4 *rhs, size_t count, glm::mat4 *out);
+    };
+
+    // Returns the most capable instruction set supported by the host CPU
+    SimdLevel GetSupportedSimdLevel();
+
+    // Returns kernels compiled for a specific instruction set. Throws if the
+    // host CPU does not support it.
+    const MxKernels &GetMxKernels(SimdLevel level);
+
+    // Returns kernels for the most capable instruction set supported by the
+    // host CPU, which is detected once on first use
+    const MxKernels &GetMxKernels();
+}
@@ -0,0 +1,100 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <testutils/glm.hpp>
+#include "mx_kernels.hpp"
+#include "transform_store.hpp"
+
+static std::vector<orc::Transform> randomTransforms(size_t count)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> angle(-glm::pi<float>(), glm::pi<float>());
+    std::uniform_real_distribution<float> offset(-5.0f, 5.0f);
+    std::uniform_real_distribution<float> factor(0.25f, 2.0f);
+
+    std::vector<orc::Transform> transforms;
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::vec3 axis = glm::normalize(glm::vec3(offset(rng), offset(rng), offset(rng)));
+        glm::quat orientation = glm::angleAxis(angle(rng), axis);
+        transforms.push_back(orc::Transform{
+            .Translation = glm::vec3(offset(rng), offset(rng), offset(rng)),
+            .Orientation = orientation,
+            .RotationMx = glm::mat3_cast(orientation),
+            .Scale = glm::vec3(factor(rng), factor(rng), factor(rng)),
+        });
+    }
+
+    return transforms;
+}
+
+static std::vector<orc::SimdLevel> supportedLevels()
+{
+    std::vector<orc::SimdLevel> levels = {orc::SimdLevel::Scalar};
+    if (orc::GetSupportedSimdLevel() >= orc::SimdLevel::SSE) levels.push_back(orc::SimdLevel::SSE);
+    if (orc::GetSupportedSimdLevel() >= orc::SimdLevel::AVX2) levels.push_back(orc::SimdLevel::AVX2);
+    return levels;
+}
+
+TEST_CASE("Batched kernels match glm", "[orc]") {
+    // An odd count exercises the padding of partial batches
+    const size_t count = 37;
+    std::vector<orc::Transform> transforms = randomTransforms(count);
+
+    // Arrange nodes in a chain where each node's parent is the one before it,
+    // except for the first node
+    std::vector<int32_t> parents;
+    std::vector<uint32_t> indices;
+    for (size_t i = 0; i < count; i++)
+    {
+        parents.push_back(i % 4 == 0 ? orc::TransformStore::noParent : i - 1);
+        indices.push_back(i);
+    }
+
+    std::vector<glm::mat4> expectedLocal, expectedWorld, expectedMvp;
+    glm::mat4 viewProjectionMx = orc::ComposeTransformMx(transforms[0]);
+    for (size_t i = 0; i < count; i++)
+    {
+        expectedLocal.push_back(orc::ComposeTransformMx(transforms[i]));
+        expectedWorld.push_back(parents[i] == orc::TransformStore::noParent
+            ? expectedLocal[i]
+            : expectedWorld[parents[i]] * expectedLocal[i]);
+        expectedMvp.push_back(viewProjectionMx * expectedWorld[i]);
+    }
+
+    for (orc::SimdLevel level : supportedLevels())
+    {
+        const orc::MxKernels &kernels = orc::GetMxKernels(level);
+        std::vector<glm::mat4> local(count), world(count), mvp(count);
+
+        kernels.ComposeTransformMxs(transforms.data(), indices.data(), count, local.data());
+        kernels.ComputeWorldMxs(world.data(), parents.data(), indices.data(), local.data(), count);
+        kernels.MultiplyMxs(viewProjectionMx, world.data(), count, mvp.data());
+
+        for (size_t i = 0; i < count; i++)
+        {
+            REQUIRE(testutils::Mat4Equals(expectedLocal[i], local[i]));
+            REQUIRE(testutils::Mat4Equals(expectedWorld[i], world[i]));
+            REQUIRE(testutils::Mat4Equals(expectedMvp[i], mvp[i]));
+        }
+    }
+}
+
+TEST_CASE("Compose a subset of transforms", "[orc]") {
+    std::vector<orc::Transform> transforms = randomTransforms(20);
+    std::vector<uint32_t> indices = {19, 3, 7, 7, 0};
+
+    for (orc::SimdLevel level : supportedLevels())
+    {
+        std::vector<glm::mat4> out(indices.size());
+        orc::GetMxKernels(level).ComposeTransformMxs(transforms.data(), indices.data(), indices.size(), out.data());
+
+        for (size_t k = 0; k < indices.size(); k++)
+        {
+            REQUIRE(testutils::Mat4Equals(orc::ComposeTransformMx(transforms[indices[k]]), out[k]));
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#include <memory>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "node.hpp"
+
+const size_t numProjectiles = 10000;
+
+TEST_CASE("Attach and detach churn", "[orc][benchmark]") {
+    // A scene that already holds plenty of other nodes
+    std::shared_ptr<orc::Node> root = orc::Node::Create();
+    for (size_t i = 0; i < numProjectiles; i++)
+    {
+        root->AttachChild(orc::Node::Create());
+    }
+
+    std::vector<std::shared_ptr<orc::Node>> projectiles;
+    for (size_t i = 0; i < numProjectiles; i++)
+    {
+        projectiles.push_back(orc::Node::Create());
+    }
+
+    // Spawns 10k projectiles, then despawns them in a different order than
+    // they were spawned in, as if they'd hit things at different times
+    BENCHMARK("Attach then detach 10k nodes") {
+        for (const std::shared_ptr<orc::Node> &p : projectiles)
+        {
+            root->AttachChild(p);
+        }
+
+        for (size_t i = 0; i < numProjectiles; i += 2)
+        {
+            projectiles[i]->Detach();
+        }
+
+        for (size_t i = 1; i < numProjectiles; i += 2)
+        {
+            projectiles[i]->Detach();
+        }
+
+        return root->GetChildren().size();
+    };
+}
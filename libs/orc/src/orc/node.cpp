@@ -1,11 +1,19 @@
 #define _USE_MATH_DEFINES
 
 #include <cmath>
+#include <cstddef>
 #include <memory>
+#include <new>
 #include <stdexcept>
-#include <glm/gtc/matrix_transform.hpp>
+#include <utility>
+#include <vector>
+#include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/euler_angles.hpp>
+#include "bounds.hpp"
+#include "change_journal.hpp"
 #include "node.hpp"
+#include "node_pool.hpp"
+#include "transform_store.hpp"
 #include "visitor.hpp"
 
 // By convention, the default direction faces the -Z axis
@@ -13,6 +21,9 @@ const glm::vec4 worldFront(0.0f, 0.0f, -1.0f, 0.0f);
 const glm::vec4 worldRight(1.0f, 0.0f, 0.0f, 0.0f);
 const glm::vec4 worldUp(0.0f, 1.0f, 0.0f, 0.0f);
 const glm::vec4 worldOrigin(0.0f, 0.0f, 0.0f, 1.0f);
+const glm::vec3 yawAxis(0.0f, 1.0f, 0.0f);
+const glm::vec3 pitchAxis(1.0f, 0.0f, 0.0f);
+const glm::vec3 rollAxis(0.0f, 0.0f, 1.0f);
 
 static float modRadians(float rad)
 {
@@ -31,14 +42,47 @@ namespace orc
         return std::shared_ptr<Node>(new Node());
     }
 
+    std::shared_ptr<Node> Node::Create(NodePool &pool)
+    {
+        return pool.Create<Node>([](void *mem) { return new (mem) Node(); });
+    }
+
     Node::Node()
-        : translation(glm::vec3(0.0f))
-        , rotation(glm::vec3(0.0f))
-        , scale(glm::vec3(1.0f))
+        : transform(Transform{
+            .Translation = glm::vec3(0.0f),
+            .Orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+            .RotationMx = glm::mat3(1.0f),
+            .Scale = glm::vec3(1.0f),
+        })
         , modelMx(glm::mat4(1.0f))
-        , isAttached(false)
+        , localBounds(EmptyAABB())
+        , worldBounds(EmptyAABB())
+        , isDirty(true)
+        , angles(0.0f)
+        , hasAngles(true)
+        , parent(nullptr)
+        , childIdx(0)
+        , handle(NodeHandle{.Index = 0, .Generation = 0})
+        , store(nullptr)
+        , storeIdx(0)
         {}
 
+    Node::~Node()
+    {
+        // Children may be kept alive elsewhere
+        for (const std::shared_ptr<Node> &child : children)
+        {
+            child->parent = nullptr;
+        }
+
+        // Leave a hole in the store rather than a dangling pointer. The hole
+        // goes away the next time the store is rebuilt.
+        if (store)
+        {
+            store->nodes[storeIdx] = nullptr;
+        }
+    }
+
     void Node::Dispatch(NodeVisitor &visitor)
     {
         // No-op
@@ -46,32 +90,78 @@ namespace orc
 
     void Node::Translate(float x, float y, float z)
     {
+        const glm::vec3 &translation = GetTransform().Translation;
         SetTranslation(translation.x + x, translation.y + y, translation.z + z);
-
     }
 
     void Node::SetTranslation(float x, float y, float z)
     {
-        translation = glm::vec3(x, y, z);
+        GetTransform().Translation = glm::vec3(x, y, z);
+        MarkDirty();
     }
 
     void Node::Rotate(float yaw, float pitch, float roll)
     {
+        // Angles that were set explicitly are reused so that repeated calls
+        // accumulate exactly as they always have, e.g. a camera pitching past
+        // vertical. Otherwise, they are recovered from the orientation.
+        if (!hasAngles)
+        {
+            glm::extractEulerAngleYXZ(glm::mat4(GetTransform().RotationMx), angles.x, angles.y, angles.z);
+        }
+
         SetRotation(
-            modRadians(rotation.x + yaw),
-            modRadians(rotation.y + pitch),
-            modRadians(rotation.z + roll)
+            modRadians(angles.x + yaw),
+            modRadians(angles.y + pitch),
+            modRadians(angles.z + roll)
         );
     }
 
     void Node::SetRotation(float yaw, float pitch, float roll)
     {
-        // TODO: Represent rotation using quaternions
-        rotation = glm::vec3(yaw, pitch, roll);
+        // Equivalent to glm::yawPitchRoll, which applies roll, then pitch,
+        // then yaw
+        ApplyOrientation(
+            glm::angleAxis(yaw, yawAxis) *
+            glm::angleAxis(pitch, pitchAxis) *
+            glm::angleAxis(roll, rollAxis)
+        );
+        angles = glm::vec3(yaw, pitch, roll);
+        hasAngles = true;
+    }
+
+    void Node::SetOrientation(const glm::quat &orientation)
+    {
+        ApplyOrientation(orientation);
+        hasAngles = false;
+    }
+
+    glm::quat Node::GetOrientation() const
+    {
+        return GetTransform().Orientation;
+    }
+
+    void Node::RotateAround(const glm::vec3 &axis, float angle)
+    {
+        SetOrientation(glm::angleAxis(angle, glm::normalize(axis)) * GetTransform().Orientation);
+    }
+
+    void Node::RotateAround(const glm::vec3 &point, const glm::vec3 &axis, float angle)
+    {
+        glm::quat rotation = glm::angleAxis(angle, glm::normalize(axis));
+        glm::vec3 translation = point + rotation * (GetTransform().Translation - point);
+        SetTranslation(translation.x, translation.y, translation.z);
+        SetOrientation(rotation * GetTransform().Orientation);
+    }
+
+    void Node::Slerp(const glm::quat &target, float t)
+    {
+        SetOrientation(glm::slerp(GetTransform().Orientation, glm::normalize(target), t));
     }
 
     void Node::Scale(float x, float y, float z)
     {
+        const glm::vec3 &scale = GetTransform().Scale;
         SetScale(scale.x * x, scale.y * y, scale.z * z);
     }
 
@@ -82,19 +172,23 @@ namespace orc
             throw std::logic_error("Scaling factors must be positive and non-zero");
         }
 
-        scale = glm::vec3(x, y, z);
+        GetTransform().Scale = glm::vec3(x, y, z);
+        MarkDirty();
     }
 
     // Assumes a T*R*S transformation matrix
     void Node::SetTransformMx(glm::mat4 mx)
     {
+        Transform &t = GetTransform();
+
         // Translation vector can be extracted from the last column of the
         // matrix
-        translation = glm::vec3(mx[3][0], mx[3][1], mx[3][2]);
+        t.Translation = glm::vec3(mx[3][0], mx[3][1], mx[3][2]);
 
         // Since each axis is be expressed as a unit vector in the pure rotation
         // matrix, the scaling factors can be derived by taking the magnitude
         // of each axis in the transformation matrix
+        glm::vec3 &scale = t.Scale;
         scale = glm::vec3(
             glm::length(glm::vec3(mx[0][0], mx[0][1], mx[0][2])),
             glm::length(glm::vec3(mx[1][0], mx[1][1], mx[1][2])),
@@ -103,7 +197,7 @@ namespace orc
 
         // Construct a pure rotation matrix by dividing each scaled axis by its
         // respective scaling factor
-        glm::mat4 pureRotationMx(1.0f);
+        glm::mat3 pureRotationMx(1.0f);
         pureRotationMx[0][0] = mx[0][0] / scale.x;
         pureRotationMx[0][1] = mx[0][1] / scale.x;
         pureRotationMx[0][2] = mx[0][2] / scale.x;
@@ -113,26 +207,51 @@ namespace orc
         pureRotationMx[2][0] = mx[2][0] / scale.z;
         pureRotationMx[2][1] = mx[2][1] / scale.z;
         pureRotationMx[2][2] = mx[2][2] / scale.z;
-        glm::extractEulerAngleYXZ(pureRotationMx, rotation.x, rotation.y, rotation.z);
+        SetOrientation(glm::quat_cast(pureRotationMx));
+    }
+
+    glm::mat4 Node::GetTransformMx() const
+    {
+        return ComposeTransformMx(GetTransform());
     }
 
     void Node::ComputeMxs()
     {
         glm::mat4 parentMx(1.0f);
-        if (std::shared_ptr<Node> p = parent.lock())
+        if (parent)
+        {
+            parentMx = parent->GetModelMx();
+        }
+
+        glm::mat4 mx = parentMx * ComposeTransformMx(GetTransform());
+        AABB bounds = TransformAABB(GetLocalBounds(), mx);
+
+        // The dirty flag of a node that belongs to a store is left alone so
+        // that its descendants and bounds are still recomputed on the next
+        // update
+        if (store)
+        {
+            store->worldMxs[storeIdx] = mx;
+            store->worldBounds[storeIdx] = bounds;
+        }
+        else
         {
-            parentMx = p->GetModelMx();
+            modelMx = mx;
+            worldBounds = bounds;
+            isDirty = false;
         }
 
-        modelMx = parentMx *
-            glm::translate(glm::mat4(1.0f), translation) *
-            glm::yawPitchRoll(rotation.x, rotation.y, rotation.z) *
-            glm::scale(glm::mat4(1.0f), scale);
+        ComputeDerivedMxs();
     }
 
     glm::mat4 Node::GetModelMx() const
     {
-        return modelMx;
+        return store ? store->worldMxs[storeIdx] : modelMx;
+    }
+
+    glm::mat4 Node::GetInterpolatedModelMx(float alpha) const
+    {
+        return store ? store->GetInterpolatedWorldMx(storeIdx, alpha) : modelMx;
     }
 
     glm::vec3 Node::GetFront() const
@@ -155,30 +274,155 @@ namespace orc
         return GetModelMx() * worldOrigin;
     }
 
+    AABB Node::GetLocalBounds() const
+    {
+        return store ? store->localBounds[storeIdx] : localBounds;
+    }
+
+    AABB Node::GetWorldBounds() const
+    {
+        return store ? store->worldBounds[storeIdx] : worldBounds;
+    }
+
+    AABB Node::GetSubtreeBounds() const
+    {
+        if (store)
+        {
+            return store->subtreeBounds[storeIdx];
+        }
+
+        AABB bounds = worldBounds;
+        for (const std::shared_ptr<Node> &child : children)
+        {
+            bounds = Merge(bounds, child->GetSubtreeBounds());
+        }
+
+        return bounds;
+    }
+
     void Node::AttachChild(std::shared_ptr<Node> child)
     {
-        if (child->isAttached)
+        if (child->parent)
         {
             throw std::logic_error("Child is already attached to another node");
         }
 
-        child->parent = shared_from_this();
-        children.insert(child);
-        child->isAttached = true;
+        child->parent = this;
+        child->childIdx = children.size();
+        children.push_back(std::move(child));
+        children.back()->FlagDirty();
+
+        if (store)
+        {
+            store->MarkStale();
+            RecordChange(ChangeType::Attached, *children.back());
+        }
     }
 
     void Node::Detach()
     {
-        if (std::shared_ptr<Node> p = parent.lock())
+        if (!parent) return;
+
+        // Swap the last sibling into this node's slot. The parent's reference
+        // may be the last one keeping this node alive, so hold on to it until
+        // the parent no longer refers to this node.
+        std::vector<std::shared_ptr<Node>> &siblings = parent->children;
+        std::shared_ptr<Node> self = std::move(siblings[childIdx]);
+        if (childIdx != siblings.size() - 1)
         {
-            parent.reset();
-            p->children.erase(shared_from_this());
-            isAttached = false;
+            siblings[childIdx] = std::move(siblings.back());
+            siblings[childIdx]->childIdx = childIdx;
+        }
+        siblings.pop_back();
+
+        parent = nullptr;
+        childIdx = 0;
+        FlagDirty();
+
+        if (store)
+        {
+            store->MarkStale();
+            RecordChange(ChangeType::Detached);
         }
     }
 
-    const std::set<std::shared_ptr<Node>> &Node::GetChildren() const
+    NodeHandle Node::GetHandle() const
+    {
+        return handle;
+    }
+
+    const std::vector<std::shared_ptr<Node>> &Node::GetChildren() const
     {
         return children;
     }
+
+    void Node::MarkDirty()
+    {
+#ifdef ORC_CHANGE_JOURNAL
+        // Only the first change of each update is recorded
+        if (store && !store->transformed[storeIdx])
+        {
+            store->transformed[storeIdx] = 1;
+            RecordChange(ChangeType::Transformed);
+        }
+#endif
+        FlagDirty();
+    }
+
+    void Node::FlagDirty()
+    {
+        if (store)
+        {
+            store->dirty[storeIdx] = 1;
+        }
+        else
+        {
+            isDirty = true;
+        }
+    }
+
+    void Node::SetLocalBounds(const AABB &bounds)
+    {
+        if (store)
+        {
+            store->localBounds[storeIdx] = bounds;
+
+            // Content may have been added to or removed from the scene
+            store->MarkStale();
+        }
+        else
+        {
+            localBounds = bounds;
+        }
+
+        FlagDirty();
+    }
+
+    void Node::ComputeDerivedMxs()
+    {
+        // No-op
+    }
+
+    bool Node::HasDerivedMxs() const
+    {
+        return false;
+    }
+
+    void Node::ApplyOrientation(const glm::quat &orientation)
+    {
+        Transform &t = GetTransform();
+        t.Orientation = glm::normalize(orientation);
+        t.RotationMx = glm::mat3_cast(t.Orientation);
+        MarkDirty();
+    }
+
+    Transform &Node::GetTransform()
+    {
+        return store ? store->locals[storeIdx] : transform;
+    }
+
+    const Transform &Node::GetTransform() const
+    {
+        return store ? store->locals[storeIdx] : transform;
+    }
 }
@@ -1,19 +1,32 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
-#include <set>
+#include <vector>
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "bounds.hpp"
+#include "change_journal.hpp"
+#include "node_pool.hpp"
+#include "transform_store.hpp"
 #include "visitor.hpp"
 
 namespace orc
 {
     // The base class for points that exist in 3D space. Handles positioning
-    // math and implements spatial hierarchy.
+    // math and implements spatial hierarchy. While a node belongs to a scene,
+    // its transformation lives in the scene's TransformStore and the node acts
+    // as a handle into it.
     class Node : public std::enable_shared_from_this<Node>
     {
         public:
         static std::shared_ptr<Node> Create();
 
+        // Creates a node in pooled memory
+        static std::shared_ptr<Node> Create(NodePool &pool);
+
+        virtual ~Node();
+
         // Implements the visitor pattern. Each concrete subclass of Node should
         // override this method to dispatch the correct request to the visitor.
         virtual void Dispatch(NodeVisitor &visitor);
@@ -29,7 +42,8 @@ namespace orc
         void SetTranslation(float x, float y, float z);
 
         // Rotates the node by the specified yaw, pitch, and roll angles,
-        // expressed in radians. This operation has no effect until ComputeMxs
+        // expressed in radians. The angles are added to the node's current
+        // yaw, pitch, and roll. This operation has no effect until ComputeMxs
         // is called.
         void Rotate(float yaw, float pitch, float roll);
 
@@ -37,6 +51,30 @@ namespace orc
         // parent. This operation has no effect until ComputeMxs is called.
         void SetRotation(float yaw, float pitch, float roll);
 
+        // Sets the orientation of this node relative to the orientation of its
+        // parent. The quaternion does not need to be normalized. This
+        // operation has no effect until ComputeMxs is called.
+        void SetOrientation(const glm::quat &orientation);
+
+        // Returns the orientation of this node relative to the orientation of
+        // its parent
+        glm::quat GetOrientation() const;
+
+        // Rotates the node by angle radians around an axis expressed in the
+        // coordinate system of its parent. This operation has no effect until
+        // ComputeMxs is called.
+        void RotateAround(const glm::vec3 &axis, float angle);
+
+        // Same as above, but the axis passes through point, which is also
+        // expressed in the coordinate system of the node's parent. The node's
+        // translation orbits the point along with its orientation.
+        void RotateAround(const glm::vec3 &point, const glm::vec3 &axis, float angle);
+
+        // Spherically interpolates between the current orientation (t = 0)
+        // and target (t = 1), taking the shortest path. This operation has no
+        // effect until ComputeMxs is called.
+        void Slerp(const glm::quat &target, float t);
+
         // Scales the object along its local axes by the provided factors. Input
         // must be positive and non-zero. This operation has no effect until
         // ComputeMxs is called.
@@ -51,15 +89,26 @@ namespace orc
         // not update the model matrix until ComputeMxs is called.
         void SetTransformMx(glm::mat4 mx);
 
+        // Returns the transformation of this node relative to its parent,
+        // composed from its current translation, rotation, and scale. Unlike
+        // the model matrix, it doesn't wait for ComputeMxs.
+        glm::mat4 GetTransformMx() const;
+
         // Computes the model matrix based on the current translation and
         // rotation. If attached, calculations are relative to the orientation
         // of the parent. If detached, they are relative to the world's origin.
-        virtual void ComputeMxs();
+        void ComputeMxs();
 
         // Returns the model matrix produced by the last invocation of
         // ComputeMxs
         glm::mat4 GetModelMx() const;
 
+        // Returns the model matrix blended between the start of the scene's
+        // current fixed step (alpha = 0) and now (alpha = 1). Nodes that
+        // don't belong to a scene, or that haven't moved during the step,
+        // return their model matrix.
+        glm::mat4 GetInterpolatedModelMx(float alpha) const;
+
         // Returns a unit vector pointing in the direction of this node. If this
         // this node has not been rotated, the front vector aligns with the -Z
         // axis.
@@ -79,6 +128,21 @@ namespace orc
         // nodes are initialized at the origin.
         glm::vec3 GetPosition() const;
 
+        // Returns the bounds of this node's own content, e.g. an object's
+        // meshes, in its local coordinate space. Empty for nodes without any
+        // content of their own.
+        AABB GetLocalBounds() const;
+
+        // Returns the bounds of this node's own content in world space, as of
+        // the last invocation of ComputeMxs
+        AABB GetWorldBounds() const;
+
+        // Returns the world space bounds of this node's content and the
+        // content of all of its descendants. While the node belongs to a
+        // scene, these are maintained incrementally by Scene::Update.
+        // Otherwise, they are merged from the subtree on demand.
+        AABB GetSubtreeBounds() const;
+
         // Establishes a parent-child relationship between this Node and the
         // specified child. Assumes shared ownership of the child. All child
         // transformations will be relative to its parent.
@@ -88,20 +152,104 @@ namespace orc
         // Scene, but can still be manipulated and reattached at a later point.
         void Detach();
 
-        // Returns a Node's children
-        const std::set<std::shared_ptr<Node>> &GetChildren() const;
+        // Returns a handle that can be resolved by the pool this node was
+        // created from. Nodes that weren't created from a pool have a handle
+        // that never resolves.
+        NodeHandle GetHandle() const;
+
+        // Returns a Node's children. Detaching a child moves the last child
+        // into its place, so order is deterministic but not insertion order.
+        const std::vector<std::shared_ptr<Node>> &GetChildren() const;
 
         protected:
         // Creates a new node at the origin facing the -Z direction
         Node();
 
+        // Flags this node's matrices as stale so that the next scene update
+        // recomputes them, along with those of its descendants, and journals
+        // the node as transformed. Subclasses should call this whenever state
+        // that feeds into ComputeMxs changes.
+        void MarkDirty();
+
+        // Called whenever the model matrix is recomputed. Subclasses that
+        // derive additional matrices from the model matrix should override
+        // this, along with HasDerivedMxs.
+        virtual void ComputeDerivedMxs();
+
+        virtual bool HasDerivedMxs() const;
+
+        // Replaces the bounds of this node's own content. Subclasses should
+        // call this whenever their content changes. This also makes the scene
+        // re-collect the content it draws on its next update, so it is much
+        // more expensive than moving the node.
+        void SetLocalBounds(const AABB &bounds);
+
+        // Records a change to this node in the journal of the scene it
+        // belongs to, if any. Defined inline, and empty without
+        // ORC_CHANGE_JOURNAL, so that it compiles out entirely.
+        void RecordChange(ChangeType type);
+
         private:
-        glm::vec3 translation;
-        glm::vec3 rotation;
-        glm::vec3 scale;
+        friend class NodePool;
+        friend class TransformStore;
+
+        // Only used while the node does not belong to a TransformStore
+        Transform transform;
         glm::mat4 modelMx;
-        std::set<std::shared_ptr<Node>> children;
-        std::weak_ptr<Node> parent;
-        bool isAttached;
+        AABB localBounds, worldBounds;
+        bool isDirty;
+
+        // The yaw, pitch, and roll last passed to SetRotation, if the
+        // orientation hasn't been set any other way since
+        glm::vec3 angles;
+        bool hasAngles;
+
+        // Parents own their children, so a child's parent pointer is cleared
+        // before the parent is destroyed rather than tracked with a weak_ptr.
+        // Each child also knows its position among its siblings, so it can be
+        // detached without searching.
+        std::vector<std::shared_ptr<Node>> children;
+        Node *parent;
+        size_t childIdx;
+
+        NodeHandle handle;
+
+        // The store that holds this node's state, if any, and the node's
+        // position within it
+        TransformStore *store;
+        size_t storeIdx;
+
+        // Sets the orientation and rebuilds the cached rotation matrix
+        void ApplyOrientation(const glm::quat &orientation);
+
+        // Like MarkDirty, but for changes to the node's content or place in
+        // the hierarchy, which aren't journaled as transformations
+        void FlagDirty();
+
+        // Records a change to target, which may not belong to a store yet, in
+        // the journal of this node's store
+        void RecordChange(ChangeType type, Node &target);
+
+        Transform &GetTransform();
+        const Transform &GetTransform() const;
     };
+
+#ifdef ORC_CHANGE_JOURNAL
+    inline void Node::RecordChange(ChangeType type)
+    {
+        RecordChange(type, *this);
+    }
+
+    inline void Node::RecordChange(ChangeType type, Node &target)
+    {
+        if (store && store->journal)
+        {
+            store->journal->Record(type, target);
+        }
+    }
+#else
+    inline void Node::RecordChange(ChangeType) {}
+
+    inline void Node::RecordChange(ChangeType, Node &) {}
+#endif
 }
@@ -2,7 +2,11 @@
 #include <iostream>
 #include <sstream>
 #include <memory>
+#include <vector>
 #include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/euler_angles.hpp>
 #include <testutils/glm.hpp>
 #include "node.hpp"
 
@@ -20,3 +24,99 @@ TEST_CASE("Set transformation matrix", "[orc]")
 
     REQUIRE(testutils::Mat4Equals(n1->GetModelMx(), n2->GetModelMx()));
 }
+
+TEST_CASE("Yaw, pitch, and roll match glm", "[orc]")
+{
+    std::shared_ptr<orc::Node> n = orc::Node::Create();
+    n->SetRotation(0.7, -1.2, 2.9);
+    n->ComputeMxs();
+
+    REQUIRE(testutils::Mat4Equals(glm::yawPitchRoll(0.7f, -1.2f, 2.9f), n->GetModelMx()));
+
+    // Angles keep accumulating past the poles
+    n->Rotate(0.0, -1.0, 0.0);
+    n->ComputeMxs();
+
+    REQUIRE(testutils::Mat4Equals(glm::yawPitchRoll(0.7f, -2.2f, 2.9f), n->GetModelMx()));
+}
+
+TEST_CASE("Set orientation", "[orc]")
+{
+    glm::quat q = glm::angleAxis(1.1f, glm::normalize(glm::vec3(1.0f, 2.0f, -0.5f)));
+
+    std::shared_ptr<orc::Node> n = orc::Node::Create();
+    n->SetOrientation(q * 3.0f);
+    n->ComputeMxs();
+
+    REQUIRE(testutils::Mat4Equals(glm::mat4_cast(q), n->GetModelMx()));
+
+    // Yaw, pitch, and roll are recovered from the orientation
+    n->Rotate(0.2, 0.0, 0.0);
+    n->ComputeMxs();
+
+    REQUIRE(testutils::Mat4Equals(glm::mat4_cast(glm::angleAxis(0.2f, glm::vec3(0.0f, 1.0f, 0.0f)) * q), n->GetModelMx()));
+}
+
+TEST_CASE("Rotate around an axis", "[orc]")
+{
+    std::shared_ptr<orc::Node> n = orc::Node::Create();
+    n->SetTranslation(2, 0, 0);
+    n->RotateAround(glm::vec3(0.0f, 2.0f, 0.0f), glm::radians(90.0f));
+    n->ComputeMxs();
+
+    REQUIRE(testutils::Vec3Equals(glm::vec3(2.0f, 0.0f, 0.0f), n->GetPosition()));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(-1.0f, 0.0f, 0.0f), n->GetFront()));
+
+    n->RotateAround(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::radians(90.0f));
+    n->ComputeMxs();
+
+    REQUIRE(testutils::Vec3Equals(glm::vec3(1.0f, 0.0f, -1.0f), n->GetPosition()));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(0.0f, 0.0f, 1.0f), n->GetFront()));
+}
+
+TEST_CASE("Slerp orientation", "[orc]")
+{
+    std::shared_ptr<orc::Node> n = orc::Node::Create();
+    n->SetRotation(glm::radians(10.0f), 0.0, 0.0);
+    n->Slerp(glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f)), 0.5);
+    n->ComputeMxs();
+
+    REQUIRE(testutils::Mat4Equals(glm::yawPitchRoll(glm::radians(50.0f), 0.0f, 0.0f), n->GetModelMx()));
+}
+
+TEST_CASE("Detach swaps the last child into place", "[orc]")
+{
+    std::shared_ptr<orc::Node> parent = orc::Node::Create();
+    std::shared_ptr<orc::Node> children[4];
+    for (std::shared_ptr<orc::Node> &c : children)
+    {
+        c = orc::Node::Create();
+        parent->AttachChild(c);
+    }
+
+    children[1]->Detach();
+    REQUIRE(parent->GetChildren() == std::vector<std::shared_ptr<orc::Node>>{children[0], children[3], children[2]});
+
+    // The moved child can still be detached from its new position
+    children[3]->Detach();
+    children[2]->Detach();
+    REQUIRE(parent->GetChildren() == std::vector<std::shared_ptr<orc::Node>>{children[0]});
+
+    parent->AttachChild(children[1]);
+    REQUIRE(parent->GetChildren() == std::vector<std::shared_ptr<orc::Node>>{children[0], children[1]});
+}
+
+TEST_CASE("Children outlive their parent", "[orc]")
+{
+    std::shared_ptr<orc::Node> child = orc::Node::Create();
+    {
+        std::shared_ptr<orc::Node> parent = orc::Node::Create();
+        parent->AttachChild(child);
+    }
+
+    // Detaching is a no-op, and the child can be attached elsewhere
+    child->Detach();
+    std::shared_ptr<orc::Node> other = orc::Node::Create();
+    other->AttachChild(child);
+    REQUIRE(other->GetChildren().size() == 1);
+}
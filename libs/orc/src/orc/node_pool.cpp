@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "node.hpp"
+#include "node_pool.hpp"
+
+// Number of blocks in the first slab of each size class. Later slabs are as
+// large as all previous slabs combined, so capacity doubles each time.
+const size_t minSlabBlocks = 64;
+
+static size_t alignUp(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+namespace orc
+{
+    struct NodePool::Arena
+    {
+        // Blocks of a single size. Free blocks form a linked list through
+        // their first bytes.
+        struct SizeClass
+        {
+            size_t BlockSize;
+            size_t Capacity;
+            size_t NumFree;
+            std::byte *FreeList;
+        };
+
+        // Tracks the node occupying a slot, and how many times the slot has
+        // been reused
+        struct Slot
+        {
+            Node *Occupant;
+            uint32_t Generation;
+        };
+
+        std::vector<SizeClass> sizeClasses;
+        std::vector<std::unique_ptr<std::byte[]>> slabs;
+        std::vector<Slot> slots;
+        std::vector<uint32_t> freeSlots;
+        size_t numNodes = 0;
+
+        // Returns the index of the size class for blocks of the given size,
+        // adding it if needed. Node classes are few, so a linear search is
+        // cheaper than a map.
+        uint32_t FindSizeClass(size_t blockSize)
+        {
+            for (size_t i = 0; i < sizeClasses.size(); i++)
+            {
+                if (sizeClasses[i].BlockSize == blockSize) return i;
+            }
+
+            sizeClasses.push_back(SizeClass{
+                .BlockSize = blockSize,
+                .Capacity = 0,
+                .NumFree = 0,
+                .FreeList = nullptr,
+            });
+            return sizeClasses.size() - 1;
+        }
+
+        void AddSlab(uint32_t classIdx, size_t numBlocks)
+        {
+            SizeClass &sc = sizeClasses[classIdx];
+            slabs.push_back(std::make_unique<std::byte[]>(numBlocks * sc.BlockSize));
+            std::byte *slab = slabs.back().get();
+
+            // Link blocks back to front so that they are handed out in
+            // address order
+            for (size_t i = numBlocks; i-- > 0;)
+            {
+                std::byte *block = slab + i * sc.BlockSize;
+                *reinterpret_cast<uint32_t *>(block + sizeClassOffset) = classIdx;
+                *reinterpret_cast<std::byte **>(block) = sc.FreeList;
+                sc.FreeList = block;
+            }
+
+            sc.Capacity += numBlocks;
+            sc.NumFree += numBlocks;
+        }
+    };
+
+    bool NodeHandle::operator==(const NodeHandle &other) const
+    {
+        return Index == other.Index && Generation == other.Generation;
+    }
+
+    bool NodeHandle::operator!=(const NodeHandle &other) const
+    {
+        return !(*this == other);
+    }
+
+    NodePool::NodePool()
+        : arena(std::make_shared<Arena>())
+        {}
+
+    NodePool::~NodePool() {}
+
+    Node *NodePool::Resolve(NodeHandle handle) const
+    {
+        if (handle.Index >= arena->slots.size()) return nullptr;
+
+        const Arena::Slot &slot = arena->slots[handle.Index];
+        return slot.Generation == handle.Generation ? slot.Occupant : nullptr;
+    }
+
+    size_t NodePool::GetSize() const
+    {
+        return arena->numNodes;
+    }
+
+    size_t NodePool::GetNumSlabs() const
+    {
+        return arena->slabs.size();
+    }
+
+    void NodePool::Deleter::operator()(Node *node) const
+    {
+        ReleaseSlot(*arena, node);
+        node->~Node();
+    }
+
+    std::byte *NodePool::AllocateBlock(Arena &arena, size_t nodeSize)
+    {
+        uint32_t classIdx = arena.FindSizeClass(nodeOffset + alignUp(nodeSize, maxAlignment));
+        Arena::SizeClass &sc = arena.sizeClasses[classIdx];
+        if (!sc.FreeList)
+        {
+            arena.AddSlab(classIdx, std::max(minSlabBlocks, sc.Capacity));
+        }
+
+        std::byte *block = sc.FreeList;
+        sc.FreeList = *reinterpret_cast<std::byte **>(block);
+        sc.NumFree--;
+        return block;
+    }
+
+    void NodePool::FreeBlock(Arena &arena, std::byte *block)
+    {
+        Arena::SizeClass &sc = arena.sizeClasses[*reinterpret_cast<uint32_t *>(block + sizeClassOffset)];
+        *reinterpret_cast<std::byte **>(block) = sc.FreeList;
+        sc.FreeList = block;
+        sc.NumFree++;
+    }
+
+    std::byte *NodePool::GetNodeStorage(std::byte *block)
+    {
+        return block + nodeOffset;
+    }
+
+    void NodePool::AcquireSlot(Arena &arena, Node *node)
+    {
+        uint32_t idx;
+        if (arena.freeSlots.empty())
+        {
+            idx = arena.slots.size();
+            arena.slots.push_back(Arena::Slot{.Occupant = nullptr, .Generation = 1});
+        }
+        else
+        {
+            idx = arena.freeSlots.back();
+            arena.freeSlots.pop_back();
+        }
+
+        arena.slots[idx].Occupant = node;
+        node->handle = NodeHandle{.Index = idx, .Generation = arena.slots[idx].Generation};
+        arena.numNodes++;
+    }
+
+    void NodePool::ReleaseSlot(Arena &arena, Node *node)
+    {
+        // Bumping the generation invalidates every outstanding handle. Slots
+        // whose generation would wrap around are retired instead of reused,
+        // so that a handle can never refer to a later node by accident.
+        Arena::Slot &slot = arena.slots[node->handle.Index];
+        slot.Occupant = nullptr;
+        if (++slot.Generation != 0)
+        {
+            arena.freeSlots.push_back(node->handle.Index);
+        }
+
+        arena.numNodes--;
+    }
+
+    void NodePool::ReserveBlocks(size_t nodeSize, size_t count)
+    {
+        uint32_t classIdx = arena->FindSizeClass(nodeOffset + alignUp(nodeSize, maxAlignment));
+        Arena::SizeClass &sc = arena->sizeClasses[classIdx];
+        if (sc.NumFree < count)
+        {
+            arena->AddSlab(classIdx, count - sc.NumFree);
+        }
+
+        // Free slots are reused first, so only the remainder needs new slots
+        size_t numNewSlots = count - std::min(count, arena->freeSlots.size());
+        arena->slots.reserve(arena->slots.size() + numNewSlots);
+        arena->freeSlots.reserve(arena->slots.capacity());
+    }
+}
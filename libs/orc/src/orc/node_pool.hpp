@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace orc
+{
+    class Node;
+
+    // Refers to a node without keeping it alive. Every time a pooled node is
+    // destroyed, the generation of its slot is incremented, so handles to it
+    // can be detected as stale even after the slot is reused.
+    struct NodeHandle
+    {
+        uint32_t Index;
+
+        // Generation 0 is never issued, so a default handle is always stale
+        uint32_t Generation;
+
+        bool operator==(const NodeHandle &other) const;
+        bool operator!=(const NodeHandle &other) const;
+    };
+
+    // Allocates nodes from large slabs instead of the global heap. Nodes of
+    // the same size share a free list, and each node's shared_ptr control
+    // block lives in the same block as the node itself, so creating or
+    // destroying a pooled node is O(1) and only allocates when a slab fills
+    // up. Slabs double in size as they fill, or can be reserved up front.
+    //
+    // Pooled nodes keep the pool's memory alive, so they may safely outlive
+    // the pool. The pool is not thread safe: nodes must be created and
+    // destroyed by one thread at a time.
+    class NodePool
+    {
+        public:
+        NodePool();
+
+        ~NodePool();
+
+        NodePool(const NodePool &other) = delete;
+        void operator=(const NodePool &other) = delete;
+
+        // Placement-constructs a node of type T in pooled memory by calling
+        // construct with a pointer to uninitialized storage. Node classes
+        // call this from their Create factories, since their constructors are
+        // not public.
+        template <typename T, typename F>
+        std::shared_ptr<T> Create(F construct);
+
+        // Makes room for count more nodes of type T, allocating at most one
+        // slab
+        template <typename T>
+        void Reserve(size_t count);
+
+        // Returns the node a handle refers to, or nullptr if it has been
+        // destroyed
+        Node *Resolve(NodeHandle handle) const;
+
+        // Number of live nodes allocated from the pool
+        size_t GetSize() const;
+
+        // Number of slabs allocated from the global heap so far
+        size_t GetNumSlabs() const;
+
+        private:
+        // The pool's memory, shared with every node allocated from it
+        struct Arena;
+
+        // Frees a node's slot once it has been destroyed
+        struct Deleter
+        {
+            Arena *arena;
+
+            void operator()(Node *node) const;
+        };
+
+        // Hands shared_ptr the space reserved for its control block
+        template <typename U>
+        struct Allocator
+        {
+            using value_type = U;
+
+            std::shared_ptr<Arena> arena;
+            std::byte *controlBlock;
+
+            Allocator(std::shared_ptr<Arena> arena, std::byte *controlBlock);
+
+            template <typename V>
+            Allocator(const Allocator<V> &other);
+
+            U *allocate(size_t n);
+
+            void deallocate(U *p, size_t n);
+
+            template <typename V>
+            bool operator==(const Allocator<V> &other) const;
+
+            template <typename V>
+            bool operator!=(const Allocator<V> &other) const;
+        };
+
+        std::shared_ptr<Arena> arena;
+
+        // Non-template parts of Create and Reserve. Each block starts with
+        // the node's control block, followed by the node itself.
+        static std::byte *AllocateBlock(Arena &arena, size_t nodeSize);
+        static void FreeBlock(Arena &arena, std::byte *block);
+        static std::byte *GetNodeStorage(std::byte *block);
+        static void AcquireSlot(Arena &arena, Node *node);
+        static void ReleaseSlot(Arena &arena, Node *node);
+        void ReserveBlocks(size_t nodeSize, size_t count);
+
+        // Slab memory is only guaranteed to be aligned for the largest
+        // fundamental type
+        static constexpr size_t maxAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+        // Space set aside for a node's shared_ptr control block. Control
+        // blocks hold a vtable pointer, reference counts, the node pointer,
+        // the deleter, and the allocator, which comfortably fit on every
+        // standard library we build with.
+        static constexpr size_t controlBlockSize = 80;
+
+        // Each block records which size class it belongs to just after its
+        // control block, and the node follows, aligned for any fundamental
+        // type
+        static constexpr size_t sizeClassOffset = controlBlockSize;
+        static constexpr size_t nodeOffset = 96;
+    };
+
+    template <typename T, typename F>
+    std::shared_ptr<T> NodePool::Create(F construct)
+    {
+        static_assert(alignof(T) <= maxAlignment, "Node is over-aligned");
+
+        std::byte *block = AllocateBlock(*arena, sizeof(T));
+        T *node;
+        try
+        {
+            node = construct(GetNodeStorage(block));
+        }
+        catch (...)
+        {
+            FreeBlock(*arena, block);
+            throw;
+        }
+
+        AcquireSlot(*arena, node);
+        return std::shared_ptr<T>(
+            node,
+            Deleter{.arena = arena.get()},
+            Allocator<T>(arena, block)
+        );
+    }
+
+    template <typename T>
+    void NodePool::Reserve(size_t count)
+    {
+        ReserveBlocks(sizeof(T), count);
+    }
+
+    template <typename U>
+    NodePool::Allocator<U>::Allocator(std::shared_ptr<Arena> arena, std::byte *controlBlock)
+        : arena(std::move(arena))
+        , controlBlock(controlBlock)
+        {}
+
+    template <typename U>
+    template <typename V>
+    NodePool::Allocator<U>::Allocator(const Allocator<V> &other)
+        : arena(other.arena)
+        , controlBlock(other.controlBlock)
+        {}
+
+    template <typename U>
+    U *NodePool::Allocator<U>::allocate(size_t n)
+    {
+        // shared_ptr only allocates its control block, whose type is only
+        // known here, so it's checked when this is instantiated rather than
+        // after the node has been constructed
+        static_assert(sizeof(U) <= controlBlockSize, "Control block does not fit in pooled node");
+        static_assert(alignof(U) <= maxAlignment, "Control block is over-aligned");
+        return reinterpret_cast<U *>(controlBlock);
+    }
+
+    template <typename U>
+    void NodePool::Allocator<U>::deallocate(U *p, size_t n)
+    {
+        // The control block is the last thing in the block to be destroyed,
+        // so the whole block can be returned to the pool
+        FreeBlock(*arena, controlBlock);
+    }
+
+    template <typename U>
+    template <typename V>
+    bool NodePool::Allocator<U>::operator==(const Allocator<V> &other) const
+    {
+        return controlBlock == other.controlBlock;
+    }
+
+    template <typename U>
+    template <typename V>
+    bool NodePool::Allocator<U>::operator!=(const Allocator<V> &other) const
+    {
+        return !(*this == other);
+    }
+}
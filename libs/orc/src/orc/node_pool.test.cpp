@@ -0,0 +1,79 @@
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <catch2/catch_test_macros.hpp>
+#include "model.hpp"
+#include "node.hpp"
+#include "node_pool.hpp"
+#include "object.hpp"
+
+TEST_CASE("Resolve handles to pooled nodes", "[orc]") {
+    orc::NodePool pool;
+    std::shared_ptr<orc::Node> n1 = orc::Node::Create(pool);
+    std::shared_ptr<orc::Object> n2 = orc::Object::Create(pool);
+    orc::NodeHandle h1 = n1->GetHandle(), h2 = n2->GetHandle();
+
+    REQUIRE(pool.GetSize() == 2);
+    REQUIRE(pool.Resolve(h1) == n1.get());
+    REQUIRE(pool.Resolve(h2) == n2.get());
+
+    // Destroying a node invalidates its handle, even once its slot is reused
+    n1.reset();
+    REQUIRE(pool.Resolve(h1) == nullptr);
+
+    std::shared_ptr<orc::Node> n3 = orc::Node::Create(pool);
+    REQUIRE(n3->GetHandle().Index == h1.Index);
+    REQUIRE(n3->GetHandle() != h1);
+    REQUIRE(pool.Resolve(h1) == nullptr);
+    REQUIRE(pool.Resolve(n3->GetHandle()) == n3.get());
+    REQUIRE(pool.GetSize() == 2);
+
+    // Nodes that don't come from a pool never resolve
+    REQUIRE(pool.Resolve(orc::Node::Create()->GetHandle()) == nullptr);
+}
+
+TEST_CASE("Pooled nodes outlive their pool", "[orc]") {
+    std::shared_ptr<orc::Node> child;
+    {
+        orc::NodePool pool;
+        std::shared_ptr<orc::Node> parent = orc::Node::Create(pool);
+        child = orc::Node::Create(pool);
+        parent->AttachChild(child);
+    }
+
+    child->Translate(1.0f, 0.0f, 0.0f);
+    child->ComputeMxs();
+    REQUIRE(child->GetPosition().x == 1.0f);
+}
+
+TEST_CASE("Reuse blocks of destroyed nodes", "[orc]") {
+    orc::NodePool pool;
+    for (int i = 0; i < 1000; i++)
+    {
+        std::shared_ptr<orc::Object> o = orc::Object::Create(pool);
+    }
+
+    REQUIRE(pool.GetSize() == 0);
+    REQUIRE(pool.GetNumSlabs() == 1);
+}
+
+TEST_CASE("Import a large model into a few slabs", "[orc]") {
+    // Each object in an OBJ file becomes a separate node
+    const size_t numObjects = 50000;
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "orc_node_pool_test.obj";
+    {
+        std::ofstream obj(path);
+        obj << "v 0 0 0\nv 1 0 0\nv 0 1 0\n";
+        for (size_t i = 0; i < numObjects; i++)
+        {
+            obj << "o object" << i << "\nf 1 2 3\n";
+        }
+    }
+
+    orc::NodePool pool;
+    std::shared_ptr<orc::Object> model = orc::LoadModel(path.string(), pool);
+    std::filesystem::remove(path);
+
+    REQUIRE(pool.GetSize() > numObjects);
+    REQUIRE(pool.GetNumSlabs() == 1);
+}
@@ -1,6 +1,10 @@
 #include <memory>
+#include <new>
 #include <vector>
+#include "bounds.hpp"
+#include "change_journal.hpp"
 #include "mesh.hpp"
+#include "node_pool.hpp"
 #include "object.hpp"
 #include "types.hpp"
 #include "visitor.hpp"
@@ -12,6 +16,11 @@ namespace orc
         return std::shared_ptr<Object>(new Object());
     }
 
+    std::shared_ptr<Object> Object::Create(NodePool &pool)
+    {
+        return pool.Create<Object>([](void *mem) { return new (mem) Object(); });
+    }
+
     Object::Object() {}
 
     void Object::Dispatch(NodeVisitor &visitor)
@@ -21,7 +30,9 @@ namespace orc
 
     void Object::AddMesh(std::shared_ptr<Mesh> mesh)
     {
+        SetLocalBounds(Merge(GetLocalBounds(), mesh->GetBounds()));
         meshes.push_back(mesh);
+        RecordChange(ChangeType::MeshAdded);
     }
 
     const std::vector<const std::shared_ptr<Mesh>> &Object::GetMeshes() const
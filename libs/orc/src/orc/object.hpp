@@ -14,6 +14,8 @@ namespace orc
         public:
         static std::shared_ptr<Object> Create();
 
+        static std::shared_ptr<Object> Create(NodePool &pool);
+
         void Dispatch(NodeVisitor &visitor) override;
 
         void AddMesh(std::shared_ptr<Mesh> mesh);
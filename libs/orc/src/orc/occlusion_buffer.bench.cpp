@@ -0,0 +1,97 @@
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "camera.hpp"
+#include "mx_kernels.hpp"
+#include "occlusion_buffer.hpp"
+#include "worker_pool.hpp"
+
+TEST_CASE("Rasterize occluders and test boxes against them", "[orc][benchmark]") {
+    std::shared_ptr<orc::Camera> camera = orc::Camera::Create();
+    camera->SetClippingDistance(0.5f, 200.0f);
+    camera->ComputeMxs();
+
+    // Walls of a few hundred triangles each, across the view at increasing
+    // depths, like the rooms of an interior
+    std::vector<glm::vec3> points;
+    std::vector<uint32_t> indices;
+    const int gridSize = 12;
+    for (int y = 0; y <= gridSize; y++)
+    {
+        for (int x = 0; x <= gridSize; x++)
+        {
+            points.push_back(glm::vec3((float)x / gridSize - 0.5f, (float)y / gridSize - 0.5f, 0.0f));
+        }
+    }
+    for (int y = 0; y < gridSize; y++)
+    {
+        for (int x = 0; x < gridSize; x++)
+        {
+            uint32_t i = y * (gridSize + 1) + x;
+            indices.insert(indices.end(), {i, i + 1, i + gridSize + 2, i, i + gridSize + 2, i + gridSize + 1});
+        }
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> lateral(-30.0f, 30.0f);
+    std::uniform_real_distribution<float> depth(-150.0f, -5.0f);
+    std::vector<glm::mat4> wallMxs;
+    for (int i = 0; i < 16; i++)
+    {
+        glm::mat4 mx(1.0f);
+        mx[0][0] = 12.0f;
+        mx[1][1] = 8.0f;
+        mx[3] = glm::vec4(lateral(rng) * 0.5f, lateral(rng) * 0.2f, -10.0f - 8.0f * i, 1.0f);
+        wallMxs.push_back(mx);
+    }
+
+    std::vector<orc::AABB> boxes;
+    for (int i = 0; i < 10000; i++)
+    {
+        glm::vec3 corner(lateral(rng), lateral(rng) * 0.5f, depth(rng));
+        boxes.push_back(orc::AABB{.Min = corner, .Max = corner + glm::vec3(1.0f)});
+    }
+    std::vector<uint8_t> visible(boxes.size());
+
+    auto rasterize = [&](orc::OcclusionBuffer &buffer, orc::WorkerPool *pool) {
+        buffer.Begin(camera->GetViewProjectionMx());
+        for (const glm::mat4 &mx : wallMxs)
+        {
+            buffer.AddOccluder(points.data(), points.size(), sizeof(glm::vec3), indices.data(), indices.size(), mx);
+        }
+        buffer.Rasterize(pool);
+        return buffer.GetMaxDepth(buffer.GetNumLevels() - 1, 0, 0);
+    };
+
+    orc::OcclusionBuffer scalar(256, 128, orc::SimdLevel::Scalar);
+    orc::OcclusionBuffer simd;
+    orc::WorkerPool pool(4);
+
+    BENCHMARK("Rasterize 16 occluders, scalar") {
+        return rasterize(scalar, nullptr);
+    };
+
+    BENCHMARK("Rasterize 16 occluders, SIMD") {
+        return rasterize(simd, nullptr);
+    };
+
+    BENCHMARK("Rasterize 16 occluders, SIMD, 4 threads") {
+        return rasterize(simd, &pool);
+    };
+
+    rasterize(simd, nullptr);
+    BENCHMARK("Test 10k boxes") {
+        simd.TestAABBs(boxes.data(), boxes.size(), visible.data());
+        return visible[0];
+    };
+
+    BENCHMARK("Test 10k boxes, 4 threads") {
+        simd.TestAABBs(boxes.data(), boxes.size(), visible.data(), &pool);
+        return visible[0];
+    };
+}
@@ -0,0 +1,482 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "mx_kernels.hpp"
+#include "occlusion_buffer.hpp"
+#include "worker_pool.hpp"
+
+#if defined(__x86_64__)
+    #define ORC_SIMD_X86
+    #include <immintrin.h>
+#endif
+
+// Number of rows of the buffer that each task of a threaded rasterization
+// fills
+const int32_t bandHeight = 8;
+
+// Number of boxes that each task of a threaded test handles
+const size_t testBatchSize = 64;
+
+namespace orc
+{
+    using Triangle = OcclusionBuffer::Triangle;
+
+    // Clips a triangle in clip space against the near plane, z = -w, and
+    // writes the resulting polygon to out. Returns its number of vertices,
+    // which is 0, 3, or 4.
+    static int clipNear(const glm::vec4 in[3], glm::vec4 out[4])
+    {
+        int n = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            const glm::vec4 &a = in[i], &b = in[(i + 1) % 3];
+            float da = a.z + a.w, db = b.z + b.w;
+            if (da >= 0.0f) out[n++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f))
+            {
+                out[n++] = a + (b - a) * (da / (da - b.z - b.w));
+            }
+        }
+
+        return n;
+    }
+
+    // Sets up a triangle in clip space, entirely in front of the near plane,
+    // for rasterizing into a buffer of the given size. Returns false if it
+    // doesn't cover any pixel centers.
+    static bool setUpTriangle(glm::vec4 a, glm::vec4 b, glm::vec4 c, uint32_t width, uint32_t height, Triangle &out)
+    {
+        // Screen space positions, with the reciprocal of depth, which unlike
+        // depth itself varies linearly across the screen
+        glm::vec3 v[3];
+        const glm::vec4 *clip[3] = {&a, &b, &c};
+        for (int i = 0; i < 3; i++)
+        {
+            float invW = 1.0f / clip[i]->w;
+            v[i] = glm::vec3(
+                (clip[i]->x * invW * 0.5f + 0.5f) * width,
+                (clip[i]->y * invW * 0.5f + 0.5f) * height,
+                invW
+            );
+        }
+
+        // Both sides are rasterized, so clockwise triangles are flipped
+        float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+        if (area < 0.0f)
+        {
+            std::swap(v[1], v[2]);
+            area = -area;
+        }
+        if (!(area > 1e-6f)) return false;
+
+        // Pixel centers are at half coordinates. Bounds are clamped as floats
+        // first, since triangles that reach far off screen can be larger
+        // than any integer.
+        float minX = std::min({v[0].x, v[1].x, v[2].x}), maxX = std::max({v[0].x, v[1].x, v[2].x});
+        float minY = std::min({v[0].y, v[1].y, v[2].y}), maxY = std::max({v[0].y, v[1].y, v[2].y});
+        out.MinX = (int32_t)std::ceil(std::clamp(minX - 0.5f, 0.0f, (float)width));
+        out.MaxX = (int32_t)std::floor(std::clamp(maxX - 0.5f, -1.0f, width - 1.0f));
+        out.MinY = (int32_t)std::ceil(std::clamp(minY - 0.5f, 0.0f, (float)height));
+        out.MaxY = (int32_t)std::floor(std::clamp(maxY - 0.5f, -1.0f, height - 1.0f));
+        if (out.MinX > out.MaxX || out.MinY > out.MaxY) return false;
+
+        // The edge function of the edge from vertex i to vertex j is positive
+        // on the inside of the triangle. The reciprocal of depth is the
+        // average of the vertices' weighted by the edge functions opposite to
+        // them, which sum to the area.
+        out.InvDepthA = out.InvDepthB = out.InvDepthC = 0.0f;
+        for (int i = 0; i < 3; i++)
+        {
+            const glm::vec3 &vi = v[i], &vj = v[(i + 1) % 3], &opposite = v[(i + 2) % 3];
+            out.EdgeA[i] = vi.y - vj.y;
+            out.EdgeB[i] = vj.x - vi.x;
+            out.EdgeC[i] = (vj.y - vi.y) * vi.x - (vj.x - vi.x) * vi.y;
+            out.InvDepthA += out.EdgeA[i] * opposite.z / area;
+            out.InvDepthB += out.EdgeB[i] * opposite.z / area;
+            out.InvDepthC += out.EdgeC[i] * opposite.z / area;
+        }
+
+        return true;
+    }
+
+    // Rasterizes rows [minY, maxY] of a triangle, keeping the nearest depth of
+    // each pixel. Every implementation computes the edge functions and depth
+    // of each pixel with exactly the same operations, so they produce
+    // identical buffers.
+    static void rasterizeRowsScalar(const Triangle &t, int32_t minY, int32_t maxY, float *depths, uint32_t stride)
+    {
+        for (int32_t y = minY; y <= maxY; y++)
+        {
+            float py = (float)y + 0.5f;
+            float *row = depths + (size_t)y * stride;
+            for (int32_t x = t.MinX; x <= t.MaxX; x++)
+            {
+                float px = (float)x + 0.5f;
+                float e0 = t.EdgeA[0] * px + t.EdgeB[0] * py + t.EdgeC[0];
+                float e1 = t.EdgeA[1] * px + t.EdgeB[1] * py + t.EdgeC[1];
+                float e2 = t.EdgeA[2] * px + t.EdgeB[2] * py + t.EdgeC[2];
+                if (!(e0 > 0.0f && e1 > 0.0f && e2 > 0.0f)) continue;
+
+                float depth = 1.0f / (t.InvDepthA * px + t.InvDepthB * py + t.InvDepthC);
+                row[x] = std::min(row[x], depth);
+            }
+        }
+    }
+
+#ifdef ORC_SIMD_X86
+    // Same as above, four pixels at a time. Groups start at multiples of 4,
+    // which the padding of each row keeps within the buffer.
+    static void rasterizeRowsSse(const Triangle &t, int32_t minY, int32_t maxY, float *depths, uint32_t stride)
+    {
+        const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        __m128 a0 = _mm_set1_ps(t.EdgeA[0]), a1 = _mm_set1_ps(t.EdgeA[1]), a2 = _mm_set1_ps(t.EdgeA[2]);
+        __m128 za = _mm_set1_ps(t.InvDepthA);
+
+        for (int32_t y = minY; y <= maxY; y++)
+        {
+            float py = (float)y + 0.5f;
+            float *row = depths + (size_t)y * stride;
+
+            // Terms that only depend on the row, added in the same order as
+            // the scalar rasterizer adds them
+            __m128 b0 = _mm_set1_ps(t.EdgeB[0] * py), b1 = _mm_set1_ps(t.EdgeB[1] * py), b2 = _mm_set1_ps(t.EdgeB[2] * py);
+            __m128 c0 = _mm_set1_ps(t.EdgeC[0]), c1 = _mm_set1_ps(t.EdgeC[1]), c2 = _mm_set1_ps(t.EdgeC[2]);
+            __m128 zb = _mm_set1_ps(t.InvDepthB * py), zc = _mm_set1_ps(t.InvDepthC);
+
+            for (int32_t x = t.MinX & ~3; x <= t.MaxX; x += 4)
+            {
+                __m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+                __m128 e0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, px), b0), c0);
+                __m128 e1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a1, px), b1), c1);
+                __m128 e2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a2, px), b2), c2);
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(e0, zero), _mm_cmpgt_ps(e1, zero)), _mm_cmpgt_ps(e2, zero));
+                if (_mm_movemask_ps(inside) == 0) continue;
+
+                __m128 depth = _mm_div_ps(one, _mm_add_ps(_mm_add_ps(_mm_mul_ps(za, px), zb), zc));
+                __m128 old = _mm_loadu_ps(row + x);
+                __m128 nearest = _mm_min_ps(old, depth);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+            }
+        }
+    }
+#endif
+
+    OcclusionBuffer::OcclusionBuffer(uint32_t width, uint32_t height, SimdLevel level)
+        : width(width)
+        , height(height)
+        , stride((width + 3) & ~3u)
+        , depths((size_t)stride * height, std::numeric_limits<float>::infinity())
+        , viewProjectionMx(1.0f)
+        , rasterizeRows(rasterizeRowsScalar)
+    {
+        if (width == 0 || height == 0)
+        {
+            throw std::logic_error("Occlusion buffer must have at least one pixel");
+        }
+
+        if (level > GetSupportedSimdLevel())
+        {
+            throw std::runtime_error("Instruction set is not supported by this CPU");
+        }
+
+#ifdef ORC_SIMD_X86
+        // The rasterizer doesn't benefit from wider registers, since most
+        // triangles of a low resolution buffer are only a few pixels wide
+        if (level >= SimdLevel::SSE)
+        {
+            rasterizeRows = rasterizeRowsSse;
+        }
+#endif
+
+        uint32_t w = width, h = height;
+        while (w > 1 || h > 1)
+        {
+            w = (w + 1) / 2;
+            h = (h + 1) / 2;
+            levels.push_back(Level{
+                .Width = w,
+                .Height = h,
+                .MinDepths = std::vector<float>((size_t)w * h),
+                .MaxDepths = std::vector<float>((size_t)w * h),
+            });
+        }
+    }
+
+    uint32_t OcclusionBuffer::GetWidth() const
+    {
+        return width;
+    }
+
+    uint32_t OcclusionBuffer::GetHeight() const
+    {
+        return height;
+    }
+
+    void OcclusionBuffer::Begin(const glm::mat4 &viewProjectionMx)
+    {
+        this->viewProjectionMx = viewProjectionMx;
+        occluders.clear();
+    }
+
+    void OcclusionBuffer::AddOccluder(
+        const glm::vec3 *points,
+        size_t count,
+        size_t stride,
+        const uint32_t *indices,
+        size_t numIndices,
+        const glm::mat4 &modelMx
+    )
+    {
+        occluders.push_back(Occluder{
+            .Points = points,
+            .Count = count,
+            .Stride = stride,
+            .Indices = indices,
+            .NumIndices = numIndices,
+            .TransformMx = viewProjectionMx * modelMx,
+        });
+    }
+
+    void OcclusionBuffer::Rasterize(WorkerPool *pool)
+    {
+        // Results of the setup pass are kept for as many occluders as there
+        // have ever been, so that their buffers are reused
+        if (occluderTriangles.size() < occluders.size())
+        {
+            occluderTriangles.resize(occluders.size());
+        }
+
+        size_t numBands = (height + bandHeight - 1) / bandHeight;
+        if (pool)
+        {
+            pool->Run(occluders.size(), [this](size_t i) { SetUpOccluder(i); });
+            pool->Run(numBands, [this](size_t band) { RasterizeBand(band); });
+        }
+        else
+        {
+            for (size_t i = 0; i < occluders.size(); i++) SetUpOccluder(i);
+            for (size_t band = 0; band < numBands; band++) RasterizeBand(band);
+        }
+
+        BuildPyramid();
+    }
+
+    void OcclusionBuffer::SetUpOccluder(size_t i)
+    {
+        const Occluder &occluder = occluders[i];
+        OccluderTriangles &out = occluderTriangles[i];
+
+        out.ClipPoints.resize(occluder.Count);
+        const char *bytes = reinterpret_cast<const char *>(occluder.Points);
+        for (size_t k = 0; k < occluder.Count; k++)
+        {
+            glm::vec3 point = *reinterpret_cast<const glm::vec3 *>(bytes + k * occluder.Stride);
+            out.ClipPoints[k] = occluder.TransformMx * glm::vec4(point, 1.0f);
+        }
+
+        out.Triangles.clear();
+        for (size_t k = 0; k + 2 < occluder.NumIndices; k += 3)
+        {
+            glm::vec4 in[3] = {
+                out.ClipPoints[occluder.Indices[k]],
+                out.ClipPoints[occluder.Indices[k + 1]],
+                out.ClipPoints[occluder.Indices[k + 2]],
+            };
+
+            // Clipping against the near plane leaves a triangle or a quad,
+            // which is split into two triangles
+            glm::vec4 clipped[4];
+            int n = clipNear(in, clipped);
+            for (int j = 2; j < n; j++)
+            {
+                Triangle triangle;
+                if (setUpTriangle(clipped[0], clipped[j - 1], clipped[j], width, height, triangle))
+                {
+                    out.Triangles.push_back(triangle);
+                }
+            }
+        }
+    }
+
+    void OcclusionBuffer::RasterizeBand(size_t band)
+    {
+        int32_t minY = band * bandHeight;
+        int32_t maxY = std::min(minY + bandHeight, (int32_t)height) - 1;
+        std::fill(depths.begin() + (size_t)minY * stride, depths.begin() + (size_t)(maxY + 1) * stride, std::numeric_limits<float>::infinity());
+
+        for (size_t i = 0; i < occluders.size(); i++)
+        {
+            for (const Triangle &triangle : occluderTriangles[i].Triangles)
+            {
+                if (triangle.MaxY < minY || triangle.MinY > maxY) continue;
+
+                rasterizeRows(triangle, std::max(minY, triangle.MinY), std::min(maxY, triangle.MaxY), depths.data(), stride);
+            }
+        }
+    }
+
+    void OcclusionBuffer::BuildPyramid()
+    {
+        // Texels of odd sized levels that hang over the edge of the level
+        // below only cover the texels that exist
+        for (size_t l = 0; l < levels.size(); l++)
+        {
+            Level &level = levels[l];
+            uint32_t belowWidth = l == 0 ? width : levels[l - 1].Width;
+            uint32_t belowHeight = l == 0 ? height : levels[l - 1].Height;
+            for (uint32_t y = 0; y < level.Height; y++)
+            {
+                for (uint32_t x = 0; x < level.Width; x++)
+                {
+                    float minDepth = std::numeric_limits<float>::infinity(), maxDepth = 0.0f;
+                    for (uint32_t by = 2 * y; by < std::min(2 * y + 2, belowHeight); by++)
+                    {
+                        for (uint32_t bx = 2 * x; bx < std::min(2 * x + 2, belowWidth); bx++)
+                        {
+                            minDepth = std::min(minDepth, GetMinDepth(l, bx, by));
+                            maxDepth = std::max(maxDepth, GetMaxDepth(l, bx, by));
+                        }
+                    }
+
+                    level.MinDepths[(size_t)y * level.Width + x] = minDepth;
+                    level.MaxDepths[(size_t)y * level.Width + x] = maxDepth;
+                }
+            }
+        }
+    }
+
+    bool OcclusionBuffer::IsVisible(const AABB &box) const
+    {
+        if (IsEmpty(box)) return false;
+
+        // The box covers the screen space bounds of its corners, and is no
+        // nearer than its nearest corner
+        float minX = std::numeric_limits<float>::infinity(), maxX = -minX;
+        float minY = minX, maxY = -minX;
+        float depth = minX;
+        for (int i = 0; i < 8; i++)
+        {
+            glm::vec4 corner(
+                i & 1 ? box.Max.x : box.Min.x,
+                i & 2 ? box.Max.y : box.Min.y,
+                i & 4 ? box.Max.z : box.Min.z,
+                1.0f
+            );
+            glm::vec4 clip = viewProjectionMx * corner;
+            if (clip.z < -clip.w) return true;
+
+            float x = (clip.x / clip.w * 0.5f + 0.5f) * width;
+            float y = (clip.y / clip.w * 0.5f + 0.5f) * height;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            depth = std::min(depth, clip.w);
+        }
+
+        if (maxX < 0.0f || maxY < 0.0f || minX >= width || minY >= height) return false;
+
+        // Every pixel that the bounds touch, not only those whose centers
+        // they contain, since the box could cover any part of them
+        int32_t x0 = (int32_t)std::max(minX, 0.0f);
+        int32_t y0 = (int32_t)std::max(minY, 0.0f);
+        int32_t x1 = (int32_t)std::min(maxX, width - 1.0f);
+        int32_t y1 = (int32_t)std::min(maxY, height - 1.0f);
+
+        // Start at the finest level at which the pixels fit within 2x2
+        // texels, which is usually enough to decide
+        uint32_t level = 0;
+        while ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)
+        {
+            level++;
+        }
+
+        return IsRegionVisible(level, x0, y0, x1, y1, depth);
+    }
+
+    bool OcclusionBuffer::IsRegionVisible(uint32_t level, int32_t x0, int32_t y0, int32_t x1, int32_t y1, float depth) const
+    {
+        for (int32_t y = y0 >> level; y <= y1 >> level; y++)
+        {
+            for (int32_t x = x0 >> level; x <= x1 >> level; x++)
+            {
+                // Hidden behind every occluder of the texel, or in front of
+                // all of them
+                if (depth > GetMaxDepth(level, x, y)) continue;
+                if (depth <= GetMinDepth(level, x, y) || level == 0) return true;
+
+                // Only the part of the region within the texel needs to be
+                // looked at more closely
+                int32_t size = 1 << level;
+                if (IsRegionVisible(
+                    level - 1,
+                    std::max(x0, x * size),
+                    std::max(y0, y * size),
+                    std::min(x1, (x + 1) * size - 1),
+                    std::min(y1, (y + 1) * size - 1),
+                    depth
+                )) return true;
+            }
+        }
+
+        return false;
+    }
+
+    void OcclusionBuffer::TestAABBs(const AABB *boxes, size_t count, uint8_t *visible, WorkerPool *pool) const
+    {
+        // The batch is captured by reference, so that the task is small
+        // enough for std::function to store without allocating
+        struct Batch
+        {
+            const AABB *Boxes;
+            size_t Count;
+            uint8_t *Visible;
+        } args{.Boxes = boxes, .Count = count, .Visible = visible};
+        auto testBatch = [this, &args](size_t batch) {
+            size_t end = std::min(args.Count, (batch + 1) * testBatchSize);
+            for (size_t i = batch * testBatchSize; i < end; i++)
+            {
+                args.Visible[i] = IsVisible(args.Boxes[i]);
+            }
+        };
+
+        size_t numBatches = (count + testBatchSize - 1) / testBatchSize;
+        if (pool)
+        {
+            pool->Run(numBatches, testBatch);
+        }
+        else
+        {
+            for (size_t batch = 0; batch < numBatches; batch++) testBatch(batch);
+        }
+    }
+
+    uint32_t OcclusionBuffer::GetNumLevels() const
+    {
+        return levels.size() + 1;
+    }
+
+    float OcclusionBuffer::GetMinDepth(uint32_t level, uint32_t x, uint32_t y) const
+    {
+        if (level == 0) return depths[(size_t)y * stride + x];
+
+        const Level &l = levels[level - 1];
+        return l.MinDepths[(size_t)y * l.Width + x];
+    }
+
+    float OcclusionBuffer::GetMaxDepth(uint32_t level, uint32_t x, uint32_t y) const
+    {
+        if (level == 0) return depths[(size_t)y * stride + x];
+
+        const Level &l = levels[level - 1];
+        return l.MaxDepths[(size_t)y * l.Width + x];
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "mx_kernels.hpp"
+#include "worker_pool.hpp"
+
+namespace orc
+{
+    // A low resolution depth buffer, rasterized on the CPU from a few large
+    // occluders, that tells whether anything behind them could be visible.
+    // Depths are distances in front of the camera, the w component of a
+    // point in clip space. Pixels that no occluder covers are infinitely far
+    // away, so nothing is hidden behind them.
+    //
+    // After rasterizing, a pyramid of the nearest and furthest depth of
+    // every 2x2 block of the level below is built on top of the buffer, so
+    // that a box covering many pixels can usually be tested against a few
+    // texels of a coarser level. Tests are conservative with respect to the
+    // buffer: a box is only reported hidden if every pixel it could cover
+    // has an occluder in front of all of it.
+    //
+    // Occluders are rasterized from both sides, so open meshes such as walls
+    // occlude from either side. A pixel is covered if its center is inside
+    // of a triangle.
+    class OcclusionBuffer
+    {
+        public:
+        // Throws if the host CPU does not support the instruction set
+        OcclusionBuffer(uint32_t width = 256, uint32_t height = 128, SimdLevel level = GetSupportedSimdLevel());
+
+        uint32_t GetWidth() const;
+
+        uint32_t GetHeight() const;
+
+        // Starts a new frame, seen through viewProjectionMx. Forgets every
+        // occluder added for the last frame.
+        void Begin(const glm::mat4 &viewProjectionMx);
+
+        // Adds the triangles of a mesh, transformed by modelMx, to the
+        // occluders of the frame. Points are read the same way as
+        // TriangleMesh reads them. Neither points nor indices are copied, so
+        // they must stay alive until Rasterize returns.
+        void AddOccluder(
+            const glm::vec3 *points,
+            size_t count,
+            size_t stride,
+            const uint32_t *indices,
+            size_t numIndices,
+            const glm::mat4 &modelMx
+        );
+
+        // Rasterizes every occluder of the frame and builds the depth
+        // pyramid. If a pool is given, occluders are transformed and
+        // horizontal bands of the buffer are rasterized on its threads.
+        // Results are identical regardless of thread count and instruction
+        // set.
+        void Rasterize(WorkerPool *pool = nullptr);
+
+        // Returns false if a world space box is entirely hidden behind the
+        // occluders. Boxes that reach behind the camera's near plane are
+        // always visible, and boxes outside of the view never are.
+        bool IsVisible(const AABB &box) const;
+
+        // Tests a batch of boxes at once, writing 1 to visible[k] if boxes[k]
+        // may be visible and 0 otherwise, spreading them across the threads
+        // of a pool if one is given
+        void TestAABBs(const AABB *boxes, size_t count, uint8_t *visible, WorkerPool *pool = nullptr) const;
+
+        // Number of levels of the pyramid, including the buffer itself
+        uint32_t GetNumLevels() const;
+
+        // Returns the nearest and furthest depth of a texel of the pyramid.
+        // Texel (x, y) of a level covers pixels [x * 2^level, (x + 1) *
+        // 2^level) of the buffer, and likewise for y. Rows are numbered from
+        // the bottom of the screen.
+        float GetMinDepth(uint32_t level, uint32_t x, uint32_t y) const;
+
+        float GetMaxDepth(uint32_t level, uint32_t x, uint32_t y) const;
+
+        // An occluder's triangle in screen space, set up for rasterizing.
+        // Each edge function, and the reciprocal of depth, is a plane
+        // A * x + B * y + C over the pixel centers (x, y).
+        struct Triangle
+        {
+            float EdgeA[3], EdgeB[3], EdgeC[3];
+            float InvDepthA, InvDepthB, InvDepthC;
+            int32_t MinX, MaxX, MinY, MaxY;
+        };
+
+        private:
+        struct Occluder
+        {
+            const glm::vec3 *Points;
+            size_t Count;
+            size_t Stride;
+            const uint32_t *Indices;
+            size_t NumIndices;
+            glm::mat4 TransformMx;
+        };
+
+        // Per occluder results of the setup pass, reused between frames
+        struct OccluderTriangles
+        {
+            std::vector<glm::vec4> ClipPoints;
+            std::vector<Triangle> Triangles;
+        };
+
+        struct Level
+        {
+            uint32_t Width, Height;
+            std::vector<float> MinDepths, MaxDepths;
+        };
+
+        uint32_t width, height;
+
+        // Rows of the buffer are padded to a multiple of 4 pixels, so that
+        // SIMD rasterizers can always write whole groups of pixels
+        uint32_t stride;
+        std::vector<float> depths;
+
+        // Levels 1 and up of the pyramid. Level 0 is the buffer itself.
+        std::vector<Level> levels;
+
+        glm::mat4 viewProjectionMx;
+        std::vector<Occluder> occluders;
+        std::vector<OccluderTriangles> occluderTriangles;
+
+        void (*rasterizeRows)(const Triangle &triangle, int32_t minY, int32_t maxY, float *depths, uint32_t stride);
+
+        void SetUpOccluder(size_t i);
+
+        void RasterizeBand(size_t band);
+
+        void BuildPyramid();
+
+        bool IsRegionVisible(uint32_t level, int32_t x0, int32_t y0, int32_t x1, int32_t y1, float depth) const;
+    };
+}
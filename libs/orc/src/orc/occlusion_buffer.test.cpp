@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "camera.hpp"
+#include "mx_kernels.hpp"
+#include "occlusion_buffer.hpp"
+#include "worker_pool.hpp"
+
+// A camera at the origin looking down -Z, with the same aspect ratio as the
+// default occlusion buffer
+static std::shared_ptr<orc::Camera> buildCamera()
+{
+    std::shared_ptr<orc::Camera> camera = orc::Camera::Create();
+    camera->SetAspectRatio(2.0f);
+    camera->SetClippingDistance(0.5f, 200.0f);
+    camera->ComputeMxs();
+    return camera;
+}
+
+// A 10 by 10 wall facing the camera, 20 units in front of it
+const std::vector<glm::vec3> wallPoints = {
+    glm::vec3(-5.0f, -5.0f, -20.0f),
+    glm::vec3(5.0f, -5.0f, -20.0f),
+    glm::vec3(5.0f, 5.0f, -20.0f),
+    glm::vec3(-5.0f, 5.0f, -20.0f),
+};
+const std::vector<uint32_t> wallIndices = {0, 1, 2, 2, 3, 0};
+
+TEST_CASE("Boxes hidden behind occluders are culled", "[orc]") {
+    std::shared_ptr<orc::Camera> camera = buildCamera();
+    orc::OcclusionBuffer buffer;
+
+    // Nothing is hidden without occluders
+    buffer.Begin(camera->GetViewProjectionMx());
+    buffer.Rasterize();
+    REQUIRE(buffer.IsVisible(orc::AABB{.Min = glm::vec3(-1.0f, -1.0f, -40.0f), .Max = glm::vec3(1.0f, 1.0f, -30.0f)}));
+
+    // The wall's winding doesn't matter, and neither does which side of it
+    // the camera is on
+    const std::vector<uint32_t> backwards(wallIndices.rbegin(), wallIndices.rend());
+    for (const std::vector<uint32_t> *indices : {&wallIndices, &backwards})
+    {
+        buffer.Begin(camera->GetViewProjectionMx());
+        buffer.AddOccluder(wallPoints.data(), wallPoints.size(), sizeof(glm::vec3), indices->data(), indices->size(), glm::mat4(1.0f));
+        buffer.Rasterize();
+
+        // Behind the wall
+        REQUIRE_FALSE(buffer.IsVisible(orc::AABB{.Min = glm::vec3(-1.0f, -1.0f, -40.0f), .Max = glm::vec3(1.0f, 1.0f, -30.0f)}));
+        REQUIRE_FALSE(buffer.IsVisible(orc::AABB{.Min = glm::vec3(-9.0f, -9.0f, -100.0f), .Max = glm::vec3(9.0f, 9.0f, -40.0f)}));
+
+        // In front of the wall, or through it
+        REQUIRE(buffer.IsVisible(orc::AABB{.Min = glm::vec3(-1.0f, -1.0f, -15.0f), .Max = glm::vec3(1.0f, 1.0f, -12.0f)}));
+        REQUIRE(buffer.IsVisible(orc::AABB{.Min = glm::vec3(-1.0f, -1.0f, -25.0f), .Max = glm::vec3(1.0f, 1.0f, -19.0f)}));
+
+        // Behind the wall, but peeking out from behind it
+        REQUIRE(buffer.IsVisible(orc::AABB{.Min = glm::vec3(-15.0f, -15.0f, -50.0f), .Max = glm::vec3(15.0f, 15.0f, -40.0f)}));
+        REQUIRE(buffer.IsVisible(orc::AABB{.Min = glm::vec3(4.0f, -1.0f, -40.0f), .Max = glm::vec3(8.0f, 1.0f, -30.0f)}));
+
+        // Reaching behind the camera, or out of view entirely
+        REQUIRE(buffer.IsVisible(orc::AABB{.Min = glm::vec3(-1.0f, -1.0f, -30.0f), .Max = glm::vec3(1.0f, 1.0f, 1.0f)}));
+        REQUIRE_FALSE(buffer.IsVisible(orc::AABB{.Min = glm::vec3(100.0f, 0.0f, -30.0f), .Max = glm::vec3(101.0f, 1.0f, -29.0f)}));
+
+        // Empty boxes are never visible
+        REQUIRE_FALSE(buffer.IsVisible(orc::EmptyAABB()));
+    }
+
+    // The wall moves with its model matrix
+    glm::mat4 modelMx(1.0f);
+    modelMx[3] = glm::vec4(20.0f, 0.0f, -20.0f, 1.0f);
+    buffer.Begin(camera->GetViewProjectionMx());
+    buffer.AddOccluder(wallPoints.data(), wallPoints.size(), sizeof(glm::vec3), wallIndices.data(), wallIndices.size(), modelMx);
+    buffer.Rasterize();
+    REQUIRE(buffer.IsVisible(orc::AABB{.Min = glm::vec3(-1.0f, -1.0f, -40.0f), .Max = glm::vec3(1.0f, 1.0f, -30.0f)}));
+    REQUIRE_FALSE(buffer.IsVisible(orc::AABB{.Min = glm::vec3(38.0f, -1.0f, -80.0f), .Max = glm::vec3(42.0f, 1.0f, -70.0f)}));
+}
+
+TEST_CASE("Depth pyramid bounds the depths beneath it", "[orc]") {
+    std::shared_ptr<orc::Camera> camera = buildCamera();
+
+    // An odd size, so that the edges of the pyramid's levels hang over
+    orc::OcclusionBuffer buffer(99, 50);
+    buffer.Begin(camera->GetViewProjectionMx());
+    buffer.AddOccluder(wallPoints.data(), wallPoints.size(), sizeof(glm::vec3), wallIndices.data(), wallIndices.size(), glm::mat4(1.0f));
+    buffer.Rasterize();
+
+    // Depth is the distance in front of the camera
+    REQUIRE(std::abs(buffer.GetMinDepth(0, 49, 25) - 20.0f) < 1e-3f);
+    REQUIRE(std::isinf(buffer.GetMinDepth(0, 0, 0)));
+
+    REQUIRE(buffer.GetNumLevels() == 8);
+    for (uint32_t level = 1; level < buffer.GetNumLevels(); level++)
+    {
+        uint32_t size = 1 << level;
+        for (uint32_t y = 0; y < buffer.GetHeight(); y++)
+        {
+            for (uint32_t x = 0; x < buffer.GetWidth(); x++)
+            {
+                float depth = buffer.GetMinDepth(0, x, y);
+                REQUIRE(buffer.GetMinDepth(level, x / size, y / size) <= depth);
+                REQUIRE(buffer.GetMaxDepth(level, x / size, y / size) >= depth);
+            }
+        }
+    }
+
+    // The top of the pyramid covers the whole buffer
+    uint32_t top = buffer.GetNumLevels() - 1;
+    REQUIRE(std::abs(buffer.GetMinDepth(top, 0, 0) - 20.0f) < 1e-3f);
+    REQUIRE(std::isinf(buffer.GetMaxDepth(top, 0, 0)));
+}
+
+TEST_CASE("Occlusion results don't depend on instruction set or threads", "[orc]") {
+    std::shared_ptr<orc::Camera> camera = buildCamera();
+
+    // Triangles all over the view, some of which cross the near plane or
+    // reach behind the camera
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> lateral(-30.0f, 30.0f);
+    std::uniform_real_distribution<float> depth(-60.0f, 2.0f);
+    std::vector<glm::vec3> points;
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < 600; i++)
+    {
+        points.push_back(glm::vec3(lateral(rng), lateral(rng), depth(rng)));
+        indices.push_back(i);
+    }
+
+    std::vector<orc::AABB> boxes;
+    for (int i = 0; i < 1000; i++)
+    {
+        glm::vec3 corner(lateral(rng), lateral(rng), depth(rng));
+        boxes.push_back(orc::AABB{.Min = corner, .Max = corner + glm::vec3(1.0f, 2.0f, 3.0f)});
+    }
+
+    auto run = [&](orc::SimdLevel level, orc::WorkerPool *pool, std::vector<float> &depths, std::vector<uint8_t> &visible) {
+        orc::OcclusionBuffer buffer(250, 125, level);
+        buffer.Begin(camera->GetViewProjectionMx());
+
+        // Split across several occluders, so that they're set up in parallel
+        for (size_t first = 0; first < indices.size(); first += 60)
+        {
+            buffer.AddOccluder(points.data(), points.size(), sizeof(glm::vec3), indices.data() + first, 60, glm::mat4(1.0f));
+        }
+        buffer.Rasterize(pool);
+
+        for (uint32_t l = 0; l < buffer.GetNumLevels(); l++)
+        {
+            for (uint32_t y = 0; y < (buffer.GetHeight() >> l); y++)
+            {
+                for (uint32_t x = 0; x < (buffer.GetWidth() >> l); x++)
+                {
+                    depths.push_back(buffer.GetMinDepth(l, x, y));
+                    depths.push_back(buffer.GetMaxDepth(l, x, y));
+                }
+            }
+        }
+
+        visible.resize(boxes.size());
+        buffer.TestAABBs(boxes.data(), boxes.size(), visible.data(), pool);
+    };
+
+    std::vector<float> expectedDepths;
+    std::vector<uint8_t> expectedVisible;
+    run(orc::SimdLevel::Scalar, nullptr, expectedDepths, expectedVisible);
+
+    // Some of the boxes are hidden, but not all of them
+    size_t numVisible = std::count(expectedVisible.begin(), expectedVisible.end(), 1);
+    REQUIRE(numVisible > 0);
+    REQUIRE(numVisible < boxes.size());
+
+    orc::WorkerPool pool(4);
+    for (int level = 0; level <= (int)orc::GetSupportedSimdLevel(); level++)
+    {
+        for (orc::WorkerPool *p : {(orc::WorkerPool *)nullptr, &pool})
+        {
+            std::vector<float> depths;
+            std::vector<uint8_t> visible;
+            run((orc::SimdLevel)level, p, depths, visible);
+            REQUIRE(depths == expectedDepths);
+            REQUIRE(visible == expectedVisible);
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "render_thread.hpp"
+#include "scene.hpp"
+
+namespace orc
+{
+    RenderThread::RenderThread(
+        Scene &scene,
+        std::function<void()> begin,
+        std::function<void(const RenderSnapshot &)> render,
+        std::function<void()> end
+    )
+        : scene(scene)
+        , begin(std::move(begin))
+        , end(std::move(end))
+        , render(std::move(render))
+        , numSubmitted(0)
+        , numRendered(0)
+        , isStopping(false)
+        , thread(&RenderThread::Run, this)
+    {}
+
+    RenderThread::~RenderThread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isStopping = true;
+        }
+
+        submitted.notify_one();
+        thread.join();
+    }
+
+    void RenderThread::Submit()
+    {
+        // The snapshot for this frame was last used two frames ago, which
+        // must have been drawn before it can be overwritten
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            rendered.wait(lock, [this] { return numSubmitted - numRendered < 2; });
+        }
+
+        scene.Extract(snapshots[numSubmitted % 2]);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            numSubmitted++;
+        }
+        submitted.notify_one();
+    }
+
+    void RenderThread::Wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        rendered.wait(lock, [this] { return numRendered == numSubmitted; });
+    }
+
+    void RenderThread::Run()
+    {
+        begin();
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                submitted.wait(lock, [this] { return isStopping || numRendered < numSubmitted; });
+                if (numRendered == numSubmitted) break;
+            }
+
+            // Meshes are released here rather than when the snapshot is next
+            // extracted into, so that any that are no longer in the scene are
+            // destroyed on the thread that owns the context
+            RenderSnapshot &snapshot = snapshots[numRendered % 2];
+            render(snapshot);
+            snapshot.Clear();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                numRendered++;
+            }
+            rendered.notify_all();
+        }
+
+        end();
+    }
+}
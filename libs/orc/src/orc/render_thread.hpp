@@ -0,0 +1,73 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "scene.hpp"
+
+namespace orc
+{
+    // Draws frames of a scene on a dedicated thread, so that the GL calls of
+    // one frame overlap with updating the scene for the next. Frames are
+    // handed over in two snapshots: while the render thread draws one, the
+    // next frame is extracted into the other. Submitting waits if the render
+    // thread is still busy with both, so the scene is never more than one
+    // frame ahead of the frame being drawn.
+    //
+    // The render thread owns the GL context while it runs, so GL objects such
+    // as meshes and textures must not be created or destroyed on any other
+    // thread until it has stopped. Snapshots keep the meshes that they draw
+    // alive and release them on the render thread, so content that is
+    // visible can be detached from the scene and dropped at any time.
+    class RenderThread
+    {
+        public:
+        // Starts the thread. It calls begin before drawing anything, which
+        // must make a GL context current on it. Each frame is drawn by
+        // render, which typically clears the screen, calls Scene::Render,
+        // draws overlays, and swaps buffers. end is called when the thread
+        // stops, and should release the context so that another thread can
+        // make it current.
+        RenderThread(
+            Scene &scene,
+            std::function<void()> begin,
+            std::function<void(const RenderSnapshot &)> render,
+            std::function<void()> end
+        );
+
+        // Draws every frame that has been submitted, then stops the thread
+        ~RenderThread();
+
+        // Threads can't be copied
+        RenderThread(const RenderThread &other) = delete;
+        void operator=(const RenderThread &other) = delete;
+
+        // Extracts the scene's next frame on the calling thread and hands it
+        // to the render thread, first waiting for a snapshot to be free. The
+        // scene must not be modified while this runs, but may be as soon as
+        // it returns.
+        void Submit();
+
+        // Blocks until every submitted frame has been drawn
+        void Wait();
+
+        private:
+        Scene &scene;
+        std::function<void()> begin, end;
+        std::function<void(const RenderSnapshot &)> render;
+
+        // Frame n is extracted into snapshots[n % 2]
+        RenderSnapshot snapshots[2];
+        uint64_t numSubmitted, numRendered;
+        bool isStopping;
+        std::mutex mutex;
+        std::condition_variable submitted, rendered;
+
+        // Started last, once everything it uses has been initialized
+        std::thread thread;
+
+        void Run();
+    };
+}
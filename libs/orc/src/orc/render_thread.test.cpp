@@ -0,0 +1,76 @@
+#include <memory>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <fixtures.hpp>
+#include "mesh.hpp"
+#include "object.hpp"
+#include "render_thread.hpp"
+#include "scene.hpp"
+
+TEST_CASE("Frames are drawn in order on the render thread", "[orc]") {
+    orc::Scene scene;
+    scene.GetCamera().Translate(0.0f, 0.0f, 10.0f);
+
+    std::vector<std::shared_ptr<orc::Object>> objects;
+    for (int i = 0; i < 3; i++)
+    {
+        objects.push_back(orc::Object::Create());
+        objects.back()->AddMesh(fixtures::BuildTriangleMesh(false, std::make_unique<fixtures::BlankTextureRef>()));
+        objects.back()->Translate((float)i, 0.0f, 0.0f);
+        scene.GetRoot().AttachChild(objects.back());
+    }
+    std::weak_ptr<orc::Mesh> droppedMesh = objects[2]->GetMeshes()[0];
+
+    // The context is handed to the render thread for as long as it runs
+    GLFWwindow *window = glfwGetCurrentContext();
+    glfwMakeContextCurrent(nullptr);
+
+    std::thread::id renderThreadId;
+    std::vector<float> cameraPositions;
+    std::vector<size_t> numDraws;
+    {
+        orc::RenderThread renderThread(
+            scene,
+            [window, &renderThreadId] {
+                glfwMakeContextCurrent(window);
+                renderThreadId = std::this_thread::get_id();
+            },
+            [&scene, &cameraPositions, &numDraws](const orc::RenderSnapshot &snapshot) {
+                scene.Render(snapshot);
+                cameraPositions.push_back(snapshot.CameraPosition.z);
+                numDraws.push_back(snapshot.Draws.size());
+            },
+            [] { glfwMakeContextCurrent(nullptr); }
+        );
+
+        for (int i = 0; i < 10; i++)
+        {
+            // Halfway through, one object is moved out of view and another
+            // is dropped from the scene entirely, possibly while a frame
+            // that draws it is still in flight
+            if (i == 5)
+            {
+                objects[0]->Translate(0.0f, 0.0f, 100.0f);
+                objects[2]->Detach();
+                objects[2].reset();
+            }
+
+            scene.GetCamera().Translate(0.0f, 0.0f, 1.0f);
+            scene.Update();
+            renderThread.Submit();
+        }
+
+        renderThread.Wait();
+        REQUIRE(cameraPositions.size() == 10);
+    }
+    glfwMakeContextCurrent(window);
+
+    REQUIRE(renderThreadId != std::this_thread::get_id());
+    REQUIRE(cameraPositions == std::vector<float>{11.0f, 12.0f, 13.0f, 14.0f, 15.0f, 16.0f, 17.0f, 18.0f, 19.0f, 20.0f});
+    REQUIRE(numDraws == std::vector<size_t>{3, 3, 3, 3, 3, 1, 1, 1, 1, 1});
+    REQUIRE(droppedMesh.expired());
+}
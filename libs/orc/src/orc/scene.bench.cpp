@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "cube.hpp"
+#include "lod.hpp"
+#include "mesh.hpp"
+#include "object.hpp"
+#include "scene.hpp"
+
+// A single pixel PNG, standing in for the crate texture of the cube
+static const unsigned char pixelPng[] = {
+    0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52,
+    0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x08, 0x02, 0x00, 0x00, 0x00, 0x90, 0x77, 0x53,
+    0xde, 0x00, 0x00, 0x00, 0x0c, 0x49, 0x44, 0x41, 0x54, 0x78, 0x9c, 0x63, 0x38, 0xd0, 0xe0, 0x00,
+    0x00, 0x03, 0x84, 0x01, 0x81, 0x66, 0x5e, 0xe1, 0x61, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e,
+    0x44, 0xae, 0x42, 0x60, 0x82,
+};
+
+static void writeCrateTexture(const std::filesystem::path &dir)
+{
+    std::filesystem::create_directories(dir / "textures");
+    std::ofstream png(dir / "textures" / "crate.png", std::ios::binary);
+    png.write((const char *)pixelPng, sizeof(pixelPng));
+}
+
+// Counts the fragments shaded while rendering a snapshot into a cleared
+// depth buffer. Fragment shader invocations are counted where the driver
+// supports pipeline statistics, and samples that pass the depth test
+// otherwise, which early depth testing makes the same for opaque meshes.
+static uint64_t countFragments(orc::Scene &scene, const orc::RenderSnapshot &snapshot)
+{
+    GLenum target = GLAD_GL_VERSION_4_6 || glfwExtensionSupported("GL_ARB_pipeline_statistics_query")
+        ? GL_FRAGMENT_SHADER_INVOCATIONS
+        : GL_SAMPLES_PASSED;
+
+    GLuint query;
+    glGenQueries(1, &query);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glBeginQuery(target, query);
+    scene.Render(snapshot);
+    glEndQuery(target);
+
+    GLuint64 count;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &count);
+    glDeleteQueries(1, &query);
+    return count;
+}
+
+TEST_CASE("Draw copies of a mesh with and without instancing", "[orc][benchmark]") {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "orc_scene_bench";
+    writeCrateTexture(dir);
+
+    // 10k cubes sharing one mesh, in a grid in front of the camera. Every
+    // cube is drawn at full detail, and none hide others from the CPU.
+    orc::Scene scene;
+    scene.SetOcclusionCulling(false);
+    scene.SetLodSelector(orc::LodSelector(0.0f, 0.0f));
+    std::shared_ptr<orc::Mesh> cube = orc::BuildCubeMesh(dir.string());
+    for (int x = 0; x < 20; x++)
+    {
+        for (int y = 0; y < 20; y++)
+        {
+            for (int z = 0; z < 25; z++)
+            {
+                std::shared_ptr<orc::Object> o = orc::Object::Create();
+                o->AddMesh(cube);
+                o->Translate(x * 2.0f - 19.0f, y * 2.0f - 19.0f, -10.0f - z * 2.0f);
+                o->Scale(0.5f, 0.5f, 0.5f);
+                scene.GetRoot().AttachChild(o);
+            }
+        }
+    }
+    scene.Update();
+
+    // Draws include waiting for the GPU to finish them
+    scene.SetInstancing(false);
+    scene.Draw();
+    glFinish();
+    WARN("Draw calls for 10k cubes without instancing: " << scene.GetStats().DrawCalls);
+    BENCHMARK("Draw 10k cubes without instancing") {
+        scene.Draw();
+        glFinish();
+    };
+
+    scene.SetInstancing(true);
+    scene.Draw();
+    glFinish();
+    WARN("Draw calls for 10k cubes with instancing: " << scene.GetStats().DrawCalls);
+    BENCHMARK("Draw 10k cubes with instancing") {
+        scene.Draw();
+        glFinish();
+    };
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Draw overlapping meshes front to back and back to front", "[orc][benchmark]") {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "orc_scene_bench";
+    writeCrateTexture(dir);
+
+    // 50 cubes that each fill the screen, one behind the other, attached
+    // farthest first. Each is drawn on its own, so that their draws are in
+    // the order they were sorted in.
+    orc::Scene scene;
+    scene.SetOcclusionCulling(false);
+    scene.SetInstancing(false);
+    scene.SetLodSelector(orc::LodSelector(0.0f, 0.0f));
+    std::shared_ptr<orc::Mesh> cube = orc::BuildCubeMesh(dir.string());
+    for (int z = 0; z < 50; z++)
+    {
+        std::shared_ptr<orc::Object> o = orc::Object::Create();
+        o->AddMesh(cube);
+        o->Translate(0.0f, 0.0f, -55.0f + z);
+        o->Scale(50.0f, 50.0f, 0.5f);
+        scene.GetRoot().AttachChild(o);
+    }
+    scene.Update();
+
+    // The scene sorts opaque draws front to back. Reversing them draws the
+    // same frame back to front, so that every cube passes the depth test.
+    glEnable(GL_DEPTH_TEST);
+    orc::RenderSnapshot frontToBack, backToFront;
+    scene.Extract(frontToBack);
+    scene.Extract(backToFront);
+    std::reverse(backToFront.Draws.begin(), backToFront.Draws.end());
+
+    WARN("Fragments shaded for 50 overlapping cubes drawn back to front: " << countFragments(scene, backToFront));
+    BENCHMARK("Draw 50 overlapping cubes back to front") {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        scene.Render(backToFront);
+        glFinish();
+    };
+
+    WARN("Fragments shaded for 50 overlapping cubes drawn front to back: " << countFragments(scene, frontToBack));
+    BENCHMARK("Draw 50 overlapping cubes front to back") {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        scene.Render(frontToBack);
+        glFinish();
+    };
+
+    glDisable(GL_DEPTH_TEST);
+    std::filesystem::remove_all(dir);
+}
@@ -1,50 +1,155 @@
 #include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
-#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <glad/glad.h>
+#include "bounds.hpp"
+#include "buffer_texture.hpp"
+#include "bvh.hpp"
+#include "change_journal.hpp"
 #include "cube.hpp"
+#include "draw_queue.hpp"
+#include "frustum.hpp"
 #include "light.hpp"
+#include "light_clusters.hpp"
+#include "lod.hpp"
+#include "loose_octree.hpp"
+#include "mx_kernels.hpp"
 #include "node.hpp"
+#include "node_pool.hpp"
 #include "object.hpp"
+#include "occlusion_buffer.hpp"
 #include "scene.hpp"
 #include "shader.hpp"
 #include "shaders/monochrome.frag.hpp"
 #include "shaders/monochrome.vert.hpp"
 #include "shaders/phong.frag.hpp"
 #include "shaders/phong.vert.hpp"
+#include "shaders/phong_instanced.vert.hpp"
 #include "shaders/skybox.frag.hpp"
 #include "shaders/skybox.vert.hpp"
 #include "skybox.hpp"
+#include "snapshot.hpp"
 #include "stateful_visitor.hpp"
+#include "static_batch.hpp"
+#include "texture.hpp"
+#include "transform_store.hpp"
+#include "triangle_mesh.hpp"
 #include "types.hpp"
 #include "visitor.hpp"
+#include "worker_pool.hpp"
 
-const size_t maxOmniLights = 4;
+// Number of rays that each task of a batched ray cast handles
+const size_t raycastBatchSize = 64;
+
+// At most this many of the meshes that are largest on screen are drawn into
+// the occlusion buffer each frame, and only if they are at least this large
+const size_t maxOccluders = 16;
+const float minOccluderScreenSize = 0.1f;
+
+// Threads that occlusion culling starts when updates are single-threaded. The
+// occlusion buffer is small, so more threads than this barely help.
+const size_t maxOcclusionThreads = 4;
 
 namespace orc
 {
     using ObjMeshPair = std::pair<Object *, std::shared_ptr<Mesh>>;
 
-    static bool compareObjMeshPairs(ObjMeshPair &a, ObjMeshPair &b)
+    // Marks a mesh that no draw has been merged into yet, and a node that
+    // doesn't belong to a static batch
+    const uint32_t noDraw = std::numeric_limits<uint32_t>::max();
+    const uint32_t noBatch = std::numeric_limits<uint32_t>::max();
+
+    void RenderSnapshot::Clear()
+    {
+        Draws.clear();
+        LightDraws.clear();
+        SkyboxMesh.reset();
+    }
+
+    // Returns the distance at which a world space ray hits a mesh, or
+    // infinity if it misses, and sets triangle to the triangle it hits
+    static float raycastMesh(const ObjMeshPair &pair, const Ray &ray, float maxDistance, uint32_t &triangle)
+    {
+        const float miss = std::numeric_limits<float>::infinity();
+
+        // The ray is brought into the mesh's coordinate space rather than
+        // bringing the mesh into world space. The transformation is affine,
+        // so distances along the ray are the same in both spaces.
+        glm::mat4 inverseMx = glm::inverse(pair.first->GetModelMx());
+        Ray localRay{
+            .Origin = glm::vec3(inverseMx * glm::vec4(ray.Origin, 1.0f)),
+            .Direction = glm::vec3(inverseMx * glm::vec4(ray.Direction, 0.0f)),
+        };
+
+        const TriangleMesh *triangles = pair.second->GetTriangles();
+        if (!triangles)
+        {
+            float distance;
+            triangle = TriangleMesh::noTriangle;
+            return Intersects(localRay, pair.second->GetBounds(), maxDistance, distance) ? distance : miss;
+        }
+
+        triangle = triangles->Raycast(localRay, maxDistance);
+        return triangle == TriangleMesh::noTriangle ? miss : maxDistance;
+    }
+
+    // Appends a node and its descendants to out, depth-first
+    static void collectSubtree(Node &node, std::vector<Node *> &out)
     {
-        return a.second->GetTexture().GetRenderSortKey() < b.second->GetTexture().GetRenderSortKey();
+        out.push_back(&node);
+        for (const std::shared_ptr<Node> &child : node.GetChildren())
+        {
+            collectSubtree(*child, out);
+        }
     }
 
     Scene::Scene()
-        : root(Node::Create())
-        , camera(Camera::Create())
+        : root(Node::Create(nodePool))
+        , camera(Camera::Create(nodePool))
+        , updateSplitDepth(0)
         , globalLight(GlobalLight{
             .Color = glm::vec3(1),
             .Direction = glm::normalize(glm::vec3(0.25, -1, 0)),
             .Phong = Phong{.Ambient=0.1, .Diffuse=0.4, .Specular=0.3}
         })
+        , stats(SceneStats{
+            .UpdatedNodes = 0,
+            .VisibleMeshes = 0,
+            .CulledMeshes = 0,
+            .Lights = 0,
+            .ClusteredLights = 0,
+            .SkippedMeshes = 0,
+            .SubmittedTriangles = 0,
+            .FullDetailTriangles = 0,
+            .Occluders = 0,
+            .OccludedMeshes = 0,
+            .BatchedMeshes = 0,
+            .MergedMeshes = 0,
+            .DrawCalls = 0,
+        })
+        , interpolation(1.0f)
+        , interpolatedCamera(Camera::Create())
+        , viewCamera(nullptr)
+        , isOcclusionCulling(true)
+        , isInstancing(true)
+        , numBatchedDrawables(0)
     {
         phongShader = std::make_unique<OpenGLShader>(
             std::string(shaders::phong_vert, sizeof(shaders::phong_vert)),
             std::string(shaders::phong_frag, sizeof(shaders::phong_frag))
         );
+        phongInstancedShader = std::make_unique<OpenGLShader>(
+            std::string(shaders::phong_instanced_vert, sizeof(shaders::phong_instanced_vert)),
+            std::string(shaders::phong_frag, sizeof(shaders::phong_frag))
+        );
         monochromeShader = std::make_unique<OpenGLShader>(
             std::string(shaders::monochrome_vert, sizeof(shaders::monochrome_vert)),
             std::string(shaders::monochrome_frag, sizeof(shaders::monochrome_frag))
@@ -54,6 +159,60 @@ namespace orc
             std::string(shaders::skybox_frag, sizeof(shaders::skybox_frag))
         );
         root->AttachChild(camera);
+#ifdef ORC_CHANGE_JOURNAL
+        transforms.SetJournal(&changes);
+#endif
+
+        // Lights and instances are read from buffer textures bound to units
+        // after the mesh's own texture, which is always bound to unit 0
+        lightBuffer = std::make_unique<BufferTexture>(GL_RGBA32F);
+        clusterBuffer = std::make_unique<BufferTexture>(GL_RG32UI);
+        clusterLightBuffer = std::make_unique<BufferTexture>(GL_R32UI);
+        instanceBuffer = std::make_unique<BufferTexture>(GL_RGBA32F);
+
+        // Each model matrix takes four texels of the instance buffer, which
+        // can hold as few as 65536 texels
+        GLint maxTexels;
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+        maxInstances = static_cast<uint32_t>(maxTexels) / texelsPerMx;
+        for (OpenGLShader *shader : {phongShader.get(), phongInstancedShader.get()})
+        {
+            shader->Use();
+            shader->SetUniformInt("u_lights", 1);
+            shader->SetUniformInt("u_clusters", 2);
+            shader->SetUniformInt("u_clusterLights", 3);
+            shader->SetUniformInt("u_clusterTilesX", lightClusters.GetTilesX());
+            shader->SetUniformInt("u_clusterTilesY", lightClusters.GetTilesY());
+            shader->SetUniformInt("u_clusterSlices", lightClusters.GetSlices());
+        }
+        phongInstancedShader->SetUniformInt("u_instances", 4);
+
+        // Uniforms that a shader doesn't have are at location -1, which GL
+        // ignores
+        auto phongLocations = [](const OpenGLShader &shader) {
+            return PhongLocations{
+                .TransformMx = shader.GetUniformLocation("u_transformMx"),
+                .ModelMx = shader.GetUniformLocation("u_modelMx"),
+                .ViewProjectionMx = shader.GetUniformLocation("u_viewProjectionMx"),
+                .FirstInstance = shader.GetUniformLocation("u_firstInstance"),
+                .CameraPosition = shader.GetUniformLocation("u_cameraPosition"),
+                .GlobalLightColor = shader.GetUniformLocation("u_globalLight.color"),
+                .GlobalLightDirection = shader.GetUniformLocation("u_globalLight.direction"),
+                .GlobalLightAmbient = shader.GetUniformLocation("u_globalLight.phong.ambient"),
+                .GlobalLightDiffuse = shader.GetUniformLocation("u_globalLight.phong.diffuse"),
+                .GlobalLightSpecular = shader.GetUniformLocation("u_globalLight.phong.specular"),
+                .NumOmniLights = shader.GetUniformLocation("u_numOmniLights"),
+                .ClusterDepthScale = shader.GetUniformLocation("u_clusterDepthScale"),
+                .ClusterDepthBias = shader.GetUniformLocation("u_clusterDepthBias"),
+            };
+        };
+        uniforms = UniformLocations{
+            .Phong = phongLocations(*phongShader),
+            .PhongInstanced = phongLocations(*phongInstancedShader),
+            .MonochromeTransformMx = monochromeShader->GetUniformLocation("u_transformMx"),
+            .MonochromeColor = monochromeShader->GetUniformLocation("u_color"),
+            .SkyboxTransformMx = skyboxShader->GetUniformLocation("u_transformMx"),
+        };
     }
 
     Node &Scene::GetRoot() const
@@ -66,151 +225,872 @@ namespace orc
         return *camera;
     }
 
+    NodePool &Scene::GetNodePool()
+    {
+        return nodePool;
+    }
+
     void Scene::SetSkybox(std::unique_ptr<Skybox> skybox)
     {
-        this->skybox.swap(skybox);
+        this->skybox = std::move(skybox);
     }
 
     void Scene::Update()
     {
-        Traverse([](Node &node) { node.ComputeMxs(); });
+#ifdef ORC_CHANGE_JOURNAL
+        changes.EndFrame();
+#endif
+
+        bool isRestructured = transforms.IsStale();
+        if (isRestructured)
+        {
+            transforms.Rebuild(*root);
+        }
+
+        stats.UpdatedNodes = updatePool
+            ? transforms.ComputeMxs(*updatePool, updateSplitDepth)
+            : transforms.ComputeMxs();
+
+        if (isRestructured)
+        {
+            CollectDrawables();
+        }
+        else if (stats.UpdatedNodes > 0)
+        {
+            // Dropping a batch changes what's drawn as much as restructuring
+            // the scene does
+            if (DropMovedBatches()) CollectDrawables();
+            else MoveDrawables();
+        }
+    }
+
+    void Scene::SetUpdateThreads(size_t numThreads, size_t splitDepth)
+    {
+        updatePool.reset();
+        if (numThreads > 1)
+        {
+            updatePool = std::make_unique<WorkerPool>(numThreads);
+
+            // Occlusion culling shares the update threads instead
+            occlusionPool.reset();
+        }
+
+        updateSplitDepth = splitDepth;
     }
 
-    // TODO: Delegate responsibility of mapping values to uniforms
-    // TODO: Traverse/compute matrices only when necessary
-    // TODO: Batch render instead of individual draw calls
-    // TODO: Set uniforms only when data has changed
-    // TODO: Maintain sort order of meshes by transparency, z-distance, etc.
     void Scene::Draw()
     {
-        // Collect all nodes in scene graph and separate by type
-        StatefulVisitor visitor;
-        Traverse([&visitor](Node &node) { node.Dispatch(visitor); });
+        Extract(drawSnapshot);
+        Render(drawSnapshot);
+    }
+
+    void Scene::Extract(RenderSnapshot &snapshot)
+    {
+        // Drawables are only collected by Update, and some of them may have
+        // been destroyed since
+        if (transforms.IsStale())
+        {
+            Update();
+        }
+
+        // Frames are drawn from where the camera was partway through the
+        // step, if interpolating
+        viewCamera = camera.get();
+        if (interpolation < 1.0f)
+        {
+            interpolatedCamera->SetFieldOfView(camera->GetFieldOfView());
+            interpolatedCamera->SetAspectRatio(camera->GetAspectRatio());
+            interpolatedCamera->SetClippingDistance(camera->GetNearClippingDistance(), camera->GetFarClippingDistance());
+            interpolatedCamera->SetTransformMx(camera->GetInterpolatedModelMx(interpolation));
+            interpolatedCamera->ComputeMxs();
+            viewCamera = interpolatedCamera.get();
+        }
 
-        // Extract drawable nodes
-        std::vector<OmniLight*> omniLights = std::vector<OmniLight *>(
-            visitor.GetOmniLights().begin(),
-            visitor.GetOmniLights().begin() + std::min(visitor.GetOmniLights().size(), maxOmniLights)
+        // Only meshes in the camera's view are drawn. Meshes of static
+        // batches are drawn by their merged meshes instead.
+        visibleDrawables.clear();
+        drawableBVH.Query(viewCamera->GetFrustum(), visibleDrawables);
+        visibleDrawables.erase(
+            std::remove_if(visibleDrawables.begin(), visibleDrawables.end(), [this](uint32_t i) {
+                return drawableOctree.Contains(i) || drawableIsBatched[i];
+            }),
+            visibleDrawables.end()
         );
-        SpotLight *spotLight = nullptr;
-        if (visitor.GetSpotLights().size())
+        drawableOctree.Query(viewCamera->GetFrustum(), visibleDrawables);
+        stats.VisibleMeshes = visibleDrawables.size();
+        stats.CulledMeshes = drawables.size() - numBatchedDrawables - visibleDrawables.size();
+
+        // Compute the transformation of every draw in one batch
+        drawModelMxs.clear();
+        for (uint32_t i : visibleDrawables)
         {
-            spotLight = visitor.GetSpotLights()[0];
+            drawModelMxs.push_back(drawables[i].first->GetInterpolatedModelMx(interpolation));
         }
-        std::vector<Object *> objects = visitor.GetObjects();
+        drawTransformMxs.resize(drawModelMxs.size());
+        GetMxKernels().MultiplyMxs(
+            viewCamera->GetViewProjectionMx(),
+            drawModelMxs.data(),
+            drawModelMxs.size(),
+            drawTransformMxs.data()
+        );
 
-        // Sort meshes in order of material properties, like transparency
-        std::vector<ObjMeshPair> pairs;
-        for (Object *obj : objects)
+        // The depth of a mesh is that of its bounding sphere's center, which
+        // is the w component of the center in clip space. The same depth
+        // decides how large the mesh is on screen, which picks its level of
+        // detail and whether it's large enough to occlude others. Its near
+        // depth is that of the nearest point of the sphere in world space.
+        float fov = viewCamera->GetFieldOfView();
+        drawDepths.resize(visibleDrawables.size());
+        drawNearDepths.resize(visibleDrawables.size());
+        drawScreenSizes.resize(visibleDrawables.size());
+        for (uint32_t k = 0; k < visibleDrawables.size(); k++)
         {
-            for (std::shared_ptr<Mesh> mesh : obj->GetMeshes())
+            const BoundingSphere &sphere = drawables[visibleDrawables[k]].second->GetBoundingSphere();
+            drawDepths[k] = (drawTransformMxs[k] * glm::vec4(sphere.Center, 1.0f)).w;
+            drawNearDepths[k] = drawDepths[k] - TransformSphere(sphere, drawModelMxs[k]).Radius;
+            drawScreenSizes[k] = ComputeScreenSize(sphere, drawModelMxs[k], drawDepths[k], fov);
+        }
+
+        if (isOcclusionCulling)
+        {
+            CullOccludedDrawables();
+        }
+        else
+        {
+            drawIsVisible.assign(visibleDrawables.size(), 1);
+            stats.Occluders = 0;
+        }
+
+        // Opaque draws come first, sorted by texture, then front to back by
+        // their near depth, so that early depth testing rejects fragments
+        // hidden behind meshes drawn earlier. Meshes that are large and near
+        // reach the front soonest. Translucent draws are sorted strictly back
+        // to front by their center, whatever their texture, so that each
+        // blends over everything behind it. Every mesh is drawn by the phong
+        // shader in the main pass.
+        float far = viewCamera->GetFarClippingDistance();
+        drawQueue.Clear();
+        stats.SkippedMeshes = 0;
+        stats.SubmittedTriangles = 0;
+        stats.FullDetailTriangles = 0;
+        stats.OccludedMeshes = 0;
+        for (uint32_t k = 0; k < visibleDrawables.size(); k++)
+        {
+            const Mesh &mesh = *drawables[visibleDrawables[k]].second;
+            uint32_t texture = drawableTextureIds[visibleDrawables[k]];
+            bool isTranslucent = drawableIsTranslucent[visibleDrawables[k]];
+
+            uint32_t &lod = drawableLods[visibleDrawables[k]];
+            lod = lodSelector.Select(drawScreenSizes[k], lod, mesh.GetNumLods());
+            stats.FullDetailTriangles += mesh.GetNumIndices() / 3;
+            if (!drawIsVisible[k])
+            {
+                stats.OccludedMeshes++;
+                continue;
+            }
+            if (lod == LodSelector::noLod)
             {
-                pairs.push_back(std::make_pair(obj, mesh));
+                stats.SkippedMeshes++;
+                continue;
             }
+
+            stats.SubmittedTriangles += mesh.GetNumIndices(lod) / 3;
+            drawQueue.Push(
+                isTranslucent
+                    ? DrawQueue::MakeKey(0, true, 0, 0, DrawQueue::QuantizeDepthReversed(drawDepths[k], far))
+                    : DrawQueue::MakeKey(0, false, 0, texture, DrawQueue::QuantizeDepth(drawNearDepths[k], far)),
+                k
+            );
         }
-        std::sort(pairs.begin(), pairs.end(), compareObjMeshPairs);
+        drawQueue.Sort();
+
+        snapshot.ViewMx = viewCamera->GetViewMx();
+        snapshot.ProjectionMx = viewCamera->GetProjectionMx();
+        snapshot.ViewProjectionMx = viewCamera->GetViewProjectionMx();
+        snapshot.CameraPosition = viewCamera->GetPosition();
+        ExtractDraws(snapshot);
+
+        ExtractLights(snapshot);
+
+        // Skybox never moves, so the model matrix will always be the
+        // identity. We also remove the translation component of the view
+        // matrix since the skybox shouldn't be influenced by camera
+        // position.
+        snapshot.SkyboxMesh = skybox;
+        snapshot.SkyboxMx = viewCamera->GetProjectionMx() * glm::mat4(glm::mat3(viewCamera->GetViewMx()));
 
+        snapshot.Stats = stats;
+    }
+
+    // TODO: Delegate responsibility of mapping values to uniforms
+    // TODO: Set uniforms only when data has changed
+    void Scene::Render(const RenderSnapshot &snapshot)
+    {
         // Draw lights
         monochromeShader->Use();
-        for (OmniLight *light : omniLights)
+        for (const RenderSnapshot::LightDraw &draw : snapshot.LightDraws)
         {
-            monochromeShader->SetUniformMat4("u_transformMx", GetCamera().GetViewProjectionMx() * light->GetModelMx());
-            monochromeShader->SetUniformVec3("u_color", light->GetColor());
+            monochromeShader->SetUniformMat4(uniforms.MonochromeTransformMx, draw.TransformMx);
+            monochromeShader->SetUniformVec3(uniforms.MonochromeColor, draw.Color);
+            draw.DrawMesh->Use();
+            draw.DrawMesh->Draw();
+        }
 
-            for (const std::shared_ptr<Mesh> &mesh : light->GetMeshes())
+        // Draw objects. Draws of a single instance set its matrices as
+        // uniforms, while instanced draws read theirs from the instance
+        // buffer. The shaders are only switched between draws of different
+        // kinds.
+        BindLights(snapshot);
+        bool isInstanced = std::any_of(snapshot.Draws.begin(), snapshot.Draws.end(), [](const RenderSnapshot::Draw &draw) {
+            return draw.NumInstances > 1;
+        });
+        if (isInstanced)
+        {
+            instanceBuffer->Use(GL_TEXTURE4);
+            SetFrameUniforms(*phongInstancedShader, uniforms.PhongInstanced, snapshot);
+        }
+        SetFrameUniforms(*phongShader, uniforms.Phong, snapshot);
+
+        // The instance buffer holds as many of the snapshot's model matrices
+        // as GL allows, starting at the first instanced draw. The window is
+        // moved up to a draw whose instances reach past it, and draws with
+        // more instances than fit in it are split.
+        size_t windowBegin = 0, windowEnd = 0;
+        OpenGLShader *current = phongShader.get();
+        for (const RenderSnapshot::Draw &draw : snapshot.Draws)
+        {
+            if (draw.NumInstances == 1)
             {
-                mesh->Use();
-                mesh->Draw();
+                if (current != phongShader.get())
+                {
+                    current = phongShader.get();
+                    current->Use();
+                }
+                current->SetUniformMat4(uniforms.Phong.TransformMx, snapshot.TransformMxs[draw.FirstInstance]);
+                current->SetUniformMat4(uniforms.Phong.ModelMx, snapshot.ModelMxs[draw.FirstInstance]);
+
+                draw.DrawMesh->Use();
+                draw.DrawMesh->DrawLod(draw.Lod);
+                continue;
+            }
+
+            if (current != phongInstancedShader.get())
+            {
+                current = phongInstancedShader.get();
+                current->Use();
+            }
+
+            draw.DrawMesh->Use();
+            size_t first = draw.FirstInstance, end = first + draw.NumInstances;
+            while (first < end)
+            {
+                size_t count = std::min<size_t>(end - first, maxInstances);
+                if (first < windowBegin || first + count > windowEnd)
+                {
+                    windowBegin = first;
+                    windowEnd = std::min<size_t>(snapshot.ModelMxs.size(), first + maxInstances);
+                    instanceBuffer->Upload(&snapshot.ModelMxs[windowBegin], (windowEnd - windowBegin) * sizeof(glm::mat4));
+                }
+                current->SetUniformInt(uniforms.PhongInstanced.FirstInstance, static_cast<int>(first - windowBegin));
+                draw.DrawMesh->DrawLodInstanced(draw.Lod, count);
+                first += count;
             }
         }
 
-        // Draw objects
-        phongShader->Use();
-        phongShader->SetUniformVec3("u_cameraPosition", GetCamera().GetPosition());
-        phongShader->SetUniformVec3("u_globalLight.color", globalLight.Color);
-        phongShader->SetUniformVec3("u_globalLight.direction", globalLight.Direction);
-        phongShader->SetUniformFloat("u_globalLight.phong.ambient", globalLight.Phong.Ambient);
-        phongShader->SetUniformFloat("u_globalLight.phong.diffuse", globalLight.Phong.Diffuse);
-        phongShader->SetUniformFloat("u_globalLight.phong.specular", globalLight.Phong.Specular);
+        if (snapshot.SkyboxMesh)
+        {
+            skyboxShader->Use();
+            skyboxShader->SetUniformMat4(uniforms.SkyboxTransformMx, snapshot.SkyboxMx);
+            snapshot.SkyboxMesh->Use();
+            snapshot.SkyboxMesh->Draw();
+        }
+    }
+
+    void Scene::BeginStep()
+    {
+        transforms.BeginStep();
+    }
+
+    void Scene::SetInterpolation(float alpha)
+    {
+        interpolation = alpha;
+    }
 
-        for (int i = 0; i < maxOmniLights; i ++)
+    void Scene::SetLodSelector(const LodSelector &selector)
+    {
+        lodSelector = selector;
+    }
+
+    void Scene::SetOcclusionCulling(bool isEnabled)
+    {
+        isOcclusionCulling = isEnabled;
+    }
+
+    void Scene::SetInstancing(bool isEnabled)
+    {
+        isInstancing = isEnabled;
+    }
+
+    void Scene::BatchStatic(Node &subtree)
+    {
+        // World matrices must be current, since they're baked into the
+        // merged meshes
+        if (transforms.IsStale())
+        {
+            Update();
+        }
+        const std::vector<Node *> &nodes = transforms.GetNodes();
+        if (std::find(nodes.begin(), nodes.end(), &subtree) == nodes.end())
+        {
+            throw std::runtime_error("Only nodes that belong to the scene can be batched");
+        }
+
+        StaticBatch batch{
+            .Root = subtree.shared_from_this(),
+            .Nodes = {},
+            .ModelMxs = {},
+            .Members = {},
+            .Merged = Object::Create(),
+        };
+        collectSubtree(subtree, batch.Nodes);
+
+        // Batches don't overlap, so that each mesh is drawn by at most one
+        staticBatches.erase(
+            std::remove_if(staticBatches.begin(), staticBatches.end(), [&batch](const StaticBatch &other) {
+                return std::find(batch.Nodes.begin(), batch.Nodes.end(), other.Root.get()) != batch.Nodes.end() ||
+                    std::find(other.Nodes.begin(), other.Nodes.end(), batch.Root.get()) != other.Nodes.end();
+            }),
+            staticBatches.end()
+        );
+
+        StatefulVisitor visitor;
+        std::vector<std::pair<const Mesh *, glm::mat4>> meshes;
+        std::vector<std::pair<const Object *, const Mesh *>> pairs;
+        for (Node *node : batch.Nodes)
         {
-            if (i >= omniLights.size())
+            batch.ModelMxs.push_back(node->GetModelMx());
+
+            size_t numObjects = visitor.GetObjects().size();
+            node->Dispatch(visitor);
+            if (visitor.GetObjects().size() == numObjects) continue;
+
+            Object *obj = visitor.GetObjects().back();
+            for (const std::shared_ptr<Mesh> &mesh : obj->GetMeshes())
             {
-                phongShader->SetUniformVec3Element("u_omniLights", "color", i, glm::vec3(0));
-                phongShader->SetUniformFloatElement("u_omniLights", "constant", i, 1); // Avoid divide by zero
-                continue;
+                meshes.push_back(std::make_pair(mesh.get(), obj->GetModelMx()));
+                pairs.push_back(std::make_pair(obj, mesh.get()));
             }
+        }
 
-            OmniLight *light = omniLights[i];
-            phongShader->SetUniformVec3Element("u_omniLights", "color", i, light->GetColor());
-            phongShader->SetUniformVec3Element("u_omniLights", "position", i, light->GetPosition());
-            phongShader->SetUniformFloatElement("u_omniLights", "phong.ambient", i, light->GetPhong().Ambient);
-            phongShader->SetUniformFloatElement("u_omniLights", "phong.diffuse", i, light->GetPhong().Diffuse);
-            phongShader->SetUniformFloatElement("u_omniLights", "phong.specular", i, light->GetPhong().Specular);
-            phongShader->SetUniformFloatElement("u_omniLights", "brightness", i, light->GetBrightness());
+        std::vector<uint8_t> isMerged;
+        for (const std::shared_ptr<Mesh> &mesh : MergeStaticMeshes(meshes, isMerged))
+        {
+            batch.Merged->AddMesh(mesh);
+        }
+        for (size_t i = 0; i < pairs.size(); i++)
+        {
+            if (isMerged[i]) batch.Members.push_back(pairs[i]);
         }
+        std::sort(batch.Members.begin(), batch.Members.end());
 
-        if (spotLight)
+        if (!batch.Members.empty())
         {
-            phongShader->SetUniformVec3("u_spotLight.color", spotLight->GetColor());
-            phongShader->SetUniformVec3("u_spotLight.direction", spotLight->GetFront());
-            phongShader->SetUniformVec3("u_spotLight.position", spotLight->GetPosition());
-            phongShader->SetUniformFloat("u_spotLight.inner", spotLight->GetInnerBlur());
-            phongShader->SetUniformFloat("u_spotLight.outer", spotLight->GetOuterBlur());
-            phongShader->SetUniformFloat("u_spotLight.phong.ambient", spotLight->GetPhong().Ambient);
-            phongShader->SetUniformFloat("u_spotLight.phong.diffuse", spotLight->GetPhong().Diffuse);
-            phongShader->SetUniformFloat("u_spotLight.phong.specular", spotLight->GetPhong().Specular);
+            staticBatches.push_back(std::move(batch));
         }
-        else
+        CollectDrawables();
+    }
+
+    void Scene::UnbatchStatic(Node &subtree)
+    {
+        auto dropped = std::remove_if(staticBatches.begin(), staticBatches.end(), [&subtree](const StaticBatch &batch) {
+            return batch.Root.get() == &subtree;
+        });
+        if (dropped == staticBatches.end()) return;
+
+        // Otherwise, the next update re-collects drawables anyway
+        staticBatches.erase(dropped, staticBatches.end());
+        if (!transforms.IsStale())
+        {
+            CollectDrawables();
+        }
+    }
+
+    const SceneStats &Scene::GetStats() const
+    {
+        return stats;
+    }
+
+    void Scene::Save(const std::string &path) const
+    {
+        SaveSnapshot(*root, path);
+    }
+
+    void Scene::Load(const std::string &path)
+    {
+        // The snapshot's own root stands in for the scene's, and is dropped
+        std::shared_ptr<Node> loaded = LoadSnapshot(path, nodePool);
+        std::vector<std::shared_ptr<Node>> children = loaded->GetChildren();
+        for (const std::shared_ptr<Node> &child : children)
         {
-            phongShader->SetUniformVec3("u_spotLight.color", glm::vec3(0));
+            child->Detach();
+            root->AttachChild(child);
         }
+    }
 
-        for (ObjMeshPair pair : pairs)
+    const ChangeJournal &Scene::GetChanges() const
+    {
+#ifdef ORC_CHANGE_JOURNAL
+        return changes;
+#else
+        // Nothing is recorded, so every frame is incomplete
+        static const ChangeJournal none;
+        return none;
+#endif
+    }
+
+    RaycastHit Scene::Raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance) const
+    {
+        Ray ray{.Origin = origin, .Direction = direction};
+        RaycastHit hit{
+            .HitObject = nullptr,
+            .HitMesh = nullptr,
+            .Triangle = TriangleMesh::noTriangle,
+            .Distance = maxDistance,
+        };
+
+        // Both indexes only accept a mesh if it's nearer than every mesh so
+        // far, in which case its triangle is the nearest too. Meshes that
+        // have moved into the octree are stale in the hierarchy.
+        // Merged meshes of static batches are skipped, so that their objects
+        // are hit through the meshes that were merged
+        uint32_t nearest = drawableBVH.Raycast(ray, hit.Distance, [this, &ray, &hit](uint32_t i, float maxDistance) {
+            if (drawableOctree.Contains(i) || i >= nodeDrawables.back()) return std::numeric_limits<float>::infinity();
+
+            uint32_t triangle;
+            float distance = raycastMesh(drawables[i], ray, maxDistance, triangle);
+            if (distance < maxDistance) hit.Triangle = triangle;
+            return distance;
+        });
+
+        uint32_t nearestMoved = drawableOctree.Raycast(ray, hit.Distance, [this, &ray, &hit](uint32_t i, float maxDistance) {
+            uint32_t triangle;
+            float distance = raycastMesh(drawables[i], ray, maxDistance, triangle);
+            if (distance < maxDistance) hit.Triangle = triangle;
+            return distance;
+        });
+        if (nearestMoved != LooseOctree::noItem)
         {
-            const Object *object = pair.first;
-            const std::shared_ptr<Mesh> mesh = pair.second;
+            nearest = nearestMoved;
+        }
 
-            phongShader->SetUniformMat4("u_transformMx", GetCamera().GetViewProjectionMx() * object->GetModelMx());
-            phongShader->SetUniformMat4("u_modelMx", object->GetModelMx());
+        if (nearest != BVH::noItem)
+        {
+            hit.HitObject = drawables[nearest].first;
+            hit.HitMesh = drawables[nearest].second.get();
+        }
+
+        return hit;
+    }
 
-            mesh->Use();
-            mesh->Draw();
+    void Scene::Raycast(const Ray *rays, size_t count, float maxDistance, RaycastHit *hits, WorkerPool &pool) const
+    {
+        pool.Run((count + raycastBatchSize - 1) / raycastBatchSize, [this, rays, count, maxDistance, hits](size_t batch) {
+            size_t end = std::min(count, (batch + 1) * raycastBatchSize);
+            for (size_t i = batch * raycastBatchSize; i < end; i++)
+            {
+                hits[i] = Raycast(rays[i].Origin, rays[i].Direction, maxDistance);
+            }
+        });
+    }
+
+    void Scene::CollectDrawables()
+    {
+        ValidateBatches();
+
+        // Nodes are visited in store order, so that the drawables of each
+        // node can be found from its index in the store
+        StatefulVisitor visitor;
+        drawables.clear();
+        drawableIsBatched.clear();
+        nodeDrawables.clear();
+        const std::vector<Node *> &nodes = transforms.GetNodes();
+        for (uint32_t idx = 0; idx < nodes.size(); idx++)
+        {
+            nodeDrawables.push_back(drawables.size());
+
+            size_t numObjects = visitor.GetObjects().size();
+            nodes[idx]->Dispatch(visitor);
+            if (visitor.GetObjects().size() == numObjects) continue;
+
+            Object *obj = visitor.GetObjects().back();
+            for (const std::shared_ptr<Mesh> &mesh : obj->GetMeshes())
+            {
+                bool isBatched = nodeBatches[idx] != noBatch && std::binary_search(
+                    staticBatches[nodeBatches[idx]].Members.begin(),
+                    staticBatches[nodeBatches[idx]].Members.end(),
+                    std::pair<const Object *, const Mesh *>(obj, mesh.get())
+                );
+                drawables.push_back(std::make_pair(obj, mesh));
+                drawableIsBatched.push_back(isBatched);
+            }
         }
+        nodeDrawables.push_back(drawables.size());
 
-        if (skybox)
+        // Merged meshes of static batches come last, and never move
+        numBatchedDrawables = std::count(drawableIsBatched.begin(), drawableIsBatched.end(), 1);
+        for (const StaticBatch &batch : staticBatches)
         {
-            skyboxShader->Use();
+            for (const std::shared_ptr<Mesh> &mesh : batch.Merged->GetMeshes())
+            {
+                drawables.push_back(std::make_pair(batch.Merged.get(), mesh));
+                drawableIsBatched.push_back(0);
+            }
+        }
+        stats.BatchedMeshes = numBatchedDrawables;
+        stats.MergedMeshes = drawables.size() - nodeDrawables.back();
+        drawableLods.assign(drawables.size(), LodSelector::noLod);
+
+        std::unordered_map<const Mesh *, uint32_t> meshIds;
+        drawableMeshIds.clear();
+        for (const ObjMeshPair &drawable : drawables)
+        {
+            auto inserted = meshIds.emplace(drawable.second.get(), meshIds.size());
+            drawableMeshIds.push_back(inserted.first->second);
+        }
+        meshDraws.resize(meshIds.size());
+
+        std::unordered_map<std::string, uint32_t> textureIds;
+        drawableTextureIds.clear();
+        drawableIsTranslucent.clear();
+        for (const ObjMeshPair &drawable : drawables)
+        {
+            const TextureRef &texture = drawable.second->GetTextureRef();
+            auto inserted = textureIds.emplace(texture.GetKey(), textureIds.size());
+            drawableTextureIds.push_back(inserted.first->second);
+            drawableIsTranslucent.push_back(texture.IsTranslucent());
+        }
+
+        omniLights = visitor.GetOmniLights();
+        spotLights = visitor.GetSpotLights();
+
+        drawableBounds.clear();
+        for (const ObjMeshPair &drawable : drawables)
+        {
+            drawableBounds.push_back(TransformAABB(drawable.second->GetBounds(), drawable.first->GetModelMx()));
+        }
+        drawableBVH.Build(drawableBounds.data(), drawableBounds.size());
+
+        // Drawables that later move are expected to stay roughly within the
+        // scene as it is now. Any that leave it still work, but are tested
+        // by every query.
+        drawableOctree.Reset(transforms.GetSubtreeBounds()[0]);
+    }
+
+    void Scene::MoveDrawables()
+    {
+        for (uint32_t idx : transforms.GetUpdatedNodes())
+        {
+            for (uint32_t i = nodeDrawables[idx]; i < nodeDrawables[idx + 1]; i++)
+            {
+                AABB bounds = TransformAABB(drawables[i].second->GetBounds(), drawables[i].first->GetModelMx());
+                if (drawableOctree.Contains(i))
+                {
+                    drawableOctree.Move(i, bounds);
+                }
+                else
+                {
+                    drawableOctree.Insert(i, bounds);
+                }
+            }
+        }
+    }
+
+    bool Scene::DropMovedBatches()
+    {
+        if (staticBatches.empty()) return false;
+
+        bool isDropped = false;
+        for (uint32_t idx : transforms.GetUpdatedNodes())
+        {
+            uint32_t b = nodeBatches[idx];
+            if (b != noBatch && staticBatches[b].Root)
+            {
+                staticBatches[b].Root.reset();
+                isDropped = true;
+            }
+        }
+
+        staticBatches.erase(
+            std::remove_if(staticBatches.begin(), staticBatches.end(), [](const StaticBatch &batch) {
+                return !batch.Root;
+            }),
+            staticBatches.end()
+        );
+        return isDropped;
+    }
+
+    void Scene::ValidateBatches()
+    {
+        const std::vector<Node *> &nodes = transforms.GetNodes();
+        nodeBatches.assign(nodes.size(), noBatch);
+        if (staticBatches.empty()) return;
 
-            // Skybox never moves, so the model matrix will always be the
-            // identity. We also remove the translation component of the view
-            // matrix since the skybox shouldn't be influenced by camera
-            // position.
-            glm::mat4 skyboxMx = glm::mat4(glm::mat3(GetCamera().GetViewMx()));
-            skyboxMx = GetCamera().GetProjectionMx() * skyboxMx;
+        std::unordered_map<const Node *, uint32_t> storeIdxs;
+        for (uint32_t idx = 0; idx < nodes.size(); idx++)
+        {
+            storeIdxs.emplace(nodes[idx], idx);
+        }
+
+        // Rebuilding the store recomputes every node, so whether a node has
+        // moved is told by its matrix rather than by the update
+        std::vector<Node *> subtree;
+        staticBatches.erase(
+            std::remove_if(staticBatches.begin(), staticBatches.end(), [&storeIdxs, &subtree](const StaticBatch &batch) {
+                if (storeIdxs.count(batch.Root.get()) == 0) return true;
 
-            skyboxShader->SetUniformMat4("u_transformMx", skyboxMx);
-            skybox->Use();
-            skybox->Draw();
+                subtree.clear();
+                collectSubtree(*batch.Root, subtree);
+                if (subtree != batch.Nodes) return true;
+
+                for (size_t k = 0; k < subtree.size(); k++)
+                {
+                    if (subtree[k]->GetModelMx() != batch.ModelMxs[k]) return true;
+                }
+                return false;
+            }),
+            staticBatches.end()
+        );
+
+        for (uint32_t b = 0; b < staticBatches.size(); b++)
+        {
+            for (Node *node : staticBatches[b].Nodes)
+            {
+                nodeBatches[storeIdxs[node]] = b;
+            }
         }
     }
 
-    void Scene::Traverse(std::function<void(Node&)> f)
+    void Scene::ExtractLights(RenderSnapshot &snapshot)
     {
-        std::queue<Node *const> q;
-        q.push(root.get());
+        // Each light is four texels, laid out as the phong shader expects.
+        // Spot lights are bounded by the sphere of their range, which is
+        // loose for narrow cones but cheap to bin.
+        lightBounds.clear();
+        snapshot.LightData.clear();
+        snapshot.LightDraws.clear();
+        for (OmniLight *light : omniLights)
+        {
+            glm::mat4 modelMx = light->GetInterpolatedModelMx(interpolation);
+            glm::vec3 position(modelMx[3]);
+            lightBounds.push_back(BoundingSphere{.Center = position, .Radius = light->GetRange()});
+            snapshot.LightData.push_back(glm::vec4(position, 1.0f / light->GetRange()));
+            snapshot.LightData.push_back(glm::vec4(light->GetColor(), light->GetBrightness()));
+            snapshot.LightData.push_back(glm::vec4(light->GetPhong().Ambient, light->GetPhong().Diffuse, light->GetPhong().Specular, 0.0f));
+            snapshot.LightData.push_back(glm::vec4(0.0f));
 
-        while (!q.empty())
+            for (const std::shared_ptr<Mesh> &mesh : light->GetMeshes())
+            {
+                snapshot.LightDraws.push_back(RenderSnapshot::LightDraw{
+                    .DrawMesh = mesh,
+                    .TransformMx = viewCamera->GetViewProjectionMx() * modelMx,
+                    .Color = light->GetColor(),
+                });
+            }
+        }
+        for (SpotLight *light : spotLights)
         {
-            Node *o = q.front();
-            f(*o);
-            q.pop();
+            glm::mat4 modelMx = light->GetInterpolatedModelMx(interpolation);
+            glm::vec3 position(modelMx[3]);
+            glm::vec3 front(modelMx * glm::vec4(0.0f, 0.0f, -1.0f, 0.0f));
+            lightBounds.push_back(BoundingSphere{.Center = position, .Radius = light->GetRange()});
+            snapshot.LightData.push_back(glm::vec4(position, 1.0f / light->GetRange()));
+            snapshot.LightData.push_back(glm::vec4(light->GetColor(), 1.0f));
+            snapshot.LightData.push_back(glm::vec4(light->GetPhong().Ambient, light->GetPhong().Diffuse, light->GetPhong().Specular, light->GetInnerBlur()));
+            snapshot.LightData.push_back(glm::vec4(front, light->GetOuterBlur()));
+        }
+        snapshot.NumOmniLights = omniLights.size();
+        snapshot.Light = globalLight;
 
-            for (const std::shared_ptr<Node> &c : o->GetChildren())
+        lightClusters.Build(*viewCamera, lightBounds.data(), lightBounds.size());
+        stats.Lights = lightBounds.size();
+        stats.ClusteredLights = lightClusters.GetLightIndices().size();
+
+        snapshot.Clusters.assign(lightClusters.GetClusters().begin(), lightClusters.GetClusters().end());
+        snapshot.ClusterLights.assign(lightClusters.GetLightIndices().begin(), lightClusters.GetLightIndices().end());
+        snapshot.ClusterDepthScale = lightClusters.GetDepthScale();
+        snapshot.ClusterDepthBias = lightClusters.GetDepthBias();
+    }
+
+    void Scene::BindLights(const RenderSnapshot &snapshot)
+    {
+        lightBuffer->Upload(snapshot.LightData.data(), snapshot.LightData.size() * sizeof(glm::vec4));
+        clusterBuffer->Upload(snapshot.Clusters.data(), snapshot.Clusters.size() * sizeof(uint32_t));
+        clusterLightBuffer->Upload(snapshot.ClusterLights.data(), snapshot.ClusterLights.size() * sizeof(uint32_t));
+        lightBuffer->Use(GL_TEXTURE1);
+        clusterBuffer->Use(GL_TEXTURE2);
+        clusterLightBuffer->Use(GL_TEXTURE3);
+    }
+
+    void Scene::SetFrameUniforms(OpenGLShader &shader, const PhongLocations &locations, const RenderSnapshot &snapshot)
+    {
+        shader.Use();
+        shader.SetUniformMat4(locations.ViewProjectionMx, snapshot.ViewProjectionMx);
+        shader.SetUniformVec3(locations.CameraPosition, snapshot.CameraPosition);
+        shader.SetUniformVec3(locations.GlobalLightColor, snapshot.Light.Color);
+        shader.SetUniformVec3(locations.GlobalLightDirection, snapshot.Light.Direction);
+        shader.SetUniformFloat(locations.GlobalLightAmbient, snapshot.Light.Phong.Ambient);
+        shader.SetUniformFloat(locations.GlobalLightDiffuse, snapshot.Light.Phong.Diffuse);
+        shader.SetUniformFloat(locations.GlobalLightSpecular, snapshot.Light.Phong.Specular);
+        shader.SetUniformInt(locations.NumOmniLights, snapshot.NumOmniLights);
+        shader.SetUniformFloat(locations.ClusterDepthScale, snapshot.ClusterDepthScale);
+        shader.SetUniformFloat(locations.ClusterDepthBias, snapshot.ClusterDepthBias);
+    }
+
+    void Scene::ExtractDraws(RenderSnapshot &snapshot)
+    {
+        // Each queued draw is merged into an earlier draw of the same mesh
+        // at the same level of detail, if there is one it may join, and
+        // counted as one of its instances. Copies of a mesh share its
+        // texture, so its opaque copies all sort into the same run of
+        // state, and only the nearest copy's place in it is kept.
+        const std::vector<DrawQueue::Entry> &entries = drawQueue.GetEntries();
+        std::fill(meshDraws.begin(), meshDraws.end(), noDraw);
+        queuedDraws.resize(entries.size());
+        snapshot.Draws.clear();
+        for (size_t j = 0; j < entries.size(); j++)
+        {
+            uint32_t i = visibleDrawables[entries[j].Item];
+            const std::shared_ptr<Mesh> &mesh = drawables[i].second;
+            uint32_t lod = drawableLods[i];
+
+            uint32_t d = noDraw;
+            if (isInstancing && DrawQueue::IsTransparent(entries[j].Key))
+            {
+                const RenderSnapshot::Draw *last = snapshot.Draws.empty() ? nullptr : &snapshot.Draws.back();
+                if (last && last->DrawMesh == mesh && last->Lod == lod) d = snapshot.Draws.size() - 1;
+            }
+            else if (isInstancing)
+            {
+                uint32_t &meshDraw = meshDraws[drawableMeshIds[i]];
+                if (meshDraw != noDraw && snapshot.Draws[meshDraw].Lod == lod) d = meshDraw;
+                else meshDraw = snapshot.Draws.size();
+            }
+
+            if (d == noDraw)
             {
-                q.push(c.get());
+                d = snapshot.Draws.size();
+                snapshot.Draws.push_back(RenderSnapshot::Draw{.DrawMesh = mesh, .Lod = lod, .FirstInstance = 0, .NumInstances = 0});
             }
+            snapshot.Draws[d].NumInstances++;
+            queuedDraws[j] = d;
         }
+        stats.DrawCalls = snapshot.Draws.size();
+
+        // Lay the instances of each draw out one after another, in the order
+        // they were queued in: front to back for opaque draws, and back to
+        // front for translucent ones
+        uint32_t numInstances = 0;
+        for (RenderSnapshot::Draw &draw : snapshot.Draws)
+        {
+            draw.FirstInstance = numInstances;
+            numInstances += draw.NumInstances;
+            draw.NumInstances = 0;
+        }
+        snapshot.ModelMxs.resize(numInstances);
+        snapshot.TransformMxs.resize(numInstances);
+        for (size_t j = 0; j < entries.size(); j++)
+        {
+            RenderSnapshot::Draw &draw = snapshot.Draws[queuedDraws[j]];
+            uint32_t instance = draw.FirstInstance + draw.NumInstances++;
+            snapshot.ModelMxs[instance] = drawModelMxs[entries[j].Item];
+            snapshot.TransformMxs[instance] = drawTransformMxs[entries[j].Item];
+        }
+    }
+
+    void Scene::CullOccludedDrawables()
+    {
+        occluderCandidates.clear();
+        for (uint32_t k = 0; k < visibleDrawables.size(); k++)
+        {
+            if (drawScreenSizes[k] < minOccluderScreenSize) continue;
+            if (!drawables[visibleDrawables[k]].second->GetOccluder()) continue;
+
+            occluderCandidates.push_back(std::make_pair(drawScreenSizes[k], k));
+        }
+        if (occluderCandidates.size() > maxOccluders)
+        {
+            std::partial_sort(
+                occluderCandidates.begin(),
+                occluderCandidates.begin() + maxOccluders,
+                occluderCandidates.end(),
+                std::greater<std::pair<float, uint32_t>>()
+            );
+            occluderCandidates.resize(maxOccluders);
+        }
+        stats.Occluders = occluderCandidates.size();
+
+        occlusionBuffer.Begin(viewCamera->GetViewProjectionMx());
+        for (const std::pair<float, uint32_t> &candidate : occluderCandidates)
+        {
+            const Mesh::Occluder &occluder = *drawables[visibleDrawables[candidate.second]].second->GetOccluder();
+            occlusionBuffer.AddOccluder(
+                occluder.Points.data(),
+                occluder.Points.size(),
+                sizeof(glm::vec3),
+                occluder.Indices.data(),
+                occluder.Indices.size(),
+                drawModelMxs[candidate.second]
+            );
+        }
+        WorkerPool *pool = GetOcclusionPool();
+        occlusionBuffer.Rasterize(pool);
+
+        drawBounds.clear();
+        for (uint32_t k = 0; k < visibleDrawables.size(); k++)
+        {
+            drawBounds.push_back(TransformAABB(drawables[visibleDrawables[k]].second->GetBounds(), drawModelMxs[k]));
+        }
+        drawIsVisible.resize(visibleDrawables.size());
+        occlusionBuffer.TestAABBs(drawBounds.data(), drawBounds.size(), drawIsVisible.data(), pool);
+
+        // Occluders are always drawn. Rounding could otherwise make one look
+        // hidden behind itself.
+        for (const std::pair<float, uint32_t> &candidate : occluderCandidates)
+        {
+            drawIsVisible[candidate.second] = 1;
+        }
+    }
+
+    WorkerPool *Scene::GetOcclusionPool()
+    {
+        if (updatePool) return updatePool.get();
+
+        if (!occlusionPool)
+        {
+            size_t numThreads = std::min<size_t>(std::thread::hardware_concurrency(), maxOcclusionThreads);
+            if (numThreads <= 1) return nullptr;
+
+            occlusionPool = std::make_unique<WorkerPool>(numThreads);
+        }
+
+        return occlusionPool.get();
+    }
+
+    void Scene::QueryNodes(const AABB &region, std::vector<Node *> &out)
+    {
+        ForEachNode([&region, &out](Node &node) {
+            if (!Intersects(node.GetSubtreeBounds(), region)) return false;
+            if (Intersects(node.GetWorldBounds(), region)) out.push_back(&node);
+            return true;
+        });
+    }
+
+    void Scene::QueryNodes(const BoundingSphere &region, std::vector<Node *> &out)
+    {
+        ForEachNode([&region, &out](Node &node) {
+            if (!Intersects(node.GetSubtreeBounds(), region)) return false;
+            if (Intersects(node.GetWorldBounds(), region)) out.push_back(&node);
+            return true;
+        });
     }
 }
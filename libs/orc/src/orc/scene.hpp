@@ -1,17 +1,153 @@
 #pragma once
 
-#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "buffer_texture.hpp"
+#include "bvh.hpp"
 #include "camera.hpp"
+#include "change_journal.hpp"
+#include "draw_queue.hpp"
+#include "light_clusters.hpp"
+#include "lod.hpp"
+#include "loose_octree.hpp"
 #include "mesh.hpp"
 #include "node.hpp"
+#include "node_pool.hpp"
+#include "occlusion_buffer.hpp"
 #include "shader.hpp"
 #include "skybox.hpp"
+#include "transform_store.hpp"
+#include "types.hpp"
 #include "visitor.hpp"
+#include "worker_pool.hpp"
 
 namespace orc
 {
+    // Counters describing the work performed by the most recent calls to
+    // Scene::Update and Scene::Draw
+    struct SceneStats
+    {
+        // Number of nodes whose matrices were recomputed by the last Update
+        size_t UpdatedNodes;
+
+        // Number of meshes that intersected the camera's view and were drawn
+        // by the last Draw, and the number that were skipped because they
+        // didn't
+        size_t VisibleMeshes;
+        size_t CulledMeshes;
+
+        // Number of lights shaded by the last Draw, and the total number of
+        // lights listed by its light clusters. The average number of lights
+        // that a fragment shades is roughly the latter divided by the number
+        // of clusters.
+        size_t Lights;
+        size_t ClusteredLights;
+
+        // Number of visible meshes that the last Draw skipped because they
+        // were too small on screen to be worth drawing
+        size_t SkippedMeshes;
+
+        // Number of triangles submitted by the last Draw, at the level of
+        // detail that each mesh was drawn at, and the number that would have
+        // been submitted had every visible mesh been drawn at full detail
+        size_t SubmittedTriangles;
+        size_t FullDetailTriangles;
+
+        // Number of meshes drawn into the occlusion buffer by the last Draw,
+        // and the number of visible meshes that it skipped because they
+        // were hidden behind them
+        size_t Occluders;
+        size_t OccludedMeshes;
+
+        // Number of meshes that are drawn as part of a merged mesh of a
+        // static batch instead of on their own, and the number of merged
+        // meshes that they make up
+        size_t BatchedMeshes;
+        size_t MergedMeshes;
+
+        // Number of draw calls that the last Draw issued for visible meshes,
+        // after merging copies of the same mesh into instanced draws
+        size_t DrawCalls;
+    };
+
+    // Everything needed to draw a frame of a scene, copied out of it by
+    // Scene::Extract, so that the frame can be drawn by Scene::Render on
+    // another thread while the scene is updated for the next one. Snapshots
+    // hold references to the meshes that they draw, which keeps meshes
+    // alive until every snapshot drawing them has been cleared.
+    struct RenderSnapshot
+    {
+        // A mesh drawn by the phong shader, at a level of detail, once for
+        // each of NumInstances instances starting at FirstInstance
+        struct Draw
+        {
+            std::shared_ptr<Mesh> DrawMesh;
+            uint32_t Lod;
+            uint32_t FirstInstance, NumInstances;
+        };
+
+        // A mesh of an omni light, drawn in the light's color
+        struct LightDraw
+        {
+            std::shared_ptr<Mesh> DrawMesh;
+            glm::mat4 TransformMx;
+            glm::vec3 Color;
+        };
+
+        glm::mat4 ViewMx, ProjectionMx, ViewProjectionMx;
+        glm::vec3 CameraPosition;
+
+        // Visible meshes, in the order to draw them, and the model and
+        // model-view-projection matrices of every instance they draw. The
+        // instances of each draw are contiguous.
+        std::vector<Draw> Draws;
+        std::vector<glm::mat4> ModelMxs, TransformMxs;
+        std::vector<LightDraw> LightDraws;
+
+        // Four texels of shader data per light, omni lights first, and the
+        // light clusters of the camera's view
+        GlobalLight Light;
+        std::vector<glm::vec4> LightData;
+        size_t NumOmniLights;
+        std::vector<uint32_t> Clusters, ClusterLights;
+        float ClusterDepthScale, ClusterDepthBias;
+
+        std::shared_ptr<Skybox> SkyboxMesh;
+        glm::mat4 SkyboxMx;
+
+        // The scene's stats as of extracting the snapshot
+        SceneStats Stats;
+
+        // Releases the meshes of the snapshot. Buffers are kept for the next
+        // time the snapshot is extracted into.
+        void Clear();
+    };
+
+    // The nearest mesh hit by a ray cast into a scene
+    struct RaycastHit
+    {
+        // The object that was hit, or nullptr if the ray didn't hit anything
+        Object *HitObject;
+
+        // Which of the object's meshes was hit
+        Mesh *HitMesh;
+
+        // The triangle of the mesh that was hit. Meshes that don't keep their
+        // triangles are hit at their bounds instead, and report noTriangle.
+        uint32_t Triangle;
+
+        // Distance along the ray, in multiples of the length of its direction
+        float Distance;
+    };
+
     class Scene
     {
         public:
@@ -21,23 +157,366 @@ namespace orc
 
         Camera &GetCamera() const;
 
+        // Returns the pool that the scene's own nodes are allocated from.
+        // Nodes created from it can be attached to this or any other scene.
+        NodePool &GetNodePool();
+
         // Sets the skybox for the scene. If a skybox has already been set, it
         // will be destroyed and must be reloaded.
         void SetSkybox(std::unique_ptr<Skybox> skybox);
 
+        // Recomputes the matrices of every node that has been transformed,
+        // attached, or detached since the last update, along with their
+        // descendants. Untouched subtrees are skipped entirely. Then updates
+        // the spatial indexes over every mesh in the scene: if the shape of
+        // the scene changed, a bounding volume hierarchy is rebuilt over all
+        // of them, otherwise only meshes of nodes that were recomputed are
+        // touched. Those are moved out of the hierarchy and into a loose
+        // octree, which keeps up with content that moves every frame, until
+        // the shape of the scene next changes.
         void Update();
 
+        // Spreads Update across numThreads threads. Each subtree rooted
+        // splitDepth levels below the root is computed independently, so the
+        // split depth should be chosen such that there are more subtrees than
+        // threads and they are of similar size. For example, a depth of 1
+        // computes each node attached directly to the root on its own thread.
+        // Results are identical regardless of thread count. Passing a thread
+        // count of 0 or 1 restores single-threaded updates.
+        void SetUpdateThreads(size_t numThreads, size_t splitDepth);
+
+        // Draws every mesh that intersects the camera's view. If nodes have
+        // been attached or detached since the last update, the scene is
+        // updated first. Otherwise, drawing reuses the lists of meshes and
+        // lights collected by the last update, and doesn't allocate once its
+        // buffers have grown to fit the scene. Lights are binned into
+        // clusters of the camera's view, so each fragment only shades the
+        // lights whose range reaches it. Each mesh is drawn at the level of
+        // detail that its size on screen calls for, or not at all if it's too
+        // small. Equivalent to Extract followed by Render.
         void Draw();
 
+        // Does all of the work of Draw that doesn't call GL, and copies the
+        // results into a snapshot: culling, selecting levels of detail,
+        // sorting draws and binning lights. Doesn't load textures: draws are
+        // sorted by what their texture refs report about them.
+        void Extract(RenderSnapshot &snapshot);
+
+        // Draws a snapshot. Only uses the scene's shaders and GL buffers, so
+        // it may be called on another thread, which owns the GL context,
+        // while the scene is updated and extracted into another snapshot.
+        void Render(const RenderSnapshot &snapshot);
+
+        // Starts a fixed step of the simulation. Nodes that move during the
+        // step, i.e. before the next call, remember where they were when it
+        // started, so that frames drawn between steps can blend the two
+        // positions. See SetInterpolation.
+        void BeginStep();
+
+        // Sets how far between the start of the current step (alpha = 0) and
+        // now (alpha = 1) to draw nodes that have moved during the step,
+        // typically the fraction of a step that real time is ahead of the
+        // simulation. The camera and lights are blended too. The default of
+        // 1 draws everything where it is. Culling is still done against
+        // where meshes are now, so a fast mesh that just entered the view may
+        // show up a frame late.
+        void SetInterpolation(float alpha);
+
+        // Sets how levels of detail are selected. LodSelector(0.0f, 0.0f)
+        // draws every mesh at full detail.
+        void SetLodSelector(const LodSelector &selector);
+
+        // Enables or disables occlusion culling, which is enabled by default.
+        // Before drawing, the meshes with occluders that are largest on
+        // screen are rasterized into a low resolution depth buffer on the
+        // CPU, and meshes whose bounds are hidden behind them are skipped.
+        // The work is spread across the threads set by SetUpdateThreads. If
+        // updates are single-threaded, the scene starts a few threads of its
+        // own for it the first time it culls.
+        void SetOcclusionCulling(bool isEnabled);
+
+        // Enables or disables instancing, which is enabled by default. Opaque
+        // meshes drawn at the same level of detail by several objects are
+        // drawn by one instanced draw call, in place of the nearest of them.
+        // Translucent ones are only merged with copies drawn right before
+        // them, so that they still blend in order.
+        void SetInstancing(bool isEnabled);
+
+        // Marks a subtree of the scene as static and merges the meshes of its
+        // objects into a few large meshes, whose vertices are transformed
+        // into world space, so that it's drawn with a handful of draw calls.
+        // See MergeStaticMeshes for which meshes are merged. The subtree's
+        // nodes stay in the scene, and are still found by queries and ray
+        // casts. Batching a subtree that overlaps one batched before drops
+        // the earlier batch.
+        //
+        // Static subtrees must not change: as soon as one of their nodes is
+        // moved, attached, or detached, the next update drops the batch and
+        // its meshes are drawn on their own again. Meshes are read back and
+        // uploaded, so this must be called on the thread that owns the GL
+        // context. Throws if the node doesn't belong to the scene.
+        void BatchStatic(Node &subtree);
+
+        // Drops the batch of a subtree passed to BatchStatic, if it still
+        // has one
+        void UnbatchStatic(Node &subtree);
+
+        const SceneStats &GetStats() const;
+
+        // Saves every node attached to the root, along with their meshes, to
+        // a snapshot at path. The camera, lights, and skybox aren't saved.
+        // See SaveSnapshot.
+        void Save(const std::string &path) const;
+
+        // Loads a snapshot saved by Save, allocating its nodes from the
+        // scene's node pool, and attaches them to the root
+        void Load(const std::string &path);
+
+        // Returns the changes made to the scene's nodes before the last call
+        // to Update and after the one before it. Changes to nodes that were
+        // attached since aren't recorded until the scene has been updated
+        // with them, but attaching them is. Systems that keep their own
+        // state about the scene can use this to update it incrementally, as
+        // long as the journal is complete.
+        const ChangeJournal &GetChanges() const;
+
+        // Appends every node whose own world space bounds intersect region to
+        // out. Subtrees whose bounds don't intersect are skipped entirely.
+        // Bounds are as of the last Update.
+        void QueryNodes(const AABB &region, std::vector<Node *> &out);
+
+        void QueryNodes(const BoundingSphere &region, std::vector<Node *> &out);
+
+        // Finds the nearest mesh that a ray starting at origin hits within
+        // maxDistance, testing only meshes whose bounds the ray passes
+        // through. Meshes are as of the last Update. Safe to call from
+        // multiple threads at once, as long as the scene isn't being updated.
+        RaycastHit Raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+        // Casts count rays, spreading them across the threads of a pool, and
+        // writes the nearest hit of rays[k] to hits[k]
+        void Raycast(const Ray *rays, size_t count, float maxDistance, RaycastHit *hits, WorkerPool &pool) const;
+
+        // Visits every node in the scene breadth-first, starting at the root.
+        // If f returns a bool, returning false skips the node's descendants.
+        // The work queue is reused between calls, so traversal doesn't
+        // allocate once it has grown to fit the scene. Not reentrant: f must
+        // not call ForEachNode on the same scene.
+        template <typename F>
+        void ForEachNode(F &&f);
+
         private:
+        NodePool nodePool;
         std::shared_ptr<Node> root;
         std::shared_ptr<Camera> camera;
-        std::unique_ptr<OpenGLShader> phongShader, monochromeShader, skyboxShader;
-        std::unique_ptr<Skybox> skybox;
+        TransformStore transforms;
+#ifdef ORC_CHANGE_JOURNAL
+        ChangeJournal changes;
+#endif
+        std::unique_ptr<WorkerPool> updatePool;
+        size_t updateSplitDepth;
+        std::unique_ptr<OpenGLShader> phongShader, phongInstancedShader, monochromeShader, skyboxShader;
+
+        // Locations of the uniforms that are set every frame, looked up once
+        // so that drawing doesn't build or look up their names. Both phong
+        // shaders share a fragment shader, so they have the same uniforms,
+        // except for those of the vertex shader that each only has one of.
+        struct PhongLocations
+        {
+            int TransformMx, ModelMx, ViewProjectionMx, FirstInstance, CameraPosition;
+            int GlobalLightColor, GlobalLightDirection, GlobalLightAmbient, GlobalLightDiffuse, GlobalLightSpecular;
+            int NumOmniLights, ClusterDepthScale, ClusterDepthBias;
+        };
+        struct UniformLocations
+        {
+            PhongLocations Phong, PhongInstanced;
+            int MonochromeTransformMx, MonochromeColor;
+            int SkyboxTransformMx;
+        };
+        UniformLocations uniforms;
+        std::shared_ptr<Skybox> skybox;
 
         // TODO: API to set global light properties
         GlobalLight globalLight;
 
-        void Traverse(std::function<void(Node&)>);
+        SceneStats stats;
+
+        // Frames are drawn from a copy of the camera, placed partway through
+        // the step when interpolating
+        float interpolation;
+        std::shared_ptr<Camera> interpolatedCamera;
+        const Camera *viewCamera;
+
+        // Snapshot drawn by Draw, reused between frames
+        RenderSnapshot drawSnapshot;
+
+        // Model and model-view-projection matrices of each visible drawable,
+        // and the order to draw them in, reused between frames
+        std::vector<glm::mat4> drawModelMxs, drawTransformMxs;
+        DrawQueue drawQueue;
+
+        // Level of detail that each drawable was last drawn at, so that
+        // selection can tell which side of a threshold it's coming from
+        LodSelector lodSelector;
+        std::vector<uint32_t> drawableLods;
+
+        // Texture of each drawable, numbered in the order that textures are
+        // first found, and whether it's translucent. Resolved from texture
+        // refs as drawables are collected, so that sorting neither loads
+        // textures nor waits for the render thread to.
+        std::vector<uint32_t> drawableTextureIds;
+        std::vector<uint8_t> drawableIsTranslucent;
+
+        // Depth of the center and of the nearest point of each visible
+        // drawable's world bounding sphere, its screen size, its world space
+        // bounds, and whether the occlusion buffer found it visible
+        std::vector<float> drawDepths, drawNearDepths, drawScreenSizes;
+        std::vector<AABB> drawBounds;
+        std::vector<uint8_t> drawIsVisible;
+
+        // Visible drawables that could occlude others are collected as
+        // (screen size, index into visibleDrawables)
+        bool isOcclusionCulling;
+        OcclusionBuffer occlusionBuffer;
+        std::unique_ptr<WorkerPool> occlusionPool;
+        std::vector<std::pair<float, uint32_t>> occluderCandidates;
+
+        // Bounds of every light, reused between frames, and the clusters
+        // that they are binned into. Omni lights come before spot lights.
+        LightClusters lightClusters;
+        std::vector<BoundingSphere> lightBounds;
+        std::unique_ptr<BufferTexture> lightBuffer, clusterBuffer, clusterLightBuffer;
+
+        // Model matrices of the instances of a snapshot, read by the
+        // instanced phong shader, and the most matrices that GL lets the
+        // buffer hold at once
+        static constexpr uint32_t texelsPerMx = 4;
+        bool isInstancing;
+        std::unique_ptr<BufferTexture> instanceBuffer;
+        uint32_t maxInstances;
+
+        // Each drawable's mesh, numbered in the order they were collected,
+        // so that copies of the same mesh can be found without hashing. While
+        // extracting, the draw that each mesh's opaque copies are merged
+        // into, and the draw that each queued draw was merged into.
+        std::vector<uint32_t> drawableMeshIds;
+        std::vector<uint32_t> meshDraws, queuedDraws;
+
+        // Every mesh of every object in the scene and every light, collected
+        // whenever the shape of the scene changes
+        std::vector<std::pair<Object *, std::shared_ptr<Mesh>>> drawables;
+        std::vector<OmniLight *> omniLights;
+        std::vector<SpotLight *> spotLights;
+
+        // Drawables are collected in the same order as nodes in the transform
+        // store. The drawables of the node at index i of the store are
+        // [nodeDrawables[i], nodeDrawables[i + 1]), and the merged meshes of
+        // static batches follow those of the last node.
+        std::vector<uint32_t> nodeDrawables;
+
+        // World space bounds of each drawable when they were collected, and a
+        // hierarchy over them. Drawables that have moved since are ignored by
+        // the hierarchy and kept in the octree instead. Both are queried to
+        // find the drawables in view.
+        std::vector<AABB> drawableBounds;
+        BVH drawableBVH;
+        LooseOctree drawableOctree;
+        std::vector<uint32_t> visibleDrawables;
+
+        // A subtree merged by BatchStatic, along with the world matrix of
+        // each of its nodes at the time, in depth-first order. The merged
+        // meshes are drawn by an object that isn't part of the scene, and
+        // which therefore never moves, in place of the (object, mesh) pairs
+        // that they were merged from.
+        struct StaticBatch
+        {
+            std::shared_ptr<Node> Root;
+            std::vector<Node *> Nodes;
+            std::vector<glm::mat4> ModelMxs;
+            std::vector<std::pair<const Object *, const Mesh *>> Members;
+            std::shared_ptr<Object> Merged;
+        };
+        std::vector<StaticBatch> staticBatches;
+
+        // Batch of each node in the transform store, if any, and whether
+        // each drawable is drawn by a batch instead of on its own. The
+        // merged meshes of every batch are collected after the drawables of
+        // the store's nodes.
+        std::vector<uint32_t> nodeBatches;
+        std::vector<uint8_t> drawableIsBatched;
+        size_t numBatchedDrawables;
+
+        // Reused by ForEachNode
+        std::vector<Node *> traversalQueue;
+
+        // Re-collects drawables and lights, rebuilds the hierarchy, and
+        // empties the octree
+        void CollectDrawables();
+
+        // Moves the drawables of every node recomputed by the last update
+        // into, or within, the octree
+        void MoveDrawables();
+
+        // Drops the static batches that any node recomputed by the last
+        // update belongs to. Returns true if any were dropped.
+        bool DropMovedBatches();
+
+        // Drops the static batches whose subtrees changed, or left the scene,
+        // since they were batched, and finds the batch of every node
+        void ValidateBatches();
+
+        // Bins every light into the clusters of the camera's view, and copies
+        // the lights and clusters into a snapshot
+        void ExtractLights(RenderSnapshot &snapshot);
+
+        // Uploads the lights and clusters of a snapshot and binds them for
+        // the phong shader
+        void BindLights(const RenderSnapshot &snapshot);
+
+        // Sets the uniforms of a phong shader that are the same for every
+        // draw of a snapshot
+        void SetFrameUniforms(OpenGLShader &shader, const PhongLocations &locations, const RenderSnapshot &snapshot);
+
+        // Merges the sorted draw queue into draws of a snapshot and copies
+        // the matrices of their instances
+        void ExtractDraws(RenderSnapshot &snapshot);
+
+        // Rasterizes the largest visible occluders and tests every visible
+        // drawable against them
+        void CullOccludedDrawables();
+
+        // Returns the update pool if there is one, or else the occlusion
+        // pass's own, which is created on first use. Returns nullptr if the
+        // machine only has one thread to spare.
+        WorkerPool *GetOcclusionPool();
     };
+
+    template <typename F>
+    void Scene::ForEachNode(F &&f)
+    {
+        // Nodes are consumed from the front of the queue by advancing an
+        // index instead of erasing them, and the queue is cleared at the end
+        traversalQueue.clear();
+        traversalQueue.push_back(root.get());
+
+        for (size_t i = 0; i < traversalQueue.size(); i++)
+        {
+            Node *node = traversalQueue[i];
+            if constexpr (std::is_same_v<std::invoke_result_t<F &, Node &>, bool>)
+            {
+                if (!f(*node)) continue;
+            }
+            else
+            {
+                f(*node);
+            }
+
+            for (const std::shared_ptr<Node> &c : node->GetChildren())
+            {
+                traversalQueue.push_back(c.get());
+            }
+        }
+
+        traversalQueue.clear();
+    }
 }
@@ -1,10 +1,18 @@
 #include <memory>
+#include <vector>
 #include <catch2/catch_test_macros.hpp>
 #include <glm/glm.hpp>
+#include <testutils/allocations.hpp>
 #include <testutils/glm.hpp>
+#include <fixtures.hpp>
+#include "bounds.hpp"
+#include "change_journal.hpp"
 #include "light.hpp"
+#include "mesh.hpp"
 #include "object.hpp"
 #include "scene.hpp"
+#include "triangle_mesh.hpp"
+#include "worker_pool.hpp"
 
 TEST_CASE("Orient single object", "[orc]") {
     orc::Scene scene;
@@ -43,3 +51,503 @@ TEST_CASE("Orient child object", "[orc]") {
     REQUIRE(testutils::Vec3Equals(child->GetRight(), glm::vec3(0.0f, 1.0f, 0.0f)));
     REQUIRE(testutils::Vec3Equals(child->GetFront(), glm::vec3(0.0f, 0.0f, -1.0f)));
 }
+
+TEST_CASE("Update only recomputes dirty subtrees", "[orc]") {
+    orc::Scene scene;
+    std::shared_ptr<orc::Object> parent = orc::Object::Create();
+    std::shared_ptr<orc::Object> child = orc::Object::Create();
+    std::shared_ptr<orc::Object> sibling = orc::Object::Create();
+    parent->AttachChild(child);
+    scene.GetRoot().AttachChild(parent);
+    scene.GetRoot().AttachChild(sibling);
+
+    // Everything is new, so root, camera, parent, child, and sibling are all
+    // computed on the first update. Nothing has changed on the second.
+    scene.Update();
+    REQUIRE(scene.GetStats().UpdatedNodes == 5);
+    scene.Update();
+    REQUIRE(scene.GetStats().UpdatedNodes == 0);
+
+    // Moving a leaf only touches the leaf
+    child->Translate(1.0f, 0.0f, 0.0f);
+    scene.Update();
+    REQUIRE(scene.GetStats().UpdatedNodes == 1);
+    REQUIRE(testutils::Vec3Equals(child->GetPosition(), glm::vec3(1.0f, 0.0f, 0.0f)));
+
+    // Moving the parent propagates to the child, but not to the sibling
+    parent->Translate(0.0f, 2.0f, 0.0f);
+    scene.Update();
+    REQUIRE(scene.GetStats().UpdatedNodes == 2);
+    REQUIRE(testutils::Vec3Equals(child->GetPosition(), glm::vec3(1.0f, 2.0f, 0.0f)));
+    REQUIRE(testutils::Vec3Equals(sibling->GetPosition(), glm::vec3(0.0f, 0.0f, 0.0f)));
+
+    // Reparenting the child makes it relative to its new parent
+    child->Detach();
+    sibling->AttachChild(child);
+    scene.Update();
+    REQUIRE(scene.GetStats().UpdatedNodes == 1);
+    REQUIRE(testutils::Vec3Equals(child->GetPosition(), glm::vec3(1.0f, 0.0f, 0.0f)));
+}
+
+TEST_CASE("Visit nodes breadth-first and prune subtrees", "[orc]") {
+    orc::Scene scene;
+    std::shared_ptr<orc::Object> parent = orc::Object::Create();
+    std::shared_ptr<orc::Object> child = orc::Object::Create();
+    std::shared_ptr<orc::Object> sibling = orc::Object::Create();
+    parent->AttachChild(child);
+    scene.GetRoot().AttachChild(parent);
+    scene.GetRoot().AttachChild(sibling);
+
+    std::vector<orc::Node *> visited;
+    scene.ForEachNode([&visited](orc::Node &node) { visited.push_back(&node); });
+    REQUIRE(visited == std::vector<orc::Node *>{
+        &scene.GetRoot(), &scene.GetCamera(), parent.get(), sibling.get(), child.get()
+    });
+
+    // Returning false from the callback skips the node's children
+    visited.clear();
+    scene.ForEachNode([&visited, &parent](orc::Node &node) {
+        visited.push_back(&node);
+        return &node != parent.get();
+    });
+    REQUIRE(visited == std::vector<orc::Node *>{
+        &scene.GetRoot(), &scene.GetCamera(), parent.get(), sibling.get()
+    });
+}
+
+TEST_CASE("Query nodes by bounds", "[orc]") {
+    orc::Scene scene;
+    std::shared_ptr<orc::Node> group = orc::Node::Create();
+    std::shared_ptr<fixtures::BoxNode> near = fixtures::BoxNode::Create(glm::vec3(-1.0f), glm::vec3(1.0f));
+    std::shared_ptr<fixtures::BoxNode> far = fixtures::BoxNode::Create(glm::vec3(-1.0f), glm::vec3(1.0f));
+    group->AttachChild(near);
+    group->AttachChild(far);
+    scene.GetRoot().AttachChild(group);
+    far->Translate(10.0f, 0.0f, 0.0f);
+    scene.Update();
+
+    std::vector<orc::Node *> found;
+    scene.QueryNodes(orc::AABB{.Min = glm::vec3(0.5f), .Max = glm::vec3(2.0f)}, found);
+    REQUIRE(found == std::vector<orc::Node *>{near.get()});
+
+    found.clear();
+    scene.QueryNodes(orc::BoundingSphere{.Center = glm::vec3(8.0f, 0.0f, 0.0f), .Radius = 1.5f}, found);
+    REQUIRE(found == std::vector<orc::Node *>{far.get()});
+
+    // Bounds follow nodes as they move
+    far->Translate(-10.0f, 0.0f, 0.0f);
+    scene.Update();
+    found.clear();
+    scene.QueryNodes(orc::BoundingSphere{.Center = glm::vec3(8.0f, 0.0f, 0.0f), .Radius = 1.5f}, found);
+    REQUIRE(found.empty());
+}
+
+TEST_CASE("Raycast finds the nearest mesh", "[orc]") {
+    orc::Scene scene;
+    std::shared_ptr<orc::Object> near = orc::Object::Create();
+    std::shared_ptr<orc::Object> far = orc::Object::Create();
+    std::shared_ptr<orc::Object> coarse = orc::Object::Create();
+    near->AddMesh(fixtures::BuildTriangleMesh(true));
+    far->AddMesh(fixtures::BuildTriangleMesh(true));
+    coarse->AddMesh(fixtures::BuildTriangleMesh(false));
+    scene.GetRoot().AttachChild(near);
+    scene.GetRoot().AttachChild(far);
+    scene.GetRoot().AttachChild(coarse);
+    near->Translate(0.0f, 0.0f, -2.0f);
+    far->Translate(0.0f, 0.0f, -5.0f);
+    far->Scale(2.0f, 2.0f, 2.0f);
+    coarse->Translate(10.0f, 0.0f, -3.0f);
+    scene.Update();
+
+    // Passes through both triangles
+    orc::RaycastHit hit = scene.Raycast(glm::vec3(0.2f, 0.2f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+    REQUIRE(hit.HitObject == near.get());
+    REQUIRE(hit.HitMesh == near->GetMeshes()[0].get());
+    REQUIRE(hit.Triangle == 0);
+    REQUIRE(testutils::Vec3Equals(glm::vec3(2.0f), glm::vec3(hit.Distance)));
+
+    // Only inside of the far triangle, since it is scaled up
+    hit = scene.Raycast(glm::vec3(0.8f, 0.8f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+    REQUIRE(hit.HitObject == far.get());
+    REQUIRE(testutils::Vec3Equals(glm::vec3(5.0f), glm::vec3(hit.Distance)));
+
+    // Meshes without triangles are hit anywhere within their bounds
+    hit = scene.Raycast(glm::vec3(10.8f, 0.8f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+    REQUIRE(hit.HitObject == coarse.get());
+    REQUIRE(hit.Triangle == orc::TriangleMesh::noTriangle);
+
+    // Misses, or doesn't reach
+    hit = scene.Raycast(glm::vec3(0.2f, 0.2f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    REQUIRE(hit.HitObject == nullptr);
+    hit = scene.Raycast(glm::vec3(0.2f, 0.2f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), 1.5f);
+    REQUIRE(hit.HitObject == nullptr);
+
+    // Batches give the same results on any number of threads
+    std::vector<orc::Ray> rays;
+    for (int i = 0; i < 200; i++)
+    {
+        rays.push_back(orc::Ray{.Origin = glm::vec3(0.01f * i, 0.2f, 0.0f), .Direction = glm::vec3(0.0f, 0.0f, -1.0f)});
+    }
+    std::vector<orc::RaycastHit> hits(rays.size());
+    orc::WorkerPool pool(4);
+    scene.Raycast(rays.data(), rays.size(), 100.0f, hits.data(), pool);
+    for (size_t i = 0; i < rays.size(); i++)
+    {
+        orc::RaycastHit expected = scene.Raycast(rays[i].Origin, rays[i].Direction, 100.0f);
+        REQUIRE(hits[i].HitObject == expected.HitObject);
+        REQUIRE(hits[i].Distance == expected.Distance);
+    }
+
+    // Meshes are found where they moved to, not where they were collected
+    near->Translate(0.0f, 0.0f, -10.0f);
+    scene.Update();
+    hit = scene.Raycast(glm::vec3(0.2f, 0.2f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+    REQUIRE(hit.HitObject == far.get());
+    hit = scene.Raycast(glm::vec3(0.2f, 0.2f, -6.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+    REQUIRE(hit.HitObject == near.get());
+    REQUIRE(testutils::Vec3Equals(glm::vec3(6.0f), glm::vec3(hit.Distance)));
+}
+
+TEST_CASE("Drawing an unchanged scene doesn't allocate", "[orc]") {
+    orc::Scene scene;
+    scene.GetCamera().Translate(0.0f, 0.0f, 10.0f);
+
+    // Meshes and lights throughout the camera's view
+    for (int i = 0; i < 20; i++)
+    {
+        std::shared_ptr<orc::Object> o = orc::Object::Create();
+        o->AddMesh(fixtures::BuildTriangleMesh(false, std::make_unique<fixtures::BlankTextureRef>()));
+        o->Translate(i % 5 - 2.0f, i % 3 - 1.0f, -(float)i);
+        scene.GetRoot().AttachChild(o);
+
+        std::shared_ptr<orc::OmniLight> light = orc::OmniLight::Create();
+        light->SetRange(2.0f);
+        light->Translate(i % 5 - 2.0f, 0.0f, -(float)i);
+        scene.GetRoot().AttachChild(light);
+    }
+    std::shared_ptr<orc::SpotLight> flash = orc::SpotLight::Create();
+    flash->SetRange(20.0f);
+    scene.GetCamera().AttachChild(flash);
+
+    // The first draws grow buffers to fit the scene
+    scene.Update();
+    scene.Draw();
+    scene.Update();
+    scene.Draw();
+    REQUIRE(scene.GetStats().VisibleMeshes == 20);
+
+    size_t allocations;
+    {
+        testutils::AllocationCounter counter;
+        scene.Update();
+        scene.Draw();
+        allocations = counter.GetCount();
+    }
+    REQUIRE(allocations == 0);
+}
+
+TEST_CASE("Meshes hidden behind occluders aren't drawn", "[orc]") {
+    orc::Scene scene;
+    scene.GetCamera().Translate(0.0f, 0.0f, 10.0f);
+
+    // A large triangle that occludes with its own shape, covering the lower
+    // left of the view
+    std::shared_ptr<orc::Mesh> wallMesh = fixtures::BuildTriangleMesh(false, std::make_unique<fixtures::BlankTextureRef>());
+    wallMesh->SetOccluder({glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)}, {0, 1, 2});
+    std::shared_ptr<orc::Object> wall = orc::Object::Create();
+    wall->AddMesh(wallMesh);
+    wall->Translate(-10.0f, -10.0f, 0.0f);
+    wall->Scale(20.0f, 20.0f, 1.0f);
+    scene.GetRoot().AttachChild(wall);
+
+    // One mesh behind it, and one that isn't
+    std::shared_ptr<orc::Object> hidden = orc::Object::Create();
+    hidden->AddMesh(fixtures::BuildTriangleMesh(false, std::make_unique<fixtures::BlankTextureRef>()));
+    hidden->Translate(-6.0f, -6.0f, -10.0f);
+    scene.GetRoot().AttachChild(hidden);
+    std::shared_ptr<orc::Object> shown = orc::Object::Create();
+    shown->AddMesh(fixtures::BuildTriangleMesh(false, std::make_unique<fixtures::BlankTextureRef>()));
+    shown->Translate(3.0f, 3.0f, -10.0f);
+    scene.GetRoot().AttachChild(shown);
+
+    scene.Draw();
+    REQUIRE(scene.GetStats().VisibleMeshes == 3);
+    REQUIRE(scene.GetStats().Occluders == 1);
+    REQUIRE(scene.GetStats().OccludedMeshes == 1);
+
+    scene.SetOcclusionCulling(false);
+    scene.Draw();
+    REQUIRE(scene.GetStats().Occluders == 0);
+    REQUIRE(scene.GetStats().OccludedMeshes == 0);
+}
+
+TEST_CASE("Snapshots copy what a frame draws", "[orc]") {
+    orc::Scene scene;
+    scene.GetCamera().Translate(0.0f, 0.0f, 10.0f);
+
+    std::shared_ptr<orc::Object> far = orc::Object::Create();
+    far->AddMesh(fixtures::BuildTriangleMesh(false, std::make_unique<fixtures::BlankTextureRef>()));
+    far->Translate(0.0f, 0.0f, -10.0f);
+    scene.GetRoot().AttachChild(far);
+    std::shared_ptr<orc::Object> near = orc::Object::Create();
+    near->AddMesh(fixtures::BuildTriangleMesh(false, std::make_unique<fixtures::BlankTextureRef>()));
+    scene.GetRoot().AttachChild(near);
+    std::shared_ptr<orc::OmniLight> light = orc::OmniLight::Create();
+    scene.GetRoot().AttachChild(light);
+
+    orc::RenderSnapshot snapshot;
+    scene.Update();
+    scene.Extract(snapshot);
+
+    // Nearer meshes are drawn first
+    REQUIRE(snapshot.Draws.size() == 2);
+    REQUIRE(snapshot.Draws[0].DrawMesh == near->GetMeshes()[0]);
+    REQUIRE(snapshot.Draws[1].DrawMesh == far->GetMeshes()[0]);
+    REQUIRE(snapshot.Draws[1].NumInstances == 1);
+    REQUIRE(testutils::Mat4Equals(far->GetModelMx(), snapshot.ModelMxs[snapshot.Draws[1].FirstInstance]));
+    REQUIRE(testutils::Mat4Equals(scene.GetCamera().GetViewProjectionMx() * far->GetModelMx(), snapshot.TransformMxs[snapshot.Draws[1].FirstInstance]));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(0.0f, 0.0f, 10.0f), snapshot.CameraPosition));
+    REQUIRE(snapshot.NumOmniLights == 1);
+    REQUIRE(snapshot.LightData.size() == 4);
+    REQUIRE(snapshot.Stats.VisibleMeshes == 2);
+
+    // Later changes to the scene don't reach the snapshot, and meshes that
+    // leave the scene stay alive until it's cleared
+    std::weak_ptr<orc::Mesh> farMesh = far->GetMeshes()[0];
+    glm::mat4 farModelMx = far->GetModelMx();
+    far->Detach();
+    far.reset();
+    near->Translate(1.0f, 0.0f, 0.0f);
+    scene.Update();
+    REQUIRE(testutils::Mat4Equals(farModelMx, snapshot.ModelMxs[snapshot.Draws[1].FirstInstance]));
+    REQUIRE_FALSE(farMesh.expired());
+
+    snapshot.Clear();
+    REQUIRE(farMesh.expired());
+
+    scene.Extract(snapshot);
+    REQUIRE(snapshot.Draws.size() == 1);
+    REQUIRE(testutils::Mat4Equals(near->GetModelMx(), snapshot.ModelMxs[snapshot.Draws[0].FirstInstance]));
+}
+
+TEST_CASE("Frames are drawn partway through a step", "[orc]") {
+    orc::Scene scene;
+    scene.GetCamera().Translate(0.0f, 0.0f, 10.0f);
+    std::shared_ptr<orc::Object> o = orc::Object::Create();
+    o->AddMesh(fixtures::BuildTriangleMesh(false, std::make_unique<fixtures::BlankTextureRef>()));
+    scene.GetRoot().AttachChild(o);
+    scene.Update();
+
+    scene.BeginStep();
+    o->Translate(2.0f, 0.0f, 0.0f);
+    scene.GetCamera().Translate(0.0f, 0.0f, 2.0f);
+    scene.Update();
+
+    orc::RenderSnapshot snapshot;
+    scene.SetInterpolation(0.5f);
+    scene.Extract(snapshot);
+    REQUIRE(snapshot.Draws.size() == 1);
+    REQUIRE(testutils::Vec3Equals(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(snapshot.ModelMxs[0][3])));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(0.0f, 0.0f, 11.0f), snapshot.CameraPosition));
+
+    scene.SetInterpolation(1.0f);
+    scene.Extract(snapshot);
+    REQUIRE(testutils::Vec3Equals(glm::vec3(2.0f, 0.0f, 0.0f), glm::vec3(snapshot.ModelMxs[0][3])));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(0.0f, 0.0f, 12.0f), snapshot.CameraPosition));
+}
+
+TEST_CASE("Copies of a mesh are drawn as instances of one draw", "[orc]") {
+    orc::Scene scene;
+    scene.GetCamera().Translate(0.0f, 0.0f, 10.0f);
+
+    // Three copies of one mesh, with a mesh of its own sorted between them
+    std::shared_ptr<orc::Mesh> shared = fixtures::BuildTriangleMesh(false, std::make_unique<fixtures::BlankTextureRef>());
+    std::vector<std::shared_ptr<orc::Object>> copies;
+    for (float z : {-5.0f, 0.0f, -10.0f})
+    {
+        std::shared_ptr<orc::Object> o = orc::Object::Create();
+        o->AddMesh(shared);
+        o->Translate(0.0f, 0.0f, z);
+        scene.GetRoot().AttachChild(o);
+        copies.push_back(o);
+    }
+    std::shared_ptr<orc::Object> other = orc::Object::Create();
+    other->AddMesh(fixtures::BuildTriangleMesh(false, std::make_unique<fixtures::BlankTextureRef>()));
+    other->Translate(0.0f, 0.0f, -2.0f);
+    scene.GetRoot().AttachChild(other);
+
+    // The copies take the place of the nearest of them, and their instances
+    // are nearest first
+    orc::RenderSnapshot snapshot;
+    scene.Update();
+    scene.Extract(snapshot);
+    REQUIRE(scene.GetStats().DrawCalls == 2);
+    REQUIRE(snapshot.Draws.size() == 2);
+    REQUIRE(snapshot.Draws[0].DrawMesh == shared);
+    REQUIRE(snapshot.Draws[0].FirstInstance == 0);
+    REQUIRE(snapshot.Draws[0].NumInstances == 3);
+    REQUIRE(snapshot.Draws[1].DrawMesh == other->GetMeshes()[0]);
+    REQUIRE(snapshot.Draws[1].FirstInstance == 3);
+    REQUIRE(snapshot.Draws[1].NumInstances == 1);
+    REQUIRE(snapshot.ModelMxs.size() == 4);
+    REQUIRE(testutils::Mat4Equals(copies[1]->GetModelMx(), snapshot.ModelMxs[0]));
+    REQUIRE(testutils::Mat4Equals(copies[0]->GetModelMx(), snapshot.ModelMxs[1]));
+    REQUIRE(testutils::Mat4Equals(copies[2]->GetModelMx(), snapshot.ModelMxs[2]));
+    REQUIRE(testutils::Mat4Equals(other->GetModelMx(), snapshot.ModelMxs[3]));
+    REQUIRE(testutils::Mat4Equals(scene.GetCamera().GetViewProjectionMx() * copies[2]->GetModelMx(), snapshot.TransformMxs[2]));
+
+    // Without instancing, every copy is drawn on its own, in depth order
+    scene.SetInstancing(false);
+    scene.Extract(snapshot);
+    REQUIRE(scene.GetStats().DrawCalls == 4);
+    REQUIRE(snapshot.Draws.size() == 4);
+    for (size_t i = 0; i < snapshot.Draws.size(); i++)
+    {
+        REQUIRE(snapshot.Draws[i].FirstInstance == i);
+        REQUIRE(snapshot.Draws[i].NumInstances == 1);
+    }
+    REQUIRE(snapshot.Draws[1].DrawMesh == other->GetMeshes()[0]);
+
+    // Drawing both kinds of draw
+    scene.SetInstancing(true);
+    scene.Draw();
+    REQUIRE(scene.GetStats().DrawCalls == 2);
+}
+
+TEST_CASE("Opaque meshes are drawn front to back, then translucent ones back to front", "[orc]") {
+    orc::Scene scene;
+    scene.GetCamera().Translate(0.0f, 0.0f, 10.0f);
+    auto attach = [&](float z, float scale, bool isTranslucent) {
+        std::shared_ptr<orc::Object> o = orc::Object::Create();
+        o->AddMesh(fixtures::BuildTriangleMesh(false, std::make_unique<fixtures::BlankTextureRef>(isTranslucent)));
+        o->Translate(0.0f, 0.0f, z);
+        o->Scale(scale, scale, scale);
+        scene.GetRoot().AttachChild(o);
+        return o->GetMeshes()[0];
+    };
+
+    // The large mesh's center is farther away than the small one's, but it
+    // reaches nearer to the camera
+    std::shared_ptr<orc::Mesh> far = attach(-5.0f, 1.0f, false);
+    std::shared_ptr<orc::Mesh> small = attach(-1.0f, 1.0f, false);
+    std::shared_ptr<orc::Mesh> large = attach(-3.0f, 6.0f, false);
+    std::shared_ptr<orc::Mesh> glassNear = attach(-2.0f, 1.0f, true);
+    std::shared_ptr<orc::Mesh> glassFar = attach(-8.0f, 1.0f, true);
+    std::shared_ptr<orc::Mesh> glassMid = attach(-4.0f, 1.0f, true);
+
+    orc::RenderSnapshot snapshot;
+    scene.Update();
+    scene.Extract(snapshot);
+    REQUIRE(snapshot.Draws.size() == 6);
+    REQUIRE(snapshot.Draws[0].DrawMesh == large);
+    REQUIRE(snapshot.Draws[1].DrawMesh == small);
+    REQUIRE(snapshot.Draws[2].DrawMesh == far);
+    REQUIRE(snapshot.Draws[3].DrawMesh == glassFar);
+    REQUIRE(snapshot.Draws[4].DrawMesh == glassMid);
+    REQUIRE(snapshot.Draws[5].DrawMesh == glassNear);
+}
+
+TEST_CASE("Scene journals the changes made before each update", "[orc]") {
+    if (!orc::ChangeJournal::isEnabled) return;
+
+    orc::Scene scene;
+    scene.Update();
+
+    std::shared_ptr<orc::Object> o = orc::Object::Create();
+    std::shared_ptr<orc::OmniLight> light = orc::OmniLight::Create();
+    scene.GetRoot().AttachChild(o);
+    scene.GetRoot().AttachChild(light);
+    scene.Update();
+    REQUIRE(scene.GetChanges().GetSize() == 2);
+    REQUIRE(scene.GetChanges()[0].Type == orc::ChangeType::Attached);
+    REQUIRE(scene.GetChanges()[0].Target == o.get());
+
+    // Adding a mesh isn't a transformation, but moving the object after it
+    // is, and is recorded once no matter how many times it moves
+    o->AddMesh(fixtures::BuildTriangleMesh(false));
+    light->SetRange(5.0f);
+    o->Translate(1.0f, 0.0f, 0.0f);
+    o->Translate(1.0f, 0.0f, 0.0f);
+    scene.Update();
+
+    std::vector<orc::ChangeType> types;
+    scene.GetChanges().ForEach([&types](const orc::Change &change) { types.push_back(change.Type); });
+    REQUIRE(types == std::vector<orc::ChangeType>{orc::ChangeType::MeshAdded, orc::ChangeType::LightChanged, orc::ChangeType::Transformed});
+
+    // Neither is detaching
+    light->Detach();
+    scene.Update();
+    REQUIRE(scene.GetChanges().GetSize() == 1);
+    REQUIRE(scene.GetChanges()[0].Type == orc::ChangeType::Detached);
+
+    scene.Update();
+    REQUIRE(scene.GetChanges().IsComplete());
+    REQUIRE(scene.GetChanges().GetSize() == 0);
+}
+
+TEST_CASE("Static subtrees are drawn as merged meshes until they move", "[orc]") {
+    orc::Scene scene;
+    scene.GetCamera().Translate(0.0f, 0.0f, 10.0f);
+
+    // Three objects whose meshes share a texture, under one node, and one
+    // that isn't static
+    std::shared_ptr<orc::Node> model = orc::Node::Create();
+    std::vector<std::shared_ptr<orc::Object>> parts;
+    for (int i = 0; i < 3; i++)
+    {
+        std::shared_ptr<orc::Object> o = orc::Object::Create();
+        o->AddMesh(fixtures::BuildTriangleMesh(true));
+        o->Translate(i * 2.0f, 0.0f, 0.0f);
+        model->AttachChild(o);
+        parts.push_back(o);
+    }
+    scene.GetRoot().AttachChild(model);
+    std::shared_ptr<orc::Object> other = orc::Object::Create();
+    other->AddMesh(fixtures::BuildTriangleMesh(false));
+    other->Translate(0.0f, 2.0f, 0.0f);
+    scene.GetRoot().AttachChild(other);
+
+    REQUIRE_THROWS(scene.BatchStatic(*orc::Node::Create()));
+
+    scene.BatchStatic(*model);
+    REQUIRE(scene.GetStats().BatchedMeshes == 3);
+    REQUIRE(scene.GetStats().MergedMeshes == 1);
+
+    orc::RenderSnapshot snapshot;
+    scene.Extract(snapshot);
+    REQUIRE(scene.GetStats().VisibleMeshes == 2);
+    REQUIRE(scene.GetStats().CulledMeshes == 0);
+    REQUIRE(snapshot.Draws.size() == 2);
+    const orc::RenderSnapshot::Draw &merged = snapshot.Draws[snapshot.Draws[0].DrawMesh == other->GetMeshes()[0] ? 1 : 0];
+    REQUIRE(merged.DrawMesh->GetNumVertices() == 9);
+    REQUIRE(testutils::Mat4Equals(glm::mat4(1.0f), snapshot.ModelMxs[merged.FirstInstance]));
+
+    // Ray casts still hit the objects that were merged
+    orc::RaycastHit hit = scene.Raycast(glm::vec3(4.2f, 0.2f, 10.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+    REQUIRE(hit.HitObject == parts[2].get());
+
+    // Moving any node of the subtree drops the batch
+    parts[1]->Translate(0.0f, -1.0f, 0.0f);
+    scene.Update();
+    REQUIRE(scene.GetStats().BatchedMeshes == 0);
+    REQUIRE(scene.GetStats().MergedMeshes == 0);
+    scene.Extract(snapshot);
+    REQUIRE(snapshot.Draws.size() == 4);
+
+    // So does attaching a node to it, even alongside other changes
+    scene.BatchStatic(*model);
+    REQUIRE(scene.GetStats().BatchedMeshes == 3);
+    model->AttachChild(orc::Object::Create());
+    scene.Update();
+    REQUIRE(scene.GetStats().BatchedMeshes == 0);
+
+    // Unchanged static subtrees survive changes to the rest of the scene,
+    // until they're unbatched
+    scene.BatchStatic(*model);
+    other->Translate(1.0f, 0.0f, 0.0f);
+    scene.GetRoot().AttachChild(orc::Object::Create());
+    scene.Update();
+    REQUIRE(scene.GetStats().BatchedMeshes == 3);
+    scene.UnbatchStatic(*model);
+    REQUIRE(scene.GetStats().BatchedMeshes == 0);
+}
@@ -109,13 +109,11 @@ namespace orc
     }
 
     void OpenGLShader::SetUniformMat4(std::string name, glm::mat4 mat) {
-        unsigned int uniformId = glGetUniformLocation(program->GetId(), name.c_str());
-        glUniformMatrix4fv(uniformId, 1, GL_FALSE, glm::value_ptr(mat));
+        SetUniformMat4(GetUniformLocation(name), mat);
     }
 
     void OpenGLShader::SetUniformVec3(std::string name, glm::vec3 vec) {
-        unsigned int uniformId = glGetUniformLocation(program->GetId(), name.c_str());
-        glUniform3f(uniformId, vec.x, vec.y, vec.z);
+        SetUniformVec3(GetUniformLocation(name), vec);
     }
 
     void OpenGLShader::SetUniformVec3Element(std::string name, std::string property, int idx, glm::vec3 vec) {
@@ -123,14 +121,37 @@ namespace orc
     }
 
     void OpenGLShader::SetUniformFloat(std::string name, float f) {
-        unsigned int uniformId = glGetUniformLocation(program->GetId(), name.c_str());
-        glUniform1f(uniformId, f);
+        SetUniformFloat(GetUniformLocation(name), f);
+    }
+
+    void OpenGLShader::SetUniformInt(std::string name, int i) {
+        SetUniformInt(GetUniformLocation(name), i);
     }
 
     void OpenGLShader::SetUniformFloatElement(std::string name, std::string property, int idx, float f) {
         SetUniformFloat(buildIndexedUniformName(name, property, idx), f);
     }
 
+    int OpenGLShader::GetUniformLocation(const std::string &name) const {
+        return glGetUniformLocation(program->GetId(), name.c_str());
+    }
+
+    void OpenGLShader::SetUniformMat4(int location, glm::mat4 mat) {
+        glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat));
+    }
+
+    void OpenGLShader::SetUniformVec3(int location, glm::vec3 vec) {
+        glUniform3f(location, vec.x, vec.y, vec.z);
+    }
+
+    void OpenGLShader::SetUniformFloat(int location, float f) {
+        glUniform1f(location, f);
+    }
+
+    void OpenGLShader::SetUniformInt(int location, int i) {
+        glUniform1i(location, i);
+    }
+
     static std::string loadShaderSrc(const std::string &path)
     {
         // Open file for reading
@@ -65,9 +65,22 @@ namespace orc
         void SetUniformMat4(std::string name, glm::mat4 mat);
         void SetUniformVec3(std::string name, glm::vec3 vec);
         void SetUniformFloat(std::string name, float f);
+        void SetUniformInt(std::string name, int i);
         void SetUniformVec3Element(std::string name, std::string property, int idx, glm::vec3 vec);
         void SetUniformFloatElement(std::string name, std::string property, int idx, float f);
 
+        // Returns the location of a uniform, which doesn't change for the
+        // lifetime of the shader, or -1 if the shader doesn't use it. Setting
+        // uniforms that are set every frame by location avoids looking them
+        // up by name, and building their names, each time.
+        int GetUniformLocation(const std::string &name) const;
+
+        // Set uniforms by location. Location -1 is ignored.
+        void SetUniformMat4(int location, glm::mat4 mat);
+        void SetUniformVec3(int location, glm::vec3 vec);
+        void SetUniformFloat(int location, float f);
+        void SetUniformInt(int location, int i);
+
         private:
         std::unique_ptr<OpenGLShaderProgram> program;
     };
@@ -1,7 +1,5 @@
 #version 330 core
 
-#define NUM_OMNI_LIGHTS 4
-
 struct Phong {
     float ambient;
     float diffuse;
@@ -22,6 +20,9 @@ struct OmniLight {
     Phong phong;
 
     float brightness;
+
+    // 1 / range, or 0 if the light has no range
+    float invRange;
 };
 
 struct SpotLight {
@@ -38,19 +39,41 @@ struct SpotLight {
     float outer;
 
     Phong phong;
+
+    // 1 / range, or 0 if the light has no range
+    float invRange;
 };
 
 in vec2 vs_out_texCoords;
 in vec3 vs_out_normal;
 in vec3 vs_out_fragPos;
+in vec4 vs_out_clipPos;
 
 out vec4 fs_out_color;
 
 uniform sampler2D u_texture;
 uniform vec3 u_cameraPosition;
 uniform GlobalLight u_globalLight;
-uniform OmniLight u_omniLights[NUM_OMNI_LIGHTS];
-uniform SpotLight u_spotLight;
+
+// Every light in the scene, four texels each, omni lights first:
+//   position, invRange
+//   color, brightness
+//   phong ambient, diffuse, specular, inner (spot lights only)
+//   direction, outer (spot lights only)
+uniform samplerBuffer u_lights;
+uniform int u_numOmniLights;
+
+// The view volume is divided into clusters, each listing the lights that
+// reach into it as (first, count), a range of u_clusterLights. Clusters are
+// ordered by slice, then row, then column. A fragment's slice is
+// log(depth) * u_clusterDepthScale + u_clusterDepthBias.
+uniform usamplerBuffer u_clusters;
+uniform usamplerBuffer u_clusterLights;
+uniform int u_clusterTilesX;
+uniform int u_clusterTilesY;
+uniform int u_clusterSlices;
+uniform float u_clusterDepthScale;
+uniform float u_clusterDepthBias;
 
 float computeLighting(Phong phong, vec3 lightDir, vec3 fragPos, vec3 normal)
 {
@@ -85,6 +108,16 @@ float computeLighting(Phong phong, vec3 lightDir, vec3 fragPos, vec3 normal)
     return ambient + diffuse + specular;
 }
 
+// Fades a light out smoothly as it approaches its range, reaching 0 exactly at
+// the range so that clusters beyond it can safely leave the light out
+float computeRangeFalloff(float distance, float invRange)
+{
+    float x = distance * invRange;
+    x *= x;
+    float window = clamp(1.0 - x * x, 0.0, 1.0);
+    return window * window;
+}
+
 vec3 computeGlobalLighting(GlobalLight light, vec3 fragPos, vec3 normal)
 {
     vec3 lightDir = normalize(-light.direction);
@@ -100,7 +133,7 @@ vec3 computePointLighting(OmniLight light, vec3 fragPos, vec3 normal)
     // farther from the light source. We use a linear attenuation function
     // instead of quadratic because we assume gamma correction is enabled, which
     // will transform color values to an exponential scale.
-    float attenuation = 1.0 / length(lightVec);
+    float attenuation = computeRangeFalloff(length(lightVec), light.invRange) / length(lightVec);
 
     return light.brightness * attenuation * computeLighting(light.phong, lightDir, fragPos, normal) * light.color;
 }
@@ -115,21 +148,76 @@ vec3 computeSpotLighting(SpotLight light, vec3 fragPos, vec3 normal)
     vec3 viewDir = normalize(light.position - fragPos);
     float cosTheta = dot(lightDir, viewDir);
     float brightness = clamp((cosTheta - light.outer) / (light.inner - light.outer), 0.1, 1.0);
+    brightness *= computeRangeFalloff(length(light.position - fragPos), light.invRange);
 
     return brightness * computeLighting(light.phong, lightDir, fragPos, normal) * light.color;
 }
 
+OmniLight fetchOmniLight(int idx)
+{
+    vec4 positionRange = texelFetch(u_lights, 4 * idx);
+    vec4 colorBrightness = texelFetch(u_lights, 4 * idx + 1);
+    vec4 phong = texelFetch(u_lights, 4 * idx + 2);
+
+    return OmniLight(
+        colorBrightness.rgb,
+        positionRange.xyz,
+        Phong(phong.x, phong.y, phong.z),
+        colorBrightness.w,
+        positionRange.w
+    );
+}
+
+SpotLight fetchSpotLight(int idx)
+{
+    vec4 positionRange = texelFetch(u_lights, 4 * idx);
+    vec4 colorBrightness = texelFetch(u_lights, 4 * idx + 1);
+    vec4 phongInner = texelFetch(u_lights, 4 * idx + 2);
+    vec4 directionOuter = texelFetch(u_lights, 4 * idx + 3);
+
+    return SpotLight(
+        colorBrightness.rgb,
+        directionOuter.xyz,
+        positionRange.xyz,
+        phongInner.w,
+        directionOuter.w,
+        Phong(phongInner.x, phongInner.y, phongInner.z),
+        positionRange.w
+    );
+}
+
+// Finds the cluster that the fragment falls in. For a perspective projection,
+// clip space w is the fragment's depth in front of the camera.
+int findCluster()
+{
+    vec2 ndc = vs_out_clipPos.xy / vs_out_clipPos.w;
+    ivec2 tiles = ivec2(u_clusterTilesX, u_clusterTilesY);
+    ivec2 tile = clamp(ivec2(floor((ndc * 0.5 + 0.5) * vec2(tiles))), ivec2(0), tiles - 1);
+    int slice = int(floor(log(vs_out_clipPos.w) * u_clusterDepthScale + u_clusterDepthBias));
+    slice = clamp(slice, 0, u_clusterSlices - 1);
+
+    return (slice * u_clusterTilesY + tile.y) * u_clusterTilesX + tile.x;
+}
+
 void main()
 {
     vec3 lighting = computeGlobalLighting(u_globalLight, vs_out_fragPos, vs_out_normal);
 
-    for (int i = 0; i < NUM_OMNI_LIGHTS; i++)
+    // Only the lights that reach the fragment's cluster are shaded
+    uvec2 cluster = texelFetch(u_clusters, findCluster()).rg;
+    for (uint i = cluster.x; i < cluster.x + cluster.y; i++)
     {
-        lighting += computePointLighting(u_omniLights[i], vs_out_fragPos, vs_out_normal);
+        int idx = int(texelFetch(u_clusterLights, int(i)).r);
+        if (idx < u_numOmniLights)
+        {
+            lighting += computePointLighting(fetchOmniLight(idx), vs_out_fragPos, vs_out_normal);
+        }
+        else
+        {
+            lighting += computeSpotLighting(fetchSpotLight(idx), vs_out_fragPos, vs_out_normal);
+        }
     }
 
-    lighting += computeSpotLighting(u_spotLight, vs_out_fragPos, vs_out_normal);
-
     // Sample texture and apply lighting to get final color values
     vec4 texColor = texture(u_texture, vs_out_texCoords);
     fs_out_color = vec4(lighting * texColor.rgb, texColor.a);
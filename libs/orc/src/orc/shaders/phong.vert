@@ -7,6 +7,7 @@ layout (location = 2) in vec2 va_texCoords;
 out vec2 vs_out_texCoords;
 out vec3 vs_out_normal;
 out vec3 vs_out_fragPos;
+out vec4 vs_out_clipPos;
 
 uniform mat4 u_transformMx;
 uniform mat4 u_modelMx;
@@ -16,6 +17,10 @@ void main()
     gl_Position = u_transformMx * vec4(va_coords, 1.0);
     vs_out_texCoords = va_texCoords;
 
+    // The fragment shader finds its light cluster from its clip space
+    // position
+    vs_out_clipPos = gl_Position;
+
     // Compute fragment position and normal direction in world space by applying
     // model transformation
     vs_out_normal = vec3(u_modelMx * vec4(va_normal, 0.0));
@@ -0,0 +1,39 @@
+#version 330 core
+
+layout (location = 0) in vec3 va_coords;
+layout (location = 1) in vec3 va_normal;
+layout (location = 2) in vec2 va_texCoords;
+
+out vec2 vs_out_texCoords;
+out vec3 vs_out_normal;
+out vec3 vs_out_fragPos;
+out vec4 vs_out_clipPos;
+
+// Model matrices of every instance drawn this frame, one column per texel.
+// The instances of a draw start at u_firstInstance.
+uniform samplerBuffer u_instances;
+uniform int u_firstInstance;
+uniform mat4 u_viewProjectionMx;
+
+void main()
+{
+    int texel = (u_firstInstance + gl_InstanceID) * 4;
+    mat4 modelMx = mat4(
+        texelFetch(u_instances, texel),
+        texelFetch(u_instances, texel + 1),
+        texelFetch(u_instances, texel + 2),
+        texelFetch(u_instances, texel + 3)
+    );
+
+    // Compute fragment position and normal direction in world space by applying
+    // model transformation
+    vs_out_fragPos = vec3(modelMx * vec4(va_coords, 1.0));
+    vs_out_normal = vec3(modelMx * vec4(va_normal, 0.0));
+
+    gl_Position = u_viewProjectionMx * vec4(vs_out_fragPos, 1.0);
+    vs_out_texCoords = va_texCoords;
+
+    // The fragment shader finds its light cluster from its clip space
+    // position
+    vs_out_clipPos = gl_Position;
+}
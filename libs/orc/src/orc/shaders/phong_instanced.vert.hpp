@@ -0,0 +1,6 @@
+#pragma once
+
+namespace orc::shaders
+{
+    extern const char phong_instanced_vert[1202];
+}
@@ -0,0 +1,104 @@
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include "model.hpp"
+#include "snapshot.hpp"
+
+// Writes a glTF model of numMeshes spheres, each a mesh of its own with
+// rings * segments * 2 triangles. Every mesh reads the same buffer, but is
+// imported separately. The texture is never loaded, so it doesn't need to
+// exist.
+static void writeModel(const std::filesystem::path &dir, int numMeshes, int rings, int segments)
+{
+    const float pi = 3.14159265f;
+    std::vector<glm::vec3> points, normals;
+    std::vector<glm::vec2> uvs;
+    for (int r = 0; r <= rings; r++)
+    {
+        float theta = pi * r / rings;
+        for (int s = 0; s <= segments; s++)
+        {
+            float phi = 2.0f * pi * s / segments;
+            glm::vec3 p(std::sin(theta) * std::cos(phi), std::cos(theta), -std::sin(theta) * std::sin(phi));
+            points.push_back(p);
+            normals.push_back(p);
+            uvs.push_back(glm::vec2((float)s / segments, (float)r / rings));
+        }
+    }
+
+    std::vector<uint32_t> indices;
+    auto at = [segments](int r, int s) { return (uint32_t)(r * (segments + 1) + s); };
+    for (int r = 0; r < rings; r++)
+    {
+        for (int s = 0; s < segments; s++)
+        {
+            indices.insert(indices.end(), {at(r, s), at(r + 1, s), at(r + 1, s + 1)});
+            indices.insert(indices.end(), {at(r, s), at(r + 1, s + 1), at(r, s + 1)});
+        }
+    }
+
+    size_t pointsSize = points.size() * sizeof(glm::vec3);
+    size_t uvsSize = uvs.size() * sizeof(glm::vec2);
+    size_t indicesSize = indices.size() * sizeof(uint32_t);
+    std::ofstream bin(dir / "model.bin", std::ios::binary);
+    bin.write((const char *)points.data(), pointsSize);
+    bin.write((const char *)normals.data(), pointsSize);
+    bin.write((const char *)uvs.data(), uvsSize);
+    bin.write((const char *)indices.data(), indicesSize);
+    bin.close();
+
+    std::string meshes, nodes, children;
+    for (int i = 0; i < numMeshes; i++)
+    {
+        std::string sep = i > 0 ? "," : "";
+        meshes += sep + R"({"primitives":[{"attributes":{"POSITION":0,"NORMAL":1,"TEXCOORD_0":2},"indices":3,"material":0}]})";
+        nodes += sep + R"({"mesh":)" + std::to_string(i) + R"(,"translation":[)" + std::to_string(i * 3) + ",0,0]}";
+        children += sep + std::to_string(i + 1);
+    }
+
+    std::ofstream gltf(dir / "model.gltf");
+    gltf << R"({"asset":{"version":"2.0"},"scene":0,"scenes":[{"nodes":[0]}],)"
+        << R"("nodes":[{"children":[)" << children << "]}," << nodes << "],"
+        << R"("meshes":[)" << meshes << "],"
+        << R"("materials":[{"pbrMetallicRoughness":{"baseColorTexture":{"index":0}}}],)"
+        << R"("textures":[{"source":0}],"images":[{"uri":"texture.png"}],)"
+        << R"("buffers":[{"uri":"model.bin","byteLength":)" << pointsSize * 2 + uvsSize + indicesSize << "}],"
+        << R"("bufferViews":[)"
+        << R"({"buffer":0,"byteOffset":0,"byteLength":)" << pointsSize << "},"
+        << R"({"buffer":0,"byteOffset":)" << pointsSize << R"(,"byteLength":)" << pointsSize << "},"
+        << R"({"buffer":0,"byteOffset":)" << pointsSize * 2 << R"(,"byteLength":)" << uvsSize << "},"
+        << R"({"buffer":0,"byteOffset":)" << pointsSize * 2 + uvsSize << R"(,"byteLength":)" << indicesSize << "}],"
+        << R"("accessors":[)"
+        << R"({"bufferView":0,"componentType":5126,"count":)" << points.size() << R"(,"type":"VEC3","min":[-1,-1,-1],"max":[1,1,1]},)"
+        << R"({"bufferView":1,"componentType":5126,"count":)" << points.size() << R"(,"type":"VEC3"},)"
+        << R"({"bufferView":2,"componentType":5126,"count":)" << uvs.size() << R"(,"type":"VEC2"},)"
+        << R"({"bufferView":3,"componentType":5125,"count":)" << indices.size() << R"(,"type":"SCALAR"}]})";
+}
+
+TEST_CASE("Load a model from a snapshot", "[orc][benchmark]") {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "orc_snapshot_bench";
+    std::filesystem::create_directories(dir);
+    writeModel(dir, 20, 32, 48);
+
+    std::string modelPath = (dir / "model.gltf").string();
+    std::string snapshotPath = (dir / "model.snapshot").string();
+    orc::SaveSnapshot(*orc::LoadModel(modelPath), snapshotPath);
+    WARN("Snapshot of 20 meshes of 3k triangles: " << std::filesystem::file_size(snapshotPath) / 1024 << " KiB");
+
+    // Both include uploading every mesh and destroying the model again
+    BENCHMARK("Import 20 meshes with assimp") {
+        return orc::LoadModel(modelPath)->GetChildren().size();
+    };
+
+    BENCHMARK("Load 20 meshes from a snapshot") {
+        return orc::LoadSnapshot(snapshotPath)->GetChildren().size();
+    };
+
+    std::filesystem::remove_all(dir);
+}
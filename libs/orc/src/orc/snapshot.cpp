@@ -0,0 +1,439 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "mapped_file.hpp"
+#include "mesh.hpp"
+#include "node.hpp"
+#include "node_pool.hpp"
+#include "object.hpp"
+#include "snapshot.hpp"
+#include "texture_2d.hpp"
+#include "visitor.hpp"
+
+// Every snapshot starts with these bytes
+const char snapshotMagic[8] = {'O', 'R', 'C', 'S', 'N', 'A', 'P', '\0'};
+
+// Bumped whenever the layout of a snapshot changes. Snapshots of any other
+// version are rejected, and must be saved again from their source.
+const uint32_t snapshotVersion = 1;
+
+// Sections of a snapshot start on multiples of this many bytes, so that
+// every record can be read in place from a mapping of the file
+const size_t snapshotAlignment = 16;
+
+const uint32_t noParent = UINT32_MAX;
+
+// Flags of a mesh in a snapshot
+const uint32_t snapshotKeepsTriangles = 1;
+const uint32_t snapshotHasOccluder = 2;
+
+namespace orc
+{
+    // A snapshot is a header followed by sections that records refer to by
+    // their offset in bytes from the start of the file. Everything is
+    // stored in the byte order and layout of the machine that saved it.
+    struct SnapshotHeader
+    {
+        char Magic[8];
+        uint32_t Version;
+
+        // Snapshots saved with a different vertex layout can't be uploaded
+        // as they are
+        uint32_t VertexSize;
+
+        uint32_t NumNodes, NumMeshes, NumMeshRefs, NumObjects;
+        uint64_t FileSize;
+        uint64_t NodesOffset, MeshesOffset, MeshRefsOffset;
+    };
+
+    enum class SnapshotNodeType : uint32_t
+    {
+        Node,
+        Object,
+    };
+
+    // Nodes are stored depth-first, so that parents always precede their
+    // children. The root is the first node, and has no parent.
+    struct SnapshotNode
+    {
+        glm::mat4 TransformMx;
+        uint32_t Parent;
+        SnapshotNodeType Type;
+
+        // An object's meshes are NumMeshRefs indices into the snapshot's
+        // meshes, starting at FirstMeshRef of the mesh refs section
+        uint32_t FirstMeshRef, NumMeshRefs;
+    };
+
+    struct SnapshotMesh
+    {
+        uint64_t VerticesOffset, IndicesOffset, LodCountsOffset;
+        uint64_t OccluderPointsOffset, OccluderIndicesOffset;
+        uint64_t TexturePathOffset;
+        uint32_t NumVertices, NumIndices, NumLods;
+        uint32_t NumOccluderPoints, NumOccluderIndices;
+        uint32_t TexturePathLength;
+        uint32_t TextureType;
+        uint32_t Flags;
+        AABB Bounds;
+        BoundingSphere Sphere;
+    };
+
+    static_assert(std::is_trivially_copyable_v<SnapshotNode>, "Snapshot records must be trivially copyable");
+    static_assert(std::is_trivially_copyable_v<SnapshotMesh>, "Snapshot records must be trivially copyable");
+    static_assert(sizeof(unsigned int) == sizeof(uint32_t), "Indices are stored as 32 bit integers");
+
+    // Tells whether a node can be saved, and collects the meshes of objects
+    class SnapshotVisitor : public NodeVisitor
+    {
+        public:
+        SnapshotNodeType Type = SnapshotNodeType::Node;
+        bool IsSkipped = false;
+        const Object *VisitedObject = nullptr;
+
+        void VisitCamera(Camera *camera) override
+        {
+            IsSkipped = true;
+        }
+
+        void VisitOmniLight(OmniLight *light) override
+        {
+            IsSkipped = true;
+        }
+
+        void VisitSpotLight(SpotLight *light) override
+        {
+            IsSkipped = true;
+        }
+
+        void VisitObject(Object *object) override
+        {
+            Type = SnapshotNodeType::Object;
+            VisitedObject = object;
+        }
+    };
+
+    // Accumulates the contents of a snapshot in memory, so that it can be
+    // written to disk at once
+    struct SnapshotBuilder
+    {
+        std::vector<char> File;
+        std::vector<SnapshotNode> Nodes;
+        std::vector<SnapshotMesh> Meshes;
+        std::vector<uint32_t> MeshRefs;
+        std::unordered_map<const Mesh *, uint32_t> MeshIndices;
+        uint32_t NumObjects = 0;
+
+        // Geometry read back from GL, reused between meshes
+        std::vector<Mesh::Vertex> Vertices;
+        std::vector<unsigned int> Indices;
+    };
+
+    // Appends a section to the file and returns its offset
+    static uint64_t appendSection(std::vector<char> &file, const void *data, size_t size)
+    {
+        file.resize((file.size() + snapshotAlignment - 1) / snapshotAlignment * snapshotAlignment);
+        uint64_t offset = file.size();
+        file.insert(file.end(), static_cast<const char *>(data), static_cast<const char *>(data) + size);
+        return offset;
+    }
+
+    static uint32_t saveMesh(SnapshotBuilder &builder, const Mesh &mesh)
+    {
+        auto it = builder.MeshIndices.find(&mesh);
+        if (it != builder.MeshIndices.end())
+        {
+            return it->second;
+        }
+
+        const Texture2DRef *texture = dynamic_cast<const Texture2DRef *>(&mesh.GetTextureRef());
+        if (!texture)
+        {
+            throw std::runtime_error("Only meshes with 2D textures can be saved to a snapshot");
+        }
+
+        std::vector<uint32_t> lodCounts;
+        for (uint32_t i = 0; i < mesh.GetNumLods(); i++)
+        {
+            lodCounts.push_back(mesh.GetNumIndices(i));
+        }
+
+        std::vector<char> &file = builder.File;
+        mesh.ReadGeometry(builder.Vertices, builder.Indices);
+        SnapshotMesh record = {
+            .VerticesOffset = appendSection(file, builder.Vertices.data(), builder.Vertices.size() * sizeof(Mesh::Vertex)),
+            .IndicesOffset = appendSection(file, builder.Indices.data(), builder.Indices.size() * sizeof(unsigned int)),
+            .LodCountsOffset = appendSection(file, lodCounts.data(), lodCounts.size() * sizeof(uint32_t)),
+            .OccluderPointsOffset = 0,
+            .OccluderIndicesOffset = 0,
+            .TexturePathOffset = appendSection(file, texture->GetPath().data(), texture->GetPath().size()),
+            .NumVertices = (uint32_t)builder.Vertices.size(),
+            .NumIndices = (uint32_t)builder.Indices.size(),
+            .NumLods = (uint32_t)lodCounts.size(),
+            .NumOccluderPoints = 0,
+            .NumOccluderIndices = 0,
+            .TexturePathLength = (uint32_t)texture->GetPath().size(),
+            .TextureType = (uint32_t)texture->GetType(),
+            .Flags = mesh.GetTriangles() ? snapshotKeepsTriangles : 0,
+            .Bounds = mesh.GetBounds(),
+            .Sphere = mesh.GetBoundingSphere(),
+        };
+
+        if (const Mesh::Occluder *occluder = mesh.GetOccluder())
+        {
+            record.Flags |= snapshotHasOccluder;
+            record.OccluderPointsOffset = appendSection(file, occluder->Points.data(), occluder->Points.size() * sizeof(glm::vec3));
+            record.OccluderIndicesOffset = appendSection(file, occluder->Indices.data(), occluder->Indices.size() * sizeof(uint32_t));
+            record.NumOccluderPoints = occluder->Points.size();
+            record.NumOccluderIndices = occluder->Indices.size();
+        }
+
+        uint32_t idx = builder.Meshes.size();
+        builder.Meshes.push_back(record);
+        builder.MeshIndices[&mesh] = idx;
+        return idx;
+    }
+
+    static void saveNode(SnapshotBuilder &builder, Node &node, uint32_t parent)
+    {
+        SnapshotVisitor visitor;
+        node.Dispatch(visitor);
+        if (visitor.IsSkipped)
+        {
+            return;
+        }
+
+        SnapshotNode record = {
+            .TransformMx = node.GetTransformMx(),
+            .Parent = parent,
+            .Type = visitor.Type,
+            .FirstMeshRef = (uint32_t)builder.MeshRefs.size(),
+            .NumMeshRefs = 0,
+        };
+
+        if (visitor.VisitedObject)
+        {
+            builder.NumObjects++;
+            for (const std::shared_ptr<Mesh> &mesh : visitor.VisitedObject->GetMeshes())
+            {
+                builder.MeshRefs.push_back(saveMesh(builder, *mesh));
+            }
+
+            record.NumMeshRefs = builder.MeshRefs.size() - record.FirstMeshRef;
+        }
+
+        uint32_t idx = builder.Nodes.size();
+        builder.Nodes.push_back(record);
+        for (const std::shared_ptr<Node> &child : node.GetChildren())
+        {
+            saveNode(builder, *child, idx);
+        }
+    }
+
+    void SaveSnapshot(Node &root, const std::string &path)
+    {
+        // Room is left for the header, which is filled in last
+        SnapshotBuilder builder;
+        builder.File.resize(sizeof(SnapshotHeader));
+        saveNode(builder, root, noParent);
+        if (builder.Nodes.empty())
+        {
+            throw std::runtime_error("Cameras and lights can't be saved to a snapshot");
+        }
+
+        SnapshotHeader header = {
+            .Version = snapshotVersion,
+            .VertexSize = sizeof(Mesh::Vertex),
+            .NumNodes = (uint32_t)builder.Nodes.size(),
+            .NumMeshes = (uint32_t)builder.Meshes.size(),
+            .NumMeshRefs = (uint32_t)builder.MeshRefs.size(),
+            .NumObjects = builder.NumObjects,
+            .FileSize = 0,
+            .NodesOffset = appendSection(builder.File, builder.Nodes.data(), builder.Nodes.size() * sizeof(SnapshotNode)),
+            .MeshesOffset = appendSection(builder.File, builder.Meshes.data(), builder.Meshes.size() * sizeof(SnapshotMesh)),
+            .MeshRefsOffset = appendSection(builder.File, builder.MeshRefs.data(), builder.MeshRefs.size() * sizeof(uint32_t)),
+        };
+        std::memcpy(header.Magic, snapshotMagic, sizeof(snapshotMagic));
+        header.FileSize = builder.File.size();
+        std::memcpy(builder.File.data(), &header, sizeof(header));
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(builder.File.data(), builder.File.size());
+        if (!file)
+        {
+            throw std::runtime_error("Failed to save snapshot at " + path);
+        }
+    }
+
+    // Returns the count records of type T at offset into a snapshot, and
+    // throws if they don't lie entirely within it
+    template <typename T>
+    static const T *getRecords(const MappedFile &file, uint64_t offset, uint64_t count, const std::string &path)
+    {
+        if (offset % alignof(T) != 0 || offset > file.GetSize() || count > (file.GetSize() - offset) / sizeof(T))
+        {
+            throw std::runtime_error("Snapshot at " + path + " is damaged");
+        }
+
+        return reinterpret_cast<const T *>(file.GetData() + offset);
+    }
+
+    // Throws unless every index is less than count
+    static void checkIndices(const uint32_t *indices, size_t numIndices, size_t count, const std::string &path)
+    {
+        for (size_t i = 0; i < numIndices; i++)
+        {
+            if (indices[i] >= count)
+            {
+                throw std::runtime_error("Snapshot at " + path + " is damaged");
+            }
+        }
+    }
+
+    static std::shared_ptr<Mesh> loadMesh(const MappedFile &file, const SnapshotMesh &record, const std::string &path)
+    {
+        const Mesh::Vertex *vertices = getRecords<Mesh::Vertex>(file, record.VerticesOffset, record.NumVertices, path);
+        const uint32_t *indices = getRecords<uint32_t>(file, record.IndicesOffset, record.NumIndices, path);
+        const uint32_t *lodCounts = getRecords<uint32_t>(file, record.LodCountsOffset, record.NumLods, path);
+        const char *texturePath = getRecords<char>(file, record.TexturePathOffset, record.TexturePathLength, path);
+
+        uint64_t totalIndices = 0;
+        for (uint32_t i = 0; i < record.NumLods; i++)
+        {
+            totalIndices += lodCounts[i];
+        }
+
+        bool keepTriangles = record.Flags & snapshotKeepsTriangles;
+        if (record.NumVertices == 0 || record.NumLods == 0 || totalIndices != record.NumIndices || record.TextureType != Texture2D::Type::BaseColor)
+        {
+            throw std::runtime_error("Snapshot at " + path + " is damaged");
+        }
+
+        // Indices of every level are checked before they reach GL, which may
+        // read whatever lies past the end of a buffer that they point out of
+        checkIndices(indices, record.NumIndices, record.NumVertices, path);
+
+        std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>(
+            vertices,
+            record.NumVertices,
+            indices,
+            lodCounts,
+            record.NumLods,
+            record.Bounds,
+            record.Sphere,
+            std::make_unique<Texture2DRef>((Texture2D::Type)record.TextureType, std::string(texturePath, record.TexturePathLength)),
+            keepTriangles
+        );
+
+        if (record.Flags & snapshotHasOccluder)
+        {
+            const glm::vec3 *points = getRecords<glm::vec3>(file, record.OccluderPointsOffset, record.NumOccluderPoints, path);
+            const uint32_t *occluderIndices = getRecords<uint32_t>(file, record.OccluderIndicesOffset, record.NumOccluderIndices, path);
+            checkIndices(occluderIndices, record.NumOccluderIndices, record.NumOccluderPoints, path);
+            mesh->SetOccluder(
+                std::vector<glm::vec3>(points, points + record.NumOccluderPoints),
+                std::vector<uint32_t>(occluderIndices, occluderIndices + record.NumOccluderIndices)
+            );
+        }
+
+        return mesh;
+    }
+
+    static std::shared_ptr<Node> loadSnapshot(const std::string &path, NodePool *pool)
+    {
+        MappedFile file(path);
+        if (file.GetSize() < sizeof(SnapshotHeader) || std::memcmp(file.GetData(), snapshotMagic, sizeof(snapshotMagic)) != 0)
+        {
+            throw std::runtime_error("File at " + path + " is not a snapshot");
+        }
+
+        const SnapshotHeader &header = *getRecords<SnapshotHeader>(file, 0, 1, path);
+        if (header.Version != snapshotVersion || header.VertexSize != sizeof(Mesh::Vertex))
+        {
+            throw std::runtime_error("Snapshot at " + path + " was saved by another version, and must be saved again");
+        }
+        if (header.FileSize != file.GetSize() || header.NumNodes == 0 || header.NumObjects > header.NumNodes)
+        {
+            throw std::runtime_error("Snapshot at " + path + " is damaged");
+        }
+
+        const SnapshotNode *nodeRecords = getRecords<SnapshotNode>(file, header.NodesOffset, header.NumNodes, path);
+        const SnapshotMesh *meshRecords = getRecords<SnapshotMesh>(file, header.MeshesOffset, header.NumMeshes, path);
+        const uint32_t *meshRefs = getRecords<uint32_t>(file, header.MeshRefsOffset, header.NumMeshRefs, path);
+        checkIndices(meshRefs, header.NumMeshRefs, header.NumMeshes, path);
+
+        std::vector<std::shared_ptr<Mesh>> meshes;
+        meshes.reserve(header.NumMeshes);
+        for (uint32_t i = 0; i < header.NumMeshes; i++)
+        {
+            meshes.push_back(loadMesh(file, meshRecords[i], path));
+        }
+
+        if (pool)
+        {
+            pool->Reserve<Object>(header.NumObjects);
+            pool->Reserve<Node>(header.NumNodes - header.NumObjects);
+        }
+
+        std::vector<std::shared_ptr<Node>> nodes;
+        nodes.reserve(header.NumNodes);
+        for (uint32_t i = 0; i < header.NumNodes; i++)
+        {
+            const SnapshotNode &record = nodeRecords[i];
+            bool isParentValid = i == 0 ? record.Parent == noParent : record.Parent < i;
+            if (!isParentValid || record.FirstMeshRef > header.NumMeshRefs || record.NumMeshRefs > header.NumMeshRefs - record.FirstMeshRef)
+            {
+                throw std::runtime_error("Snapshot at " + path + " is damaged");
+            }
+
+            std::shared_ptr<Node> node;
+            if (record.Type == SnapshotNodeType::Object)
+            {
+                std::shared_ptr<Object> object = pool ? Object::Create(*pool) : Object::Create();
+                for (uint32_t j = 0; j < record.NumMeshRefs; j++)
+                {
+                    object->AddMesh(meshes[meshRefs[record.FirstMeshRef + j]]);
+                }
+
+                node = object;
+            }
+            else if (record.Type == SnapshotNodeType::Node)
+            {
+                node = pool ? Node::Create(*pool) : Node::Create();
+            }
+            else
+            {
+                throw std::runtime_error("Snapshot at " + path + " is damaged");
+            }
+
+            node->SetTransformMx(record.TransformMx);
+            if (i > 0)
+            {
+                nodes[record.Parent]->AttachChild(node);
+            }
+
+            nodes.push_back(node);
+        }
+
+        return nodes[0];
+    }
+
+    std::shared_ptr<Node> LoadSnapshot(const std::string &path)
+    {
+        return loadSnapshot(path, nullptr);
+    }
+
+    std::shared_ptr<Node> LoadSnapshot(const std::string &path, NodePool &pool)
+    {
+        return loadSnapshot(path, &pool);
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include "node.hpp"
+#include "node_pool.hpp"
+
+namespace orc
+{
+    // Saves a node and its descendants to a binary snapshot at path, which
+    // LoadSnapshot loads back much faster than the files they were imported
+    // from. Snapshots hold the hierarchy, each node's transform relative to
+    // its parent, and the meshes of every object, laid out exactly as they
+    // are uploaded: vertices, indices and levels of detail, bounds,
+    // occluders, and the path of each mesh's texture. Meshes shared by
+    // several objects are saved once.
+    //
+    // Cameras and lights are left out, along with everything attached to
+    // them, as are nodes of any other type than Node and Object. Meshes are
+    // read back from GL, so this must be called on the thread that owns the
+    // context. Throws if a mesh's texture isn't a Texture2DRef, or if the
+    // file can't be written.
+    void SaveSnapshot(Node &root, const std::string &path);
+
+    // Maps a snapshot saved by SaveSnapshot into memory and rebuilds the
+    // hierarchy saved in it. Meshes are uploaded straight from the mapping,
+    // and keep their triangles for ray casting if they did when they were
+    // saved. Textures are loaded the first time they're drawn, as usual.
+    // Throws if the file isn't a snapshot, is damaged, or was saved by
+    // another version of the format.
+    std::shared_ptr<Node> LoadSnapshot(const std::string &path);
+
+    // Same as above, but allocates the snapshot's nodes from a pool. Room
+    // for every node is reserved before the hierarchy is built.
+    std::shared_ptr<Node> LoadSnapshot(const std::string &path, NodePool &pool);
+}
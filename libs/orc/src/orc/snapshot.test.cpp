@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include <testutils/glm.hpp>
+#include <fixtures.hpp>
+#include "light.hpp"
+#include "mesh.hpp"
+#include "node.hpp"
+#include "node_pool.hpp"
+#include "object.hpp"
+#include "scene.hpp"
+#include "snapshot.hpp"
+#include "texture_2d.hpp"
+
+static std::string snapshotPath()
+{
+    return (std::filesystem::temp_directory_path() / "orc_snapshot_test.snapshot").string();
+}
+
+// Vertices are tightly packed floats, so they can be compared byte by byte
+static bool verticesEqual(const std::vector<orc::Mesh::Vertex> &expected, const std::vector<orc::Mesh::Vertex> &actual)
+{
+    return expected.size() == actual.size() &&
+        std::memcmp(expected.data(), actual.data(), expected.size() * sizeof(orc::Mesh::Vertex)) == 0;
+}
+
+static void requireSameMesh(const orc::Mesh &expected, const orc::Mesh &actual)
+{
+    std::vector<orc::Mesh::Vertex> expectedVertices, actualVertices;
+    std::vector<unsigned int> expectedIndices, actualIndices;
+    expected.ReadGeometry(expectedVertices, expectedIndices);
+    actual.ReadGeometry(actualVertices, actualIndices);
+    REQUIRE(verticesEqual(expectedVertices, actualVertices));
+    REQUIRE(expectedIndices == actualIndices);
+
+    REQUIRE(actual.GetNumLods() == expected.GetNumLods());
+    for (uint32_t i = 0; i < expected.GetNumLods(); i++)
+    {
+        REQUIRE(actual.GetNumIndices(i) == expected.GetNumIndices(i));
+    }
+
+    REQUIRE(actual.GetBounds().Min == expected.GetBounds().Min);
+    REQUIRE(actual.GetBounds().Max == expected.GetBounds().Max);
+    REQUIRE(actual.GetBoundingSphere().Center == expected.GetBoundingSphere().Center);
+    REQUIRE(actual.GetBoundingSphere().Radius == expected.GetBoundingSphere().Radius);
+    REQUIRE((actual.GetTriangles() != nullptr) == (expected.GetTriangles() != nullptr));
+
+    const orc::Texture2DRef &expectedTexture = static_cast<const orc::Texture2DRef &>(expected.GetTextureRef());
+    const orc::Texture2DRef &actualTexture = static_cast<const orc::Texture2DRef &>(actual.GetTextureRef());
+    REQUIRE(actualTexture.GetPath() == expectedTexture.GetPath());
+    REQUIRE(actualTexture.GetType() == expectedTexture.GetType());
+
+    REQUIRE((actual.GetOccluder() != nullptr) == (expected.GetOccluder() != nullptr));
+    if (expected.GetOccluder())
+    {
+        REQUIRE(actual.GetOccluder()->Points == expected.GetOccluder()->Points);
+        REQUIRE(actual.GetOccluder()->Indices == expected.GetOccluder()->Indices);
+    }
+}
+
+TEST_CASE("Snapshots load the hierarchy and meshes they were saved with", "[orc]") {
+    std::shared_ptr<orc::Mesh> square = fixtures::BuildSquareMesh(true);
+    std::shared_ptr<orc::Mesh> triangle = fixtures::BuildTriangleMesh();
+
+    std::shared_ptr<orc::Node> root = orc::Node::Create();
+    std::shared_ptr<orc::Object> o1 = orc::Object::Create();
+    o1->Translate(1, 2, 3);
+    o1->Rotate(0.3, -0.2, 0.1);
+    o1->Scale(2, 1, 0.5);
+    o1->AddMesh(square);
+    o1->AddMesh(triangle);
+    root->AttachChild(o1);
+
+    std::shared_ptr<orc::Node> group = orc::Node::Create();
+    group->Translate(0, -4, 0);
+    root->AttachChild(group);
+
+    std::shared_ptr<orc::Object> o2 = orc::Object::Create();
+    o2->Rotate(1.2, 0, 0);
+    o2->AddMesh(square);
+    group->AttachChild(o2);
+
+    // Lights aren't saved, nor is anything attached to them
+    std::shared_ptr<orc::OmniLight> light = orc::OmniLight::Create();
+    light->AttachChild(orc::Object::Create());
+    group->AttachChild(light);
+
+    orc::SaveSnapshot(*root, snapshotPath());
+    std::shared_ptr<orc::Node> loaded = orc::LoadSnapshot(snapshotPath());
+
+    REQUIRE(loaded->GetChildren().size() == 2);
+    orc::Object *loaded1 = static_cast<orc::Object *>(loaded->GetChildren()[0].get());
+    orc::Node *loadedGroup = loaded->GetChildren()[1].get();
+    REQUIRE(loadedGroup->GetChildren().size() == 1);
+    orc::Object *loaded2 = static_cast<orc::Object *>(loadedGroup->GetChildren()[0].get());
+    REQUIRE(loaded2->GetChildren().empty());
+
+    REQUIRE(testutils::Mat4Equals(o1->GetTransformMx(), loaded1->GetTransformMx()));
+    REQUIRE(testutils::Mat4Equals(group->GetTransformMx(), loadedGroup->GetTransformMx()));
+    REQUIRE(testutils::Mat4Equals(o2->GetTransformMx(), loaded2->GetTransformMx()));
+
+    REQUIRE(loaded1->GetMeshes().size() == 2);
+    requireSameMesh(*square, *loaded1->GetMeshes()[0]);
+    requireSameMesh(*triangle, *loaded1->GetMeshes()[1]);
+
+    // Shared meshes are still shared
+    REQUIRE(loaded2->GetMeshes().size() == 1);
+    REQUIRE(loaded2->GetMeshes()[0] == loaded1->GetMeshes()[0]);
+
+    // Loading into a pool allocates every node from it
+    orc::NodePool pool;
+    std::shared_ptr<orc::Node> pooled = orc::LoadSnapshot(snapshotPath(), pool);
+    REQUIRE(pool.GetSize() == 4);
+    REQUIRE(pool.Resolve(pooled->GetHandle()) == pooled.get());
+
+    std::remove(snapshotPath().c_str());
+}
+
+TEST_CASE("Scenes are saved without their camera and lights", "[orc]") {
+    orc::Scene scene;
+    std::shared_ptr<orc::Object> o = orc::Object::Create();
+    o->Translate(0, 0, -5);
+    o->AddMesh(fixtures::BuildTriangleMesh());
+    scene.GetRoot().AttachChild(o);
+    scene.GetRoot().AttachChild(orc::OmniLight::Create());
+    scene.Save(snapshotPath());
+
+    orc::Scene loaded;
+    loaded.Load(snapshotPath());
+    loaded.Update();
+
+    // The root holds the camera and the object
+    REQUIRE(loaded.GetRoot().GetChildren().size() == 2);
+    std::vector<orc::Node *> hits;
+    loaded.QueryNodes(orc::AABB{.Min = glm::vec3(-1.0f, -1.0f, -6.0f), .Max = glm::vec3(3.0f, 3.0f, -4.0f)}, hits);
+    REQUIRE(hits.size() == 1);
+    REQUIRE(testutils::Vec3Equals(glm::vec3(0.0f, 0.0f, -5.0f), hits[0]->GetPosition()));
+
+    std::remove(snapshotPath().c_str());
+}
+
+TEST_CASE("Snapshots that can't be loaded are rejected", "[orc]") {
+    std::shared_ptr<orc::Object> o = orc::Object::Create();
+    o->AddMesh(fixtures::BuildSquareMesh(true));
+    orc::SaveSnapshot(*o, snapshotPath());
+
+    std::vector<char> contents;
+    {
+        std::ifstream file(snapshotPath(), std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    auto rewrite = [&](const std::vector<char> &bytes) {
+        std::ofstream file(snapshotPath(), std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), bytes.size());
+    };
+
+    // Another version of the format
+    std::vector<char> version = contents;
+    version[8]++;
+    rewrite(version);
+    REQUIRE_THROWS(orc::LoadSnapshot(snapshotPath()));
+
+    // Not a snapshot at all
+    std::vector<char> magic = contents;
+    magic[0] = 'X';
+    rewrite(magic);
+    REQUIRE_THROWS(orc::LoadSnapshot(snapshotPath()));
+
+    // An index of the coarser level of detail points past the last vertex
+    const uint32_t indices[] = {0, 1, 2, 2, 3, 0, 0, 1, 2};
+    auto indicesAt = std::search(contents.begin(), contents.end(), (const char *)indices, (const char *)indices + sizeof(indices));
+    REQUIRE(indicesAt != contents.end());
+    std::vector<char> outOfRange = contents;
+    uint32_t pastLastVertex = 4;
+    std::memcpy(&outOfRange[indicesAt - contents.begin() + 8 * sizeof(uint32_t)], &pastLastVertex, sizeof(uint32_t));
+    rewrite(outOfRange);
+    REQUIRE_THROWS(orc::LoadSnapshot(snapshotPath()));
+
+    // Cut short
+    rewrite(std::vector<char>(contents.begin(), contents.end() - 16));
+    REQUIRE_THROWS(orc::LoadSnapshot(snapshotPath()));
+    rewrite({});
+    REQUIRE_THROWS(orc::LoadSnapshot(snapshotPath()));
+
+    std::remove(snapshotPath().c_str());
+    REQUIRE_THROWS(orc::LoadSnapshot(snapshotPath()));
+
+    // Only nodes and objects can be saved
+    REQUIRE_THROWS(orc::SaveSnapshot(*orc::OmniLight::Create(), snapshotPath()));
+}
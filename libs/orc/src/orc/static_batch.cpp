@@ -0,0 +1,150 @@
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include "mesh.hpp"
+#include "static_batch.hpp"
+#include "texture_2d.hpp"
+
+// Merged meshes stay small enough to be culled piecewise
+const size_t maxBatchVertices = 1 << 16;
+
+namespace orc
+{
+    // Meshes that share a texture, in the order they were given
+    struct BatchGroup
+    {
+        Texture2D::Type Type;
+        std::string Path;
+        std::vector<size_t> Members;
+    };
+
+    // A mesh's vertices and indices, read back from GL once no matter how
+    // many times the mesh is merged
+    struct BatchGeometry
+    {
+        std::vector<Mesh::Vertex> Vertices;
+        std::vector<unsigned int> Indices;
+    };
+
+    std::vector<std::shared_ptr<Mesh>> MergeStaticMeshes(
+        const std::vector<std::pair<const Mesh *, glm::mat4>> &meshes,
+        std::vector<uint8_t> &isMerged
+    )
+    {
+        std::map<std::pair<Texture2D::Type, std::string>, size_t> groupIdxs;
+        std::vector<BatchGroup> groups;
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            const Texture2DRef *texture = dynamic_cast<const Texture2DRef *>(&meshes[i].first->GetTextureRef());
+            if (!texture || meshes[i].first->GetNumVertices() == 0) continue;
+
+            auto inserted = groupIdxs.emplace(std::make_pair(texture->GetType(), texture->GetPath()), groups.size());
+            if (inserted.second)
+            {
+                groups.push_back(BatchGroup{.Type = texture->GetType(), .Path = texture->GetPath(), .Members = {}});
+            }
+            groups[inserted.first->second].Members.push_back(i);
+        }
+
+        std::map<const Mesh *, BatchGeometry> geometries;
+        std::vector<std::shared_ptr<Mesh>> merged;
+        std::vector<size_t> members;
+        std::vector<Mesh::Vertex> vertices;
+        std::vector<unsigned int> indices;
+        std::vector<glm::vec3> occluderPoints;
+        std::vector<uint32_t> occluderIndices;
+        isMerged.assign(meshes.size(), 0);
+
+        // A mesh that nothing was merged with is better off drawn as it is,
+        // with its levels of detail
+        auto flush = [&](const BatchGroup &group) {
+            if (members.size() > 1)
+            {
+                std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>(
+                    vertices,
+                    indices,
+                    std::make_unique<Texture2DRef>(group.Type, group.Path)
+                );
+                if (!occluderIndices.empty())
+                {
+                    mesh->SetOccluder(occluderPoints, occluderIndices);
+                }
+                merged.push_back(mesh);
+
+                for (size_t i : members)
+                {
+                    isMerged[i] = 1;
+                }
+            }
+
+            members.clear();
+            vertices.clear();
+            indices.clear();
+            occluderPoints.clear();
+            occluderIndices.clear();
+        };
+
+        for (const BatchGroup &group : groups)
+        {
+            for (size_t i : group.Members)
+            {
+                const Mesh &mesh = *meshes[i].first;
+                BatchGeometry &geometry = geometries[&mesh];
+                if (geometry.Vertices.empty())
+                {
+                    mesh.ReadGeometry(geometry.Vertices, geometry.Indices);
+                }
+
+                if (!vertices.empty() && vertices.size() + geometry.Vertices.size() > maxBatchVertices)
+                {
+                    flush(group);
+                }
+
+                // Normals are transformed the same way the phong shader
+                // transforms them, so merged meshes look exactly like the
+                // meshes they were merged from
+                const glm::mat4 &modelMx = meshes[i].second;
+                uint32_t first = vertices.size();
+                for (const Mesh::Vertex &v : geometry.Vertices)
+                {
+                    vertices.push_back(Mesh::Vertex{
+                        .Coordinates = glm::vec3(modelMx * glm::vec4(v.Coordinates, 1.0f)),
+                        .Normal = glm::vec3(modelMx * glm::vec4(v.Normal, 0.0f)),
+                        .TextureCoords = v.TextureCoords,
+                    });
+                }
+
+                // Levels of detail follow the mesh's own indices, and are
+                // left out
+                for (size_t k = 0; k < mesh.GetNumIndices(); k++)
+                {
+                    indices.push_back(first + geometry.Indices[k]);
+                }
+
+                if (const Mesh::Occluder *occluder = mesh.GetOccluder())
+                {
+                    uint32_t firstPoint = occluderPoints.size();
+                    for (const glm::vec3 &p : occluder->Points)
+                    {
+                        occluderPoints.push_back(glm::vec3(modelMx * glm::vec4(p, 1.0f)));
+                    }
+                    for (uint32_t idx : occluder->Indices)
+                    {
+                        occluderIndices.push_back(firstPoint + idx);
+                    }
+                }
+
+                members.push_back(i);
+            }
+
+            flush(group);
+        }
+
+        return merged;
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include "mesh.hpp"
+
+namespace orc
+{
+    // Merges meshes that are placed in the world by model matrices and never
+    // move into as few meshes as possible, so that they can be drawn with a
+    // few draw calls instead of one each. Vertices are transformed into world
+    // space, so the merged meshes are drawn with identity matrices.
+    //
+    // Meshes are merged if their textures are Texture2DRefs of the same
+    // image, up to 65536 vertices per merged mesh, so that merged meshes are
+    // still culled piecewise. Meshes that nothing could be merged with are
+    // left out, and isMerged[i] is set for each of the given meshes that was
+    // merged. Merged meshes only have a full level of detail, don't keep
+    // their triangles, and occlude with the occluders of the meshes they
+    // were merged from.
+    //
+    // Meshes are read back from GL, so this must be called on the thread that
+    // owns the context.
+    std::vector<std::shared_ptr<Mesh>> MergeStaticMeshes(
+        const std::vector<std::pair<const Mesh *, glm::mat4>> &meshes,
+        std::vector<uint8_t> &isMerged
+    );
+}
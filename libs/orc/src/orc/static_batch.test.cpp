@@ -0,0 +1,77 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <testutils/glm.hpp>
+#include <fixtures.hpp>
+#include "mesh.hpp"
+#include "static_batch.hpp"
+#include "texture_2d.hpp"
+
+TEST_CASE("Static meshes that share a texture are merged in world space", "[orc]") {
+    std::shared_ptr<orc::Mesh> square = fixtures::BuildSquareMesh(false, fixtures::ImageTexture("shared.png"));
+    std::shared_ptr<orc::Mesh> triangle = fixtures::BuildTriangleMesh(false, fixtures::ImageTexture("shared.png"));
+    std::shared_ptr<orc::Mesh> loner = fixtures::BuildTriangleMesh(false, fixtures::ImageTexture("other.png"));
+
+    // The square is placed twice, once turned to face +X
+    glm::mat4 moved = glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, 0.0f, 0.0f));
+    glm::mat4 turned = glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    std::vector<uint8_t> isMerged;
+    std::vector<std::shared_ptr<orc::Mesh>> merged = orc::MergeStaticMeshes(
+        {
+            std::make_pair(square.get(), moved),
+            std::make_pair(loner.get(), glm::mat4(1.0f)),
+            std::make_pair(square.get(), turned),
+            std::make_pair(triangle.get(), glm::mat4(1.0f)),
+        },
+        isMerged
+    );
+
+    // The mesh with a texture of its own is left alone
+    REQUIRE(merged.size() == 1);
+    REQUIRE(isMerged == std::vector<uint8_t>{1, 0, 1, 1});
+    const orc::Mesh &mesh = *merged[0];
+    REQUIRE(static_cast<const orc::Texture2DRef &>(mesh.GetTextureRef()).GetPath() == "shared.png");
+    REQUIRE(mesh.GetNumLods() == 1);
+
+    std::vector<orc::Mesh::Vertex> vertices;
+    std::vector<unsigned int> indices;
+    mesh.ReadGeometry(vertices, indices);
+    REQUIRE(vertices.size() == 11);
+    REQUIRE(indices == std::vector<unsigned int>{0, 1, 2, 2, 3, 0, 4, 5, 6, 6, 7, 4, 8, 9, 10});
+
+    REQUIRE(testutils::Vec3Equals(glm::vec3(11.0f, 1.0f, 0.0f), vertices[2].Coordinates));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(0.0f, 0.0f, 1.0f), vertices[2].Normal));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(0.0f, 0.0f, -1.0f), vertices[5].Coordinates));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(1.0f, 0.0f, 0.0f), vertices[5].Normal));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(0.0f, 1.0f, 0.0f), vertices[10].Coordinates));
+    REQUIRE(vertices[6].TextureCoords.x == 1.0f);
+    REQUIRE(vertices[6].TextureCoords.y == 1.0f);
+
+    REQUIRE(testutils::Vec3Equals(glm::vec3(0.0f, 0.0f, -1.0f), mesh.GetBounds().Min));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(11.0f, 1.0f, 0.0f), mesh.GetBounds().Max));
+
+    // Both copies of the square occlude, the triangle doesn't
+    REQUIRE(mesh.GetOccluder() != nullptr);
+    REQUIRE(mesh.GetOccluder()->Points.size() == 6);
+    REQUIRE(mesh.GetOccluder()->Indices == std::vector<uint32_t>{0, 1, 2, 3, 4, 5});
+    REQUIRE(testutils::Vec3Equals(glm::vec3(10.0f, 1.0f, 0.0f), mesh.GetOccluder()->Points[2]));
+}
+
+TEST_CASE("Static meshes that nothing shares a texture with aren't merged", "[orc]") {
+    std::shared_ptr<orc::Mesh> a = fixtures::BuildTriangleMesh(false, fixtures::ImageTexture("a.png"));
+    std::shared_ptr<orc::Mesh> b = fixtures::BuildTriangleMesh(false, fixtures::ImageTexture("b.png"));
+
+    std::vector<uint8_t> isMerged;
+    std::vector<std::shared_ptr<orc::Mesh>> merged = orc::MergeStaticMeshes(
+        {std::make_pair(a.get(), glm::mat4(1.0f)), std::make_pair(b.get(), glm::mat4(1.0f))},
+        isMerged
+    );
+
+    REQUIRE(merged.empty());
+    REQUIRE(isMerged == std::vector<uint8_t>{0, 0});
+}
@@ -38,6 +38,16 @@ namespace orc
         public:
         virtual Texture &Load() = 0;
 
+        // Identifies the texture without loading it. Refs to the same
+        // texture have the same key, so that draws can be sorted by texture
+        // on a thread that can't call GL.
+        virtual const std::string &GetKey() const = 0;
+
+        // Returns true if the texture has an alpha channel that draws must
+        // blend with. Like GetKey, doesn't call GL, but may read the header
+        // of the texture's image.
+        virtual bool IsTranslucent() const = 0;
+
         virtual ~TextureRef() = default;
     };
 }
@@ -74,6 +74,7 @@ namespace orc
     Texture2DRef::Texture2DRef(Texture2D::Type type, const std::string &path)
         : type(type)
         , path(path)
+        , numChannels(-1)
         {}
 
     Texture &Texture2DRef::Load()
@@ -85,4 +86,29 @@ namespace orc
 
         return *cache[path];
     }
+
+    const std::string &Texture2DRef::GetKey() const
+    {
+        return path;
+    }
+
+    bool Texture2DRef::IsTranslucent() const
+    {
+        if (numChannels < 0)
+        {
+            numChannels = Image::ReadChannels(path);
+        }
+
+        return numChannels == 4;
+    }
+
+    Texture2D::Type Texture2DRef::GetType() const
+    {
+        return type;
+    }
+
+    const std::string &Texture2DRef::GetPath() const
+    {
+        return path;
+    }
 }
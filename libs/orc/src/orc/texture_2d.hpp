@@ -32,10 +32,22 @@ namespace orc
 
         Texture &Load() override;
 
+        // Textures are cached by path, so the path is the key
+        const std::string &GetKey() const override;
+
+        // Images with four channels are translucent. The image's header is
+        // read the first time this is called.
+        bool IsTranslucent() const override;
+
+        Texture2D::Type GetType() const;
+
+        const std::string &GetPath() const;
+
         private:
         static std::map<std::string, std::unique_ptr<Texture2D>> cache;
 
         Texture2D::Type type;
         const std::string path;
+        mutable int numChannels;
     };
 }
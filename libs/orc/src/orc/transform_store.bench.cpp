@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "node.hpp"
+#include "transform_store.hpp"
+#include "worker_pool.hpp"
+
+// Builds a hierarchy of roughly 100k nodes: 100 children of the root, each
+// with 10 children, each with 99 leaves
+static std::shared_ptr<orc::Node> buildSyntheticScene()
+{
+    std::shared_ptr<orc::Node> root = orc::Node::Create();
+
+    for (int i = 0; i < 100; i++)
+    {
+        std::shared_ptr<orc::Node> model = orc::Node::Create();
+        model->Translate(i, 0, 0);
+        root->AttachChild(model);
+
+        for (int j = 0; j < 10; j++)
+        {
+            std::shared_ptr<orc::Node> part = orc::Node::Create();
+            part->Rotate(0.1f * j, 0, 0);
+            model->AttachChild(part);
+
+            for (int k = 0; k < 99; k++)
+            {
+                std::shared_ptr<orc::Node> leaf = orc::Node::Create();
+                leaf->Translate(0, k, 0);
+                part->AttachChild(leaf);
+            }
+        }
+    }
+
+    return root;
+}
+
+TEST_CASE("Update 100k nodes", "[orc][benchmark]") {
+    std::shared_ptr<orc::Node> root = buildSyntheticScene();
+    orc::TransformStore store;
+    store.Rebuild(*root);
+
+    BENCHMARK("Single-threaded") {
+        // Moving the root forces every node to be recomputed
+        root->Translate(0, 0, 0);
+        return store.ComputeMxs();
+    };
+
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        orc::WorkerPool pool(numThreads);
+        BENCHMARK(std::to_string(numThreads) + " threads, split at depth 2") {
+            root->Translate(0, 0, 0);
+            return store.ComputeMxs(pool, 2);
+        };
+    }
+}
@@ -0,0 +1,415 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "bounds.hpp"
+#include "mx_kernels.hpp"
+#include "node.hpp"
+#include "transform_store.hpp"
+#include "worker_pool.hpp"
+
+// Number of nodes whose matrices are composed and multiplied together. Large
+// enough to amortize the cost of calling into the kernels, small enough to
+// keep the scratch space on the stack.
+const size_t batchSize = 64;
+
+namespace orc
+{
+    glm::mat4 ComposeTransformMx(const Transform &transform)
+    {
+        // Scaling along the local axes scales the columns of the rotation
+        // matrix, and translation fills in the last column
+        const glm::mat3 &r = transform.RotationMx;
+        return glm::mat4(
+            glm::vec4(r[0] * transform.Scale.x, 0.0f),
+            glm::vec4(r[1] * transform.Scale.y, 0.0f),
+            glm::vec4(r[2] * transform.Scale.z, 0.0f),
+            glm::vec4(transform.Translation, 1.0f)
+        );
+    }
+
+    glm::mat4 InterpolateTransformMx(const glm::mat4 &from, const glm::mat4 &to, float t)
+    {
+        // Split each matrix back into its components the same way as
+        // Node::SetTransformMx
+        glm::vec3 fromScale(glm::length(glm::vec3(from[0])), glm::length(glm::vec3(from[1])), glm::length(glm::vec3(from[2])));
+        glm::vec3 toScale(glm::length(glm::vec3(to[0])), glm::length(glm::vec3(to[1])), glm::length(glm::vec3(to[2])));
+        glm::quat fromOrientation = glm::quat_cast(glm::mat3(
+            glm::vec3(from[0]) / fromScale.x,
+            glm::vec3(from[1]) / fromScale.y,
+            glm::vec3(from[2]) / fromScale.z
+        ));
+        glm::quat toOrientation = glm::quat_cast(glm::mat3(
+            glm::vec3(to[0]) / toScale.x,
+            glm::vec3(to[1]) / toScale.y,
+            glm::vec3(to[2]) / toScale.z
+        ));
+
+        Transform blended;
+        blended.Translation = glm::mix(glm::vec3(from[3]), glm::vec3(to[3]), t);
+        blended.Orientation = glm::slerp(fromOrientation, toOrientation, t);
+        blended.RotationMx = glm::mat3_cast(blended.Orientation);
+        blended.Scale = glm::mix(fromScale, toScale, t);
+        return ComposeTransformMx(blended);
+    }
+
+    TransformStore::TransformStore()
+        : kernels(GetMxKernels())
+        , journal(nullptr)
+        , isRebuilt(false)
+        , isStale(true)
+        {}
+
+    TransformStore::~TransformStore()
+    {
+        ReleaseAll();
+    }
+
+    bool TransformStore::IsStale() const
+    {
+        return isStale;
+    }
+
+    void TransformStore::Rebuild(Node &root)
+    {
+        // Hand every node its state back, then pull the state of every node
+        // that is still in the hierarchy back in, in depth-first order. Popping
+        // a node and pushing all of its children means that each subtree is
+        // fully emitted before its next sibling, keeping subtrees contiguous.
+        ReleaseAll();
+        nodes.clear();
+        parents.clear();
+        locals.clear();
+        worldMxs.clear();
+        dirty.clear();
+#ifdef ORC_CHANGE_JOURNAL
+        transformed.clear();
+#endif
+        updated.clear();
+        stepStartMxs.clear();
+        stepped.clear();
+        steppedNodes.clear();
+        localBounds.clear();
+        worldBounds.clear();
+        subtreeBounds.clear();
+        boundsStale.clear();
+        depths.clear();
+        subtreeSizes.clear();
+        derived.clear();
+
+        stack.clear();
+        stack.push_back(std::make_pair(&root, noParent));
+        while (!stack.empty())
+        {
+            auto [node, parentIdx] = stack.back();
+            stack.pop_back();
+
+            // A node may still belong to another scene if it was moved without
+            // that scene being updated
+            if (node->store)
+            {
+                node->store->Release(node->storeIdx);
+            }
+
+            size_t idx = nodes.size();
+            nodes.push_back(node);
+            parents.push_back(parentIdx);
+            locals.push_back(node->transform);
+            worldMxs.push_back(node->modelMx);
+            dirty.push_back(node->isDirty);
+#ifdef ORC_CHANGE_JOURNAL
+            transformed.push_back(0);
+#endif
+            stepStartMxs.push_back(node->modelMx);
+            stepped.push_back(1);
+            steppedNodes.push_back(idx);
+            localBounds.push_back(node->localBounds);
+            worldBounds.push_back(node->worldBounds);
+
+            // The shape of the hierarchy may have changed, so every subtree
+            // is merged again on the next update
+            subtreeBounds.push_back(EmptyAABB());
+            boundsStale.push_back(1);
+            depths.push_back(parentIdx == noParent ? 0 : depths[parentIdx] + 1);
+            subtreeSizes.push_back(1);
+            if (node->HasDerivedMxs())
+            {
+                derived.push_back(idx);
+            }
+
+            node->store = this;
+            node->storeIdx = idx;
+
+            for (const std::shared_ptr<Node> &child : node->GetChildren())
+            {
+                stack.push_back(std::make_pair(child.get(), (int32_t)idx));
+            }
+        }
+
+        // Children always follow their parents, so walking backwards
+        // accumulates the size of each subtree before it is added to its
+        // parent's
+        for (size_t i = nodes.size(); i-- > 1;)
+        {
+            subtreeSizes[parents[i]] += subtreeSizes[i];
+        }
+
+        isRebuilt = true;
+        isStale = false;
+    }
+
+    size_t TransformStore::ComputeMxs()
+    {
+        size_t numUpdated = ComputeRange(0, nodes.size());
+        FinishCompute();
+        return numUpdated;
+    }
+
+    size_t TransformStore::ComputeMxs(WorkerPool &pool, size_t splitDepth)
+    {
+        // Compute everything above the split depth, setting aside each subtree
+        // that starts at the split depth
+        size_t numUpdated = 0;
+        partitions.clear();
+        for (size_t i = 0; i < nodes.size();)
+        {
+            if (depths[i] == splitDepth)
+            {
+                partitions.push_back(std::make_pair(i, i + subtreeSizes[i]));
+                i += subtreeSizes[i];
+                continue;
+            }
+
+            if (PropagateDirty(i))
+            {
+                uint32_t idx = i;
+                ComputeBatch(&idx, 1);
+                numUpdated++;
+            }
+
+            i++;
+        }
+
+        // Subtrees don't depend on each other, and their roots' parents have
+        // all been computed by now
+        std::atomic<size_t> numPartitionUpdated(0);
+        pool.Run(partitions.size(), [this, &numPartitionUpdated](size_t i) {
+            numPartitionUpdated += ComputeRange(partitions[i].first, partitions[i].second);
+        });
+
+        FinishCompute();
+        return numUpdated + numPartitionUpdated;
+    }
+
+    size_t TransformStore::GetSize() const
+    {
+        return nodes.size();
+    }
+
+    const std::vector<Node *> &TransformStore::GetNodes() const
+    {
+        return nodes;
+    }
+
+    const std::vector<int32_t> &TransformStore::GetParents() const
+    {
+        return parents;
+    }
+
+    const std::vector<glm::mat4> &TransformStore::GetWorldMxs() const
+    {
+        return worldMxs;
+    }
+
+    const std::vector<AABB> &TransformStore::GetWorldBounds() const
+    {
+        return worldBounds;
+    }
+
+    const std::vector<AABB> &TransformStore::GetSubtreeBounds() const
+    {
+        return subtreeBounds;
+    }
+
+    const std::vector<uint32_t> &TransformStore::GetUpdatedNodes() const
+    {
+        return updated;
+    }
+
+    void TransformStore::SetJournal(ChangeJournal *journal)
+    {
+        this->journal = journal;
+    }
+
+    void TransformStore::BeginStep()
+    {
+        for (uint32_t idx : steppedNodes)
+        {
+            stepped[idx] = 0;
+        }
+        steppedNodes.clear();
+    }
+
+    glm::mat4 TransformStore::GetInterpolatedWorldMx(size_t idx, float alpha) const
+    {
+        if (!stepped[idx] || alpha >= 1.0f) return worldMxs[idx];
+        return InterpolateTransformMx(stepStartMxs[idx], worldMxs[idx], alpha);
+    }
+
+    void TransformStore::MarkStale()
+    {
+        isStale = true;
+    }
+
+    bool TransformStore::PropagateDirty(size_t idx)
+    {
+        // Because parents precede their children, a parent's dirty flag has
+        // always been resolved by the time its children are visited. Nodes
+        // that are recomputed stay dirty for the rest of the pass so that the
+        // change propagates down to their descendants.
+        int32_t p = parents[idx];
+        if (p != noParent && dirty[p])
+        {
+            dirty[idx] = 1;
+        }
+
+        return dirty[idx];
+    }
+
+    void TransformStore::ComputeBatch(const uint32_t *indices, size_t count)
+    {
+        // Each node is computed at most once per pass, so a node that hasn't
+        // been recomputed during the step still has its starting matrix
+        for (size_t k = 0; k < count; k++)
+        {
+            if (!stepped[indices[k]]) stepStartMxs[indices[k]] = worldMxs[indices[k]];
+        }
+
+        glm::mat4 localMxs[batchSize];
+        kernels.ComposeTransformMxs(locals.data(), indices, count, localMxs);
+        kernels.ComputeWorldMxs(worldMxs.data(), parents.data(), indices, localMxs, count);
+
+        for (size_t k = 0; k < count; k++)
+        {
+            worldBounds[indices[k]] = TransformAABB(localBounds[indices[k]], worldMxs[indices[k]]);
+        }
+    }
+
+    size_t TransformStore::ComputeRange(size_t begin, size_t end)
+    {
+        // Collect dirty nodes into batches. A batch is always computed in
+        // order, and before any later batch, so parents are still computed
+        // before their children.
+        uint32_t batch[batchSize];
+        size_t batchLen = 0, numUpdated = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+            if (!PropagateDirty(i)) continue;
+
+            batch[batchLen++] = i;
+            if (batchLen == batchSize)
+            {
+                ComputeBatch(batch, batchLen);
+                numUpdated += batchLen;
+                batchLen = 0;
+            }
+        }
+
+        ComputeBatch(batch, batchLen);
+        return numUpdated + batchLen;
+    }
+
+    void TransformStore::ComputeSubtreeBounds()
+    {
+        // Children always follow their parents, so walking backwards merges
+        // every child's subtree before its parent's. A node's direct children
+        // are found by skipping over each child's subtree in turn.
+        for (size_t i = nodes.size(); i-- > 0;)
+        {
+            if (!dirty[i] && !boundsStale[i]) continue;
+            boundsStale[i] = 0;
+
+            AABB bounds = worldBounds[i];
+            for (size_t c = i + 1; c < i + subtreeSizes[i]; c += subtreeSizes[c])
+            {
+                bounds = Merge(bounds, subtreeBounds[c]);
+            }
+
+            // Bounds that didn't change don't need to be merged into the
+            // parent's again
+            AABB &prev = subtreeBounds[i];
+            if (bounds.Min == prev.Min && bounds.Max == prev.Max) continue;
+
+            prev = bounds;
+            if (parents[i] != noParent)
+            {
+                boundsStale[parents[i]] = 1;
+            }
+        }
+    }
+
+    void TransformStore::FinishCompute()
+    {
+        ComputeSubtreeBounds();
+
+        for (size_t i : derived)
+        {
+            if (dirty[i] && nodes[i])
+            {
+                nodes[i]->ComputeDerivedMxs();
+            }
+        }
+
+        updated.clear();
+        for (size_t i = 0; i < dirty.size(); i++)
+        {
+            if (dirty[i])
+            {
+                updated.push_back(i);
+                dirty[i] = 0;
+#ifdef ORC_CHANGE_JOURNAL
+                transformed[i] = 0;
+#endif
+                if (!stepped[i])
+                {
+                    stepped[i] = 1;
+                    steppedNodes.push_back(i);
+                }
+            }
+        }
+
+        // Nodes that weren't in the store before it was rebuilt may not have
+        // had a valid matrix, so none of them are interpolated until the
+        // next step
+        if (isRebuilt)
+        {
+            stepStartMxs = worldMxs;
+            isRebuilt = false;
+        }
+    }
+
+    void TransformStore::Release(size_t idx)
+    {
+        Node *node = nodes[idx];
+        if (!node) return;
+
+        node->transform = locals[idx];
+        node->modelMx = worldMxs[idx];
+        node->localBounds = localBounds[idx];
+        node->worldBounds = worldBounds[idx];
+        node->isDirty = dirty[idx];
+        node->store = nullptr;
+        nodes[idx] = nullptr;
+    }
+
+    void TransformStore::ReleaseAll()
+    {
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            Release(i);
+        }
+    }
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "bounds.hpp"
+#include "change_journal.hpp"
+#include "worker_pool.hpp"
+
+namespace orc
+{
+    class Node;
+    struct MxKernels;
+
+    // Position, orientation, and scale of a node relative to its parent
+    struct Transform
+    {
+        glm::vec3 Translation;
+
+        // Always normalized
+        glm::quat Orientation;
+
+        // The rotation matrix equivalent to Orientation. It is only rebuilt
+        // when the orientation changes, so that composing a transform doesn't
+        // have to convert the quaternion every time.
+        glm::mat3 RotationMx;
+
+        glm::vec3 Scale;
+    };
+
+    // Composes a T*R*S matrix from the individual components of a transform
+    glm::mat4 ComposeTransformMx(const Transform &transform);
+
+    // Blends two T*R*S matrices, from (t = 0) to to (t = 1). Translation and
+    // scale are blended linearly and rotation spherically, so that a node
+    // that turns between the two isn't squashed halfway through.
+    glm::mat4 InterpolateTransformMx(const glm::mat4 &from, const glm::mat4 &to, float t);
+
+    // Stores the transformations of an entire node hierarchy in contiguous
+    // arrays, ordered depth-first so that parents always precede their
+    // children and every subtree occupies a contiguous range. Nodes that
+    // belong to the hierarchy act as handles into the store, reading and
+    // writing their state by index rather than holding it themselves.
+    //
+    // The store must be rebuilt after the shape of the hierarchy changes, but
+    // computing matrices for the entire hierarchy is a single linear pass.
+    class TransformStore
+    {
+        public:
+        static constexpr int32_t noParent = -1;
+
+        TransformStore();
+
+        ~TransformStore();
+
+        // Nodes hold pointers back into the store, so it cannot be copied
+        TransformStore(const TransformStore &other) = delete;
+        void operator=(const TransformStore &other) = delete;
+
+        // Returns true if a node has been attached to or detached from the
+        // hierarchy since the last rebuild
+        bool IsStale() const;
+
+        // Re-linearizes the hierarchy starting at root. Nodes that are no
+        // longer part of the hierarchy are released and take their state with
+        // them. Dirty state is preserved.
+        void Rebuild(Node &root);
+
+        // Recomputes world matrices for every dirty node and every descendant
+        // of a dirty node in a single pass. Returns the number of nodes that
+        // were recomputed.
+        size_t ComputeMxs();
+
+        // Same as above, but distributes the work across a pool of threads.
+        // Nodes above splitDepth are computed on the calling thread, then each
+        // subtree rooted at splitDepth is handed to the pool as a separate
+        // task. Since every node is computed exactly once from its parent's
+        // matrix, the results are identical to a single-threaded pass.
+        size_t ComputeMxs(WorkerPool &pool, size_t splitDepth);
+
+        size_t GetSize() const;
+
+        const std::vector<Node *> &GetNodes() const;
+
+        const std::vector<int32_t> &GetParents() const;
+
+        const std::vector<glm::mat4> &GetWorldMxs() const;
+
+        // World space bounds of each node's own content, and of each node's
+        // entire subtree
+        const std::vector<AABB> &GetWorldBounds() const;
+
+        const std::vector<AABB> &GetSubtreeBounds() const;
+
+        // Indices of the nodes that were recomputed by the last call to
+        // ComputeMxs, in ascending order, so that anything that tracks nodes
+        // can update only the ones that moved
+        const std::vector<uint32_t> &GetUpdatedNodes() const;
+
+        // Sets the journal that nodes in the store record their changes to,
+        // or nullptr to stop recording
+        void SetJournal(ChangeJournal *journal);
+
+        // Starts a new fixed step of a simulation. Each node that is
+        // recomputed during the step keeps the world matrix it had when the
+        // step began, so that it can be drawn anywhere in between. Nodes
+        // that were recomputed since the store was last rebuilt don't keep
+        // one until the next step, and are drawn where they are.
+        void BeginStep();
+
+        // Returns the world matrix of a node blended between the start of
+        // the current step (alpha = 0) and now (alpha = 1). Nodes that
+        // haven't been recomputed during the step are where they started.
+        glm::mat4 GetInterpolatedWorldMx(size_t idx, float alpha) const;
+
+        private:
+        friend class Node;
+
+        std::vector<Node *> nodes;
+        std::vector<int32_t> parents;
+        std::vector<Transform> locals;
+        std::vector<glm::mat4> worldMxs;
+        std::vector<uint8_t> dirty;
+        std::vector<uint32_t> updated;
+
+        // World matrix of each node at the start of the current step, kept
+        // the first time the node is recomputed during it, and the nodes that
+        // have been. Rebuilding marks every node as already recomputed.
+        std::vector<glm::mat4> stepStartMxs;
+        std::vector<uint8_t> stepped;
+        std::vector<uint32_t> steppedNodes;
+
+        // Bounds are recomputed along with matrices. Subtree bounds are then
+        // merged from the leaves up, but only for nodes that were recomputed
+        // or that have a child whose subtree bounds changed.
+        std::vector<AABB> localBounds, worldBounds, subtreeBounds;
+        std::vector<uint8_t> boundsStale;
+
+        // Distance of each node from the root, and the number of nodes in the
+        // subtree rooted at each node, including itself
+        std::vector<uint32_t> depths;
+        std::vector<uint32_t> subtreeSizes;
+
+        // Indices of nodes that compute additional matrices from their world
+        // matrix, e.g. cameras
+        std::vector<size_t> derived;
+
+        // Reused to avoid allocating on every rebuild or update
+        std::vector<std::pair<Node *, int32_t>> stack;
+        std::vector<std::pair<size_t, size_t>> partitions;
+
+        const MxKernels &kernels;
+        ChangeJournal *journal;
+
+#ifdef ORC_CHANGE_JOURNAL
+        // Whether each node's transformation has been journaled since the
+        // last update. Nodes are also dirtied by changes to their content or
+        // place in the hierarchy, which are journaled as changes of their own.
+        std::vector<uint8_t> transformed;
+#endif
+
+        bool isRebuilt, isStale;
+
+        void MarkStale();
+
+        // Marks the node at idx dirty if its parent is dirty. Returns true if
+        // the node needs to be recomputed.
+        bool PropagateDirty(size_t idx);
+
+        // Recomputes the world matrices of a batch of nodes, in order
+        void ComputeBatch(const uint32_t *indices, size_t count);
+
+        // Computes matrices for the range of nodes [begin, end), where the
+        // parent of the first node has already been computed
+        size_t ComputeRange(size_t begin, size_t end);
+
+        // Re-merges subtree bounds that may have changed
+        void ComputeSubtreeBounds();
+
+        // Gives nodes that were recomputed a chance to derive additional
+        // matrices, updates subtree bounds, then records which nodes were
+        // recomputed and resets all dirty flags
+        void FinishCompute();
+
+        // Copies a node's state out of the store and back into the node
+        void Release(size_t idx);
+
+        void ReleaseAll();
+    };
+}
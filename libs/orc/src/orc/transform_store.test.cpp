@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include <testutils/glm.hpp>
+#include <fixtures.hpp>
+#include "node.hpp"
+#include "transform_store.hpp"
+#include "worker_pool.hpp"
+
+TEST_CASE("Linearize hierarchy", "[orc]") {
+    std::shared_ptr<orc::Node> root = orc::Node::Create();
+    std::shared_ptr<orc::Node> a = orc::Node::Create();
+    std::shared_ptr<orc::Node> b = orc::Node::Create();
+    std::shared_ptr<orc::Node> a1 = orc::Node::Create();
+    std::shared_ptr<orc::Node> a2 = orc::Node::Create();
+    std::shared_ptr<orc::Node> a11 = orc::Node::Create();
+    a1->AttachChild(a11);
+    a->AttachChild(a1);
+    a->AttachChild(a2);
+    root->AttachChild(a);
+    root->AttachChild(b);
+
+    orc::TransformStore store;
+    store.Rebuild(*root);
+    REQUIRE(store.GetSize() == 6);
+    REQUIRE_FALSE(store.IsStale());
+
+    const std::vector<orc::Node *> &nodes = store.GetNodes();
+    const std::vector<int32_t> &parents = store.GetParents();
+    REQUIRE(nodes[0] == root.get());
+    REQUIRE(parents[0] == orc::TransformStore::noParent);
+
+    // Every parent precedes its children
+    for (size_t i = 1; i < nodes.size(); i++)
+    {
+        REQUIRE(parents[i] >= 0);
+        REQUIRE((size_t)parents[i] < i);
+    }
+
+    // The subtree rooted at a occupies a contiguous range of 4 nodes
+    size_t aIdx = std::find(nodes.begin(), nodes.end(), a.get()) - nodes.begin();
+    for (orc::Node *n : {a1.get(), a2.get(), a11.get()})
+    {
+        size_t idx = std::find(nodes.begin(), nodes.end(), n) - nodes.begin();
+        REQUIRE(idx > aIdx);
+        REQUIRE(idx < aIdx + 4);
+    }
+
+    // Attaching a node makes the store stale
+    a2->AttachChild(orc::Node::Create());
+    REQUIRE(store.IsStale());
+}
+
+TEST_CASE("Compute matrices in a single pass", "[orc]") {
+    // Build two identical hierarchies. One is computed node by node, the other
+    // through the store.
+    std::shared_ptr<orc::Node> roots[2], parents[2], children[2];
+    for (int i = 0; i < 2; i++)
+    {
+        roots[i] = orc::Node::Create();
+        parents[i] = orc::Node::Create();
+        children[i] = orc::Node::Create();
+        parents[i]->AttachChild(children[i]);
+        roots[i]->AttachChild(parents[i]);
+
+        parents[i]->Translate(-10.0f, 7.0f, -5.0f);
+        parents[i]->Rotate(0.0f, 0.0f, glm::radians(90.0f));
+        children[i]->Translate(2.0f, 1.0f, 4.0f);
+        children[i]->Scale(2.0f, 2.0f, 2.0f);
+    }
+
+    roots[0]->ComputeMxs();
+    parents[0]->ComputeMxs();
+    children[0]->ComputeMxs();
+
+    orc::TransformStore store;
+    store.Rebuild(*roots[1]);
+    REQUIRE(store.ComputeMxs() == 3);
+    REQUIRE(testutils::Mat4Equals(children[0]->GetModelMx(), children[1]->GetModelMx()));
+
+    // Nothing changed, so nothing is recomputed
+    REQUIRE(store.ComputeMxs() == 0);
+    REQUIRE(store.GetUpdatedNodes().empty());
+
+    // Transformations applied through the node land in the store, and the
+    // store reports which node moved
+    children[1]->Translate(1.0f, 0.0f, 0.0f);
+    REQUIRE(store.ComputeMxs() == 1);
+    REQUIRE(store.GetUpdatedNodes() == std::vector<uint32_t>{2});
+    REQUIRE(testutils::Vec3Equals(children[1]->GetPosition(), glm::vec3(-11.0f, 10.0f, -1.0f)));
+}
+
+TEST_CASE("Released nodes keep their transformation", "[orc]") {
+    std::shared_ptr<orc::Node> root = orc::Node::Create();
+    std::shared_ptr<orc::Node> child = orc::Node::Create();
+    root->AttachChild(child);
+
+    orc::TransformStore store;
+    store.Rebuild(*root);
+    child->Translate(3.0f, 0.0f, 0.0f);
+    store.ComputeMxs();
+
+    child->Detach();
+    store.Rebuild(*root);
+    REQUIRE(store.GetSize() == 1);
+
+    // Detached nodes are relative to the world's origin
+    child->Translate(0.0f, 1.0f, 0.0f);
+    child->ComputeMxs();
+    REQUIRE(testutils::Vec3Equals(child->GetPosition(), glm::vec3(3.0f, 1.0f, 0.0f)));
+}
+
+TEST_CASE("Multi-threaded pass matches single-threaded pass", "[orc]") {
+    // A few levels of uneven subtrees
+    std::shared_ptr<orc::Node> root = orc::Node::Create();
+    for (int i = 0; i < 8; i++)
+    {
+        std::shared_ptr<orc::Node> model = orc::Node::Create();
+        model->Translate(i, 0, -i);
+        model->Rotate(0.3f * i, 0, 0);
+        root->AttachChild(model);
+
+        for (int j = 0; j < i * 3; j++)
+        {
+            std::shared_ptr<orc::Node> part = orc::Node::Create();
+            part->Translate(0, j, 0);
+            part->Rotate(0, 0.1f * j, 0);
+            part->Scale(1.5f, 1.0f, 1.0f);
+            model->AttachChild(part);
+            part->AttachChild(orc::Node::Create());
+        }
+    }
+
+    orc::TransformStore store;
+    orc::WorkerPool pool(4);
+    store.Rebuild(*root);
+    size_t numUpdated = store.ComputeMxs();
+    std::vector<glm::mat4> expected = store.GetWorldMxs();
+
+    // Moving the root by nothing forces every node to be recomputed without
+    // changing any results
+    root->Translate(0, 0, 0);
+    REQUIRE(store.ComputeMxs(pool, 1) == numUpdated);
+    REQUIRE(store.GetWorldMxs() == expected);
+
+    root->Translate(0, 0, 0);
+    REQUIRE(store.ComputeMxs(pool, 2) == numUpdated);
+    REQUIRE(store.GetWorldMxs() == expected);
+
+    // Splitting deeper than the hierarchy computes everything up front
+    root->Translate(0, 0, 0);
+    REQUIRE(store.ComputeMxs(pool, 10) == numUpdated);
+    REQUIRE(store.GetWorldMxs() == expected);
+}
+
+TEST_CASE("Maintain subtree bounds incrementally", "[orc]") {
+    std::shared_ptr<orc::Node> root = orc::Node::Create();
+    std::shared_ptr<orc::Node> group = orc::Node::Create();
+    std::shared_ptr<fixtures::BoxNode> a = fixtures::BoxNode::Create(glm::vec3(-1.0f), glm::vec3(1.0f));
+    std::shared_ptr<fixtures::BoxNode> b = fixtures::BoxNode::Create(glm::vec3(0.0f), glm::vec3(1.0f));
+    group->AttachChild(a);
+    group->AttachChild(b);
+    root->AttachChild(group);
+
+    orc::TransformStore store;
+    store.Rebuild(*root);
+    b->Translate(5.0f, 0.0f, 0.0f);
+    store.ComputeMxs();
+
+    // Nodes without content of their own take the bounds of their subtree
+    REQUIRE(orc::IsEmpty(group->GetWorldBounds()));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(-1.0f), root->GetSubtreeBounds().Min));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(6.0f, 1.0f, 1.0f), root->GetSubtreeBounds().Max));
+
+    // Moving a leaf refreshes the bounds of its ancestors
+    a->Translate(0.0f, -10.0f, 0.0f);
+    store.ComputeMxs();
+    REQUIRE(testutils::Vec3Equals(glm::vec3(-1.0f, -11.0f, -1.0f), a->GetWorldBounds().Min));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(-1.0f, -11.0f, -1.0f), group->GetSubtreeBounds().Min));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(-1.0f, -11.0f, -1.0f), root->GetSubtreeBounds().Min));
+
+    // So does detaching, and the detached node keeps its own bounds
+    a->Detach();
+    store.Rebuild(*root);
+    store.ComputeMxs();
+    REQUIRE(testutils::Vec3Equals(glm::vec3(5.0f, 0.0f, 0.0f), root->GetSubtreeBounds().Min));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(-1.0f, -11.0f, -1.0f), a->GetSubtreeBounds().Min));
+}
+
+TEST_CASE("Nodes are interpolated across a step", "[orc]") {
+    std::shared_ptr<orc::Node> root = orc::Node::Create();
+    std::shared_ptr<orc::Node> parent = orc::Node::Create();
+    std::shared_ptr<orc::Node> child = orc::Node::Create();
+    std::shared_ptr<orc::Node> still = orc::Node::Create();
+    child->Translate(0.0f, 0.0f, -2.0f);
+    parent->AttachChild(child);
+    root->AttachChild(parent);
+    root->AttachChild(still);
+
+    // Nodes that were just attached are drawn where they are until the next
+    // step
+    orc::TransformStore store;
+    store.Rebuild(*root);
+    store.ComputeMxs();
+    REQUIRE(testutils::Mat4Equals(child->GetModelMx(), child->GetInterpolatedModelMx(0.0f)));
+
+    // Moving and turning a parent carries its children along the arc
+    store.BeginStep();
+    parent->Translate(10.0f, 0.0f, 0.0f);
+    parent->RotateAround(glm::vec3(0.0f, 1.0f, 0.0f), glm::radians(90.0f));
+    store.ComputeMxs();
+    REQUIRE(testutils::Vec3Equals(glm::vec3(0.0f, 0.0f, -2.0f), glm::vec3(child->GetInterpolatedModelMx(0.0f)[3])));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(10.0f, 0.0f, 0.0f), glm::vec3(parent->GetInterpolatedModelMx(1.0f)[3])));
+
+    glm::mat4 halfway = parent->GetInterpolatedModelMx(0.5f);
+    REQUIRE(testutils::Vec3Equals(glm::vec3(5.0f, 0.0f, 0.0f), glm::vec3(halfway[3])));
+    REQUIRE(testutils::Vec3Equals(glm::vec3(std::sqrt(0.5f), 0.0f, -std::sqrt(0.5f)), glm::vec3(halfway[0])));
+
+    // Nodes that haven't moved stay put
+    REQUIRE(testutils::Mat4Equals(still->GetModelMx(), still->GetInterpolatedModelMx(0.5f)));
+
+    // Recomputing again during the same step keeps the matrix from the start
+    // of it, and the next step starts from where the last one ended
+    parent->Translate(10.0f, 0.0f, 0.0f);
+    store.ComputeMxs();
+    REQUIRE(testutils::Vec3Equals(glm::vec3(10.0f, 0.0f, 0.0f), glm::vec3(parent->GetInterpolatedModelMx(0.5f)[3])));
+
+    store.BeginStep();
+    store.ComputeMxs();
+    REQUIRE(testutils::Mat4Equals(parent->GetModelMx(), parent->GetInterpolatedModelMx(0.5f)));
+}
@@ -0,0 +1,84 @@
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "bvh.hpp"
+#include "triangle_mesh.hpp"
+
+namespace orc
+{
+    TriangleMesh::TriangleMesh(const glm::vec3 *points, size_t count, size_t stride, const uint32_t *indices, size_t numIndices)
+        : indices(indices, indices + numIndices)
+    {
+        if (numIndices % 3 != 0)
+        {
+            throw std::logic_error("Triangle mesh indices must come in groups of three");
+        }
+
+        const char *bytes = reinterpret_cast<const char *>(points);
+        for (size_t i = 0; i < count; i++)
+        {
+            this->points.push_back(*reinterpret_cast<const glm::vec3 *>(bytes + i * stride));
+        }
+
+        std::vector<AABB> bounds;
+        for (size_t i = 0; i < numIndices; i += 3)
+        {
+            if (indices[i] >= count || indices[i + 1] >= count || indices[i + 2] >= count)
+            {
+                throw std::logic_error("Triangle mesh index is out of range");
+            }
+
+            AABB box = EmptyAABB();
+            for (size_t j = i; j < i + 3; j++)
+            {
+                box = Merge(box, this->points[indices[j]]);
+            }
+            bounds.push_back(box);
+        }
+
+        bvh.Build(bounds.data(), bounds.size());
+    }
+
+    size_t TriangleMesh::GetNumTriangles() const
+    {
+        return indices.size() / 3;
+    }
+
+    uint32_t TriangleMesh::Raycast(const Ray &ray, float &maxDistance) const
+    {
+        return bvh.Raycast(ray, maxDistance, [this, &ray](uint32_t triangle, float) {
+            const uint32_t *tri = &indices[3 * triangle];
+            return IntersectTriangle(ray, points[tri[0]], points[tri[1]], points[tri[2]]);
+        });
+    }
+
+    float IntersectTriangle(const Ray &ray, glm::vec3 a, glm::vec3 b, glm::vec3 c)
+    {
+        const float miss = std::numeric_limits<float>::infinity();
+
+        // Solve origin + t * direction = a + u * (b - a) + v * (c - a) by
+        // Cramer's rule. The determinant is zero when the ray is parallel to
+        // the triangle or the triangle is degenerate.
+        glm::vec3 ab = b - a;
+        glm::vec3 ac = c - a;
+        glm::vec3 p = glm::cross(ray.Direction, ac);
+        float det = glm::dot(ab, p);
+        if (det == 0.0f) return miss;
+
+        float invDet = 1.0f / det;
+        glm::vec3 s = ray.Origin - a;
+        float u = glm::dot(s, p) * invDet;
+        if (u < 0.0f || u > 1.0f) return miss;
+
+        glm::vec3 q = glm::cross(s, ab);
+        float v = glm::dot(ray.Direction, q) * invDet;
+        if (v < 0.0f || u + v > 1.0f) return miss;
+
+        float t = glm::dot(ac, q) * invDet;
+        return t >= 0.0f ? t : miss;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "bvh.hpp"
+
+namespace orc
+{
+    // A copy of a mesh's triangles kept in memory after the mesh has been
+    // uploaded to the GPU, along with a BVH over them, so that rays can be
+    // tested against the mesh's exact shape. Immutable once built.
+    class TriangleMesh
+    {
+        public:
+        static constexpr uint32_t noTriangle = BVH::noItem;
+
+        // Copies count points spaced stride bytes apart, which allows them to
+        // be read directly out of an array of vertices, and numIndices
+        // indices, every three of which form a triangle
+        TriangleMesh(const glm::vec3 *points, size_t count, size_t stride, const uint32_t *indices, size_t numIndices);
+
+        size_t GetNumTriangles() const;
+
+        // Finds the nearest triangle that the ray hits within maxDistance,
+        // from either side. Returns the index of the triangle, i.e. its first
+        // index divided by 3, and sets maxDistance to the distance of the hit,
+        // or returns noTriangle if the ray misses.
+        uint32_t Raycast(const Ray &ray, float &maxDistance) const;
+
+        private:
+        std::vector<glm::vec3> points;
+        std::vector<uint32_t> indices;
+        BVH bvh;
+    };
+
+    // Returns the distance at which the ray hits the triangle abc from either
+    // side (Moller and Trumbore), or infinity if it misses
+    float IntersectTriangle(const Ray &ray, glm::vec3 a, glm::vec3 b, glm::vec3 c);
+}
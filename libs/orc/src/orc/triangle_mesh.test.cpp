@@ -0,0 +1,84 @@
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include <testutils/glm.hpp>
+#include "bounds.hpp"
+#include "triangle_mesh.hpp"
+
+TEST_CASE("Intersect rays with triangles", "[orc]") {
+    glm::vec3 a(0.0f, 0.0f, 0.0f), b(1.0f, 0.0f, 0.0f), c(0.0f, 1.0f, 0.0f);
+
+    // Triangles are hit from either side
+    float d = orc::IntersectTriangle(orc::Ray{.Origin = glm::vec3(0.25f, 0.25f, 2.0f), .Direction = glm::vec3(0.0f, 0.0f, -1.0f)}, a, b, c);
+    REQUIRE(testutils::Vec3Equals(glm::vec3(2.0f), glm::vec3(d)));
+    d = orc::IntersectTriangle(orc::Ray{.Origin = glm::vec3(0.25f, 0.25f, -4.0f), .Direction = glm::vec3(0.0f, 0.0f, 2.0f)}, a, b, c);
+    REQUIRE(testutils::Vec3Equals(glm::vec3(2.0f), glm::vec3(d)));
+
+    // Outside of the triangle, behind the ray, or parallel to it
+    const float miss = std::numeric_limits<float>::infinity();
+    REQUIRE(orc::IntersectTriangle(orc::Ray{.Origin = glm::vec3(0.75f, 0.75f, 2.0f), .Direction = glm::vec3(0.0f, 0.0f, -1.0f)}, a, b, c) == miss);
+    REQUIRE(orc::IntersectTriangle(orc::Ray{.Origin = glm::vec3(0.25f, 0.25f, 2.0f), .Direction = glm::vec3(0.0f, 0.0f, 1.0f)}, a, b, c) == miss);
+    REQUIRE(orc::IntersectTriangle(orc::Ray{.Origin = glm::vec3(-1.0f, 0.25f, 0.0f), .Direction = glm::vec3(1.0f, 0.0f, 0.0f)}, a, b, c) == miss);
+}
+
+TEST_CASE("Raycast triangle mesh matches brute force", "[orc]") {
+    // A soup of random triangles, some of which overlap
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> pos(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+    std::vector<glm::vec3> points;
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        glm::vec3 center(pos(rng), pos(rng), pos(rng));
+        for (int j = 0; j < 3; j++)
+        {
+            points.push_back(center + glm::vec3(offset(rng), offset(rng), offset(rng)));
+            indices.push_back(3 * i + j);
+        }
+    }
+
+    orc::TriangleMesh mesh(points.data(), points.size(), sizeof(glm::vec3), indices.data(), indices.size());
+    REQUIRE(mesh.GetNumTriangles() == 1000);
+
+    int numHits = 0;
+    for (int r = 0; r < 200; r++)
+    {
+        orc::Ray ray{
+            .Origin = glm::vec3(pos(rng), pos(rng), -20.0f),
+            .Direction = glm::vec3(offset(rng) * 0.2f, offset(rng) * 0.2f, 1.0f),
+        };
+
+        uint32_t expected = orc::TriangleMesh::noTriangle;
+        float expectedDistance = 100.0f;
+        for (uint32_t t = 0; t < 1000; t++)
+        {
+            float d = orc::IntersectTriangle(ray, points[3 * t], points[3 * t + 1], points[3 * t + 2]);
+            if (d < expectedDistance)
+            {
+                expected = t;
+                expectedDistance = d;
+            }
+        }
+
+        float distance = 100.0f;
+        REQUIRE(mesh.Raycast(ray, distance) == expected);
+        REQUIRE(distance == expectedDistance);
+        numHits += expected != orc::TriangleMesh::noTriangle;
+    }
+
+    REQUIRE(numHits > 0);
+}
+
+TEST_CASE("Reject malformed triangle meshes", "[orc]") {
+    std::vector<glm::vec3> points = {glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)};
+    std::vector<uint32_t> partial = {0, 1};
+    std::vector<uint32_t> outOfRange = {0, 1, 3};
+
+    REQUIRE_THROWS_AS(orc::TriangleMesh(points.data(), points.size(), sizeof(glm::vec3), partial.data(), partial.size()), std::logic_error);
+    REQUIRE_THROWS_AS(orc::TriangleMesh(points.data(), points.size(), sizeof(glm::vec3), outOfRange.data(), outOfRange.size()), std::logic_error);
+}
@@ -0,0 +1,94 @@
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "worker_pool.hpp"
+
+namespace orc
+{
+    WorkerPool::WorkerPool(size_t numThreads)
+        : task(nullptr)
+        , numTasks(0)
+        , nextTask(0)
+        , numBusyThreads(0)
+        , batch(0)
+        , isStopping(false)
+    {
+        for (size_t i = 1; i < numThreads; i++)
+        {
+            threads.emplace_back(&WorkerPool::Work, this);
+        }
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isStopping = true;
+        }
+
+        wake.notify_all();
+        for (std::thread &t : threads)
+        {
+            t.join();
+        }
+    }
+
+    size_t WorkerPool::GetNumThreads() const
+    {
+        return threads.size() + 1;
+    }
+
+    void WorkerPool::Run(size_t numTasks, const std::function<void(size_t)> &task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->task = &task;
+            this->numTasks = numTasks;
+            nextTask = 0;
+            numBusyThreads = threads.size();
+            batch++;
+        }
+
+        wake.notify_all();
+        Drain();
+
+        // Every background thread must check in before returning, otherwise a
+        // slow thread could pick up the next batch's state mid-way through
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return numBusyThreads == 0; });
+        this->task = nullptr;
+    }
+
+    void WorkerPool::Work()
+    {
+        uint64_t lastBatch = 0;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this, lastBatch] { return isStopping || batch != lastBatch; });
+                if (isStopping) return;
+                lastBatch = batch;
+            }
+
+            Drain();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--numBusyThreads == 0)
+            {
+                done.notify_one();
+            }
+        }
+    }
+
+    void WorkerPool::Drain()
+    {
+        for (size_t i = nextTask++; i < numTasks; i = nextTask++)
+        {
+            (*task)(i);
+        }
+    }
+}
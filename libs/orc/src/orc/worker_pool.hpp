@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace orc
+{
+    // A fixed set of threads that execute batches of independent tasks. The
+    // thread that submits a batch also works on it, so a pool of N threads
+    // only starts N - 1 background threads.
+    class WorkerPool
+    {
+        public:
+        explicit WorkerPool(size_t numThreads);
+
+        ~WorkerPool();
+
+        // Threads can't be copied
+        WorkerPool(const WorkerPool &other) = delete;
+        void operator=(const WorkerPool &other) = delete;
+
+        size_t GetNumThreads() const;
+
+        // Invokes task once for every index in [0, numTasks), spreading the
+        // calls across all threads in the pool. Tasks are handed out one at a
+        // time, so uneven tasks are balanced automatically. Blocks until every
+        // task has completed.
+        void Run(size_t numTasks, const std::function<void(size_t)> &task);
+
+        private:
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable wake, done;
+
+        // State of the batch currently being executed
+        const std::function<void(size_t)> *task;
+        size_t numTasks;
+        std::atomic<size_t> nextTask;
+        size_t numBusyThreads;
+        uint64_t batch;
+
+        bool isStopping;
+
+        void Work();
+
+        void Drain();
+    };
+}
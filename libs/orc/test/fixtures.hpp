@@ -0,0 +1,190 @@
+#pragma once
+
+// Fixtures shared by orc's tests
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+#include <orc/bounds.hpp>
+#include <orc/frustum.hpp>
+#include <orc/mesh.hpp>
+#include <orc/node.hpp>
+#include <orc/texture.hpp>
+#include <orc/texture_2d.hpp>
+
+namespace fixtures
+{
+    // A node with content of a fixed size
+    class BoxNode : public orc::Node
+    {
+        public:
+        static std::shared_ptr<BoxNode> Create(glm::vec3 min, glm::vec3 max)
+        {
+            std::shared_ptr<BoxNode> node(new BoxNode());
+            node->SetLocalBounds(orc::AABB{.Min = min, .Max = max});
+            return node;
+        }
+    };
+
+    // A texture without an image, so that meshes can be drawn without
+    // loading any files. It can pretend to be translucent.
+    class BlankTexture : public orc::Texture
+    {
+        public:
+        BlankTexture(bool isTranslucent = false) : isTranslucent(isTranslucent) {}
+
+        void Use() override
+        {
+            Bind(GL_TEXTURE_2D);
+        }
+
+        int64_t GetRenderSortKey() const override
+        {
+            return isTranslucent ? 1 : 0;
+        }
+
+        private:
+        bool isTranslucent;
+    };
+
+    class BlankTextureRef : public orc::TextureRef
+    {
+        public:
+        BlankTextureRef(bool isTranslucent = false)
+            : isTranslucent(isTranslucent)
+            , key(isTranslucent ? "blank translucent" : "blank")
+            {}
+
+        orc::Texture &Load() override
+        {
+            if (!texture) texture = std::make_unique<BlankTexture>(isTranslucent);
+            return *texture;
+        }
+
+        const std::string &GetKey() const override
+        {
+            return key;
+        }
+
+        bool IsTranslucent() const override
+        {
+            return isTranslucent;
+        }
+
+        private:
+        bool isTranslucent;
+        std::string key;
+        std::unique_ptr<BlankTexture> texture;
+    };
+
+    // A reference to an image that is never loaded, so meshes that aren't
+    // drawn can still be told apart by their texture
+    inline std::unique_ptr<orc::TextureRef> ImageTexture(const std::string &path)
+    {
+        return std::make_unique<orc::Texture2DRef>(orc::Texture2D::Type::BaseColor, path);
+    }
+
+    // A triangle in the XY plane, within the unit square. Without a texture,
+    // it refers to an image that doesn't exist, so it must not be drawn.
+    inline std::shared_ptr<orc::Mesh> BuildTriangleMesh(bool keepTriangles = false, std::unique_ptr<orc::TextureRef> texture = nullptr)
+    {
+        std::vector<orc::Mesh::Vertex> vertices = {
+            orc::Mesh::Vertex{.Coordinates = glm::vec3(0.0f, 0.0f, 0.0f), .Normal = glm::vec3(0.0f, 0.0f, 1.0f), .TextureCoords = glm::vec2(0.0f)},
+            orc::Mesh::Vertex{.Coordinates = glm::vec3(1.0f, 0.0f, 0.0f), .Normal = glm::vec3(0.0f, 0.0f, 1.0f), .TextureCoords = glm::vec2(0.0f)},
+            orc::Mesh::Vertex{.Coordinates = glm::vec3(0.0f, 1.0f, 0.0f), .Normal = glm::vec3(0.0f, 0.0f, 1.0f), .TextureCoords = glm::vec2(0.0f)},
+        };
+
+        return std::make_shared<orc::Mesh>(
+            vertices,
+            std::vector<unsigned int>{0, 1, 2},
+            texture ? std::move(texture) : ImageTexture("unused.png"),
+            keepTriangles
+        );
+    }
+
+    // The unit square in the XY plane, with a coarser level of detail and an
+    // occluder. Like the triangle, it must not be drawn without a texture.
+    inline std::shared_ptr<orc::Mesh> BuildSquareMesh(bool keepTriangles = false, std::unique_ptr<orc::TextureRef> texture = nullptr)
+    {
+        std::vector<orc::Mesh::Vertex> vertices = {
+            orc::Mesh::Vertex{.Coordinates = glm::vec3(0.0f, 0.0f, 0.0f), .Normal = glm::vec3(0.0f, 0.0f, 1.0f), .TextureCoords = glm::vec2(0.0f, 0.0f)},
+            orc::Mesh::Vertex{.Coordinates = glm::vec3(1.0f, 0.0f, 0.0f), .Normal = glm::vec3(0.0f, 0.0f, 1.0f), .TextureCoords = glm::vec2(1.0f, 0.0f)},
+            orc::Mesh::Vertex{.Coordinates = glm::vec3(1.0f, 1.0f, 0.0f), .Normal = glm::vec3(0.0f, 0.0f, 1.0f), .TextureCoords = glm::vec2(1.0f, 1.0f)},
+            orc::Mesh::Vertex{.Coordinates = glm::vec3(0.0f, 1.0f, 0.0f), .Normal = glm::vec3(0.0f, 0.0f, 1.0f), .TextureCoords = glm::vec2(0.0f, 1.0f)},
+        };
+
+        std::shared_ptr<orc::Mesh> mesh = std::make_shared<orc::Mesh>(
+            vertices,
+            std::vector<unsigned int>{0, 1, 2, 2, 3, 0},
+            texture ? std::move(texture) : ImageTexture("unused.png"),
+            keepTriangles,
+            std::vector<std::vector<unsigned int>>{{0, 1, 2}}
+        );
+        mesh->SetOccluder({glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)}, {0, 1, 2});
+        return mesh;
+    }
+
+    // Queries that a spatial index, e.g. a BVH or a loose octree, runs for
+    // all of its items at once, and that can be run against each item's
+    // bounds alone
+    struct FrustumQuery
+    {
+        orc::Frustum Frustum;
+
+        bool Matches(const orc::AABB &box) const { return orc::Intersects(Frustum, box); }
+
+        template <typename Index>
+        void Run(const Index &index, std::vector<uint32_t> &out) const { index.Query(Frustum, out); }
+    };
+
+    struct BoxQuery
+    {
+        orc::AABB Region;
+
+        bool Matches(const orc::AABB &box) const { return orc::Intersects(box, Region); }
+
+        template <typename Index>
+        void Run(const Index &index, std::vector<uint32_t> &out) const { index.Query(Region, out); }
+    };
+
+    struct SphereQuery
+    {
+        orc::BoundingSphere Region;
+
+        bool Matches(const orc::AABB &box) const { return orc::Intersects(box, Region); }
+
+        template <typename Index>
+        void Run(const Index &index, std::vector<uint32_t> &out) const { index.Query(Region, out); }
+    };
+
+    struct RayQuery
+    {
+        orc::Ray Ray;
+        float MaxDistance;
+
+        bool Matches(const orc::AABB &box) const { float d; return orc::Intersects(Ray, box, MaxDistance, d); }
+
+        template <typename Index>
+        void Run(const Index &index, std::vector<uint32_t> &out) const { index.Query(Ray, MaxDistance, out); }
+    };
+
+    // Runs the same query against a spatial index and every item's bounds
+    // individually, where the index holds item i with bounds boxes[i]
+    template <typename Index, typename Query>
+    void RequireSameResults(const Index &index, const std::vector<orc::AABB> &boxes, const Query &query)
+    {
+        std::vector<uint32_t> expected, found;
+        for (uint32_t i = 0; i < boxes.size(); i++)
+        {
+            if (query.Matches(boxes[i])) expected.push_back(i);
+        }
+
+        query.Run(index, found);
+        std::sort(found.begin(), found.end());
+        REQUIRE(found == expected);
+    }
+}
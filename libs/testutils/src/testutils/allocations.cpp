@@ -0,0 +1,67 @@
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "allocations.hpp"
+
+// Every allocation made by each thread, and the number of counters that are
+// alive on it. Nothing is counted while there are none.
+static thread_local size_t numAllocations = 0;
+static thread_local size_t numCounters = 0;
+
+static void *allocate(size_t size)
+{
+    if (numCounters > 0) numAllocations++;
+
+    void *ptr = std::malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void *operator new(size_t size)
+{
+    return allocate(size);
+}
+
+void *operator new[](size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace testutils
+{
+    AllocationCounter::AllocationCounter()
+        : start(numAllocations)
+    {
+        numCounters++;
+    }
+
+    AllocationCounter::~AllocationCounter()
+    {
+        numCounters--;
+    }
+
+    size_t AllocationCounter::GetCount() const
+    {
+        return numAllocations - start;
+    }
+}
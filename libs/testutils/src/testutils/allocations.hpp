@@ -0,0 +1,21 @@
+#include <cstddef>
+
+namespace testutils
+{
+    // Counts heap allocations made through operator new by the current
+    // thread, from construction until destruction. Linking this in replaces
+    // the global operator new and delete of the whole test binary, which
+    // otherwise behave as usual.
+    class AllocationCounter
+    {
+        public:
+        AllocationCounter();
+
+        ~AllocationCounter();
+
+        size_t GetCount() const;
+
+        private:
+        size_t start;
+    };
+}